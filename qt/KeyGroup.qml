@@ -128,7 +128,7 @@ ToolBar {
             }
             hoverEnabled: true
             ToolTip.visible: hovered
-            ToolTip.text: cConnector.evalText
+            ToolTip.text: cConnector.evaluating ? qsTr("Evaluating...") : cConnector.evalText
             background: Rectangle {
                 id: runButtonID
                 color: (cConnector.evalText === "Evaluate Proof") ? (darkMode ? "#BB86FC" : "white") : (cConnector.evalText === "Correct!") ? (darkMode ? "springgreen" : "green") : "red"
@@ -137,7 +137,6 @@ ToolBar {
 
             onClicked: {
                 cConnector.evalProof(theData, theGoals)
-                goalDataID.evalGoals(theGoals, cConnector)
                 animationID.start()
             }
 
@@ -179,9 +179,7 @@ Item {
                 background: Rectangle {
                     id: backRectID
                     border.width: 1
-                    border.color: ((cConnector.evalText).includes(
-                                       "Error in line " + (indexx + 1) + " -")
-                                   && cConnector.evalText !== "Evaluate Proof") ? "red" : (cConnector.evalText === "Evaluate Proof") ? (darkMode ? "white" : "black") : "springgreen"
+                    border.color: (model.verdict === ProofModel.Incorrect) ? "red" : (model.verdict === ProofModel.Correct) ? "springgreen" : (darkMode ? "white" : "black")
                     color: textFieldColor
                 }
 
@@ -13,6 +13,7 @@ SOURCES += \
         goaldata.cpp \
         goalmodel.cpp \
         goals-qt.c \
+        ../src/goal-index.c \
         settings.cpp \
         ../src/interop-isar.c \
         ../src/list.c \
@@ -23,13 +24,18 @@ SOURCES += \
         proofdata.cpp \
         proofmodel.cpp \
         ../src/sen-data.c \
+        ../src/sexpr-cong.c \
+        ../src/sexpr-prenex.c \
         ../src/sexpr-process-bool.c \
         ../src/sexpr-process-equiv.c \
         ../src/sexpr-process-infer.c \
         ../src/sexpr-process-misc.c \
         ../src/sexpr-process-quant.c \
         ../src/sexpr-process.c \
+        ../src/sexpr-rewrite.c \
+        ../src/sexpr-scope.c \
         ../src/var.c \
+        ../src/var-index.c \
         ../src/vec.c
 
 RESOURCES += qml.qrc \
@@ -72,6 +78,7 @@ HEADERS += \
     goaldata.h \
     goalmodel.h \
     goals-qt.h \
+    ../src/goal-index.h \
     settings.h \
     ../src/interop-isar.h \
     ../src/list.h \
@@ -81,9 +88,14 @@ HEADERS += \
     proofmodel.h \
     ../src/rules.h \
     ../src/sen-data.h \
+    ../src/sexpr-cong.h \
+    ../src/sexpr-prenex.h \
     ../src/sexpr-process.h \
+    ../src/sexpr-rewrite.h \
+    ../src/sexpr-scope.h \
     ../src/typedef.h \
     ../src/var.h \
+    ../src/var-index.h \
     ../src/vec.h
 
 # Uncomment the below lines when compiling to webassembly
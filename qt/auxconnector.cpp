@@ -25,7 +25,9 @@
 #include <QDebug>
 #include <QFile>
 #include <QFileDialog>
+#include <QPointer>
 #include <QSaveFile>
+#include <QSharedPointer>
 
 #ifndef Q_OS_WASM
 #include <QProcess>
@@ -80,6 +82,8 @@ void auxConnector::wasmLatex(const ProofData *pd, Connector *c)
 }
 
 /* Imports a proof into the current proof.
+ *  The file is read and converted in the background, then all of its
+ *  lines are inserted at once.
  *  input:
  *    name  - filename of the imported proof file.
  *    pd    - pointer to the ProofData object.
@@ -88,148 +92,89 @@ void auxConnector::wasmLatex(const ProofData *pd, Connector *c)
  *  output:
  *    none.
  */
-void auxConnector::importProof(const QString &name, ProofData *pd, const Connector *c, ProofModel *pm)
+void auxConnector::importProof(const QString &name, ProofData *pd, Connector *c, ProofModel *pm)
 {
-    QString newName = name.contains("file://")? name.mid(7): name;
-    char *file_name = (char *) calloc((newName.size()+1), sizeof(char));
-    memcpy(file_name, newName.toStdString().c_str(), newName.size());
-
-    proof_t *proof = aio_open(file_name);
-
-    if (!proof) {
-        qDebug() << "Failed to import proof";
-        free(file_name);
-        return;
-    }
-
-    item_t *pf_itr;
-    int ref_num = 0, ev_conc = -1, ev_itr;
-    short *refs;
-
-    refs = (short *) calloc (proof->everything->num_stuff, sizeof(int));
-
-    while (pd->lines().size() > 0) {
-        pd->removeLineAt(0);
-    }
-    
-    // 2. TELL THE UI THE LIST IS NOW EMPTY 
-    pm->updateLines(); 
+    Q_UNUSED(pm);
 
-    int num_ins = 0;
-    for (pf_itr =(item_t *) proof->everything->head; pf_itr != NULL; pf_itr = pf_itr->next){
-        sen_data *sd;
-        char *pf_text;
-
-        sd = (sen_data *) pf_itr->value;
-        if (!sd->premise)
-            break;
+    QString newName = name.contains("file://")? name.mid(7): name;
+    std::string file_name = newName.toStdString();
 
-        pf_text = (char *) sd->text;
+    QSharedPointer<QVector<ProofLine>> lines(new QVector<ProofLine>);
+    QHash<int,QString> ruleNames = c->reverseRulesMap;
+    QPointer<ProofData> data(pd);
 
-        for (ev_itr = 0; ev_itr < pd->lines().size(); ev_itr++){
-            char *ev_text;
-            int ln = ev_itr + 1;
+    auto build = [lines, ruleNames, file_name](proof_t *proof){
+        QHash<QString,int> premises;
+        QList<int> refs = {-1};
+        item_t *pf_itr;
 
-            if (pd->lines().at(ev_itr).pType != "premise"){
-                if (ev_conc == -1)
-                    ev_conc = ev_itr;
+        // Each premise is added once; the lemmas cite them all.
+        for (pf_itr = proof->everything->head; pf_itr != NULL; pf_itr = pf_itr->next){
+            sen_data *sd = (sen_data *) pf_itr->value;
+            if (!sd->premise)
                 break;
-            }
 
-            std::string str = pd->lines().at(ev_itr).pText.toStdString();
-            ev_text = (char *) calloc((strlen(str.c_str()))+1, sizeof(char));
-            memcpy(ev_text, str.c_str(), strlen(str.c_str()));
-
-            if (!strcmp(ev_text, pf_text)){
-                refs[ref_num++] = (short) ln;
-                free(ev_text);
-                break;
+            QString text = (const char *) sd->text;
+            int ln = premises.value(text, 0);
+
+            if (ln == 0){
+                ProofLine line;
+                line.pLine = lines->size() + 1;
+                line.pText = text;
+                line.pType = ruleNames.value((sd->depth > 0) ? -2 : sd->rule);
+                line.pSub = false;
+                line.pSubStart = false;
+                line.pSubEnd = false;
+                line.pInd = sd->depth * 20;
+                line.pRefs = {-1};
+                line.fname = (unsigned char *) strdup(file_name.c_str());
+                lines->append(line);
+
+                ln = lines->size();
+                premises.insert(text, ln);
             }
-            if (ev_text)
-                free(ev_text);
-        }
-
-        if (ev_itr >= pd->lines().size() || pd->lines().at(ev_itr).pType != "premise"){
-            QList<int> temp_refs = {-1};
-//            for (int i = 0; sd->refs[i] != REF_END; i++)
-//                temp_refs.push_back(sd->refs[i]);
-
-            if (sd->depth > 0)
-                sd->rule = -2;
-            pd->insertLine(num_ins,num_ins+1,(const char *) sd->text,c->reverseRulesMap[sd->rule],false,
-                               false,false, sd->depth * 20,temp_refs);
-            pd->setFile(num_ins,newName);
-            pm->updateLines();
-            pm->updateRefs(num_ins,true);
-            num_ins++;
 
-            refs[ref_num++] = (short) num_ins;
+            refs.append(ln);
         }
 
-    }
-
-    refs[ref_num] = REF_END;
-
-    if (ev_conc == -1){
-        for (ev_itr = 0; ev_itr < pd->lines().size(); ev_itr++){
-            if (pd->lines().at(ev_itr).pType == "premise"){
-                if (ev_conc == -1)
-                    ev_conc = ev_itr;
-                break;
-            }
+        // Each goal that is not a premise becomes a lemma, placed right
+        // after the premises.
+        const int num_premises = lines->size();
+        for (pf_itr = proof->goals->head; pf_itr != NULL; pf_itr = pf_itr->next){
+            QString text = (const char *) pf_itr->value;
+            if (premises.contains(text))
+                continue;
+
+            ProofLine line;
+            line.pText = text;
+            line.pType = ruleNames.value(RULE_LM);
+            line.pSub = false;
+            line.pSubStart = false;
+            line.pSubEnd = false;
+            line.pInd = 0;
+            line.pRefs = refs;
+            line.fname = (unsigned char *) strdup(file_name.c_str());
+            lines->insert(num_premises, line);
         }
-    }
-
-    for (pf_itr = proof->goals->head; pf_itr != NULL; pf_itr = pf_itr->next){
-
-        unsigned char *pf_text;
-        pf_text = (unsigned char *) pf_itr->value;
-
-        for (ev_itr = ev_conc; ev_itr < pd->lines().size(); ev_itr++){
-
-            unsigned char *ev_text;
-            std::string str = pd->lines().at(ev_itr).pText.toStdString();
-            ev_text = (unsigned char *) calloc((strlen(str.c_str()))+1, sizeof(unsigned char));
-            memcpy(ev_text, str.c_str(), strlen(str.c_str()));
 
+        for (int i = num_premises; i < lines->size(); i++)
+            (*lines)[i].pLine = i + 1;
+    };
 
-            if (!strcmp((char *)pf_text,(char *)ev_text)){
-                free(ev_text);
-                break;
-            }
-            if (ev_text)
-                free(ev_text);
+    auto done = [lines, data](bool opened){
+        if (!opened){
+            qDebug() << "Failed to import proof";
+            return;
         }
 
-        if (ev_itr >= pd->lines().size()){
-            sen_data *sd;
-            sd = sen_data_init(-1,RULE_LM,(unsigned char *)pf_text,refs,0,(unsigned char *)file_name,0,0,NULL);
-            qDebug()<< file_name;
+        if (!data)
+            return;
 
-            QList<int> temp_refs = {-1};
-            for (int i = 0; sd->refs[i] != REF_END; i++)
-                temp_refs.push_back(sd->refs[i]);
-
-            int l;
-            for (l = 0; l < pd->lines().size(); l++){
-                if (pd->lines().at(l).pType != "premise")
-                    break;
-            }
-
-            pd->insertLine(l,l+1,(const char *) sd->text,c->reverseRulesMap[sd->rule],false,
-                           false,false, sd->depth * 20,temp_refs);
-            pd->setFile(l,newName);
-            pm->updateLines();
-            pm->updateRefs(l,true);
-
-        }
-
-    }
+        data->removeLines(0, data->size());
+        data->insertLines(0, *lines);
+    };
 
-    free(refs);
-    proof_destroy(proof);
-    if (file_name)
-        free(file_name);
+    c->loadProof(newName, build, done);
 }
 
 /* Imports a proof into the current proof (for WebAssembly).
@@ -240,7 +185,7 @@ void auxConnector::importProof(const QString &name, ProofData *pd, const Connect
  *  output:
  *    none.
  */
-void auxConnector::wasmImportProof(ProofData *pd, const Connector *c, ProofModel *pm)
+void auxConnector::wasmImportProof(ProofData *pd, Connector *c, ProofModel *pm)
 {
     auto fileContentReady = [this, &c, &pd, &pm](const QString &fileName, const QByteArray &fileContent) {
         if (fileName.isEmpty()) {
@@ -30,8 +30,8 @@ public:
 
     Q_INVOKABLE void latex(const QString &name, const ProofData *toBeEval , Connector *c);
     Q_INVOKABLE void wasmLatex(const ProofData *pd, Connector *c);
-    Q_INVOKABLE void importProof(const QString &name, ProofData *pd, const Connector *c, ProofModel *pm);
-    Q_INVOKABLE void wasmImportProof(ProofData *pd, const Connector *c, ProofModel *pm);
+    Q_INVOKABLE void importProof(const QString &name, ProofData *pd, Connector *c, ProofModel *pm);
+    Q_INVOKABLE void wasmImportProof(ProofData *pd, Connector *c, ProofModel *pm);
 
 #ifndef Q_OS_WASM
     Q_INVOKABLE void newWindow();
@@ -0,0 +1,464 @@
+/* Headless benchmark of the latency of editing actions in aris-qt.
+
+   Copyright (C) 2026 The GNU Aris contributors.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Replays scripted editing sessions through the same Connector,
+// auxConnector and model calls that the QML front end makes, and reports
+// the latency of each kind of action.  Run it with QT_QPA_PLATFORM=offscreen on a machine
+// without a display:
+//
+//   aris-qt-bench [--lines N] [--rounds N] [--seed N] [proof.tle ...]
+//
+// Without files, a generated proof of --lines lines is used.
+
+#include "auxconnector.h"
+#include "connector.h"
+#include "goaldata.h"
+#include "goalmodel.h"
+#include "proofdata.h"
+#include "proofmodel.h"
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QMap>
+#include <QRandomGenerator>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QTimer>
+#include <algorithm>
+#include <cmath>
+#include <sys/resource.h>
+
+// How long to wait for a background job, in milliseconds.
+#define BENCH_TIMEOUT 60000
+
+// The latencies of each kind of action, in nanoseconds.
+typedef QMap<QString, QVector<qint64>> Latencies;
+
+// The objects QML works with, as set up by main.cpp.
+struct Session {
+    ProofData *data;
+    GoalData *goals;
+    ProofModel *model;
+    GoalModel *goalModel;
+    Connector *c;
+    auxConnector *aux;
+    Latencies latencies;
+};
+
+/* Runs the event loop until a signal is emitted.
+ *  input:
+ *    sender    - the object emitting the signal.
+ *    signal    - the signal to wait for.
+ *  output:
+ *    true if the signal was emitted, false on timeout.
+ */
+template <typename Sender, typename Signal>
+static bool waitFor(const Sender *sender, Signal signal)
+{
+    QEventLoop loop;
+    QTimer timer;
+
+    timer.setSingleShot(true);
+    QObject::connect(sender, signal, &loop, [&loop](){ loop.exit(0); });
+    QObject::connect(&timer, &QTimer::timeout, &loop, [&loop](){ loop.exit(1); });
+    timer.start(BENCH_TIMEOUT);
+
+    return loop.exec() == 0;
+}
+
+/* Fills the session with a generated proof.
+ *  Two premises are followed by alternating conjunctions and
+ *  simplifications, each citing the lines before it.
+ *  input:
+ *    s         - the session.
+ *    numLines  - the number of lines to generate, at least 2.
+ *  output:
+ *    none.
+ */
+static void generateProof(Session &s, int numLines)
+{
+    const QString conj = QStringLiteral("(A \u2227 B)");
+    QVector<ProofLine> lines;
+
+    for (int ln = 1; ln <= numLines; ln++){
+        ProofLine line = {ln, "", "premise", false, false, false, 0, {-1}, NULL};
+
+        if (ln <= 2){
+            line.pText = (ln == 1) ? "A" : "B";
+        }
+        else if (ln % 2){
+            line.pText = conj;
+            line.pType = "Conjunction";
+            line.pRefs = {-1, 1, 2};
+        }
+        else{
+            line.pText = "A";
+            line.pType = "Simplification";
+            line.pRefs = {-1, ln - 1};
+        }
+        lines.append(line);
+    }
+
+    s.data->replaceLines(0, s.data->size(), lines);
+
+    s.goals->insertgLine(0, -2, false, conj);
+    while (s.goals->glines().size() > 1)
+        s.goals->removegLineAt(1);
+}
+
+/* Runs the event loop until a proof file has been loaded.
+ *  input:
+ *    s     - the session.
+ *  output:
+ *    true if the proof was loaded.
+ */
+static bool waitForLoad(Session &s)
+{
+    bool opened = false;
+    QMetaObject::Connection conn;
+
+    conn = QObject::connect(s.c, &Connector::proofLoaded, [&opened](bool ok){ opened = ok; });
+    bool loaded = waitFor(s.c, &Connector::proofLoaded);
+    QObject::disconnect(conn);
+
+    return loaded && opened;
+}
+
+/* Opens a proof file as the Open dialog does.
+ * The time runs until the lines and the goals have been loaded.
+ *  input:
+ *    s     - the session.
+ *    name  - the path of the proof file.
+ *  output:
+ *    true if the proof was loaded.
+ */
+static bool openProof(Session &s, const QString &name)
+{
+    QElapsedTimer timer;
+
+    timer.start();
+    s.c->openProof(name, s.data, s.goals);
+    if (!waitForLoad(s))
+        return false;
+    s.latencies["open"].append(timer.nsecsElapsed());
+
+    return true;
+}
+
+/* Imports a proof file as the Import Proof dialog does.
+ * The imported premises and lemmas replace the loaded proof.
+ *  input:
+ *    s     - the session.
+ *    name  - the path of the proof file.
+ *  output:
+ *    true if the proof was imported.
+ */
+static bool importProof(Session &s, const QString &name)
+{
+    QElapsedTimer timer;
+
+    timer.start();
+    s.aux->importProof(name, s.data, s.c, s.model);
+    if (!waitForLoad(s))
+        return false;
+    s.latencies["import"].append(timer.nsecsElapsed());
+
+    return true;
+}
+
+/* Exports the proof to a LaTeX file, as the Export menu does.
+ *  input:
+ *    s     - the session.
+ *  output:
+ *    true if the file was written.
+ */
+static bool exportLatex(Session &s)
+{
+    QTemporaryDir dir;
+    QElapsedTimer timer;
+
+    if (!dir.isValid())
+        return false;
+
+    timer.start();
+    s.aux->latex(dir.filePath("bench.tex"), s.data, s.c);
+    s.latencies["latex"].append(timer.nsecsElapsed());
+
+    return QFile::exists(dir.filePath("bench.tex"));
+}
+
+/* Changes the text of a line, as finishing an edit does.
+ *  input:
+ *    s     - the session.
+ *    row   - the line to edit.
+ *  output:
+ *    none.
+ */
+static void typeText(Session &s, int row)
+{
+    QModelIndex idx = s.model->index(row, 0);
+    QString text = s.model->data(idx, ProofModel::TextRole).toString();
+    QElapsedTimer timer;
+
+    // Alternate between adding and removing a trailing space, so the
+    // proof stays the same from round to round.
+    text = text.endsWith(' ') ? text.chopped(1) : text + ' ';
+
+    timer.start();
+    s.model->setData(idx, text, ProofModel::TextRole);
+    s.c->setEvalText("Evaluate Proof");
+    QCoreApplication::processEvents();
+    s.latencies["type"].append(timer.nsecsElapsed());
+}
+
+/* Inserts a conclusion after a line, then removes it again,
+ * as the line options menu does.
+ *  input:
+ *    s     - the session.
+ *    row   - the line to insert after.
+ *  output:
+ *    none.
+ */
+static void insertRemoveLine(Session &s, int row)
+{
+    QModelIndex idx = s.model->index(row, 0);
+    bool sub = s.model->data(idx, ProofModel::SubRole).toBool();
+    int ind = s.model->data(idx, ProofModel::IndentRole).toInt();
+    QElapsedTimer timer;
+
+    timer.start();
+    s.data->insertLine(row + 1, row + 2, "", "choose", sub, false, false, ind, {-1});
+    s.model->updateLines();
+    s.model->updateRefs(row + 1, true);
+    s.c->setEvalText("Evaluate Proof");
+    QCoreApplication::processEvents();
+    s.latencies["insert"].append(timer.nsecsElapsed());
+
+    timer.restart();
+    s.data->removeLineAt(row + 1);
+    s.model->updateLines();
+    s.model->updateRefs(row + 1, false);
+    s.c->setEvalText("Evaluate Proof");
+    QCoreApplication::processEvents();
+    s.latencies["remove"].append(timer.nsecsElapsed());
+}
+
+/* Toggles a reference to the first line, as clicking a line number does.
+ *  input:
+ *    s     - the session.
+ *    row   - the line whose references change.
+ *  output:
+ *    none.
+ */
+static void toggleReference(Session &s, int row)
+{
+    QModelIndex idx = s.model->index(row, 0);
+    QVariantList refs = s.model->data(idx, ProofModel::RefsRole).toList();
+    QElapsedTimer timer;
+
+    if (refs.contains(1))
+        refs.removeAll(1);
+    else
+        refs.append(1);
+
+    timer.start();
+    s.model->setData(idx, refs, ProofModel::RefsRole);
+    s.c->setEvalText("Evaluate Proof");
+    QCoreApplication::processEvents();
+    s.latencies["reference"].append(timer.nsecsElapsed());
+}
+
+/* Evaluates the proof and its goals, as the Evaluate button does.
+ * The time runs until the goals have been checked.
+ *  input:
+ *    s     - the session.
+ *  output:
+ *    true if the evaluation finished.
+ */
+static bool evaluate(Session &s)
+{
+    QElapsedTimer timer;
+
+    timer.start();
+    if (!s.c->evalProof(s.data, s.goals))
+        return false;
+    if (!waitFor(s.c, &Connector::evaluationFinished))
+        return false;
+    s.goalModel->evalGoals(s.goals, s.c);
+    s.latencies["evaluate"].append(timer.nsecsElapsed());
+
+    return true;
+}
+
+/* Replays an editing session on the loaded proof.
+ *  Each round edits a random line, inserts and removes a line after it,
+ *  toggles one of its references, and evaluates the proof.
+ *  input:
+ *    s         - the session.
+ *    rounds    - the number of rounds.
+ *    rng       - the random number generator.
+ *  output:
+ *    true if every evaluation finished.
+ */
+static bool replay(Session &s, int rounds, QRandomGenerator &rng)
+{
+    if (s.data->size() < 1)
+        return true;
+
+    for (int i = 0; i < rounds; i++){
+        int row = rng.bounded(s.data->size());
+
+        typeText(s, row);
+        insertRemoveLine(s, row);
+        toggleReference(s, row);
+        if (!evaluate(s))
+            return false;
+    }
+
+    return true;
+}
+
+/* Returns a percentile of a sorted list of latencies.
+ *  input:
+ *    sorted    - the latencies, in ascending order.
+ *    p         - the percentile, between 0 and 1.
+ *  output:
+ *    the latency at percentile p.
+ */
+static qint64 percentile(const QVector<qint64> &sorted, double p)
+{
+    int i = (int) std::ceil(p * sorted.size()) - 1;
+    return sorted.at(qBound(0, i, (int) sorted.size() - 1));
+}
+
+/* Prints the latency of each kind of action.
+ *  input:
+ *    out       - the stream to print to.
+ *    title     - the name of the session.
+ *    latencies - the latencies of each kind of action.
+ *  output:
+ *    none.
+ */
+static void report(QTextStream &out, const QString &title, const Latencies &latencies)
+{
+    out << title << "\n";
+    out << QString("  %1 %2 %3 %4 %5\n").arg("action", -10).arg("count", 7)
+           .arg("p50 ms", 10).arg("p99 ms", 10).arg("max ms", 10);
+
+    for (auto it = latencies.cbegin(); it != latencies.cend(); ++it){
+        QVector<qint64> sorted = it.value();
+        if (sorted.isEmpty())
+            continue;
+        std::sort(sorted.begin(), sorted.end());
+
+        out << QString("  %1 %2 %3 %4 %5\n").arg(it.key(), -10).arg(sorted.size(), 7)
+               .arg(percentile(sorted, 0.50) / 1e6, 10, 'f', 3)
+               .arg(percentile(sorted, 0.99) / 1e6, 10, 'f', 3)
+               .arg(sorted.last() / 1e6, 10, 'f', 3);
+    }
+
+    out.flush();
+}
+
+int main(int argc, char *argv[])
+{
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QApplication app(argc, argv);
+    QCoreApplication::setApplicationName("aris-qt-bench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Measures the latency of editing actions in aris-qt.");
+    parser.addHelpOption();
+    parser.addOption({"lines", "Lines in the generated proof.", "n", "500"});
+    parser.addOption({"rounds", "Editing rounds per proof.", "n", "50"});
+    parser.addOption({"seed", "Seed for choosing the edited lines.", "n", "1"});
+    parser.addPositionalArgument("files", "Proof files to open instead of a generated proof.", "[file.tle...]");
+    parser.process(app);
+
+    int numLines = qMax(2, parser.value("lines").toInt());
+    int rounds = qMax(1, parser.value("rounds").toInt());
+    QRandomGenerator rng(parser.value("seed").toUInt());
+    QTextStream out(stdout);
+    int status = 0;
+
+    ProofData theData;
+    GoalData theGoals;
+    Connector cConnector;
+    auxConnector aux;
+    ProofModel proofModel;
+    GoalModel goalModel;
+
+    cConnector.reverseMapInit();
+    proofModel.setlines(&theData);
+    goalModel.setGlines(&theGoals);
+
+    Session s = {&theData, &theGoals, &proofModel, &goalModel, &cConnector, &aux, Latencies()};
+
+    // QML shows each line's verdict as it arrives.
+    QObject::connect(&cConnector, &Connector::evaluationStarted, &proofModel, &ProofModel::beginResults);
+    QObject::connect(&cConnector, &Connector::lineEvaluated, &proofModel, &ProofModel::setResult);
+    QObject::connect(&cConnector, &Connector::evaluationFinished, &proofModel, &ProofModel::finishResults);
+    QObject::connect(&cConnector, &Connector::evaluationCancelled, &proofModel, &ProofModel::cancelResults);
+
+    const QStringList files = parser.positionalArguments();
+    if (files.isEmpty()){
+        QElapsedTimer timer;
+
+        timer.start();
+        generateProof(s, numLines);
+        s.latencies["load"].append(timer.nsecsElapsed());
+
+        if (!replay(s, rounds, rng) || !exportLatex(s))
+            status = 1;
+        report(out, QString("generated proof, %1 lines").arg(numLines), s.latencies);
+    }
+
+    for (const QString &name: files){
+        s.latencies.clear();
+
+        if (!openProof(s, name)){
+            out << name << ": could not open\n";
+            status = 1;
+            continue;
+        }
+
+        if (!replay(s, rounds, rng) || !exportLatex(s))
+            status = 1;
+
+        int size = theData.size();
+        if (!importProof(s, name))
+            status = 1;
+        report(out, QString("%1, %2 lines").arg(name).arg(size), s.latencies);
+    }
+
+    // The peak is kept by the kernel for the whole process, so it
+    // covers every session above.
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+        out << "peak memory of the run: " << usage.ru_maxrss << " KB\n";
+
+    if (status)
+        out << "some actions did not finish\n";
+
+    return status;
+}
@@ -30,10 +30,53 @@
 #include <QFileDialog>
 #include <QSaveFile>
 #include <QUrl>
+#include <QPointer>
+#include <QSharedPointer>
+
+// Text using any of these is written with the CLI connectives.
+static const std::regex cliPattern("[&|~$%@#!^:>]");
+
+/* Frees a proof, along with its sentence data and goals.
+ *  input:
+ *    proof - the proof to free.
+ *  output:
+ *    none.
+ */
+static void freeProof(proof_t *proof)
+{
+    item_t *itm, *n_itm;
+
+    for (itm = proof->everything->head; itm; itm = n_itm){
+        sen_data *sd = (sen_data *) itm->value;
+        n_itm = itm->next;
+
+        if (sd->file)
+            free(sd->file);
+        sen_data_destroy(sd);
+        free(itm);
+    }
+
+    for (itm = proof->goals->head; itm; itm = n_itm){
+        n_itm = itm->next;
+        free(itm->value);
+        free(itm);
+    }
+
+    free(proof->everything);
+    free(proof->goals);
+    free(proof);
+}
 
 Connector::Connector(QObject *parent)
-    : QObject{parent}, m_evalText{"Evaluate Proof"}
-{   
+    : QObject{parent}, returns{nullptr}, m_evalText{"Evaluate Proof"},
+      m_lines{nullptr}, m_numCli{0}, m_cliConns{false}, m_indicesDirty{false},
+      m_evaluating{false}
+{
+    cProof = proof_init();
+
+    // The engine keeps global state, so evaluate one proof at a time.
+    m_pool.setMaxThreadCount(1);
+
     // Initialize rulesMap
 
     rulesMap["premise"] = -1;                       rulesMap["Modus Ponens"] = 0;                   rulesMap["Addition"] = 1;
@@ -51,6 +94,18 @@ Connector::Connector(QObject *parent)
     rulesMap["sf"] = -2;
 }
 
+Connector::~Connector()
+{
+    // Let a running evaluation stop before its proof goes away.
+    m_evalGen.fetchAndAddOrdered(1);
+    m_pool.waitForDone();
+
+    if (cProof)
+        freeProof(cProof);
+    if (returns)
+        destroy_str_vec(returns);
+}
+
 void Connector::reverseMapInit()
 {
     // Initialize reverseRulesMap
@@ -85,109 +140,339 @@ void Connector::setEvalText(const QString &newEvalText)
     emit evalTextChanged();
 }
 
-/* Populates m_indices, with array of indices for sen-data corresponding to a line.
+/* Starts mirroring a ProofData object in cProof.
+ *  cProof is rebuilt from the proof data, then kept up to date from its
+ *  signals, so that it never has to be rebuilt for an evaluation.
  *  input:
  *    toBeEval  - pointer to the ProofData object.
  *  output:
  *    none.
  */
-void Connector::genIndices(const ProofData *toBeEval)
+void Connector::trackLines(const ProofData *toBeEval)
+{
+    if (m_lines)
+        disconnect(m_lines, nullptr, this, nullptr);
+
+    while (!m_items.isEmpty())
+        removeData(m_items.size() - 1);
+
+    m_lines = toBeEval;
+    if (!m_lines)
+        return;
+
+    const int num_lines = m_lines->size();
+    for (int i = 0; i < num_lines; i++)
+        insertData(i);
+
+    connect(m_lines, &ProofData::postLineInsert, this, [=](int first, int last){
+        for (int i = first; i <= last; i++)
+            insertData(i);
+    });
+    connect(m_lines, &ProofData::postLineRemove, this, [=](int first, int last){
+        for (int i = last; i >= first; i--)
+            removeData(i);
+    });
+    connect(m_lines, &ProofData::lineChanged, this, [=](int first, int last){
+        for (int i = first; i <= last; i++)
+            updateData(i);
+    });
+    connect(m_lines, &QObject::destroyed, this, [=](){
+        m_lines = nullptr;
+        while (!m_items.isEmpty())
+            removeData(m_items.size() - 1);
+    });
+}
+
+/* Sets the fields of a sentence data object from a proof line.
+ *  The cached sexpr is kept unless the text changed.
+ *  input:
+ *    sd    - the sentence data to set.
+ *    line  - the proof line.
+ *  output:
+ *    2 if the structure of the proof changed, 1 if only the line changed,
+ *    0 if nothing changed, -1 on memory error.
+ */
+int Connector::setLineData(sen_data *sd, const ProofLine &line)
 {
-    m_indices.clear();
-    QList<int> parent_subproof;
-    for (int i = 0; i < toBeEval->lines().size(); i++){
-        m_indices.push_back({});
+    int rule, depth, premise, subproof, changed = 0;
+
+    rule = rulesMap[line.pType];
+    depth = line.pInd/20;
+    premise = (rule == -1)?1:0;
+    subproof = (rule == -2)?1:0;
+
+    if (rule == -2)
+        rule = -1;
+
+    if (sd->depth != depth || sd->subproof != subproof)
+        changed = 2;
+    else if (sd->rule != rule || sd->premise != premise)
+        changed = 1;
+
+    sd->rule = rule;
+    sd->depth = depth;
+    sd->premise = premise;
+    sd->subproof = subproof;
+
+    // Assign Text
+    std::string str = line.pText.toStdString();
+    if (!sd->text || strcmp((const char *) sd->text, str.c_str())){
+        if (sd->text)
+            free(sd->text);
+        sd->text = (unsigned char *) strdup(str.c_str());
+        if (!sd->text)
+            return AEC_MEM;
+
+        if (sd->sexpr)
+            free(sd->sexpr);
+        sd->sexpr = NULL;
+
+        if (!changed)
+            changed = 1;
+    }
 
-        if (toBeEval->lines().at(i).pType == "sf")
-            parent_subproof.push_back(i + 1);
+    // Assign references, skipping the leading -1 of pRefs
+    int num_refs = line.pRefs.size() - 1, ii;
+    for (ii = 0; sd->refs && ii < num_refs; ii++)
+        if (sd->refs[ii] != line.pRefs.at(ii+1))
+            break;
 
-        if ( i > 0 && toBeEval->lines().at(i).pInd < toBeEval->lines().at(i-1).pInd)
-            if (parent_subproof.size() > 0)
-                parent_subproof.pop_back();
+    if (!sd->refs || ii < num_refs || sd->refs[num_refs] != REF_END){
+        short *temp_refs = (short *) realloc(sd->refs, (num_refs + 1) * sizeof(short));
+        if (!temp_refs)
+            return AEC_MEM;
 
-        for (const int subp: parent_subproof)
-            m_indices[i].push_back(subp);
+        for (ii = 0; ii < num_refs; ii++)
+            temp_refs[ii] = line.pRefs.at(ii+1);
+        temp_refs[num_refs] = REF_END;
+        sd->refs = temp_refs;
 
+        if (!changed)
+            changed = 1;
     }
 
-    for (int i = 0; i < m_indices.size(); i++)
-        m_indices[i].push_back(-1);
+    // Assign the lemma file
+    if ((sd->file || line.fname)
+        && (!sd->file || !line.fname || strcmp((const char *) sd->file, (const char *) line.fname))){
+        if (sd->file)
+            free(sd->file);
+        sd->file = (line.fname) ? (unsigned char *) strdup((const char *) line.fname) : NULL;
 
+        if (!changed)
+            changed = 1;
+    }
 
+    return changed;
 }
 
-/* Sets connectives (using regex) and generates proof_t from corresponding ProofData Object
- * This is stored inside cProof
+/* Inserts the sentence data for a new line into cProof.
  *  input:
- *    toBeEval  - pointer to the ProofData object.
+ *    index - the index of the new line.
  *  output:
  *    none.
  */
-void Connector::genProof(const ProofData *toBeEval)
+void Connector::insertData(int index)
 {
-    main_conns = gui_conns;
-    int conn = 1;
-    std::regex pat("[&|~$%@#!^:>]");
-    cProof = proof_init();
-    genIndices(toBeEval);
-    for (int i = 0; i < toBeEval->lines().size(); i++){
-        sen_data *sd;
-        item_t *itm;
-        unsigned char *temp_text;
-        sd = (sen_data *) calloc (1, sizeof(sen_data));
-        int *ind = (int *) calloc(m_indices[i].size(), sizeof(int));
-        short *temp_refs = (short *) calloc(toBeEval->lines().at(i).pRefs.size(), sizeof(short));
+    sen_data *sd;
+    item_t *itm;
 
-        sd->line_num = i+1;
-        sd->rule = rulesMap[toBeEval->lines().at(i).pType];
-        sd->depth = toBeEval->lines().at(i).pInd/20;
-        sd->premise = (sd->rule == -1)?1:0;
-        sd->subproof = (sd->rule == -2)?1:0;
-        sd->file = toBeEval->lines().at(i).fname;
+    const ProofLine &line = m_lines->lineAt(index);
 
-        if (sd->rule == -2)
-            sd->rule = -1;
+    sd = (sen_data *) calloc(1, sizeof(sen_data));
+    if (!sd || setLineData(sd, line) == AEC_MEM){
+        qDebug() << "proof: could not create sen_data ";
+        return;
+    }
 
-        // Assign Indices
-        for (int ii = 0; ii < m_indices[i].size(); ii++)
-            ind[ii] = m_indices[i][ii];
+    if (index == 0 && !m_items.isEmpty()){
+        // Lists can't insert before their head, so insert after it and
+        // swap the data into place.
+        item_t *head = cProof->everything->head;
 
-        sd->indices = ind;
+        itm = ls_ins_obj(cProof->everything, head->value, head);
+        if (itm){
+            head->value = sd;
+            m_items.insert(1, itm);
+        }
+    }
+    else{
+        itm = ls_ins_obj(cProof->everything, sd, (index > 0) ? m_items.at(index - 1) : NULL);
+        if (itm)
+            m_items.insert(index, itm);
+    }
+
+    if (!itm){
+        qDebug() << "proof: could not insert sen_data ";
+        return;
+    }
 
-        // TODO : Cross-check Unicodes
-        // Assign Text
-        std::string str = toBeEval->lines().at(i).pText.toStdString();
+    bool cli = std::regex_search(line.pText.toStdString(), cliPattern);
+    m_cliLines.insert(index, cli);
+    if (cli)
+        m_numCli++;
 
-        if (conn && std::regex_search(str,pat)){
-            main_conns = cli_conns;
-            conn = 0;
+    m_indicesDirty = true;
+    cancelEval();
+}
+
+/* Removes the sentence data of a removed line from cProof.
+ *  input:
+ *    index - the index of the removed line.
+ *  output:
+ *    none.
+ */
+void Connector::removeData(int index)
+{
+    item_t *itm = m_items.at(index);
+    sen_data *sd = (sen_data *) itm->value;
+
+    ls_rem_obj(cProof->everything, itm);
+    free(itm);
+
+    if (sd->file)
+        free(sd->file);
+    sen_data_destroy(sd);
+
+    if (m_cliLines.at(index))
+        m_numCli--;
+
+    m_items.removeAt(index);
+    m_cliLines.removeAt(index);
+    m_indicesDirty = true;
+    cancelEval();
+}
+
+/* Updates the sentence data of a changed line in cProof.
+ *  input:
+ *    index - the index of the changed line.
+ *  output:
+ *    none.
+ */
+void Connector::updateData(int index)
+{
+    sen_data *sd = (sen_data *) m_items.at(index)->value;
+    const ProofLine &line = m_lines->lineAt(index);
+    int ret;
+
+    ret = setLineData(sd, line);
+    if (ret == AEC_MEM){
+        qDebug() << "proof: could not update sen_data ";
+        return;
+    }
+
+    if (ret == 0)
+        return;
+
+    if (ret == 2)
+        m_indicesDirty = true;
+
+    cancelEval();
+
+    // Only a changed text clears the sexpr.
+    if (!sd->sexpr){
+        bool cli = std::regex_search(line.pText.toStdString(), cliPattern);
+        if (cli != m_cliLines.at(index)){
+            m_numCli += (cli) ? 1 : -1;
+            m_cliLines[index] = cli;
         }
+    }
+}
 
-        temp_text = (unsigned char *) calloc((strlen(str.c_str()))+1, sizeof(unsigned char));
-        memcpy(temp_text, str.c_str(), strlen(str.c_str()));
-        sd->text = temp_text;
+/* Sets the line numbers and indices of the sentence data in cProof.
+ *  A line lies within the last depth subproofs that are still open.
+ *  input:
+ *    none.
+ *  output:
+ *    none.
+ */
+void Connector::genIndices()
+{
+    QVector<int> open_subproofs;
+    int ln = 0;
+
+    for (item_t *itm = cProof->everything->head; itm; itm = itm->next){
+        sen_data *sd = (sen_data *) itm->value;
 
+        ln++;
+        sd->line_num = ln;
 
-        // Assign references
-        if (toBeEval->lines().at(i).pRefs.size() == 1)
-            temp_refs[0] = REF_END;
-        else{
-            for (int ii = 1; ii < toBeEval->lines().at(i).pRefs.size(); ii++)
-                temp_refs[ii-1] = toBeEval->lines().at(i).pRefs.at(ii);
-            temp_refs[toBeEval->lines().at(i).pRefs.size()-1] = REF_END;
+        if (sd->subproof && sd->depth > 0){
+            if (open_subproofs.size() > sd->depth - 1)
+                open_subproofs.resize(sd->depth - 1);
+            open_subproofs.push_back(ln);
+        }
+        else if (open_subproofs.size() > sd->depth){
+            open_subproofs.resize(sd->depth);
         }
-        sd->refs = temp_refs;
 
-        // Insert into proof object
-        itm = ls_ins_obj (cProof->everything, sd, cProof->everything->tail);
-        if (!itm)
-            qDebug() << "proof: could not insert sen_data ";
+        // Copies of sen_data read depth + 1 indices.
+        int num_ind = qMax((int) open_subproofs.size(), sd->depth);
+        int *ind = (int *) realloc(sd->indices, (num_ind + 1) * sizeof(int));
+        if (!ind){
+            qDebug() << "proof: could not set indices ";
+            return;
+        }
+
+        for (int ii = 0; ii <= num_ind; ii++)
+            ind[ii] = (ii < open_subproofs.size()) ? open_subproofs.at(ii) : -1;
+        sd->indices = ind;
     }
 
+    m_indicesDirty = false;
+}
+/* Brings cProof up to date with the corresponding ProofData Object.
+ * Only the lines that changed since the last call are rebuilt.
+ *  input:
+ *    toBeEval  - pointer to the ProofData object.
+ *  output:
+ *    none.
+ */
+void Connector::genProof(const ProofData *toBeEval)
+{
+    if (toBeEval != m_lines)
+        trackLines(toBeEval);
+
+    if (m_indicesDirty)
+        genIndices();
+
+    // The sexprs depend on the connectives they were parsed with.
+    bool cli = (m_numCli > 0);
+    if (cli != m_cliConns){
+        for (item_t *itm = cProof->everything->head; itm; itm = itm->next){
+            sen_data *sd = (sen_data *) itm->value;
+            if (sd->sexpr)
+                free(sd->sexpr);
+            sd->sexpr = NULL;
+        }
+        m_cliConns = cli;
+    }
+
+    // main_conns is only set by the worker that parses, since a pool task
+    // may be parsing while the GUI thread calls this.
+
     // TODO : Fix boolean
     cProof->boolean = 0;
 }
 
+/* Frees the goals of cProof.
+ *  input:
+ *    none.
+ *  output:
+ *    none.
+ */
+void Connector::clearGoals()
+{
+    item_t *itm, *n_itm;
+
+    for (itm = cProof->goals->head; itm; itm = n_itm){
+        n_itm = itm->next;
+        free(itm->value);
+        free(itm);
+    }
+
+    cProof->goals->head = cProof->goals->tail = NULL;
+    cProof->goals->num_stuff = 0;
+}
 
 /* Inserts goal text from corresponding GoalData Object into cProof.
  *  input:
@@ -197,13 +482,15 @@ void Connector::genProof(const ProofData *toBeEval)
  */
 void Connector::genGoals(const GoalData *toBeEval)
 {
+    clearGoals();
 
-    for (int i = 0; i < toBeEval->glines().size(); i++){
+    const QVector<GoalLine> &glines = toBeEval->glines();
+    for (int i = 0; i < glines.size(); i++){
 
         unsigned char *temp_text;
         item_t *itm;
 
-        std::string str = toBeEval->glines().at(i).gText.toStdString();
+        std::string str = glines.at(i).gText.toStdString();
         temp_text = (unsigned char *) calloc((strlen(str.c_str()))+1, sizeof(unsigned char));
         memcpy(temp_text, str.c_str(), strlen(str.c_str()));
 
@@ -214,49 +501,188 @@ void Connector::genGoals(const GoalData *toBeEval)
     }
 }
 
-/* Evaluates the proof and updates m_evalText accordingly.
+// The state shared between an evaluation task and its line callback.
+struct EvalTask {
+    Connector *c;
+    int gen;
+    int total;
+};
+
+/* Reports an evaluated line to the GUI thread - runs on the worker.
+ *  input:
+ *    line  - the number of the line.
+ *    ret   - the result of the line.
+ *    data  - the EvalTask of the evaluation.
+ *  output:
+ *    1 if the evaluation was cancelled, 0 otherwise.
+ */
+int Connector::lineDone(int line, const char *ret, void *data)
+{
+    EvalTask *task = (EvalTask *) data;
+    Connector *c = task->c;
+    int gen = task->gen, total = task->total;
+    bool correct = !strcmp(ret, CORRECT);
+    QString message = QString::fromUtf8(ret);
+
+    if (c->m_evalGen.loadAcquire() != gen)
+        return 1;
+
+    QMetaObject::invokeMethod(c, [c, gen, line, total, correct, message](){
+        if (c->m_evalGen.loadAcquire() != gen)
+            return;
+        emit c->lineEvaluated(line - 1, correct, message);
+        emit c->evaluationProgress(line, total);
+    }, Qt::QueuedConnection);
+
+    return 0;
+}
+
+/* Starts evaluating the proof on a worker thread.
+ * The worker evaluates a copy of cProof, so the GUI thread may keep
+ * editing; any edit cancels the evaluation.  Each line is reported
+ * through lineEvaluated as it is checked, and evaluationFinished is
+ * emitted once m_evalText and the returns are up to date.
  *  input:
  *    toBeEval  - pointer to the ProofData object.
  *    gls       - pointer to the GoalData object.
  *  output:
- *    1 on success.
+ *    1 if the evaluation was started, 0 otherwise.
  */
 int Connector::evalProof(const ProofData *toBeEval, const GoalData *gls)
 {
     genProof(toBeEval);
     genGoals(gls);
-//    vec_t *rets;
-    returns = init_vec(sizeof(char *));
 
-    if (!proof_eval(cProof,returns,1))
-        qDebug() << "Proof Evaluated Successfully";
-    else
+    cancelEval();
+
+    proof_t *snapshot = proof_init();
+    if (!snapshot){
         qDebug() << "Memory Error";
+        return 0;
+    }
 
-    item_t * ev_itr;
-    int f = 0;
-    ev_itr = cProof->everything->head;
-    for (int i = 0; i < returns->num_stuff; i++){
-        char * cur_ret, * cur_line;
-        cur_ret = (char *) vec_str_nth (returns, i);
-        cur_line =(char *) ((sen_data *) ev_itr->value)->text;
+    for (item_t *itm = cProof->everything->head; itm; itm = itm->next){
+        sen_data *sd = (sen_data *) calloc(1, sizeof(sen_data));
+        if (!sd || sen_data_copy((sen_data *) itm->value, sd) == AEC_MEM
+            || !ls_push_obj(snapshot->everything, sd)){
+            qDebug() << "Memory Error";
+            freeProof(snapshot);
+            return 0;
+        }
+    }
+    snapshot->boolean = cProof->boolean;
+
+    int gen = m_evalGen.loadAcquire();
+    bool cli = m_cliConns;
 
-        if (strcmp (cur_ret, CORRECT)){
-            qDebug() << "Error in line " << i + 1 << "- " << cur_line;
-            setEvalText(((f)?m_evalText:"") + QString("Error in line %1 - \n      ").arg(i+1) + cur_ret + "\n");
-            f = 1;
-            qDebug() << "  "<< cur_ret;
+    setEvaluating(true);
+    emit evaluationStarted();
+
+    m_pool.start([this, snapshot, gen, cli](){
+        EvalTask task = {this, gen, (int) snapshot->everything->num_stuff};
+        vec_t *rets = init_vec(sizeof(char *));
+        int status = AEC_MEM;
+
+        if (rets){
+            main_conns = (cli) ? cli_conns : gui_conns;
+            status = proof_eval_each(snapshot, rets, &Connector::lineDone, &task);
         }
-        else
-            qDebug() <<"Line " << i + 1 << ": " << CORRECT;
 
-        ev_itr = ev_itr->next;
-    }
-    if (!f) setEvalText("Correct!");
+        QMetaObject::invokeMethod(this, [this, snapshot, rets, gen, status](){
+            finishEval(snapshot, rets, gen, status);
+        }, Qt::QueuedConnection);
+    });
 
     return 1;
 }
 
+/* Cancels the running evaluation, if there is one.
+ * Every change to cProof comes through here, and evaluationCancelled
+ * is emitted only if an evaluation was running.
+ *  input:
+ *    none.
+ *  output:
+ *    none.
+ */
+void Connector::cancelEval()
+{
+    m_evalGen.fetchAndAddOrdered(1);
+    if (m_evaluating)
+        emit evaluationCancelled();
+    setEvaluating(false);
+}
+
+/* Applies the results of an evaluation - runs on the GUI thread.
+ *  input:
+ *    snapshot  - the copy of cProof that was evaluated.
+ *    rets      - the result of each line.
+ *    gen       - the generation of cProof that was copied.
+ *    status    - the return value of the evaluation.
+ *  output:
+ *    none.
+ */
+void Connector::finishEval(proof_t *snapshot, vec_t *rets, int gen, int status)
+{
+    // A cancelled evaluation no longer matches cProof.
+    if (gen != m_evalGen.loadAcquire() || status != 0){
+        if (status == AEC_MEM && gen == m_evalGen.loadAcquire()){
+            qDebug() << "Memory Error";
+            emit evaluationCancelled();
+            setEvaluating(false);
+        }
+        freeProof(snapshot);
+        if (rets)
+            destroy_str_vec(rets);
+        return;
+    }
+
+    // Keep the conversions, since the text hasn't changed.
+    item_t *ev_itr, *sn_itr;
+    for (ev_itr = cProof->everything->head, sn_itr = snapshot->everything->head;
+         ev_itr && sn_itr; ev_itr = ev_itr->next, sn_itr = sn_itr->next){
+        sen_data *sd = (sen_data *) ev_itr->value;
+        sen_data *sn = (sen_data *) sn_itr->value;
+
+        if (!sd->sexpr && sn->sexpr){
+            sd->sexpr = sn->sexpr;
+            sn->sexpr = NULL;
+        }
+    }
+    freeProof(snapshot);
+
+    if (returns)
+        destroy_str_vec(returns);
+    returns = rets;
+
+    QString text;
+    for (int i = 0; i < returns->num_stuff; i++){
+        char * cur_ret;
+        cur_ret = (char *) vec_str_nth (returns, i);
+
+        if (strcmp (cur_ret, CORRECT))
+            text += QString("Error in line %1 - \n      ").arg(i+1) + cur_ret + "\n";
+    }
+    setEvalText(text.isEmpty() ? QString("Correct!") : text);
+
+    setEvaluating(false);
+    emit evaluationFinished();
+}
+
+// Getter for m_evaluating
+bool Connector::evaluating() const
+{
+    return m_evaluating;
+}
+
+// Setter for m_evaluating
+void Connector::setEvaluating(bool newEvaluating)
+{
+    if (m_evaluating == newEvaluating)
+        return;
+    m_evaluating = newEvaluating;
+    emit evaluatingChanged();
+}
+
 /* Generates cProof and saves file (using aio_save).
  *  input:
  *    name          - filename for the file being saved.
@@ -287,7 +713,40 @@ void Connector::saveProof(const QString &name, const ProofData *toBeSaved, const
         free(file_name);
 }
 
+/* Opens a proof file on the worker thread.
+ *  The proof is converted by build on the worker, so that only the
+ *  insertion of the converted lines is left for the GUI thread.
+ *  input:
+ *    fileName  - path of the proof file.
+ *    build     - converts the opened proof, which is freed afterwards.
+ *    done      - called on the GUI thread with whether the proof opened.
+ *  output:
+ *    none; proofLoaded is emitted once done has run.
+ */
+void Connector::loadProof(const QString &fileName, std::function<void (proof_t *)> build,
+                          std::function<void (bool)> done)
+{
+    std::string path = fileName.toStdString();
+
+    m_pool.start([this, path, build, done](){
+        proof_t *proof = aio_open(path.c_str());
+        bool opened = (proof != nullptr);
+
+        if (opened){
+            build(proof);
+            freeProof(proof);
+        }
+
+        QMetaObject::invokeMethod(this, [this, done, opened](){
+            done(opened);
+            emit proofLoaded(opened);
+        }, Qt::QueuedConnection);
+    });
+}
+
 /* Opens the specified proof after clearing the previous one.
+ *  The file is read and converted in the background, then all of its
+ *  lines are inserted at once.
  *  input:
  *    name      - filename of the opened proof.
  *    openTo    - pointer to the ProofData object.
@@ -303,57 +762,71 @@ void Connector::openProof(const QString &name, ProofData *openTo, GoalData *gls)
     if (localName.isEmpty())
         localName = name;
 
-    std::string nameStr = localName.toStdString();
-    char *file_name = (char *) calloc((nameStr.size()+1), sizeof(char)); 
-    memcpy(file_name, nameStr.c_str(), nameStr.size());
+    reverseMapInit();
 
-    cProof = aio_open((const char *) file_name);
-    if (cProof)
+    QSharedPointer<QVector<ProofLine>> lines(new QVector<ProofLine>);
+    QSharedPointer<QStringList> goals(new QStringList);
+    QHash<int,QString> ruleNames = reverseRulesMap;
+    QPointer<ProofData> pd(openTo);
+    QPointer<GoalData> gd(gls);
+
+    auto build = [lines, goals, ruleNames](proof_t *opened){
+        item_t *pf_itr;
+        int d = 0;
+
+        lines->reserve(opened->everything->num_stuff);
+        for (pf_itr = opened->everything->head; pf_itr; pf_itr = pf_itr->next){
+            sen_data *sd = (sen_data *) pf_itr->value;
+            QList<int> temp_refs = {-1};
+            for (int i = 0; sd->refs[i] != REF_END; i++)
+                temp_refs.push_back(sd->refs[i]);
+
+            int rule = (sd->depth > d) ? -2 : sd->rule;
+
+            ProofLine line;
+            line.pLine = sd->line_num;
+            line.pText = (const char *) sd->text;
+            line.pType = ruleNames.value(rule);
+            line.pSub = (sd->depth > 0);
+            line.pSubStart = (rule == -2);
+            line.pSubEnd = (sd->line_num != 1 && ((sen_data *) pf_itr->prev->value)->depth > sd->depth);
+            line.pInd = sd->depth * 20;
+            line.pRefs = temp_refs;
+            line.fname = NULL;
+            lines->append(line);
+
+            d = sd->depth;
+        }
+
+        for (pf_itr = opened->goals->head; pf_itr; pf_itr = pf_itr->next)
+            goals->append((const char *) pf_itr->value);
+    };
+
+    auto done = [lines, goals, pd, gd, localName](bool opened){
+        if (!opened){
+            qDebug() << "File Open Failed for path:" << localName;
+            return;
+        }
         qDebug() << "File Opened Successfully";
-    else
-        qDebug() << "File Open Failed for path:" << localName;
-    if (file_name)
-        free(file_name);
 
-    reverseMapInit();
+        if (!pd || !gd)
+            return;
 
-    if (!cProof)
-    {
-        qDebug() << "Cannot populate UI: proof is null.";
-        return;
-    }
+        // The lines reach cProof through pd's signals.
+        pd->removeLines(0, pd->size());
+        pd->insertLines(0, *lines);
 
-    int s = openTo->lines().size();
-    for (int i = 0; i < s; i++)
-        openTo->removeLineAt(0);
-    //    openTo->lines().clear();
-
-    item_t * pf_itr;
-    int d = 0;
-    for (pf_itr = cProof->everything->head; pf_itr; pf_itr = pf_itr->next){
-        sen_data *sd = (sen_data *) pf_itr->value;
-        QList<int> temp_refs = {-1};
-        for (int i = 0; sd->refs[i] != REF_END; i++)
-            temp_refs.push_back(sd->refs[i]);
-
-        if (sd->depth > d)
-            sd->rule = -2;
-        openTo->insertLine(sd->line_num-1,sd->line_num,(const char *) sd->text,reverseRulesMap[sd->rule],(sd->depth > 0),
-                           (sd->rule == -2),(sd->line_num != 1 && ((sen_data *) pf_itr->prev->value)->depth > sd->depth), sd->depth * 20,temp_refs);
-        d = sd->depth;
-    }
+        int g = gd->glines().size();
+        for (int i = 0; i < g; i++)
+            gd->removegLineAt(0);
 
-    int g = gls->glines().size();
-    for (int i = 0; i < g; i++)
-        gls->removegLineAt(0);
+        for (int i = 0; i < goals->size(); i++)
+            gd->insertgLine(i,-2,false,goals->at(i));
 
-    int i = 0;
-    for (pf_itr = cProof->goals->head; pf_itr; pf_itr = pf_itr->next){
-        gls->insertgLine(i,-2,false,(const char *) pf_itr->value);
-        i++;
-    }
+        qDebug() << "Model Loaded Successfully";
+    };
 
-    qDebug() << "Model Loaded Successfully";
+    loadProof(localName, build, done);
 }
 
 /* Opens the specified proof after clearing the previous one (for WebAssembly).
@@ -20,6 +20,9 @@
 
 #include <QObject>
 #include <QHash>
+#include <QAtomicInt>
+#include <QThreadPool>
+#include <functional>
 #include "../src/typedef.h"
 #include "proofdata.h"
 #include "goaldata.h"
@@ -29,21 +32,28 @@ class Connector : public QObject
     Q_OBJECT
 public:
     explicit Connector(QObject *parent = nullptr);
+    ~Connector();
 
     void reverseMapInit();
 
     Q_PROPERTY(QString evalText READ evalText WRITE setEvalText NOTIFY evalTextChanged)
+    Q_PROPERTY(bool evaluating READ evaluating NOTIFY evaluatingChanged)
 
     QString evalText() const;
     void setEvalText(const QString &newEvalText);
+    bool evaluating() const;
 
-    void genIndices(const ProofData * toBeEval);
+    void trackLines(const ProofData * toBeEval);
+    void genIndices();
     void genProof(const ProofData * toBeEval);
     void genGoals(const GoalData * toBeEval);
 
     Q_INVOKABLE int evalProof(const ProofData * toBeEval, const GoalData * gls);
+    Q_INVOKABLE void cancelEval();
     Q_INVOKABLE void saveProof(const QString &name,  const ProofData *toBeSaved, const GoalData *gls);
     Q_INVOKABLE void openProof(const QString &name, ProofData *openTo, GoalData *gls);
+    void loadProof(const QString &fileName, std::function<void (proof_t *)> build,
+                   std::function<void (bool)> done);
     Q_INVOKABLE void wasmOpenProof(ProofData *open, GoalData *gls);
     Q_INVOKABLE void wasmSaveProof(const ProofData *pd, const GoalData *gls);
 
@@ -56,15 +66,47 @@ public:
 signals:
 
     void evalTextChanged();
+    void evaluatingChanged();
+
+    void evaluationStarted();
+    void lineEvaluated(int index, bool correct, const QString &message);
+    void evaluationProgress(int done, int total);
+    void evaluationFinished();
+    void evaluationCancelled();
+
+    void proofLoaded(bool opened);
 
 
 private:
+    int setLineData(sen_data * sd, const ProofLine &line);
+    void insertData(int index);
+    void removeData(int index);
+    void updateData(int index);
+    void clearGoals();
+    void setEvaluating(bool newEvaluating);
+    void finishEval(proof_t * snapshot, vec_t * rets, int gen, int status);
+    static int lineDone(int line, const char * ret, void * data);
+
     proof_t * cProof;
     vec_t * returns;
 //    QHash<QString,int> rulesMap;
 //    QHash<int,QString> reverseRulesMap;
     QString m_evalText;
-    QList<QList<int>> m_indices;
+
+    // cProof mirrors m_lines, and is kept up to date as lines change,
+    // so each evaluation only parses the lines that changed.
+    const ProofData * m_lines;
+    QVector<item_t *> m_items;      // The item of each line in cProof.
+    QVector<bool> m_cliLines;       // Whether each line uses CLI connectives.
+    int m_numCli;                   // The number of lines that do.
+    bool m_cliConns;                // Whether cProof was parsed with CLI connectives.
+    bool m_indicesDirty;            // Whether the line numbers or indices are stale.
+
+    // Evaluations run on m_pool against a copy of cProof.  Every change
+    // to cProof bumps m_evalGen, which cancels the running evaluation.
+    QThreadPool m_pool;
+    QAtomicInt m_evalGen;
+    bool m_evaluating;
 };
 
 #endif // CONNECTOR_H
@@ -23,7 +23,7 @@ GoalData::GoalData(QObject *parent)
     m_goalLines.append({-2,false,""});
 }
 
-QVector<GoalLine> GoalData::glines() const
+const QVector<GoalLine> &GoalData::glines() const
 {
     return m_goalLines;
 }
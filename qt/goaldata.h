@@ -32,7 +32,7 @@ class GoalData : public QObject
 public:
     explicit GoalData(QObject *parent = nullptr);
 
-    QVector<GoalLine> glines() const;
+    const QVector<GoalLine> &glines() const;
 
     bool setgLineAt(int index, const GoalLine &goalLine);
 
@@ -17,6 +17,7 @@
 */
 #include "goalmodel.h"
 #include "goals-qt.h"
+#include "../src/goal-index.h"
 #include <QApplication>
 
 GoalModel::GoalModel(QObject *parent)
@@ -41,7 +42,7 @@ QVariant GoalModel::data(const QModelIndex &index, int role) const
     if (!index.isValid())
         return QVariant();
 
-    const GoalLine someLine = m_glines->glines().at(index.row());
+    const GoalLine &someLine = m_glines->glines().at(index.row());
 
     switch(role){
         case LineRole:
@@ -137,6 +138,13 @@ void GoalModel::setGlines(GoalData *newGlines)
 // Evaluate goals and set the valid role
 void GoalModel::evalGoals(GoalData *gls, Connector *c)
 {
+    // Index the proof once, so that each goal is a single lookup.
+    goal_index *gi = qtgoal_build_index(c->getCProof(),c->getReturns());
+    if (!gi){
+        qDebug() << "Error in indexing the proof for the goals";
+        return;
+    }
+
     for (int i = 0; i < gls->glines().size(); i++){
         int ln, is_valid;
         unsigned char *temp_text;
@@ -146,11 +154,14 @@ void GoalModel::evalGoals(GoalData *gls, Connector *c)
         memcpy(temp_text, str.c_str(), strlen(str.c_str()));
 
 
-        if (qtgoal_check_line(c->getCProof(),temp_text,c->getReturns(),&ln,&is_valid) == 0){
+        if (qtgoal_check_line(gi,temp_text,&ln,&is_valid) == 0){
             setData(index(i,0),ln,256);
             setData(index(i,0),(is_valid == 1),258);
         }
         else
             qDebug() << "Error in checking goal " << i + 1 << ":\n\t Goal was probably empty";
+        free(temp_text);
     }
+
+    goal_index_destroy(gi);
 }
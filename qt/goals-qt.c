@@ -22,15 +22,54 @@
 #include "../src/proof.h"
 #include "../src/list.h"
 #include "../src/vec.h"
+#include "../src/goal-index.h"
+
+/* Builds a goal index of a proof. Inspired from aris_proof_index_lines in aris-proof.c
+ *  input:
+ *    proof - the proof to index.
+ *    rets - the evaluation results of each line of proof.
+ *  output:
+ *    the goal index of the proof, or NULL on memory error.
+ */
+goal_index * qtgoal_build_index(proof_t *proof, vec_t *rets)
+{
+    goal_index * gi;
+    item_t * ev_itr;
+
+    gi = goal_index_init ();
+    if (!gi)
+        return NULL;
+
+    for (ev_itr = proof->everything->head; ev_itr != NULL;
+         ev_itr = ev_itr->next)
+    {
+        sen_data * ev_sen = ev_itr->value;
+        int valid = 0;
+
+        if (goal_index_set_line (gi, ev_sen->line_num, ev_sen->text) == AEC_MEM)
+        {
+            goal_index_destroy (gi);
+            return NULL;
+        }
+
+        if (ev_sen->line_num - 1 < rets->num_stuff)
+            valid = !strcmp (vec_str_nth (rets, ev_sen->line_num - 1), CORRECT);
+        goal_index_set_valid (gi, ev_sen->line_num, valid);
+    }
+
+    return gi;
+}
 
 /* Checks a line in the goal. Inspired from goal_check_line in goals.c
  *  input:
- *    goal - the goal containing the sentence to be checked.
- *    sen - the sentence being checked.
+ *    gi - the goal index of the proof.
+ *    sen_text - the text of the goal being checked.
+ *    ln - receives the line at which the goal is met, or -3 if it is not met.
+ *    is_valid - receives whether the lines leading up to the goal are correct.
  *  output:
  *    0 on success, -1 on error.
  */
-int qtgoal_check_line(proof_t *proof, unsigned char *sen_text, vec_t *rets, int *ln, int *is_valid)
+int qtgoal_check_line(goal_index *gi, unsigned char *sen_text, int *ln, int *is_valid)
 {
     // First, check for text errors.
     // Is that necessary?
@@ -42,42 +81,19 @@ int qtgoal_check_line(proof_t *proof, unsigned char *sen_text, vec_t *rets, int
 
     int ret_check = check_text (cmp_text);
     if (ret_check < 0)
-        return AEC_MEM;
-
-    item_t * ev_itr;
-    *is_valid = 1;
-    *ln = -3;
-
-    for (ev_itr = proof->everything->head; ev_itr != NULL;
-         ev_itr = ev_itr->next)
     {
-        sen_data * ev_sen = ev_itr->value;
-        unsigned char * ev_cmp_text = format_string (ev_sen->text);
-        unsigned char * ev_cur_ret = vec_str_nth(rets,ev_sen->line_num -1);
-
-        if (!ev_cmp_text)
-            return AEC_MEM;
-
-        if (!strcmp (ev_cmp_text, cmp_text))
-        {
-            if (strcmp(ev_cur_ret, CORRECT))
-                *is_valid = 0;
+        free (cmp_text);
+        return AEC_MEM;
+    }
 
-            *ln = ev_sen->line_num;
+    *ln = goal_index_find (gi, cmp_text, is_valid);
+    free (cmp_text);
 
-            free (ev_cmp_text);
-            free (cmp_text);
-            return 0;
-        }
-        else
-        {
-            if (strcmp(ev_cur_ret, CORRECT))
-                *is_valid = 0;
-        }
+    if (*ln == AEC_MEM)
+        return AEC_MEM;
 
-        free (ev_cmp_text);
-    }
+    if (*ln == 0)
+        *ln = -3;
 
-    free (cmp_text);
     return 0;
 }
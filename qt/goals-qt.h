@@ -25,7 +25,8 @@ extern "C" {
 
 #include "../src/typedef.h"
 
-int qtgoal_check_line (proof_t * proof, unsigned char * sen_text, vec_t * rets, int * ln, int * is_valid);
+goal_index * qtgoal_build_index (proof_t * proof, vec_t * rets);
+int qtgoal_check_line (goal_index * gi, unsigned char * sen_text, int * ln, int * is_valid);
 
 #ifdef __cplusplus
 }
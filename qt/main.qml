@@ -327,6 +327,26 @@ ApplicationWindow {
         glines: theGoals
     }
 
+    // Show the result of each line, and check the goals once the proof has been evaluated.
+    // The last results stay shown until a new evaluation replaces them; the model
+    // clears the results of an edited line and of the lines that refer to it.
+    Connections {
+        target: cConnector
+        function onEvaluationStarted() {
+            proofModel.beginResults()
+        }
+        function onLineEvaluated(index, correct, message) {
+            proofModel.setResult(index, correct, message)
+        }
+        function onEvaluationFinished() {
+            proofModel.finishResults()
+            goalDataID.evalGoals(theGoals, cConnector)
+        }
+        function onEvaluationCancelled() {
+            proofModel.cancelResults()
+        }
+    }
+
     ProofModel {
         id: proofModel
         lines: theData
@@ -23,11 +23,21 @@ ProofData::ProofData(QObject *parent)
     m_proofLines.append({1,"","premise",false,false,false,0,{-1},NULL});
 }
 
-QVector<ProofLine> ProofData::lines() const
+const QVector<ProofLine> &ProofData::lines() const
 {
     return m_proofLines;
 }
 
+int ProofData::size() const
+{
+    return m_proofLines.size();
+}
+
+const ProofLine &ProofData::lineAt(int index) const
+{
+    return m_proofLines.at(index);
+}
+
 // Edit/Change an existing proof line (in m_proofLines) for some valid index
 bool ProofData::setLineAt(int index, const ProofLine &proofLine)
 {
@@ -44,6 +54,7 @@ bool ProofData::setLineAt(int index, const ProofLine &proofLine)
     }
 
     m_proofLines[index] = proofLine;
+    emit lineChanged(index, index);
     return true;
 }
 
@@ -52,13 +63,12 @@ void ProofData::setFile(int index, const QString &name)
 {
     m_proofLines[index].fname = (unsigned char *) calloc(name.size()+1, sizeof(unsigned char));
     memcpy(m_proofLines[index].fname, name.toStdString().c_str(), name.size());
+    emit lineChanged(index, index);
 }
 
 // Insert a proof line (in m_proofLines) at a valid index
 void ProofData::insertLine(int index,int a, QString b, QString c, bool d, bool e, bool f, int g, QList<int> h)
 {
-    emit preLineInsert(index);
-
     ProofLine aLine;
     aLine.pLine = a;
     aLine.pText = b;
@@ -69,17 +79,78 @@ void ProofData::insertLine(int index,int a, QString b, QString c, bool d, bool e
     aLine.pInd = g;
     aLine.pRefs = h;
     aLine.fname = NULL;
-    m_proofLines.insert(index,aLine);
 
-    emit postLineInsert();
+    insertLines(index, {aLine});
 }
 
-// Proof a proof line (in m_proofLines) at a valid index
+// Remove a proof line (in m_proofLines) at a valid index
 void ProofData::removeLineAt(int index)
 {
-    emit preLineRemove(index);
+    removeLines(index, 1);
+}
+
+// Insert several proof lines (in m_proofLines) at a valid index, with one pair of signals
+void ProofData::insertLines(int index, const QVector<ProofLine> &newLines)
+{
+    if (newLines.isEmpty() || index < 0 || index > m_proofLines.size())
+        return;
+
+    const int last = index + newLines.size() - 1;
+    emit preLineInsert(index, last);
+
+    m_proofLines.insert(index, newLines.size(), ProofLine());
+    for (int i = 0; i < newLines.size(); i++)
+        m_proofLines[index + i] = newLines.at(i);
+
+    emit postLineInsert(index, last);
+}
+
+// Remove count proof lines (in m_proofLines) starting at a valid index, with one pair of signals
+void ProofData::removeLines(int index, int count)
+{
+    if (index < 0 || count <= 0 || index + count > m_proofLines.size())
+        return;
+
+    const int last = index + count - 1;
+    emit preLineRemove(index, last);
+
+    m_proofLines.remove(index, count);
+
+    emit postLineRemove(index, last);
+}
+
+// Replace count proof lines starting at index with newLines.
+// Lines present in both are changed in place; the rest are inserted or removed.
+void ProofData::replaceLines(int index, int count, const QVector<ProofLine> &newLines)
+{
+    if (index < 0 || count < 0 || index + count > m_proofLines.size())
+        return;
+
+    const int common = qMin(count, (int) newLines.size());
+    int first = -1, last = -1;
+
+    for (int i = 0; i < common; i++){
+        const ProofLine &oldLine = m_proofLines.at(index + i);
+        const ProofLine &newLine = newLines.at(i);
+
+        if (oldLine.pLine == newLine.pLine && oldLine.pText == newLine.pText \
+            && oldLine.pSub == newLine.pSub && oldLine.pSubEnd == newLine.pSubEnd \
+            && oldLine.pSubStart == newLine.pSubStart && oldLine.pInd == newLine.pInd \
+            && oldLine.pType == newLine.pType && oldLine.pRefs == newLine.pRefs \
+            && oldLine.fname == newLine.fname)
+            continue;
+
+        m_proofLines[index + i] = newLine;
+        if (first == -1)
+            first = index + i;
+        last = index + i;
+    }
 
-    m_proofLines.removeAt(index);
+    if (first != -1)
+        emit lineChanged(first, last);
 
-    emit postLineRemove();
+    if (count > common)
+        removeLines(index + common, count - common);
+    else if (newLines.size() > common)
+        insertLines(index + common, newLines.mid(common));
 }
@@ -38,17 +38,27 @@ class ProofData : public QObject
 public:
     explicit ProofData(QObject *parent = nullptr);
 
-    QVector<ProofLine> lines() const;
+    // Read access never copies the lines.
+    const QVector<ProofLine> &lines() const;
+    int size() const;
+    const ProofLine &lineAt(int index) const;
 
     bool setLineAt(int index, const ProofLine &proofLine);
     void setFile(int index, const QString& name);
 
+    void insertLines(int index, const QVector<ProofLine> &newLines);
+    void removeLines(int index, int count);
+    void replaceLines(int index, int count, const QVector<ProofLine> &newLines);
+
 signals:
-    void preLineInsert(int index);
-    void postLineInsert();
+    // Each signal covers the lines first to last, inclusive.
+    void preLineInsert(int first, int last);
+    void postLineInsert(int first, int last);
+
+    void preLineRemove(int first, int last);
+    void postLineRemove(int first, int last);
 
-    void preLineRemove(int index);
-    void postLineRemove();
+    void lineChanged(int first, int last);
 
 public slots:
     void insertLine(int index, int a, QString b, QString c, bool d, bool e, bool f, int g, QList<int> h);
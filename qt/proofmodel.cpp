@@ -18,7 +18,7 @@
 #include "proofmodel.h"
 
 ProofModel::ProofModel(QObject *parent)
-    : QAbstractListModel(parent), mLines(nullptr)
+    : QAbstractListModel(parent), mLines(nullptr), mSetting(false), mRenumbering(false)
 {
 }
 
@@ -30,7 +30,7 @@ int ProofModel::rowCount(const QModelIndex &parent) const
     if (parent.isValid() || !mLines)
         return 0;
 
-    return mLines->lines().size();
+    return mLines->size();
 }
 
 // Return data corresponding to a particular index and role(enum)
@@ -39,7 +39,7 @@ QVariant ProofModel::data(const QModelIndex &index, int role) const
     if (!index.isValid())
         return QVariant();
 
-    const ProofLine someLine = mLines->lines().at(index.row());
+    const ProofLine &someLine = mLines->lineAt(index.row());
 
     switch (role){
     case LineRole:
@@ -56,6 +56,10 @@ QVariant ProofModel::data(const QModelIndex &index, int role) const
         return QVariant(someLine.pSubEnd);
     case IndentRole:
         return QVariant(someLine.pInd);
+    case VerdictRole:
+        return QVariant(index.row() < mResults.size() ? mResults.at(index.row()).verdict : (int) Unchecked);
+    case MessageRole:
+        return QVariant(index.row() < mResults.size() ? mResults.at(index.row()).message : QString());
     case RefsRole:
         QList<QVariant> ret;
         for (int x: someLine.pRefs)
@@ -72,7 +76,7 @@ bool ProofModel::setData(const QModelIndex &index, const QVariant &value, int ro
     if (!mLines)
         return false;
 
-    ProofLine someLine = mLines->lines().at(index.row());
+    ProofLine someLine = mLines->lineAt(index.row());
 
     switch (role){
     case LineRole:
@@ -105,8 +109,15 @@ bool ProofModel::setData(const QModelIndex &index, const QVariant &value, int ro
 
     }
 
-    if (mLines->setLineAt(index.row(),someLine)) {
+    mSetting = true;
+    bool changed = mLines->setLineAt(index.row(),someLine);
+    mSetting = false;
+
+    if (changed) {
         emit dataChanged(index, index, {role});
+        // Renumbering keeps the meaning of a line, so its result stands.
+        if (role != LineRole && !mRenumbering)
+            resetResults(index.row(), index.row());
         return true;
     }
     return false;
@@ -132,6 +143,8 @@ QHash<int, QByteArray> ProofModel::roleNames() const
     names[SubEndRole] = "subEnd";
     names[IndentRole] = "ind";
     names[RefsRole] = "refs";
+    names[VerdictRole] = "verdict";
+    names[MessageRole] = "message";
     return names;
 }
 
@@ -149,20 +162,32 @@ void ProofModel::setlines(ProofData *newLines)
         mLines->disconnect(this);
 
     mLines = newLines;
+    mResults.clear();
 
     if (mLines){
-        connect(mLines,&ProofData::preLineInsert,this,[=](int index){
-            beginInsertRows(QModelIndex(),index,index);
+        mResults.fill(LineResult(), mLines->size());
+
+        connect(mLines,&ProofData::preLineInsert,this,[=](int first, int last){
+            beginInsertRows(QModelIndex(),first,last);
+            mResults.insert(first, last - first + 1, LineResult());
         });
         connect(mLines,&ProofData::postLineInsert,this,[=](){
             endInsertRows();
         });
-        connect(mLines,&ProofData::preLineRemove,this,[=](int index){
-            beginRemoveRows(QModelIndex(),index,index);
+        connect(mLines,&ProofData::preLineRemove,this,[=](int first, int last){
+            beginRemoveRows(QModelIndex(),first,last);
+            mResults.remove(first, last - first + 1);
         });
         connect(mLines,&ProofData::postLineRemove,this,[=](){
             endRemoveRows();
         });
+        // setData reports its own changes, with the role that changed.
+        connect(mLines,&ProofData::lineChanged,this,[=](int first, int last){
+            if (!mSetting){
+                emit dataChanged(index(first,0), index(last,0));
+                resetResults(first, last);
+            }
+        });
     }
 
     endResetModel();
@@ -173,7 +198,7 @@ void ProofModel::setlines(ProofData *newLines)
 // Update line number roles after insertion and/or removal of a proof line
 void ProofModel::updateLines()
 {
-    for (int i = 0; i < mLines->lines().size(); ++i) {
+    for (int i = 0; i < mLines->size(); ++i) {
         setData(index(i,0),i+1,LineRole);
     }
 }
@@ -181,8 +206,8 @@ void ProofModel::updateLines()
 // Update relevant reference roles after insertion and/or removal of a proof line
 void ProofModel::updateRefs(int ln, bool op)
 {
-    for (int i = ln+1; i < mLines->lines().size(); i++){
-        QList<int> refs = mLines->lines().at(i).pRefs;
+    for (int i = ln+1; i < mLines->size(); i++){
+        QList<int> refs = mLines->lineAt(i).pRefs;
 
         for (int ii = 1; ii < refs.size(); ii++){
 
@@ -202,7 +227,90 @@ void ProofModel::updateRefs(int ln, bool op)
         QList<QVariant> ret;
         for (int x: refs)
             ret.append(x);
+        mRenumbering = true;
         setData(index(i,0),ret,RefsRole);
+        mRenumbering = false;
+    }
+
+}
+
+// Set the result of a line, notifying the view only if it changed
+void ProofModel::setResultAt(int row, int verdict, const QString &message)
+{
+    if (row < 0 || row >= mResults.size())
+        return;
+
+    LineResult &result = mResults[row];
+    if (result.verdict == verdict && result.message == message)
+        return;
+
+    result.verdict = verdict;
+    result.message = message;
+    emit dataChanged(index(row,0), index(row,0), {VerdictRole, MessageRole});
+}
+
+// Mark the changed lines, and the lines that refer to them, as unchecked
+void ProofModel::resetResults(int first, int last)
+{
+    for (int i = first; i < mResults.size(); i++){
+        bool stale = (i <= last);
+
+        // References are line numbers, after a leading -1.
+        const QList<int> &refs = mLines->lineAt(i).pRefs;
+        for (int ii = 1; ii < refs.size() && !stale; ii++)
+            stale = (refs.at(ii) >= first + 1 && refs.at(ii) <= last + 1);
+
+        if (!stale)
+            continue;
+
+        LineResult &result = mResults[i];
+        result.reported = false;
+        result.lastVerdict = Unchecked;
+        result.lastMessage.clear();
+        setResultAt(i, Unchecked, QString());
     }
+}
 
+// Start taking the results of a new evaluation, keeping the old ones shown
+void ProofModel::beginResults()
+{
+    for (int i = 0; i < mResults.size(); i++)
+        mResults[i].reported = false;
+}
+
+// Set the evaluation result of a line
+void ProofModel::setResult(int row, bool correct, const QString &message)
+{
+    setResultAt(row, correct ? Correct : Incorrect, correct ? QString() : message);
+    if (row >= 0 && row < mResults.size())
+        mResults[row].reported = true;
+}
+
+// Keep the results of a finished evaluation; lines it didn't report are unchecked
+void ProofModel::finishResults()
+{
+    for (int i = 0; i < mResults.size(); i++){
+        LineResult &result = mResults[i];
+
+        if (!result.reported)
+            setResultAt(i, Unchecked, QString());
+
+        result.reported = false;
+        result.lastVerdict = result.verdict;
+        result.lastMessage = result.message;
+    }
+}
+
+// Undo the results of a cancelled evaluation, showing the last finished ones
+void ProofModel::cancelResults()
+{
+    for (int i = 0; i < mResults.size(); i++){
+        LineResult &result = mResults[i];
+
+        if (!result.reported)
+            continue;
+
+        result.reported = false;
+        setResultAt(i, result.lastVerdict, result.lastMessage);
+    }
 }
@@ -38,9 +38,19 @@ public:
         SubStartRole,
         SubEndRole,
         IndentRole,
-        RefsRole
+        RefsRole,
+        VerdictRole,
+        MessageRole
     };
 
+    // The result of evaluating a line.
+    enum Verdict {
+        Unchecked = 0,
+        Correct,
+        Incorrect
+    };
+    Q_ENUM(Verdict)
+
     // Basic functionality:
     int rowCount(const QModelIndex &parent = QModelIndex()) const override;
 
@@ -59,8 +69,31 @@ public:
     Q_INVOKABLE void updateLines();
     Q_INVOKABLE void updateRefs(int ln, bool op);
 
+public slots:
+    void beginResults();
+    void setResult(int row, bool correct, const QString &message);
+    void finishResults();
+    void cancelResults();
+
 private:
+    // The evaluation result of a line, kept outside of ProofData.
+    // The result of the last finished evaluation is kept, so that a
+    // cancelled evaluation can be undone.
+    struct LineResult {
+        int verdict = Unchecked;
+        QString message;
+        bool reported = false;      // Whether the running evaluation reported it.
+        int lastVerdict = Unchecked;
+        QString lastMessage;
+    };
+
+    void setResultAt(int row, int verdict, const QString &message);
+    void resetResults(int first, int last);
+
     ProofData *mLines;
+    QVector<LineResult> mResults;
+    bool mSetting;          // Whether setData is changing a line.
+    bool mRenumbering;      // Whether updateRefs is renumbering references.
 };
 
 #endif // PROOFMODEL_H
@@ -49,6 +49,11 @@
 #define IS_REF(s) (!strcmp (CSTD_CAST (s),REF_DATA) || !strcmp (CSTD_CAST (s),ALT_REF_DATA))
 #define IS_FILE(s) (!strcmp (CSTD_CAST (s),FILE_DATA) || !strcmp (CSTD_CAST (s),ALT_FILE_DATA))
 
+// The function used to look up lemmas outside of the file system.
+
+static aio_lemma_func lemma_resolver = NULL;
+static void * lemma_resolver_data = NULL;
+
 // A standard solution to replace a substring in a char array.
 // Taken from https://stackoverflow.com/a/779960
 
@@ -768,28 +773,21 @@ aio_validate_proof (proof_t * proof)
     return 0;
 }
 
-/* Opens a proof.
+/* Reads a proof from an xml stream, then frees the stream.
  *  input:
- *    file_name - the name of the file to open.
+ *    xml - the xml stream from which to read the proof.
  *  output:
- *    the opened proof, or NULL on error.
+ *    the read proof, or NULL on error.
  */
-proof_t *
-aio_open (const char * file_name)
+static proof_t *
+aio_read_proof (xmlTextReader * xml)
 {
-    if (file_name == NULL)
-        return NULL;
-
     proof_t * proof;
-    xmlTextReader * xml;
 
     proof = proof_init ();
     if (!proof)
         return NULL;
 
-    xml = xmlReaderForFile (file_name, NULL, 0);
-    if (!xml) XML_ERR (NULL);
-
     xmlChar * buffer, * name;
     int ret;
     int depth;
@@ -1016,3 +1014,79 @@ aio_open (const char * file_name)
 
     return proof;
 }
+
+/* Opens a proof.
+ *  input:
+ *    file_name - the name of the file to open.
+ *  output:
+ *    the opened proof, or NULL on error.
+ */
+proof_t *
+aio_open (const char * file_name)
+{
+    if (file_name == NULL)
+        return NULL;
+
+    xmlTextReader * xml;
+
+    xml = xmlReaderForFile (file_name, NULL, 0);
+    if (!xml) XML_ERR (NULL);
+
+    return aio_read_proof (xml);
+}
+
+/* Opens a proof from a buffer in memory.
+ *  input:
+ *    buffer - the contents of a proof file.
+ *    size - the size of buffer.
+ *    url - the name to report the buffer as, or NULL.
+ *  output:
+ *    the opened proof, or NULL on error.
+ */
+proof_t *
+aio_open_memory (const char * buffer, int size, const char * url)
+{
+    if (buffer == NULL)
+        return NULL;
+
+    xmlTextReader * xml;
+
+    xml = xmlReaderForMemory (buffer, size, url, NULL, 0);
+    if (!xml) XML_ERR (NULL);
+
+    return aio_read_proof (xml);
+}
+
+/* Sets the function used to look up lemma files before the file system.
+ *  input:
+ *    func - the function to call, or NULL to only use the file system.
+ *    data - the data to pass to func.
+ *  output:
+ *    none.
+ */
+void
+aio_set_lemma_resolver (aio_lemma_func func, void * data)
+{
+    lemma_resolver = func;
+    lemma_resolver_data = data;
+}
+
+/* Opens a proof used as a lemma.
+ *  input:
+ *    file_name - the name of the lemma file.
+ *  output:
+ *    the opened proof, or NULL on error.
+ */
+proof_t *
+aio_open_lemma (const char * file_name)
+{
+    if (lemma_resolver)
+    {
+        proof_t * proof;
+        proof = lemma_resolver (file_name, lemma_resolver_data);
+        if (proof)
+            return proof;
+    }
+
+    return aio_open (file_name);
+}
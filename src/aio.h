@@ -58,8 +58,15 @@ extern "C" {
 #define XML_CAST(o) ((xmlChar *)o)
 #define UNS_CAST (unsigned char *)
 
+// Looks up a lemma by file name, returning NULL if it isn't found.
+
+typedef proof_t * (* aio_lemma_func) (const char * file_name, void * data);
+
 int aio_save (proof_t * proof, const char * file_name);
 proof_t * aio_open (const char * file_name);
+proof_t * aio_open_memory (const char * buffer, int size, const char * url);
+void aio_set_lemma_resolver (aio_lemma_func func, void * data);
+proof_t * aio_open_lemma (const char * file_name);
 #ifdef __cplusplus
 }
 #endif
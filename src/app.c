@@ -33,6 +33,7 @@
 #include "sen-parent.h"
 #include "menu.h"
 #include "conf-file.h"
+#include "undo.h"
 
 #include "and-conn.xpm"
 #include "or-conn.xpm"
@@ -93,6 +94,8 @@ init_app (int boolean, int verbose)
   for (i = 0; i < NUM_BG_COLORS; i++)
     app->bg_colors[i] = NULL;
 
+  app->undo_limit = UNDO_LIMIT_DEFAULT;
+
   /* First, read the default configuration.
    * This way, if there are any problems reading the user's
    *   configuration, then there will already be one in place.
@@ -73,6 +73,7 @@ struct aris_app {
   char * ip_addr;        // The IP Address of the grade server.
   char * grade_pass;     // The password to the grade server.
   char * grade_dir;      // The directory in the ftp server to cd to.
+  int undo_limit;        // The memory limit of each undo stack, in kilobytes.
 
   int boolean : 1;  // Whether boolean mode was specified.
   int verbose : 1;  // Whether verbose was specified.
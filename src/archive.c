@@ -0,0 +1,589 @@
+/* Functions for reading proofs from archives.
+
+   Copyright (C) 2026 The GNU Aris contributors.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>
+
+#include "archive.h"
+#include "aio.h"
+#include "vec.h"
+
+#define TAR_BLOCK 512
+
+#define ZIP_LOCAL_SIG 0x04034b50
+#define ZIP_CENTRAL_SIG 0x02014b50
+#define ZIP_END_SIG 0x06054b50
+#define ZIP_END_LEN 22
+#define ZIP_MAX_COMMENT 0xffff
+
+#define ZIP_STORED 0
+#define ZIP_DEFLATED 8
+
+// The largest entry read, and the most that deflate can expand its input.
+#define ARCHIVE_MAX_SIZE 0x7ffffffe
+#define ZIP_MAX_RATIO 1032
+
+// Little endian readers for zip headers.
+#define GET_16(p) ((unsigned int) (p)[0] | ((unsigned int) (p)[1] << 8))
+#define GET_32(p) (GET_16 (p) | (GET_16 ((p) + 2) << 16))
+
+/* Adds an entry to an archive, taking ownership of name and data.
+ *  input:
+ *    arc - the archive to which to add the entry.
+ *    name - the name of the entry.
+ *    data - the contents of the entry.
+ *    size - the size of data.
+ *  output:
+ *    0 on success, -1 on memory error.
+ */
+static int
+archive_add_entry (archive_t * arc, char * name, char * data, int size)
+{
+    archive_entry entry;
+    int ret;
+
+    // Directories have no contents worth keeping.
+    if (name[0] == '\0' || name[strlen (name) - 1] == '/')
+    {
+        free (name);
+        free (data);
+        return 0;
+    }
+
+    entry.name = name;
+    entry.data = data;
+    entry.size = size;
+
+    ret = vec_add_obj (arc->entries, &entry);
+    if (ret < 0)
+    {
+        free (name);
+        free (data);
+        return AEC_MEM;
+    }
+
+    return 0;
+}
+
+/* Reads the entries of a tar archive, which may be gzip compressed.
+ *  input:
+ *    arc - the archive that receives the entries.
+ *    file_name - the name of the archive file.
+ *  output:
+ *    0 on success, -1 on memory error, -2 on I/O error, -3 on a malformed
+ *    archive.
+ */
+static int
+archive_read_tar (archive_t * arc, const char * file_name)
+{
+    gzFile gz;
+    unsigned char header[TAR_BLOCK];
+    char * long_name = NULL;
+    int ret;
+
+    // gzread passes uncompressed files through untouched.
+    gz = gzopen (file_name, "rb");
+    if (!gz)
+        return AEC_IO;
+
+    while (gzread (gz, header, TAR_BLOCK) == TAR_BLOCK)
+    {
+        char * name, * data;
+        long size;
+        int padded, type;
+
+        // An empty header marks the end of the archive.
+        if (header[0] == '\0')
+            break;
+
+        size = strtol ((const char *) header + 124, NULL, 8);
+        type = header[156];
+        if (size < 0 || size > ARCHIVE_MAX_SIZE)
+        {
+            if (long_name)
+                free (long_name);
+            gzclose (gz);
+            return AEC_FORMAT;
+        }
+
+        padded = (size + TAR_BLOCK - 1) / TAR_BLOCK * TAR_BLOCK;
+        data = (char *) calloc (padded + 1, sizeof (char));
+        CHECK_ALLOC (data, AEC_MEM);
+
+        if (gzread (gz, data, padded) != padded)
+        {
+            free (data);
+            gzclose (gz);
+            return AEC_FORMAT;
+        }
+
+        data[size] = '\0';
+
+        // GNU long names and pax headers name the entry that follows.
+        if (type == 'L')
+        {
+            if (long_name)
+                free (long_name);
+            long_name = data;
+            continue;
+        }
+
+        if (type == 'x')
+        {
+            char * path;
+            path = strstr (data, " path=");
+            if (path)
+            {
+                path += 6;
+                if (long_name)
+                    free (long_name);
+                long_name = strndup (path, strcspn (path, "\n"));
+                CHECK_ALLOC (long_name, AEC_MEM);
+            }
+            free (data);
+            continue;
+        }
+
+        if (type != '0' && type != '\0')
+        {
+            free (data);
+            continue;
+        }
+
+        if (long_name)
+        {
+            name = long_name;
+            long_name = NULL;
+        }
+        else if (!strncmp ((const char *) header + 257, "ustar", 5)
+                 && header[345] != '\0')
+        {
+            name = (char *) calloc (257, sizeof (char));
+            CHECK_ALLOC (name, AEC_MEM);
+            sprintf (name, "%.155s/%.100s", header + 345, header);
+        }
+        else
+        {
+            name = strndup ((const char *) header, 100);
+            CHECK_ALLOC (name, AEC_MEM);
+        }
+
+        ret = archive_add_entry (arc, name, data, (int) size);
+        if (ret < 0)
+        {
+            gzclose (gz);
+            return AEC_MEM;
+        }
+    }
+
+    if (long_name)
+        free (long_name);
+
+    gzclose (gz);
+    return 0;
+}
+
+/* Reads the entries of a zip archive.
+ *  input:
+ *    arc - the archive that receives the entries.
+ *    file_name - the name of the archive file.
+ *  output:
+ *    0 on success, -1 on memory error, -2 on I/O error, -3 on a malformed
+ *    archive.
+ */
+static int
+archive_read_zip (archive_t * arc, const char * file_name)
+{
+    FILE * file;
+    unsigned char * buffer, * end, * cdr;
+    long buf_len;
+    int i, num_entries, ret;
+
+    file = fopen (file_name, "rb");
+    if (!file)
+        return AEC_IO;
+
+    fseek (file, 0, SEEK_END);
+    buf_len = ftell (file);
+    fseek (file, 0, SEEK_SET);
+
+    if (buf_len < ZIP_END_LEN)
+    {
+        fclose (file);
+        return AEC_FORMAT;
+    }
+
+    buffer = (unsigned char *) calloc (buf_len, sizeof (char));
+    CHECK_ALLOC (buffer, AEC_MEM);
+
+    if (fread (buffer, 1, buf_len, file) != buf_len)
+    {
+        free (buffer);
+        fclose (file);
+        return AEC_IO;
+    }
+
+    fclose (file);
+
+    // The central directory is located by the record at the end of the file,
+    // which may be followed by a comment.
+
+    end = buffer + buf_len - ZIP_END_LEN;
+    while (end > buffer && GET_32 (end) != ZIP_END_SIG
+           && buffer + buf_len - end < ZIP_END_LEN + ZIP_MAX_COMMENT)
+        end--;
+
+    if (GET_32 (end) != ZIP_END_SIG)
+    {
+        free (buffer);
+        return AEC_FORMAT;
+    }
+
+    // Every offset and length below comes from the archive, so each is
+    // checked against the end of the buffer before it is used.
+
+    num_entries = GET_16 (end + 10);
+    if (GET_32 (end + 16) > end - buffer)
+    {
+        free (buffer);
+        return AEC_FORMAT;
+    }
+
+    cdr = buffer + GET_32 (end + 16);
+    ret = 0;
+
+    for (i = 0; i < num_entries; i++)
+    {
+        unsigned char * local;
+        unsigned int method, comp_size, size, name_len;
+        unsigned int cdr_len, local_off, local_len;
+        char * name, * data;
+
+        if (end - cdr < 46 || GET_32 (cdr) != ZIP_CENTRAL_SIG)
+            break;
+
+        method = GET_16 (cdr + 10);
+        comp_size = GET_32 (cdr + 20);
+        size = GET_32 (cdr + 24);
+        name_len = GET_16 (cdr + 28);
+        cdr_len = 46 + name_len + GET_16 (cdr + 30) + GET_16 (cdr + 32);
+        local_off = GET_32 (cdr + 42);
+
+        if (cdr_len > end - cdr || local_off > end - buffer)
+            break;
+
+        local = buffer + local_off;
+        if (end - local < 30 || GET_32 (local) != ZIP_LOCAL_SIG)
+            break;
+
+        local_len = 30 + GET_16 (local + 26) + GET_16 (local + 28);
+        if (local_len > end - local)
+            break;
+
+        local += local_len;
+        if (comp_size > end - local)
+            break;
+
+        name = strndup ((const char *) cdr + 46, name_len);
+        cdr += cdr_len;
+
+        if (!name)
+        {
+            ret = AEC_MEM;
+            break;
+        }
+
+        // Deflate cannot expand data by more than ZIP_MAX_RATIO, so a
+        // larger size is a corrupt or malicious header.
+        if (size > ARCHIVE_MAX_SIZE
+            || (unsigned long) size > (unsigned long) comp_size * ZIP_MAX_RATIO)
+        {
+            free (name);
+            continue;
+        }
+
+        data = (char *) calloc (size + 1, sizeof (char));
+        if (!data)
+        {
+            free (name);
+            ret = AEC_MEM;
+            break;
+        }
+
+        if (method == ZIP_STORED && comp_size == size)
+        {
+            memcpy (data, local, size);
+        }
+        else if (method == ZIP_DEFLATED)
+        {
+            z_stream zs;
+            int z_ret;
+
+            memset (&zs, 0, sizeof (z_stream));
+            if (inflateInit2 (&zs, -MAX_WBITS) != Z_OK)
+            {
+                free (name);
+                free (data);
+                break;
+            }
+
+            zs.next_in = local;
+            zs.avail_in = comp_size;
+            zs.next_out = (unsigned char *) data;
+            zs.avail_out = size;
+
+            z_ret = inflate (&zs, Z_FINISH);
+            inflateEnd (&zs);
+
+            if (z_ret != Z_STREAM_END)
+            {
+                free (name);
+                free (data);
+                continue;
+            }
+        }
+        else
+        {
+            // Unsupported compression methods are skipped.
+            free (name);
+            free (data);
+            continue;
+        }
+
+        data[size] = '\0';
+
+        if (archive_add_entry (arc, name, data, (int) size) < 0)
+        {
+            ret = AEC_MEM;
+            break;
+        }
+    }
+
+    free (buffer);
+
+    if (ret < 0)
+        return ret;
+
+    return (i == num_entries) ? 0 : AEC_FORMAT;
+}
+
+/* Determines whether or not a file name names an archive.
+ *  input:
+ *    file_name - the file name to check.
+ *  output:
+ *    1 if file_name has an archive extension, 0 otherwise.
+ */
+int
+archive_is_archive (const char * file_name)
+{
+    static const char * exts[] = {".zip", ".tar", ".tar.gz", ".tgz", NULL};
+    int i, f_len, e_len;
+
+    f_len = strlen (file_name);
+    for (i = 0; exts[i]; i++)
+    {
+        e_len = strlen (exts[i]);
+        if (f_len > e_len && !strcmp (file_name + f_len - e_len, exts[i]))
+            return 1;
+    }
+
+    return 0;
+}
+
+/* Opens an archive, decompressing its entries into memory.
+ *  input:
+ *    file_name - the name of the archive file.
+ *  output:
+ *    the opened archive, or NULL on error.
+ */
+archive_t *
+archive_open (const char * file_name)
+{
+    archive_t * arc;
+    FILE * file;
+    unsigned char magic[4];
+    int ret;
+
+    file = fopen (file_name, "rb");
+    if (!file)
+    {
+        PERROR (file_name);
+        return NULL;
+    }
+
+    memset (magic, 0, 4);
+    ret = fread (magic, 1, 4, file);
+    fclose (file);
+
+    arc = (archive_t *) calloc (1, sizeof (archive_t));
+    CHECK_ALLOC (arc, NULL);
+
+    arc->entries = init_vec (sizeof (archive_entry));
+    if (!arc->entries)
+    {
+        free (arc);
+        return NULL;
+    }
+
+    if (ret == 4 && GET_32 (magic) == ZIP_LOCAL_SIG)
+        ret = archive_read_zip (arc, file_name);
+    else
+        ret = archive_read_tar (arc, file_name);
+
+    if (ret < 0)
+    {
+        fprintf (stderr, "Unable to read archive '%s'.\n", file_name);
+        archive_destroy (arc);
+        return NULL;
+    }
+
+    return arc;
+}
+
+/* Destroys an archive.
+ *  input:
+ *    arc - the archive to destroy.
+ *  output:
+ *    none.
+ */
+void
+archive_destroy (archive_t * arc)
+{
+    int i;
+
+    for (i = 0; i < arc->entries->num_stuff; i++)
+    {
+        archive_entry * entry;
+        entry = vec_nth (arc->entries, i);
+        free (entry->name);
+        free (entry->data);
+    }
+
+    destroy_vec (arc->entries);
+    free (arc);
+}
+
+/* Gets the base name of a path.
+ *  input:
+ *    path - the path.
+ *  output:
+ *    the part of path after the last separator.
+ */
+static const char *
+archive_base_name (const char * path)
+{
+    const char * sep;
+
+    sep = strrchr (path, '/');
+    if (!sep)
+        sep = strrchr (path, '\\');
+
+    return sep ? sep + 1 : path;
+}
+
+/* Finds an entry of an archive by name.
+ *  input:
+ *    arc - the archive in which to find the entry.
+ *    name - the name of the entry, which is matched against the full path
+ *           first, then against the base name within the directory of
+ *           the current entry.
+ *  output:
+ *    the entry, or NULL if no entry has the given name.
+ */
+archive_entry *
+archive_find (archive_t * arc, const char * name)
+{
+    const char * base, * dir;
+    int i, dir_len;
+
+    while (!strncmp (name, "./", 2))
+        name += 2;
+
+    for (i = 0; i < arc->entries->num_stuff; i++)
+    {
+        archive_entry * entry;
+        const char * entry_name;
+
+        entry = vec_nth (arc->entries, i);
+        entry_name = entry->name;
+        while (!strncmp (entry_name, "./", 2))
+            entry_name += 2;
+
+        if (!strcmp (entry_name, name))
+            return entry;
+    }
+
+    // Lemmas are usually referred to by an absolute path on the
+    // submitter's machine, so fall back to the base name.  An archive may
+    // hold several submissions, so only look beside the proof that refers
+    // to the lemma - a lemma of the same name in another submission is a
+    // different lemma.
+
+    base = archive_base_name (name);
+    dir = arc->current ? arc->current->name : "";
+    dir_len = archive_base_name (dir) - dir;
+
+    for (i = 0; i < arc->entries->num_stuff; i++)
+    {
+        archive_entry * entry;
+        entry = vec_nth (arc->entries, i);
+
+        if (archive_base_name (entry->name) - entry->name == dir_len
+            && !strncmp (entry->name, dir, dir_len)
+            && !strcmp (entry->name + dir_len, base))
+            return entry;
+    }
+
+    return NULL;
+}
+
+/* Opens a proof from an entry of an archive.
+ *  input:
+ *    arc - the archive that contains the entry.
+ *    entry - the entry to open.
+ *  output:
+ *    the opened proof, or NULL on error.
+ */
+proof_t *
+archive_open_proof (archive_t * arc, archive_entry * entry)
+{
+    arc->current = entry;
+    return aio_open_memory (entry->data, entry->size, entry->name);
+}
+
+/* Opens a lemma from an archive - for use with aio_set_lemma_resolver.
+ *  input:
+ *    file_name - the name of the lemma file.
+ *    data - the archive in which to look for the lemma.
+ *  output:
+ *    the opened proof, or NULL if the archive doesn't contain the lemma.
+ */
+proof_t *
+archive_open_lemma (const char * file_name, void * data)
+{
+    archive_entry * entry;
+
+    entry = archive_find ((archive_t *) data, file_name);
+    if (!entry)
+        return NULL;
+
+    // Keep looking beside the proof that refers to the lemma.
+    return aio_open_memory (entry->data, entry->size, entry->name);
+}
@@ -0,0 +1,52 @@
+/* Functions for reading proofs from archives.
+
+   Copyright (C) 2026 The GNU Aris contributors.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ARCHIVE_H
+#define ARCHIVE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include "typedef.h"
+
+// An entry of an archive, decompressed into memory.
+
+struct archive_entry {
+    char * name;   // The name of the entry within the archive.
+    char * data;   // The decompressed contents of the entry.
+    int size;      // The size of data.
+};
+
+// The archive structure.
+
+struct archive {
+    vec_t * entries;          // The regular files of the archive.
+    archive_entry * current;  // The proof being evaluated, or NULL.
+};
+
+int archive_is_archive (const char * file_name);
+archive_t * archive_open (const char * file_name);
+void archive_destroy (archive_t * arc);
+archive_entry * archive_find (archive_t * arc, const char * name);
+proof_t * archive_open_proof (archive_t * arc, archive_entry * entry);
+proof_t * archive_open_lemma (const char * file_name, void * data);
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ARCHIVE_H
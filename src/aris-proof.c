@@ -33,6 +33,7 @@
 #include "sen-data.h"
 #include "var.h"
 #include "goal.h"
+#include "goal-index.h"
 #include "callbacks.h"
 #include "list.h"
 #include "process.h"
@@ -41,6 +42,7 @@
 #include "aio.h"
 #include "vec.h"
 #include "undo.h"
+#include "eval-worker.h"
 
 #include "sentence-screen-keyboard.h"
 
@@ -108,6 +110,15 @@ aris_proof_init ()
   if (!ap->undo_stack)
     return NULL;
   ap->undo_pt = -1;
+  ap->undo_size = 0;
+
+  ap->live_pending = init_list ();
+  if (!ap->live_pending)
+    return NULL;
+
+  ap->live_running = init_list ();
+  if (!ap->live_running)
+    return NULL;
 
   aris_proof_set_sb (ap, _("Ready"));
 
@@ -117,6 +128,10 @@ aris_proof_init ()
   if (ret < 0)
     return NULL;
 
+  ret = aris_proof_index_lines (ap);
+  if (ret < 0)
+    return NULL;
+
   ap->goal = goal_init (ap);
   if (!ap->goal)
     return NULL;
@@ -256,10 +271,23 @@ aris_proof_init_from_proof (proof_t * proof)
   if (!ap->undo_stack)
     return NULL;
   ap->undo_pt = -1;
+  ap->undo_size = 0;
+
+  ap->live_pending = init_list ();
+  if (!ap->live_pending)
+    return NULL;
+
+  ap->live_running = init_list ();
+  if (!ap->live_running)
+    return NULL;
 
   item_t * ev_itr;
   int first = 1;
 
+  // Only create the widgets of the sentences that are shown.
+  if (proof->everything->num_stuff > SEN_PARENT_LAZY_LINES)
+    SEN_PARENT (ap)->lazy = 1;
+
   ev_itr = proof->everything->head;
   for (; ev_itr != NULL; ev_itr = ev_itr->next)
     {
@@ -292,12 +320,15 @@ aris_proof_init_from_proof (proof_t * proof)
         }
     }
 
+  if (aris_proof_index_lines (ap) < 0)
+    return NULL;
+
   ap->goal = goal_init_from_list (ap, proof->goals);
   if (!ap->goal)
     return NULL;
 
   gtk_widget_show_all (SEN_PARENT (ap)->window);
-  gtk_widget_grab_focus (((sentence *) SEN_PARENT (ap)->everything->head->value)->entry);
+  sen_parent_set_focus (SEN_PARENT (ap), SEN_PARENT (ap)->everything->head);
    
   //init_sentence_screen_keyboard(&(ap->sp)); // Initialize the screen keyboard for logic operations
 
@@ -327,10 +358,34 @@ aris_proof_destroy (aris_proof * ap)
       ap->yanked = NULL;
     }
 
+  eval_worker_cancel (ap);
+
+  if (ap->live_source)
+    g_source_remove (ap->live_source);
+  ap->live_source = 0;
+
+  if (ap->live_pending)
+    {
+      destroy_list (ap->live_pending);
+      ap->live_pending = NULL;
+    }
+
+  if (ap->live_running)
+    {
+      destroy_list (ap->live_running);
+      ap->live_running = NULL;
+    }
+
   ap->fin_prem = NULL;
   ap->sb_text = NULL;
 
   goal_destroy (ap->goal);
+  if (ap->lines_index)
+    {
+      goal_index_destroy (ap->lines_index);
+      ap->lines_index = NULL;
+    }
+
   if (ap->selected)
     {
       destroy_list (ap->selected);
@@ -384,6 +439,7 @@ aris_proof_create_menu (sen_parent * ap)
     (conf_obj[]) {
       main_menu_conf[CONF_MENU_EVAL_LINE],
       main_menu_conf[CONF_MENU_EVAL_PROOF],
+      main_menu_conf[CONF_MENU_LIVE_EVAL],
       menu_separator,
       main_menu_conf[CONF_MENU_GOAL],
       main_menu_conf[CONF_MENU_BOOLEAN],
@@ -437,6 +493,14 @@ aris_proof_set_changed (aris_proof * ap, int changed, undo_info ui)
   const char * title = gtk_window_get_title (GTK_WINDOW (SEN_PARENT (ap)->window));
   int pos = 0;
 
+  // Results computed from the old contents are no longer valid.
+  if (changed)
+    {
+      eval_worker_cancel (ap);
+      if (aris_proof_live_requeue (ap) == AEC_MEM)
+        return AEC_MEM;
+    }
+
   new_title = (char *) calloc (strlen (title) + 4, sizeof (char));
   CHECK_ALLOC (new_title, AEC_MEM);
   pos = sprintf (new_title, "%s", title);
@@ -472,6 +536,13 @@ aris_proof_set_changed (aris_proof * ap, int changed, undo_info ui)
 int
 aris_proof_adjust_lines (aris_proof * ap, item_t * itm, int mod)
 {
+  // Batches renumber everything once they end.
+  if (ap->batch)
+    {
+      ap->batch_dirty = 1;
+      return 0;
+    }
+
   int line_mod = 1;
   line_mod *= mod;
 
@@ -493,6 +564,15 @@ aris_proof_adjust_lines (aris_proof * ap, item_t * itm, int mod)
       if (ret == AEC_MEM)
         return AEC_MEM;
 
+      // Keep the goals met at this sentence pointing at its new line.
+      item_t * g_itr;
+      for (g_itr = ev_sen->goals->head; g_itr; g_itr = g_itr->next)
+        {
+          ret = sentence_update_line_no (SENTENCE (g_itr->value), new_line_no);
+          if (ret == AEC_MEM)
+            return AEC_MEM;
+        }
+
       int i;
 
       for (i = 0; i < SEN_DEPTH(ev_sen); i++)
@@ -506,6 +586,196 @@ aris_proof_adjust_lines (aris_proof * ap, item_t * itm, int mod)
   return 0;
 }
 
+/* Starts a batch of structural edits to an aris proof.
+ *  Until the batch ends, inserting or removing sentences doesn't renumber
+ *  the sentences after them.  Only the sentences before the first edit
+ *  are guaranteed to have the correct line numbers.
+ *  input:
+ *    ap - the aris proof being edited.
+ *  output:
+ *    none.
+ */
+void
+aris_proof_begin_batch (aris_proof * ap)
+{
+  ap->batch++;
+}
+
+/* Ends a batch of structural edits to an aris proof, renumbering the
+ * lines, subproof indices and references of the proof in a single pass.
+ *  input:
+ *    ap - the aris proof being edited.
+ *  output:
+ *    0 on success, -1 on memory error.
+ */
+int
+aris_proof_end_batch (aris_proof * ap)
+{
+  item_t * ev_itr, * g_itr;
+  vec_t * sub_lines;
+  int ln, i, ret;
+
+  if (ap->batch == 0 || --ap->batch > 0 || !ap->batch_dirty)
+    return 0;
+
+  ap->batch_dirty = 0;
+
+  // The stack of the lines of the open subproofs.
+  sub_lines = init_vec (sizeof (int));
+  if (!sub_lines)
+    return AEC_MEM;
+
+  ln = 0;
+  for (ev_itr = SEN_PARENT (ap)->everything->head; ev_itr; ev_itr = ev_itr->next)
+    {
+      sentence * ev_sen = ev_itr->value;
+      int depth = SEN_DEPTH(ev_sen);
+
+      ln++;
+      if (sentence_get_line_no (ev_sen) != ln)
+        {
+          ret = sentence_update_line_no (ev_sen, ln);
+          if (ret == AEC_MEM)
+            return AEC_MEM;
+
+          for (g_itr = ev_sen->goals->head; g_itr; g_itr = g_itr->next)
+            {
+              ret = sentence_update_line_no (SENTENCE (g_itr->value), ln);
+              if (ret == AEC_MEM)
+                return AEC_MEM;
+            }
+        }
+
+      // A sentence lies within the last depth open subproofs.
+      if (SEN_SUB(ev_sen) && depth > 0)
+        {
+          if (sub_lines->num_stuff > depth - 1)
+            sub_lines->num_stuff = depth - 1;
+          ret = vec_add_obj (sub_lines, &ln);
+          if (ret < 0)
+            return AEC_MEM;
+        }
+      else if (sub_lines->num_stuff > depth)
+        {
+          sub_lines->num_stuff = depth;
+        }
+
+      if (sub_lines->num_stuff < depth)
+        continue;
+
+      for (i = 0; i < depth; i++)
+        sentence_set_index (ev_sen, i, *((int *) vec_nth (sub_lines, i)));
+    }
+
+  destroy_vec (sub_lines);
+
+  for (ev_itr = SEN_PARENT (ap)->everything->head; ev_itr; ev_itr = ev_itr->next)
+    {
+      sentence * ev_sen = ev_itr->value;
+
+      if (ev_sen->references->num_stuff == 0)
+        continue;
+
+      ret = sentence_refresh_refs (ev_sen);
+      if (ret == AEC_MEM)
+        return AEC_MEM;
+    }
+
+  if (ap->lines_index)
+    {
+      ret = aris_proof_index_lines (ap);
+      if (ret < 0)
+        return AEC_MEM;
+    }
+
+  return 0;
+}
+
+/* Determines whether a line counts as correct when a goal is met after it.
+ *  input:
+ *    sen - the sentence of the line.
+ *  output:
+ *    1 if the line is correct, 0 otherwise.
+ */
+static int
+aris_proof_line_valid (sentence * sen)
+{
+  if (SEN_PREM (sen) || SEN_SUB (sen))
+    return (sen->value_type != VALUE_TYPE_ERROR);
+
+  return (sen->value_type == VALUE_TYPE_TRUE);
+}
+
+/* Updates the text and correctness of a line in the index of an aris proof.
+ *  During a batch, the index is rebuilt once the batch ends instead.
+ *  input:
+ *    ap - the aris proof containing the sentence.
+ *    sen - the sentence that changed.
+ *  output:
+ *    0 on success, -1 on memory error.
+ */
+int
+aris_proof_index_line (aris_proof * ap, sentence * sen)
+{
+  int ln, ret;
+
+  if (!ap->lines_index)
+    return 0;
+
+  if (ap->batch)
+    {
+      ap->batch_dirty = 1;
+      return 0;
+    }
+
+  ln = sentence_get_line_no (sen);
+  ret = goal_index_set_line (ap->lines_index, ln, sentence_get_text (sen));
+  if (ret == AEC_MEM)
+    return AEC_MEM;
+
+  goal_index_set_valid (ap->lines_index, ln, aris_proof_line_valid (sen));
+  return 0;
+}
+
+/* Rebuilds the index of the lines of an aris proof.
+ *  input:
+ *    ap - the aris proof to index.
+ *  output:
+ *    0 on success, -1 on memory error.
+ */
+int
+aris_proof_index_lines (aris_proof * ap)
+{
+  goal_index * gi;
+  item_t * ev_itr;
+  int ln, ret;
+
+  gi = goal_index_init ();
+  if (!gi)
+    return AEC_MEM;
+
+  for (ev_itr = SEN_PARENT (ap)->everything->head, ln = 1; ev_itr;
+       ev_itr = ev_itr->next, ln++)
+    {
+      sentence * ev_sen = ev_itr->value;
+
+      ret = goal_index_set_line (gi, ln, sentence_get_text (ev_sen));
+      if (ret == AEC_MEM)
+        {
+          goal_index_destroy (gi);
+          return AEC_MEM;
+        }
+
+      goal_index_set_valid (gi, ln, aris_proof_line_valid (ev_sen));
+    }
+
+  if (ap->lines_index)
+    goal_index_destroy (ap->lines_index);
+  ap->lines_index = gi;
+
+  return 0;
+}
+
 /* Copies an aris proof into a data proof.
  *  input:
  *    ap - the aris proof to copy in.
@@ -612,6 +882,23 @@ aris_proof_create_sentence (aris_proof * ap, sen_data * sd, int undo)
 
   sen = itm->value;
 
+  if (ap->lines_index && !ap->batch)
+    {
+      ret = goal_index_insert_line (ap->lines_index, sentence_get_line_no (sen),
+                                    sentence_get_text (sen),
+                                    aris_proof_line_valid (sen));
+      if (ret < 0)
+        return NULL;
+    }
+
+  // New sentences are always shown, since they take focus.
+  if (undo && !SEN_REALIZED (sen))
+    {
+      ret = sentence_gui_realize (sen, 1);
+      if (ret < 0)
+        return NULL;
+    }
+
   //fprintf (stderr, "create_sentence: sen->line_num == %i\n", sentence_get_line_no (sen));
 
   undo_info ui = { 0 };
@@ -769,10 +1056,15 @@ aris_proof_end_sub (aris_proof * ap)
 int
 aris_proof_remove_sentence (aris_proof * ap, sentence * sen)
 {
-  if (sentence_get_line_no (sen) == 1)
+  // Line numbers may be stale during a batch, so check the position.
+  if (SEN_PARENT (ap)->everything->head->value == sen)
     return 1;
 
   int have_fin_prem = (ap->fin_prem->value == sen) ? 1 : 0;
+  int ln = sentence_get_line_no (sen);
+
+  ls_rem_obj_value (ap->live_pending, sen);
+  ls_rem_obj_value (ap->live_running, sen);
 
   item_t * target = sen_parent_rem_sentence ((sen_parent *) ap, sen);
   if (!target)
@@ -785,9 +1077,40 @@ aris_proof_remove_sentence (aris_proof * ap, sentence * sen)
   if (ret < 0)
     return AEC_MEM;
 
+  if (ap->lines_index && !ap->batch)
+    goal_index_remove_line (ap->lines_index, ln);
+
   return 0;
 }
 
+/* Removes a set of sentences from an aris proof, renumbering once.
+ *  input:
+ *    ap - the aris proof from which to remove the sentences.
+ *    sens - the sentences to remove.
+ *  output:
+ *    0 on success, -1 on memory error, 1 if one of the sentences is the first.
+ */
+int
+aris_proof_remove_sentences (aris_proof * ap, list_t * sens)
+{
+  item_t * itm;
+  int ret = 0;
+
+  aris_proof_begin_batch (ap);
+
+  for (itm = sens->head; itm; itm = itm->next)
+    {
+      ret = aris_proof_remove_sentence (ap, itm->value);
+      if (ret != 0)
+        break;
+    }
+
+  if (aris_proof_end_batch (ap) == AEC_MEM)
+    return AEC_MEM;
+
+  return ret;
+}
+
 /* Sets the font of an aris proof.
  *  input:
  *    ap - the aris proof to set the font of.
@@ -1050,7 +1373,17 @@ aris_proof_kill (aris_proof * ap)
   if (!sen_ls)
     return AEC_MEM;
 
-  item_t * push_chk;
+  item_t * push_chk, ** lines, * ev_itr;
+  int i;
+
+  // Look the lines up by number in a single pass.
+  lines = (item_t **) calloc (SEN_PARENT (ap)->everything->num_stuff,
+                              sizeof (item_t *));
+  CHECK_ALLOC (lines, AEC_MEM);
+
+  i = 0;
+  for (ev_itr = SEN_PARENT (ap)->everything->head; ev_itr; ev_itr = ev_itr->next)
+    lines[i++] = ev_itr;
 
   /* Since refs will be changing, set up undo information and
    *  the list of sentences before removing anything.
@@ -1060,8 +1393,7 @@ aris_proof_kill (aris_proof * ap)
     {
       sen_data * sd = sel_itr->value;
 
-      // This is really inefficient.
-      item_t * ev_itr = ls_nth (SEN_PARENT (ap)->everything, sd->line_num - 1);
+      ev_itr = lines[sd->line_num - 1];
 
       sentence * sen;
       sen = ev_itr->value;
@@ -1078,21 +1410,15 @@ aris_proof_kill (aris_proof * ap)
         return AEC_MEM;
     }
 
-  item_t * n_itr;
+  free (lines);
 
-  for (sel_itr = sen_ls->head; sel_itr;)
-    {
-      sentence * sen = sel_itr->value;
-      ret_chk = aris_proof_remove_sentence (ap, sen);
-      if (ret_chk == AEC_MEM)
-        return AEC_MEM;
-      if (ret_chk == 1)
-        return 1;
-      n_itr = sel_itr->next;
-      free (sel_itr);
-      sel_itr = n_itr;
-    }
-  free (sen_ls);
+  ret_chk = aris_proof_remove_sentences (ap, sen_ls);
+  if (ret_chk == AEC_MEM)
+    return AEC_MEM;
+  if (ret_chk == 1)
+    return 1;
+
+  destroy_list (sen_ls);
 
   ui = undo_info_init (ap, ls, UIT_REM_SEN);
   if (ui.type == -1)
@@ -1126,6 +1452,10 @@ aris_proof_yank (aris_proof * ap)
   item_t * yank_itr;
   int ret, line_num;
   line_num = sentence_get_line_no ((sentence *)SEN_PARENT(ap)->focused->value);
+
+  // Renumber the lines after the yanked ones only once.
+  aris_proof_begin_batch (ap);
+
   for (yank_itr = ap->yanked->head; yank_itr; yank_itr = yank_itr->next)
     {
       line_num++;
@@ -1150,6 +1480,10 @@ aris_proof_yank (aris_proof * ap)
       ls_push_obj (ls, sentence_copy_to_data (sen));
     }
 
+  ret = aris_proof_end_batch (ap);
+  if (ret == AEC_MEM)
+    return AEC_MEM;
+
   undo_info ui;
   ui = undo_info_init (ap, ls, UIT_ADD_SEN);
   if (ui.type == -1)
@@ -1277,6 +1611,193 @@ aris_proof_toggle_boolean_mode (aris_proof * ap)
   return 0;
 }
 
+/* Toggles live evaluation for an aris proof.
+ *  input:
+ *    ap - The aris proof for which live evaluation is being toggled.
+ *  output:
+ *    0 on success, -1 on memory error.
+ */
+int
+aris_proof_toggle_live_eval (aris_proof * ap)
+{
+  ap->live_eval = (ap->live_eval) ? 0 : 1;
+
+  if (!ap->live_eval)
+    {
+      if (ap->live_source)
+        g_source_remove (ap->live_source);
+      ap->live_source = 0;
+      ls_clear (ap->live_pending);
+      ls_clear (ap->live_running);
+      ap->live_full = 0;
+
+      aris_proof_set_sb (ap, _("Live evaluation disabled."));
+      return 0;
+    }
+
+  // Bring every line up to date, so that later edits only need
+  // to re-check the lines they affect.
+  int ret;
+  ret = eval_worker_queue (ap, NULL, 0);
+  if (ret == AEC_MEM)
+    return AEC_MEM;
+
+  // An edit before it finishes schedules it again.
+  ap->live_full = 1;
+
+  aris_proof_set_sb (ap, _("Live evaluation enabled."));
+  return 0;
+}
+
+/* Moves the sentences of the running live evaluation back to the
+ * pending sentences.
+ *  input:
+ *    ap - the aris proof.
+ *  output:
+ *    0 on success, -1 on memory error.
+ */
+static int
+aris_proof_live_merge (aris_proof * ap)
+{
+  item_t * itm;
+
+  for (itm = ap->live_running->head; itm; itm = itm->next)
+    {
+      if (ls_find (ap->live_pending, itm->value))
+        continue;
+
+      if (!ls_push_obj (ap->live_pending, itm->value))
+        return AEC_MEM;
+    }
+
+  ls_clear (ap->live_running);
+  return 0;
+}
+
+/* Evaluates the pending sentences of a proof - called when typing pauses.
+ *  input:
+ *    data - the aris proof.
+ *  output:
+ *    FALSE, so that the source is removed.
+ */
+static gboolean
+aris_proof_live_eval_timeout (gpointer data)
+{
+  aris_proof * ap = (aris_proof *) data;
+
+  int full, ret;
+  list_t * tmp;
+
+  ap->live_source = 0;
+
+  // The evaluation still running is replaced, so its sentences
+  // join the new one.
+  full = ap->live_full;
+  ap->live_full = 0;
+
+  ret = aris_proof_live_merge (ap);
+  if (ret == AEC_MEM)
+    return FALSE;
+
+  if (!full && ap->live_pending->num_stuff == 0)
+    return FALSE;
+
+  ret = eval_worker_queue (ap, full ? NULL : ap->live_pending, 0);
+  ap->live_full = full;
+  if (ret == AEC_MEM)
+    return FALSE;
+
+  // Keep the sentences until the evaluation finishes, in case it
+  // is cancelled.
+  tmp = ap->live_running;
+  ap->live_running = ap->live_pending;
+  ap->live_pending = tmp;
+  ls_clear (ap->live_pending);
+
+  return FALSE;
+}
+
+/* Schedules an edited sentence to be re-evaluated, if live evaluation
+ * is enabled.  The sentences that reference it are re-evaluated as well.
+ *  input:
+ *    ap - the aris proof containing the sentence.
+ *    sen - the sentence that was edited.
+ *  output:
+ *    0 on success, -1 on memory error.
+ */
+int
+aris_proof_schedule_eval (aris_proof * ap, sentence * sen)
+{
+  item_t * d_itr;
+
+  if (!ap->live_eval)
+    return 0;
+
+  if (!ls_find (ap->live_pending, sen)
+      && !ls_push_obj (ap->live_pending, sen))
+    return AEC_MEM;
+
+  for (d_itr = sen->dependents->head; d_itr; d_itr = d_itr->next)
+    {
+      sentence * d_sen = d_itr->value;
+
+      if (ls_find (ap->live_pending, d_sen))
+        continue;
+
+      if (!ls_push_obj (ap->live_pending, d_sen))
+        return AEC_MEM;
+    }
+
+  // Restart the delay, so that evaluation waits for typing to pause.
+  if (ap->live_source)
+    g_source_remove (ap->live_source);
+
+  ap->live_source = g_timeout_add (LIVE_EVAL_DELAY,
+                                   aris_proof_live_eval_timeout, ap);
+
+  return 0;
+}
+
+/* Schedules the sentences of a cancelled live evaluation to be
+ * evaluated again, so that they aren't left with stale values.
+ *  input:
+ *    ap - the aris proof whose evaluation was cancelled.
+ *  output:
+ *    0 on success, -1 on memory error.
+ */
+int
+aris_proof_live_requeue (aris_proof * ap)
+{
+  int ret;
+
+  if (!ap->live_eval
+      || (!ap->live_full && ap->live_running->num_stuff == 0))
+    return 0;
+
+  ret = aris_proof_live_merge (ap);
+  if (ret == AEC_MEM)
+    return AEC_MEM;
+
+  if (!ap->live_source)
+    ap->live_source = g_timeout_add (LIVE_EVAL_DELAY,
+                                     aris_proof_live_eval_timeout, ap);
+
+  return 0;
+}
+
+/* Forgets the sentences of a live evaluation once it has finished.
+ *  input:
+ *    ap - the aris proof whose evaluation finished.
+ *  output:
+ *    none.
+ */
+void
+aris_proof_live_finished (aris_proof * ap)
+{
+  ls_clear (ap->live_running);
+  ap->live_full = 0;
+}
+
 /* Imports a proof into the current proof.
  *  input:
  *    ap - The current proof.
@@ -1340,10 +1861,18 @@ aris_proof_import_proof (aris_proof * ap)
   item_t * ev_itr, * pf_itr, * ev_conc = NULL;
   int ref_num = 0;
   short * refs;
+  list_t * added;
 
   refs = (short *) calloc (proof->everything->num_stuff, sizeof (int));
   CHECK_ALLOC (refs, AEC_MEM);
 
+  // The whole import is undone at once.
+  added = init_list ();
+  if (!added)
+    return AEC_MEM;
+
+  aris_proof_begin_batch (ap);
+
   for (pf_itr = proof->everything->head; pf_itr;
        pf_itr = pf_itr->next)
     {
@@ -1385,16 +1914,24 @@ aris_proof_import_proof (aris_proof * ap)
           sentence * sen_chk;
           int ln;
 
-          sen_chk = aris_proof_create_sentence (ap, sd, 1);
+          sen_chk = aris_proof_create_sentence (ap, sd, 0);
           if (!sen_chk)
             return AEC_MEM;
           ln = sentence_get_line_no (sen_chk);
           refs[ref_num++] = (short) ln;
+
+          if (!ls_push_obj (added, sentence_copy_to_data (sen_chk)))
+            return AEC_MEM;
         }
     }
 
   refs[ref_num] = REF_END;
 
+  // The lemmas follow the conclusions, so the premises must be numbered.
+  ret = aris_proof_end_batch (ap);
+  if (ret == AEC_MEM)
+    return AEC_MEM;
+
   if (!ev_conc)
     {
       for (ev_itr = SEN_PARENT(ap)->everything->head; ev_itr;
@@ -1412,6 +1949,8 @@ aris_proof_import_proof (aris_proof * ap)
         }
     }
 
+  aris_proof_begin_batch (ap);
+
   for (pf_itr = proof->goals->head; pf_itr; pf_itr = pf_itr->next)
     {
       unsigned char * pf_text;
@@ -1438,14 +1977,37 @@ aris_proof_import_proof (aris_proof * ap)
           if (!sd)
             return AEC_MEM;
 
-          sen_chk = aris_proof_create_sentence (ap, sd, 1);
+          sen_chk = aris_proof_create_sentence (ap, sd, 0);
           if (!sen_chk)
             return AEC_MEM;
+
+          if (!ls_push_obj (added, sentence_copy_to_data (sen_chk)))
+            return AEC_MEM;
         }
     }
 
+  ret = aris_proof_end_batch (ap);
+  if (ret == AEC_MEM)
+    return AEC_MEM;
+
   free (refs);
   proof_destroy (proof);
+
+  if (added->num_stuff == 0)
+    {
+      destroy_list (added);
+      return 0;
+    }
+
+  undo_info ui;
+  ui = undo_info_init (ap, added, UIT_ADD_SEN);
+  if (ui.type == -1)
+    return AEC_MEM;
+
+  ret = aris_proof_set_changed (ap, 1, ui);
+  if (ret < 0)
+    return AEC_MEM;
+
   return 0;
 }
 
@@ -1462,35 +2024,109 @@ aris_proof_undo_stack_push (aris_proof * ap, undo_info ui)
   if (ui.type == -1)
     return 1;
 
-  if (ui.type == UIT_MOD_TEXT
-      && ap->undo_stack->num_stuff > 0
-      && ap->undo_pt >= 0)
+  int rc;
+  while (ap->undo_stack->num_stuff > ap->undo_pt + 1)
+    rc = aris_proof_undo_stack_pop (ap);
+
+  // Quick edits to the same text are undone together.
+  if (ui.type == UIT_MOD_TEXT && ap->undo_pt >= 0)
     {
       undo_info * last;
+      size_t old_size;
+
       last = vec_nth (ap->undo_stack, ap->undo_pt);
-      if (last->type == UIT_MOD_TEXT)
+      old_size = last->size;
+
+      if (ui.stamp - last->stamp <= UNDO_INT)
         {
-          sen_data * lsd = (sen_data *) last->ls->head->value;
-          sen_data * usd = (sen_data *) ui.ls->head->value;
-          if (ui.stamp - last->stamp <= UNDO_INT
-              && lsd->line_num == usd->line_num)
+          rc = undo_info_merge (last, &ui);
+          if (rc == AEC_MEM)
+            return AEC_MEM;
+
+          if (rc == 0)
             {
-              last->stamp = ui.stamp;
+              ap->undo_size += last->size - old_size;
               undo_info_destroy (ui);
-              return 0;
+              return aris_proof_undo_stack_compact (ap);
             }
         }
     }
 
-  int rc;
-  while (ap->undo_stack->num_stuff > ap->undo_pt + 1)
-    rc = aris_proof_undo_stack_pop (ap);
-
   rc = vec_add_obj (ap->undo_stack, &ui);
   if (rc == AEC_MEM)
     return AEC_MEM;
 
   ap->undo_pt++;
+  ap->undo_size += ui.size;
+
+  return aris_proof_undo_stack_compact (ap);
+}
+
+/* Removes an object from an undo stack.
+ *  input:
+ *    ap - the aris proof that owns the undo stack.
+ *    n - the position of the object to remove.
+ *  output:
+ *    none.
+ */
+static void
+aris_proof_undo_stack_remove (aris_proof * ap, int n)
+{
+  vec_t * stack = ap->undo_stack;
+  undo_info * ui;
+
+  ui = vec_nth (stack, n);
+  ap->undo_size -= ui->size;
+  undo_info_destroy (*ui);
+
+  memmove (ui, ui + 1, (stack->num_stuff - n - 1) * sizeof (undo_info));
+  stack->num_stuff--;
+
+  if (ap->undo_pt >= n)
+    ap->undo_pt--;
+}
+
+/* Keeps the memory held by an undo stack within the limit.
+ *  The oldest text changes are merged together where they can be,
+ *  and the oldest actions are dropped otherwise.  The most recent
+ *  action is always kept.
+ *  input:
+ *    ap - the aris proof that owns the undo stack.
+ *  output:
+ *    0 on success, -1 on memory error.
+ */
+int
+aris_proof_undo_stack_compact (aris_proof * ap)
+{
+  size_t limit;
+  int rc;
+
+  limit = (size_t) ((the_app && the_app->undo_limit > 0)
+                    ? the_app->undo_limit : UNDO_LIMIT_DEFAULT) * 1024;
+
+  while (ap->undo_size > limit && ap->undo_pt > 0)
+    {
+      undo_info * first, * second;
+      size_t old_size;
+
+      first = vec_nth (ap->undo_stack, 0);
+      second = vec_nth (ap->undo_stack, 1);
+      old_size = first->size;
+
+      rc = undo_info_merge (first, second);
+      if (rc == AEC_MEM)
+        return AEC_MEM;
+
+      if (rc == 0)
+        {
+          ap->undo_size += first->size - old_size;
+          aris_proof_undo_stack_remove (ap, 1);
+        }
+      else
+        {
+          aris_proof_undo_stack_remove (ap, 0);
+        }
+    }
 
   return 0;
 }
@@ -1510,6 +2146,7 @@ aris_proof_undo_stack_pop (aris_proof * ap)
   undo_info * ui;
   ui = vec_nth (ap->undo_stack, ap->undo_stack->num_stuff - 1);
 
+  ap->undo_size -= ui->size;
   undo_info_destroy (*ui);
 
   vec_pop_obj (ap->undo_stack);
@@ -1551,6 +2188,10 @@ aris_proof_undo (aris_proof * ap, int undo)
 
   ap->undo_pt += (undo) ? -1 : 1;
 
+  eval_worker_cancel (ap);
+  if (aris_proof_live_requeue (ap) == AEC_MEM)
+    return AEC_MEM;
+
   if (!ui || ui->type == -1)
     return 1;
 
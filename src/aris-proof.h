@@ -47,8 +47,26 @@ struct aris_proof {
 
   vec_t * undo_stack;	// The stack of previous actions to undo.
   int undo_pt;		// The position within the undo stack.
+  size_t undo_size;	// The memory held by the undo stack.
+
+  eval_job * eval_job;	// The evaluation running in the background, if any.
+
+  int live_eval : 1;	// Whether edited lines are re-evaluated while typing.
+  list_t * live_pending;	// The sentences waiting to be re-evaluated.
+  list_t * live_running;	// The sentences of the live evaluation running.
+  int live_full;	// Whether every sentence awaits live evaluation.
+  guint live_source;	// The debounce timeout for live evaluation, or 0.
+
+  int batch;		// The nesting depth of structural edit batches.
+  int batch_dirty;	// Whether lines were added or removed in the batch.
+
+  goal_index * lines_index;	// The text and correctness of each line,
+				// for finding the goals.
 };
 
+// The delay after the last keystroke before live evaluation, in ms.
+#define LIVE_EVAL_DELAY 150
+
 aris_proof * aris_proof_init ();
 int aris_proof_post_init (aris_proof * ap);
 aris_proof * aris_proof_init_from_proof (proof_t * proof);
@@ -58,6 +76,10 @@ void aris_proof_create_menu (sen_parent * ap);
 
 int aris_proof_set_changed (aris_proof * ap, int changed, undo_info ui);
 int aris_proof_adjust_lines (aris_proof * ap, item_t * itm, int mod);
+void aris_proof_begin_batch (aris_proof * ap);
+int aris_proof_end_batch (aris_proof * ap);
+int aris_proof_index_line (aris_proof * ap, sentence * sen);
+int aris_proof_index_lines (aris_proof * ap);
 
 proof_t * aris_proof_to_proof (aris_proof * ap);
 
@@ -68,6 +90,7 @@ sentence * aris_proof_create_new_sub (aris_proof * ap);
 sentence * aris_proof_end_sub (aris_proof * ap);
 
 int aris_proof_remove_sentence (aris_proof * ap, sentence * sen);
+int aris_proof_remove_sentences (aris_proof * ap, list_t * sens);
 
 void aris_proof_set_font (aris_proof * ap, int font);
 void aris_proof_set_sb (aris_proof * ap, char * sb_text);
@@ -82,6 +105,10 @@ int aris_proof_select_sentence (aris_proof * ap, sentence * sen);
 int aris_proof_deselect_sentence (aris_proof * ap, sentence * sen);
 
 int aris_proof_toggle_boolean_mode (aris_proof * ap);
+int aris_proof_toggle_live_eval (aris_proof * ap);
+int aris_proof_schedule_eval (aris_proof * ap, sentence * sen);
+int aris_proof_live_requeue (aris_proof * ap);
+void aris_proof_live_finished (aris_proof * ap);
 
 int aris_proof_submit (aris_proof * ap, const char * hw,
 		       const char * user_email,
@@ -91,6 +118,7 @@ int aris_proof_import_proof (aris_proof * ap);
 
 int aris_proof_undo_stack_push (aris_proof * ap, undo_info ui);
 int aris_proof_undo_stack_pop (aris_proof * ap);
+int aris_proof_undo_stack_compact (aris_proof * ap);
 
 int aris_proof_undo (aris_proof * ap, int undo);
 
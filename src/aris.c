@@ -26,12 +26,16 @@
 #include "vec.h"
 #include "list.h"
 #include "var.h"
+#include "var-index.h"
 #include "sen-data.h"
 #include "proof.h"
 #include "aio.h"
 #include "rules.h"
 #include "config.h"
 #include "interop-isar.h"
+#include "archive.h"
+#include "goal-index.h"
+#include "sexpr-prenex.h"
 #include "menu.h"
 
 #ifdef ARIS_GUI
@@ -62,6 +66,7 @@ static struct option const long_opts[] =
     {"latex", required_argument, NULL, 'x'},
     {"version", no_argument, NULL, 0},
     {"help", no_argument, NULL, 'h'},
+    {"relaxed", no_argument, NULL, 'R'},
     {NULL, 0, NULL, 0}
   };
 
@@ -71,13 +76,15 @@ enum ARG_FLAGS {
   ARG_FLAG_VERBOSE = 1 << 0,
   ARG_FLAG_EVALUATE = 1 << 1,
   ARG_FLAG_BOOLEAN = 1 << 2,
-  ARG_FLAG_GRADE = 1 << 3
+  ARG_FLAG_GRADE = 1 << 3,
+  ARG_FLAG_RELAXED = 1 << 4
 };
 
 #define AF_VERBOSE(flags) (flags & 1)
 #define AF_EVALUATE(flags) ((flags >> 1) & 1)
 #define AF_BOOLEAN(flags) ((flags >> 2) & 1)
 #define AF_GRADE(flags) ((flags >> 3) & 1)
+#define AF_RELAXED(flags) ((flags >> 4) & 1)
 
 struct arg_items {
   char flags;
@@ -87,7 +94,7 @@ struct arg_items {
   vec_t * prems;
   char rule[3];
   char * rule_file;
-  vec_t * vars;
+  var_index * vars;
 };
 
 /* Lists the rules.
@@ -188,9 +195,12 @@ to designate it as arbitrary.\n");
   printf ("  -c, --conclusion=CONCLUSION    Set CONCLUSION as the conclusion.\n");
   printf ("  -e, --evaluate                 Run Aris in evaluation mode.\n");
   printf ("  -f, --file=FILE                Evaluate FILE.\n");
+  printf ("                                  FILE may be a zip or tar archive of proofs.\n");
   printf ("  -g, --grade                    Grade files specified in the file flag.\n");
   printf ("  -l, --list                     List the available rules.\n");
   printf ("  -p, --premise PREMISE          Use PREMISE as a premise.\n");
+  printf ("  -R, --relaxed                  Accept several quantifier moves\
+ on one Prenex or Null Quantifier line.\n");
   printf ("  -r, --rule RULE                Set RULE as the rule.\n");
   printf ("                                  Use 'lm:/path/to/file' to designate a file.\n");
   printf ("  -t, --text TEXT                Simply check the correctness of TEXT.\n");
@@ -292,42 +302,42 @@ grade_file (proof_t * c_file)
     }
 
   // Check the goals.
-  for (ev_itr = c_file->goals->head; ev_itr; ev_itr = ev_itr->next)
-    {
-      unsigned char * cur_goal;
+  goal_index * gi;
+  int ln;
+
+  gi = goal_index_init ();
+  if (!gi)
+    return -1;
 
-      cur_goal = die_spaces_die ((unsigned char *) ev_itr->value);
-      if (!cur_goal)
+  for (ev_itr = c_file->everything->head, i = 1; ev_itr; ev_itr = ev_itr->next, i++)
+    {
+      ret_chk = goal_index_set_line (gi, i, ((sen_data *) ev_itr->value)->text);
+      if (ret_chk == AEC_MEM)
         return -1;
+    }
 
-      item_t * sen_itr;
+  for (ev_itr = c_file->goals->head; ev_itr; ev_itr = ev_itr->next)
+    {
+      ln = goal_index_find (gi, (unsigned char *) ev_itr->value, NULL);
+      if (ln == AEC_MEM)
+        return -1;
 
-      for (sen_itr = c_file->everything->head; sen_itr; sen_itr = sen_itr->next)
+      if (ln == 0)
         {
-          unsigned char * cur_sen;
-          int cmp;
+          unsigned char * cur_goal;
 
-          cur_sen = die_spaces_die (((sen_data *) sen_itr->value)->text);
-          if (!cur_sen)
+          cur_goal = die_spaces_die ((unsigned char *) ev_itr->value);
+          if (!cur_goal)
             return -1;
 
-          cmp = !strcmp (cur_goal, cur_sen);
-          free (cur_sen);
-
-          if (cmp)
-            break;
-        }
-
-      if (!sen_itr)
-        {
           printf ("Goal '%s' was not met.\n", cur_goal);
           free (cur_goal);
           break;
         }
-
-      free (cur_goal);
     }
 
+  goal_index_destroy (gi);
+
   grade = (wrong) ? 0 : 1;
 
   if (wrong)
@@ -338,6 +348,74 @@ grade_file (proof_t * c_file)
   return grade;
 }
 
+/* Evaluates each proof in an archive.
+ *  input:
+ *    file_name - the name of the archive.
+ *    grade - whether or not to grade the proofs.
+ *    verbose - whether or not to print verbose output.
+ *  output:
+ *    0 on success, -1 on error.
+ */
+int
+evaluate_archive (const char * file_name, int grade, int verbose)
+{
+  archive_t * arc;
+  int i, num_entries, ret;
+
+  arc = archive_open (file_name);
+  if (!arc)
+    return -1;
+
+  num_entries = arc->entries->num_stuff;
+
+  // Lemmas are looked for in the archive before the file system.
+  aio_set_lemma_resolver (archive_open_lemma, arc);
+
+  for (i = 0; i < num_entries; i++)
+    {
+      archive_entry * entry;
+      proof_t * proof;
+      int n_len;
+
+      entry = vec_nth (arc->entries, i);
+      n_len = strlen (entry->name);
+      if (n_len < 4 || strcmp (entry->name + n_len - 4, ".tle"))
+        continue;
+
+      proof = archive_open_proof (arc, entry);
+      if (!proof)
+        {
+          fprintf (stderr, "Unable to open '%s' in '%s'.\n",
+                   entry->name, file_name);
+          continue;
+        }
+
+      if (grade)
+        {
+          printf ("Grading file: '%s:%s'\n", file_name, entry->name);
+          ret = grade_file (proof);
+          printf ("\n");
+        }
+      else
+        {
+          if (verbose)
+            printf ("Evaluating file: '%s:%s'\n", file_name, entry->name);
+          ret = proof_eval (proof, NULL, verbose);
+        }
+
+      proof_destroy (proof);
+      free (proof);
+
+      if (ret == -1)
+        break;
+    }
+
+  aio_set_lemma_resolver (NULL, NULL);
+  archive_destroy (arc);
+
+  return (i == num_entries) ? 0 : -1;
+}
+
 /* Parses the supplied arguments.
  *  input:
  *   argc, argv - should be self-explanatory.
@@ -364,7 +442,7 @@ parse_args (int argc, char * argv[], struct arg_items * ai)
     }
 
   ai->prems = init_vec (sizeof (char*));
-  ai->vars = init_vec (sizeof (variable));
+  ai->vars = var_index_init ();
   memset ((char *) ai->rule, 0, sizeof (char) * 3);
 
   //Only one conclusion and one rule can exist.
@@ -377,7 +455,7 @@ parse_args (int argc, char * argv[], struct arg_items * ai)
     {
       int opt_idx = 0;
 
-      c = getopt_long (argc, argv, "ep:c:r:t:a:f:gi:s:x:lbvh",
+      c = getopt_long (argc, argv, "ep:c:r:t:a:f:gi:s:x:lbvhR",
                        long_opts, &opt_idx);
 
       if (c == -1)
@@ -524,23 +602,15 @@ character of a variable must be lowercase, ignoring variable \"%s\".\n", optarg)
                   break;
                 }
 
-              variable v;
+              int arbitrary;
               opt_len = strlen (optarg);
 
-              v.text = (unsigned char *) calloc (opt_len, sizeof (char));
-              strcpy (v.text, optarg);
+              arbitrary = (optarg[opt_len - 1] == '*');
+              if (arbitrary)
+                opt_len--;
 
-              if (v.text[opt_len - 1] == '*')
-                {
-                  v.arbitrary = 1;
-                  v.text[opt_len - 1] = '\0';
-                }
-              else
-                {
-                  v.arbitrary = 0;
-                }
-
-              vec_add_obj (ai->vars, &v);
+              var_index_add (ai->vars, (unsigned char *) optarg, opt_len,
+                             arbitrary, 0);
             }
           else
             {
@@ -616,6 +686,10 @@ requires a filename, ignoring flag.\n");
           ai->flags |= ARG_FLAG_BOOLEAN;
           break;
 
+        case 'R':
+          ai->flags |= ARG_FLAG_RELAXED;
+          break;
+
         case 'l':
           list_rules ();
           break;
@@ -684,7 +758,7 @@ main (int argc, char *argv[])
   vec_t * prems;
   unsigned char * conc = NULL;
   char * rule;
-  vec_t * vars;
+  var_index * vars;
   char ** file_name, ** latex_name;
   proof_t ** proof;
   int cur_file, cur_latex, grade;
@@ -704,6 +778,7 @@ main (int argc, char *argv[])
   file_name = (char **) args.file_name;
   latex_name = (char **) args.latex_name;
   grade = AF_GRADE (args.flags);
+  prenex_relaxed = AF_RELAXED (args.flags);
   rule = args.rule;
   rule_file = args.rule_file;
 
@@ -771,6 +846,18 @@ a conclusion must be specified in evaluation mode.\n");
 
       for (c = 0; c < cur_file; c++)
         {
+          // Archives are opened entry by entry when they are evaluated.
+          if (archive_is_archive (file_name[c]))
+            {
+              if (!evaluate_mode)
+                {
+                  fprintf (stderr, "Argument Error - \
+archives can only be opened in evaluation mode.\n");
+                  exit (EXIT_FAILURE);
+                }
+              continue;
+            }
+
           proof[c] = aio_open (file_name[c]);
           if (!proof[c])
             exit (EXIT_FAILURE);
@@ -788,6 +875,14 @@ a conclusion must be specified in evaluation mode.\n");
               int g;
               for (c = 0; c < cur_file; c++)
                 {
+                  if (!proof[c])
+                    {
+                      g = evaluate_archive (file_name[c], 1, verbose);
+                      if (g == -1)
+                        exit (EXIT_FAILURE);
+                      continue;
+                    }
+
                   if (verbose)
                     printf ("Grading file: '%s'\n", file_name[c]);
                   g = grade_file (proof[c]);
@@ -802,7 +897,10 @@ a conclusion must be specified in evaluation mode.\n");
           for (c = 0; c < cur_file; c++)
             {
               int ret_chk;
-              ret_chk = proof_eval (proof[c], NULL, verbose);
+              if (proof[c])
+                ret_chk = proof_eval (proof[c], NULL, verbose);
+              else
+                ret_chk = evaluate_archive (file_name[c], 0, verbose);
               if (ret_chk == -1)
                 exit (EXIT_FAILURE);
             }
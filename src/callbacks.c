@@ -38,6 +38,7 @@
 #include "sentence-screen-keyboard.h"
 #include "config.h"
 #include "vec.h"
+#include "eval-worker.h"
 #include "var.h"
 #include "interop-isar.h"
 #include "proof.h"
@@ -216,6 +217,16 @@ sentence_key_press (GtkWidget * widget, GdkEventKey * event, gpointer data)
   return FALSE;
 }
 
+/* Realizes the sentences that have scrolled into view.
+ *  input:
+ *    data - the sentence parent that was scrolled.
+ */
+G_MODULE_EXPORT void
+container_scrolled (GtkAdjustment * adj, gpointer data)
+{
+  sen_parent_queue_realize ((sen_parent *) data);
+}
+
 /* Calls sentence_text_changed (sentence.h) on a sentence specified by data.
  *  input:
  *    data - the sentence being changed.
@@ -717,79 +728,36 @@ gui_save (aris_proof * ap, int save_as)
 }
 
 /* Evaluates a sentence.
+ *  The evaluation runs in the background, and the result is
+ *  displayed once it finishes.
  *  input:
  *    ap - the aris proof containing the sentence being evaluated.
  *    sen - the sentence being evaluated.
  *  output:
- *    0 on success, -1 on memory error, non-zero on generic error.
+ *    0 on success, -1 on memory error.
  */
 int
 evaluate_line (aris_proof * ap, sentence * sen)
 {
-  item_t * ev_itr, * ret_chk;
+  list_t * targets;
   int ret;
-  list_t * lines, * vars;
 
-  lines = init_list ();
-  if (!lines)
+  targets = init_list ();
+  if (!targets)
     return AEC_MEM;
 
-  vars = init_list ();
-  if (!vars)
+  if (!ls_push_obj (targets, sen))
     return AEC_MEM;
 
-  int sen_ln;
-  sen_ln = sentence_get_line_no (sen);
-
-  for (ev_itr = SEN_PARENT (ap)->everything->head; 1;
-       ev_itr = ev_itr->next)
-    {
-      sentence * ev_sen = ev_itr->value;
-      int conv_check = 0;
-      int ln = sentence_get_line_no (ev_sen);
-      if (ln == sen_ln)
-        break;
-
-      conv_check = sd_convert_sexpr (SD(ev_sen));
-      if (conv_check == AEC_MEM)
-        return AEC_MEM;
-
-      ret = sentence_can_select_as_ref (sen, ev_sen);
-      if (ret == ln && conv_check == 0)
-        {
-          int rule = sentence_get_rule (ev_sen);
-          // This means that the variables apply to the current line.
-          int prem = SEN_PREM(ev_sen), sub = SEN_SUB(ev_sen);
-          int arb = (prem || sub
-                     || rule == RULE_EI
-                     || rule == RULE_SQ)
-            ? 0 : 1;
-          ret = sexpr_collect_vars_to_proof (vars, SD(ev_sen)->sexpr, arb);
-          if (ret == AEC_MEM)
-            return AEC_MEM;
-        }
-
-      ret_chk = ls_push_obj (lines, SD(ev_sen));
-      if (!ret_chk)
-        return AEC_MEM;
-    }
-
-  sentence_refresh_refs (sen);
-
-  char * ret_str;
-  ret_str = sen_data_evaluate (SD(sen), &ret, vars, lines);
-  if (!ret_str)
-    return AEC_MEM;
-
-  sentence_set_value (sen, ret);
-  aris_proof_set_sb (ap, ret_str);
-
-  destroy_list (lines);
+  ret = eval_worker_queue (ap, targets, 0);
+  destroy_list (targets);
 
   return ret;
 }
 
-/* Evaluates an aris proof.
+/* Evaluates an aris proof, then checks its goals.
+ *  The evaluation runs in the background, and the results are
+ *  displayed once it finishes.
  *  input:
  *    ap - the aris proof to evaluate.
  *  output:
@@ -798,29 +766,7 @@ evaluate_line (aris_proof * ap, sentence * sen)
 int
 evaluate_proof (aris_proof * ap)
 {
-  item_t * ev_itr;
-  sentence * sen;
-  int ret;
-
-  for (ev_itr = SEN_PARENT (ap)->everything->head; ev_itr; ev_itr = ev_itr->next)
-    {
-      sen = ev_itr->value;
-      ret = evaluate_line (ap, sen);
-      if (ret == AEC_MEM)
-        return AEC_MEM;
-    }
-
-  /*
-  ret = eval_proof (SEN_PARENT(ap)->everything, NULL, 0);
-  if (ret == -1)
-    return -1;
-  */
-
-  ret = goal_check_all (ap->goal);
-  if (ret == AEC_MEM)
-    return AEC_MEM;
-
-  return 0;
+  return eval_worker_queue (ap, NULL, 1);
 }
 
 /* Toggles the goal window.
@@ -1567,6 +1513,10 @@ menu_activated (aris_proof * ap, int menu_id)
       ret = evaluate_proof (ap);
       break;
 
+    case CONF_MENU_LIVE_EVAL:
+      ret = aris_proof_toggle_live_eval (ap);
+      break;
+
     case CONF_MENU_GOAL:
       gui_goal_check (ap);
       break;
@@ -49,6 +49,8 @@ G_MODULE_EXPORT gboolean window_focus_in (GtkWidget * widget,
 G_MODULE_EXPORT gboolean sen_parent_btn_press (GtkWidget * widget,
 					       GdkEventButton * event,
 					       gpointer data);
+G_MODULE_EXPORT void container_scrolled (GtkAdjustment * adj,
+					 gpointer data);
 
 
 G_MODULE_EXPORT gboolean sentence_focus_in (GtkWidget * widget,
@@ -226,6 +226,26 @@ conf_file_read (const unsigned char * buffer, aris_app * app)
 	  continue;
 	}
 
+      if (!strcmp (cur_conf_key, "undo-limit"))
+	{
+	  free (cur_conf_key);
+
+	  // Should be in the form (undo-limit kilobytes)
+
+	  int limit;
+
+	  ret_chk = sscanf (cur_conf, "(undo-limit %i)", &limit);
+	  if (ret_chk != 1)
+	    ret_chk = sscanf (cur_conf, "(undo-limit \'%i\')", &limit);
+	  free (cur_conf);
+
+	  if (ret_chk == 1 && limit > 0)
+	    app->undo_limit = limit;
+
+	  pos = tmp_pos + 2;
+	  continue;
+	}
+
       if (!strcmp (cur_conf_key, "color-pref"))
 	{
 	  free (cur_conf_key);
@@ -54,6 +54,7 @@ enum CONF_MENU_ID {
   CONF_MENU_INSERT,
   CONF_MENU_EVAL_LINE,
   CONF_MENU_EVAL_PROOF,
+  CONF_MENU_LIVE_EVAL,
   CONF_MENU_GOAL,
   CONF_MENU_BOOLEAN,
   CONF_MENU_IMPORT,
@@ -173,6 +174,10 @@ static conf_obj main_menu_conf[NUM_CONF_MENUS] = {
    CONF_OBJ_MENU, CONF_MENU_EVAL_PROOF, conf_menu_value,
    "edit-select-all", "c+f"},
 
+  {N_("Toggle Live Evaluation"),
+   N_("Re-evaluate edited lines while typing in the current proof."),
+   NULL, CONF_OBJ_MENU, CONF_MENU_LIVE_EVAL, conf_menu_value, NULL, NULL},
+
   {N_("Toggle Goals..."),
    N_("Check/Modify the current goal(s) for the current proof."),
    NULL, CONF_OBJ_MENU, CONF_MENU_GOAL, conf_menu_value, NULL, "c+l"},
@@ -326,7 +331,7 @@ enum MENU_ORDER {
 enum MENU_SIZE {
   FILE_MENU_SIZE = 10,
   EDIT_MENU_SIZE = 11,
-  PROOF_MENU_SIZE = 6,
+  PROOF_MENU_SIZE = 7,
   RULES_MENU_SIZE = 2,
   FONT_MENU_SIZE = 4,
   HELP_MENU_SIZE = 2
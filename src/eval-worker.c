@@ -0,0 +1,397 @@
+/*  Functions for evaluating proofs in the background.
+
+   Copyright (C) 2026 The GNU Aris contributors.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "eval-worker.h"
+#include "aris-proof.h"
+#include "goal.h"
+#include "goal-index.h"
+#include "list.h"
+#include "vec.h"
+#include "var.h"
+#include "var-index.h"
+#include "rules.h"
+#include "process.h"
+#include "sexpr-process.h"
+#include "sen-data.h"
+#include "sen-parent.h"
+#include "sentence.h"
+
+// The engine keeps global state (the connectives, the lemma resolver,
+// the theory cache), so only one job evaluates at a time, on a single
+// worker thread that is kept between jobs.
+static GMutex eval_lock;
+static GThreadPool * eval_pool = NULL;
+
+/* Determines whether the variables of a sentence are arbitrary.
+ *  input:
+ *    sd - the sentence data whose variables are being collected.
+ *  output:
+ *    1 if the variables are arbitrary, 0 otherwise.
+ */
+static int
+sd_vars_arbitrary (sen_data * sd)
+{
+  return (sd->premise || sd->subproof
+          || sd->rule == RULE_EI
+          || sd->rule == RULE_SQ)
+    ? 0 : 1;
+}
+
+/* Destroys an evaluation job and its snapshot.
+ *  input:
+ *    job - the job to destroy.
+ *  output:
+ *    none.
+ */
+static void
+eval_job_destroy (eval_job * job)
+{
+  item_t * itm;
+
+  if (job->lines)
+    {
+      for (itm = job->lines->head; itm; itm = itm->next)
+        sen_data_destroy (itm->value);
+      destroy_list (job->lines);
+    }
+
+  free (job->targets);
+  free (job->values);
+  free (job->messages);
+  free (job);
+}
+
+/* Evaluates the snapshot of a job in a single forward pass.
+ *  Only the target lines are evaluated, but every line up to the last
+ *  target contributes its variables to the lines after it.
+ *  input:
+ *    job - the job to evaluate.
+ *  output:
+ *    0 on success, 1 if the job was cancelled, -1 on memory error.
+ */
+static int
+eval_job_evaluate (eval_job * job)
+{
+  item_t * ev_itr, * ret_chk;
+  list_t * prev;
+  var_index * vars;
+  int k, ret, last_target, cancelled;
+
+  last_target = -1;
+  for (k = 0; k < job->num_lines; k++)
+    {
+      if (job->targets[k])
+        last_target = k;
+    }
+
+  prev = init_list ();
+  if (!prev)
+    return AEC_MEM;
+
+  vars = var_index_init ();
+  if (!vars)
+    return AEC_MEM;
+
+  cancelled = 0;
+  for (ev_itr = job->lines->head, k = 0; ev_itr && k <= last_target;
+       ev_itr = ev_itr->next, k++)
+    {
+      sen_data * sd = ev_itr->value;
+      int conv_check;
+
+      if (g_atomic_int_get (&job->cancelled))
+        {
+          cancelled = 1;
+          break;
+        }
+
+      // Drop the variables of the subproofs that this line is not in.
+      ret = var_index_enter (vars, sd->depth, sd->subproof);
+      if (ret == AEC_MEM)
+        return AEC_MEM;
+
+      conv_check = sd_convert_sexpr (sd);
+      if (conv_check == AEC_MEM)
+        return AEC_MEM;
+
+      if (job->targets[k])
+        {
+          const char * ret_str;
+          ret_str = sen_data_evaluate (sd, &(job->values[k]), vars, prev);
+          if (!ret_str)
+            return AEC_MEM;
+
+          job->messages[k] = ret_str;
+          job->last = k;
+        }
+
+      if (conv_check == 0)
+        {
+          ret = sexpr_collect_vars_to_proof (vars, sd->sexpr,
+                                             sd_vars_arbitrary (sd), k + 1);
+          if (ret == AEC_MEM)
+            return AEC_MEM;
+        }
+
+      ret_chk = ls_push_obj (prev, sd);
+      if (!ret_chk)
+        return AEC_MEM;
+    }
+
+  var_index_destroy (vars);
+  destroy_list (prev);
+
+  return cancelled;
+}
+
+/* Applies the results of a job to its proof - runs in the main loop.
+ *  input:
+ *    data - the finished job.
+ *  output:
+ *    FALSE, so that the source is removed.
+ */
+static gboolean
+eval_job_finish (gpointer data)
+{
+  eval_job * job = (eval_job *) data;
+  aris_proof * ap = job->ap;
+  item_t * ev_itr, * sd_itr;
+  int k;
+
+  // A cancelled job's snapshot no longer matches the proof.
+  if (!ap || ap->eval_job != job)
+    {
+      eval_job_destroy (job);
+      return FALSE;
+    }
+
+  ap->eval_job = NULL;
+  aris_proof_live_finished (ap);
+
+  if (job->status == AEC_MEM)
+    {
+      aris_proof_set_sb (ap, _("There was a memory error during evaluation."));
+      eval_job_destroy (job);
+      return FALSE;
+    }
+
+  for (ev_itr = SEN_PARENT (ap)->everything->head, sd_itr = job->lines->head,
+         k = 0;
+       ev_itr && sd_itr; ev_itr = ev_itr->next, sd_itr = sd_itr->next, k++)
+    {
+      sentence * sen = ev_itr->value;
+      sen_data * sd = sd_itr->value;
+
+      if (job->targets[k])
+        sentence_set_value (sen, job->values[k]);
+
+      // Keep the conversion, since the text hasn't changed.
+      if (!SD(sen)->sexpr && sd->sexpr)
+        {
+          SD(sen)->sexpr = sd->sexpr;
+          sd->sexpr = NULL;
+        }
+    }
+
+  if (job->last >= 0)
+    aris_proof_set_sb (ap, (char *) job->messages[job->last]);
+
+  // The index of the proof has followed the new values, so each goal is
+  // a single lookup.
+  if (job->check_goals)
+    {
+      for (ev_itr = SEN_PARENT (ap->goal)->everything->head; ev_itr;
+           ev_itr = ev_itr->next)
+        {
+          sentence * goal_sen = ev_itr->value;
+          int ln, is_valid;
+
+          ln = goal_index_find (ap->lines_index, sentence_get_text (goal_sen),
+                                &is_valid);
+          if (ln == AEC_MEM)
+            break;
+
+          goal_apply_line (ap->goal, goal_sen, ln, is_valid);
+        }
+    }
+
+  eval_job_destroy (job);
+  return FALSE;
+}
+
+/* Evaluates a job on the worker thread.
+ *  input:
+ *    data - the job to evaluate.
+ *    user_data - unused.
+ *  output:
+ *    none.
+ */
+static void
+eval_worker_run (gpointer data, gpointer user_data)
+{
+  eval_job * job = (eval_job *) data;
+
+  // A job cancelled while it was queued has nothing to do.
+  g_mutex_lock (&eval_lock);
+  job->status = g_atomic_int_get (&job->cancelled)
+    ? 1 : eval_job_evaluate (job);
+  g_mutex_unlock (&eval_lock);
+
+  g_idle_add (eval_job_finish, job);
+}
+
+/* Creates a job from a snapshot of a proof.
+ *  input:
+ *    ap - the proof to snapshot.
+ *    targets - the sentences to evaluate, or NULL for every sentence.
+ *    check_goals - whether to check the goals after evaluating.
+ *  output:
+ *    the new job, or NULL on memory error.
+ */
+static eval_job *
+eval_job_init (aris_proof * ap, list_t * targets, int check_goals)
+{
+  eval_job * job;
+  item_t * ev_itr;
+  int k, last_target;
+
+  job = (eval_job *) calloc (1, sizeof (eval_job));
+  CHECK_ALLOC (job, NULL);
+
+  job->ap = ap;
+  job->last = -1;
+  job->check_goals = check_goals;
+
+  // The lines after the last target have no effect on it, so they aren't
+  // copied.
+  last_target = SEN_PARENT (ap)->everything->num_stuff - 1;
+  if (targets)
+    {
+      last_target = -1;
+      for (ev_itr = SEN_PARENT (ap)->everything->head, k = 0; ev_itr;
+           ev_itr = ev_itr->next, k++)
+        {
+          if (ls_find (targets, ev_itr->value))
+            last_target = k;
+        }
+    }
+
+  job->num_lines = last_target + 1;
+
+  job->lines = init_list ();
+  job->targets = (char *) calloc (job->num_lines + 1, sizeof (char));
+  job->values = (int *) calloc (job->num_lines + 1, sizeof (int));
+  job->messages = (const char **) calloc (job->num_lines + 1, sizeof (char *));
+  if (!job->lines || !job->targets || !job->values || !job->messages)
+    {
+      eval_job_destroy (job);
+      return NULL;
+    }
+
+  for (ev_itr = SEN_PARENT (ap)->everything->head, k = 0;
+       ev_itr && k < job->num_lines; ev_itr = ev_itr->next, k++)
+    {
+      sentence * sen = ev_itr->value;
+      sen_data * sd;
+      int ret;
+
+      job->targets[k] = (!targets || ls_find (targets, sen)) ? 1 : 0;
+      job->values[k] = sen->value_type;
+
+      if (job->targets[k])
+        {
+          ret = sentence_refresh_refs (sen);
+          if (ret == AEC_MEM)
+            {
+              eval_job_destroy (job);
+              return NULL;
+            }
+        }
+
+      sd = (sen_data *) calloc (1, sizeof (sen_data));
+      if (!sd || sen_data_copy (SD(sen), sd) == AEC_MEM
+          || !ls_push_obj (job->lines, sd))
+        {
+          eval_job_destroy (job);
+          return NULL;
+        }
+    }
+
+  return job;
+}
+
+/* Starts evaluating a proof on a worker thread.
+ *  Any evaluation of the proof that is still running is cancelled.
+ *  input:
+ *    ap - the proof to evaluate.
+ *    targets - the sentences to evaluate, or NULL for every sentence.
+ *    check_goals - whether to check the goals after evaluating.
+ *  output:
+ *    0 on success, -1 on memory error.
+ */
+int
+eval_worker_queue (aris_proof * ap, list_t * targets, int check_goals)
+{
+  eval_job * job;
+
+  eval_worker_cancel (ap);
+
+  // A full evaluation covers the lines of a live one, but others don't.
+  if (targets && aris_proof_live_requeue (ap) == AEC_MEM)
+    return AEC_MEM;
+
+  if (!eval_pool)
+    {
+      eval_pool = g_thread_pool_new (eval_worker_run, NULL, 1, FALSE, NULL);
+      if (!eval_pool)
+        return AEC_MEM;
+    }
+
+  job = eval_job_init (ap, targets, check_goals);
+  if (!job)
+    return AEC_MEM;
+
+  ap->eval_job = job;
+  aris_proof_set_sb (ap, _("Evaluating..."));
+
+  g_thread_pool_push (eval_pool, job, NULL);
+
+  return 0;
+}
+
+/* Cancels the background evaluation of a proof, if there is one.
+ *  The worker stops at the next line, and its results are discarded.
+ *  input:
+ *    ap - the proof whose evaluation to cancel.
+ *  output:
+ *    none.
+ */
+void
+eval_worker_cancel (aris_proof * ap)
+{
+  eval_job * job = ap->eval_job;
+
+  if (!job)
+    return;
+
+  g_atomic_int_set (&job->cancelled, 1);
+  job->ap = NULL;
+  ap->eval_job = NULL;
+}
@@ -0,0 +1,47 @@
+/*  Functions for evaluating proofs in the background.
+
+   Copyright (C) 2026 The GNU Aris contributors.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ARIS_EVAL_WORKER_H
+#define ARIS_EVAL_WORKER_H
+
+#include <gtk/gtk.h>
+#include "typedef.h"
+
+// An evaluation of a snapshot of a proof, run on a worker thread.
+// Only the worker touches the snapshot until the job is finished;
+// ap is only touched from the main loop.
+
+struct eval_job {
+  aris_proof * ap;        // The proof being evaluated, or NULL once cancelled.
+  gint cancelled;         // Set when the proof changes during evaluation.
+  int status;             // The return value of the evaluation.
+
+  list_t * lines;         // Copies of the sentence data of the proof.
+  int num_lines;          // The number of lines.
+  char * targets;         // Whether each line is to be evaluated.
+  int * values;           // The value type of each line.
+  const char ** messages; // The status message of each evaluated line.
+  int last;               // The last line evaluated, or -1.
+
+  int check_goals;        // Whether the goals are checked once it finishes.
+};
+
+int eval_worker_queue (aris_proof * ap, list_t * targets, int check_goals);
+void eval_worker_cancel (aris_proof * ap);
+
+#endif  /*  ARIS_EVAL_WORKER_H  */
@@ -0,0 +1,435 @@
+/* Functions for matching goals against the lines of a proof.
+
+   Copyright (C) 2026 The GNU Aris contributors.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "goal-index.h"
+#include "process.h"
+
+#define GOAL_INDEX_MIN_BUCKETS 16
+
+/* Hashes a formatted string.
+ *  input:
+ *    str - the string to hash.
+ *  output:
+ *    the FNV-1a hash of str.
+ */
+static unsigned int
+goal_index_hash (unsigned char * str)
+{
+    unsigned int hash = 2166136261u;
+
+    for (; *str; str++)
+    {
+        hash ^= *str;
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+/* Initializes a goal index.
+ *  input:
+ *    none.
+ *  output:
+ *    the new goal index, or NULL on memory error.
+ */
+goal_index *
+goal_index_init ()
+{
+    goal_index * gi;
+
+    gi = (goal_index *) calloc (1, sizeof (goal_index));
+    CHECK_ALLOC (gi, NULL);
+
+    gi->num_buckets = GOAL_INDEX_MIN_BUCKETS;
+    gi->buckets = (int *) calloc (gi->num_buckets, sizeof (int));
+    CHECK_ALLOC (gi->buckets, NULL);
+
+    return gi;
+}
+
+/* Destroys a goal index.
+ *  input:
+ *    gi - the goal index to destroy.
+ *  output:
+ *    none.
+ */
+void
+goal_index_destroy (goal_index * gi)
+{
+    int i;
+
+    for (i = 0; i < gi->num_lines; i++)
+    {
+        if (gi->keys[i])
+            free (gi->keys[i]);
+    }
+
+    if (gi->keys)
+        free (gi->keys);
+    if (gi->hashes)
+        free (gi->hashes);
+    if (gi->next)
+        free (gi->next);
+    if (gi->valid)
+        free (gi->valid);
+    free (gi->buckets);
+    free (gi);
+}
+
+/* Links a line into the bucket for its hash.
+ *  input:
+ *    gi - the goal index.
+ *    ln - the line to link.
+ *  output:
+ *    none.
+ */
+static void
+goal_index_link (goal_index * gi, int ln)
+{
+    int b = gi->hashes[ln - 1] & (gi->num_buckets - 1);
+
+    gi->next[ln - 1] = gi->buckets[b];
+    gi->buckets[b] = ln;
+}
+
+/* Unlinks a line from the bucket for its hash.
+ *  input:
+ *    gi - the goal index.
+ *    ln - the line to unlink.
+ *  output:
+ *    none.
+ */
+static void
+goal_index_unlink (goal_index * gi, int ln)
+{
+    int b = gi->hashes[ln - 1] & (gi->num_buckets - 1);
+    int * cur;
+
+    for (cur = &gi->buckets[b]; *cur; cur = &gi->next[*cur - 1])
+    {
+        if (*cur == ln)
+        {
+            *cur = gi->next[ln - 1];
+            break;
+        }
+    }
+
+    gi->next[ln - 1] = 0;
+}
+
+/* Relinks every line of a goal index into its bucket.
+ *  input:
+ *    gi - the goal index.
+ *  output:
+ *    none.
+ */
+static void
+goal_index_relink (goal_index * gi)
+{
+    int i;
+
+    memset (gi->buckets, 0, gi->num_buckets * sizeof (int));
+
+    for (i = 1; i <= gi->num_lines; i++)
+    {
+        gi->next[i - 1] = 0;
+        if (gi->keys[i - 1])
+            goal_index_link (gi, i);
+    }
+}
+
+/* Makes room for a line in a goal index.
+ *  input:
+ *    gi - the goal index.
+ *    ln - the line that must fit.
+ *  output:
+ *    0 on success, -1 on memory error.
+ */
+static int
+goal_index_grow (goal_index * gi, int ln)
+{
+    int i;
+
+    if (ln > gi->alloc_lines)
+    {
+        int new_alloc = (gi->alloc_lines > 0) ? gi->alloc_lines : 16;
+
+        while (new_alloc < ln)
+            new_alloc *= 2;
+
+        gi->keys = (unsigned char **) realloc (gi->keys, new_alloc * sizeof (char *));
+        CHECK_ALLOC (gi->keys, AEC_MEM);
+        gi->hashes = (unsigned int *) realloc (gi->hashes, new_alloc * sizeof (int));
+        CHECK_ALLOC (gi->hashes, AEC_MEM);
+        gi->next = (int *) realloc (gi->next, new_alloc * sizeof (int));
+        CHECK_ALLOC (gi->next, AEC_MEM);
+        gi->valid = (char *) realloc (gi->valid, new_alloc * sizeof (char));
+        CHECK_ALLOC (gi->valid, AEC_MEM);
+
+        gi->alloc_lines = new_alloc;
+    }
+
+    for (i = gi->num_lines; i < ln; i++)
+    {
+        gi->keys[i] = NULL;
+        gi->hashes[i] = 0;
+        gi->next[i] = 0;
+        gi->valid[i] = 1;
+    }
+
+    if (ln > gi->num_lines)
+        gi->num_lines = ln;
+
+    // Keep the chains short by keeping at least one bucket per line.
+    if (gi->num_lines > gi->num_buckets)
+    {
+        int new_buckets = gi->num_buckets;
+
+        while (new_buckets < gi->num_lines)
+            new_buckets *= 2;
+
+        free (gi->buckets);
+        gi->buckets = (int *) calloc (new_buckets, sizeof (int));
+        CHECK_ALLOC (gi->buckets, AEC_MEM);
+        gi->num_buckets = new_buckets;
+
+        goal_index_relink (gi);
+    }
+
+    return 0;
+}
+
+/* Sets the text of a line in a goal index.
+ *  Only this line is re-indexed, so a changed line costs one lookup.
+ *  input:
+ *    gi - the goal index.
+ *    ln - the line to set.
+ *    text - the text of the line, or NULL to clear the line.
+ *  output:
+ *    0 on success, -1 on memory error.
+ */
+int
+goal_index_set_line (goal_index * gi, int ln, unsigned char * text)
+{
+    unsigned char * key = NULL;
+    int ret;
+
+    if (ln < 1)
+        return 0;
+
+    if (text)
+    {
+        key = format_string (text);
+        if (!key)
+            return AEC_MEM;
+    }
+
+    ret = goal_index_grow (gi, ln);
+    if (ret == AEC_MEM)
+        return AEC_MEM;
+
+    if (gi->keys[ln - 1])
+    {
+        if (key && !strcmp ((char *) key, (char *) gi->keys[ln - 1]))
+        {
+            free (key);
+            return 0;
+        }
+
+        goal_index_unlink (gi, ln);
+        free (gi->keys[ln - 1]);
+    }
+
+    gi->keys[ln - 1] = key;
+    if (key)
+    {
+        gi->hashes[ln - 1] = goal_index_hash (key);
+        goal_index_link (gi, ln);
+    }
+
+    return 0;
+}
+
+/* Inserts a line into a goal index, moving the lines after it down.
+ *  input:
+ *    gi - the goal index.
+ *    ln - the number of the new line.
+ *    text - the text of the new line, or NULL.
+ *    valid - whether the new line is correct.
+ *  output:
+ *    0 on success, -1 on memory error.
+ */
+int
+goal_index_insert_line (goal_index * gi, int ln, unsigned char * text,
+                        int valid)
+{
+    int n, ret;
+
+    if (ln < 1)
+        return 0;
+
+    if (ln > gi->num_lines)
+    {
+        ret = goal_index_set_line (gi, ln, text);
+        if (ret == AEC_MEM)
+            return AEC_MEM;
+        goal_index_set_valid (gi, ln, valid);
+        return 0;
+    }
+
+    n = gi->num_lines - ln + 1;
+    ret = goal_index_grow (gi, gi->num_lines + 1);
+    if (ret == AEC_MEM)
+        return AEC_MEM;
+
+    memmove (gi->keys + ln, gi->keys + ln - 1, n * sizeof (char *));
+    memmove (gi->hashes + ln, gi->hashes + ln - 1, n * sizeof (int));
+    memmove (gi->valid + ln, gi->valid + ln - 1, n * sizeof (char));
+
+    gi->keys[ln - 1] = NULL;
+    gi->valid[ln - 1] = 1;
+    goal_index_relink (gi);
+    gi->first_bad = -1;
+
+    ret = goal_index_set_line (gi, ln, text);
+    if (ret == AEC_MEM)
+        return AEC_MEM;
+    goal_index_set_valid (gi, ln, valid);
+
+    return 0;
+}
+
+/* Removes a line from a goal index, moving the lines after it up.
+ *  input:
+ *    gi - the goal index.
+ *    ln - the line to remove.
+ *  output:
+ *    none.
+ */
+void
+goal_index_remove_line (goal_index * gi, int ln)
+{
+    int n;
+
+    if (ln < 1 || ln > gi->num_lines)
+        return;
+
+    if (gi->keys[ln - 1])
+        free (gi->keys[ln - 1]);
+
+    n = gi->num_lines - ln;
+    memmove (gi->keys + ln - 1, gi->keys + ln, n * sizeof (char *));
+    memmove (gi->hashes + ln - 1, gi->hashes + ln, n * sizeof (int));
+    memmove (gi->valid + ln - 1, gi->valid + ln, n * sizeof (char));
+
+    gi->num_lines--;
+    goal_index_relink (gi);
+    gi->first_bad = -1;
+}
+
+/* Sets whether a line of a goal index is correct.
+ *  input:
+ *    gi - the goal index.
+ *    ln - the line.
+ *    valid - whether the line is correct.
+ *  output:
+ *    none.
+ */
+void
+goal_index_set_valid (goal_index * gi, int ln, int valid)
+{
+    if (ln < 1 || goal_index_grow (gi, ln) == AEC_MEM)
+        return;
+
+    valid = valid ? 1 : 0;
+    if (gi->valid[ln - 1] == valid)
+        return;
+
+    gi->valid[ln - 1] = valid;
+
+    if (!valid && gi->first_bad >= 0 && (gi->first_bad == 0 || ln < gi->first_bad))
+        gi->first_bad = ln;
+    else if (valid && ln == gi->first_bad)
+        gi->first_bad = -1;
+}
+
+/* Finds the line at which a goal is met.
+ *  input:
+ *    gi - the goal index of the proof.
+ *    text - the text of the goal.
+ *    is_valid - receives whether the lines up to and including the goal
+ *               are correct.
+ *  output:
+ *    the first line at which the goal is met, 0 if it is not met,
+ *    or -1 on memory error.
+ */
+int
+goal_index_find (goal_index * gi, unsigned char * text, int * is_valid)
+{
+    unsigned char * key;
+    unsigned int hash;
+    int cur, ln = 0;
+
+    key = format_string (text);
+    if (!key)
+        return AEC_MEM;
+
+    hash = goal_index_hash (key);
+
+    for (cur = gi->buckets[hash & (gi->num_buckets - 1)]; cur;
+         cur = gi->next[cur - 1])
+    {
+        if (gi->hashes[cur - 1] != hash
+            || strcmp ((char *) gi->keys[cur - 1], (char *) key))
+            continue;
+
+        if (ln == 0 || cur < ln)
+            ln = cur;
+    }
+
+    free (key);
+
+    if (gi->first_bad < 0)
+    {
+        int i;
+
+        gi->first_bad = 0;
+        for (i = 0; i < gi->num_lines; i++)
+        {
+            if (!gi->valid[i])
+            {
+                gi->first_bad = i + 1;
+                break;
+            }
+        }
+    }
+
+    if (is_valid)
+    {
+        if (ln > 0)
+            *is_valid = (gi->first_bad == 0 || gi->first_bad > ln);
+        else
+            *is_valid = (gi->first_bad == 0);
+    }
+
+    return ln;
+}
@@ -0,0 +1,56 @@
+/* Functions for matching goals against the lines of a proof.
+
+   Copyright (C) 2026 The GNU Aris contributors.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GOAL_INDEX_H
+#define GOAL_INDEX_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include "typedef.h"
+
+// A hash table from the formatted text of each line of a proof to its
+// line number, so that each goal is found with a single lookup.
+// Lines are numbered from 1, as in the proof.
+
+struct goal_index {
+    int num_lines;          // The number of lines indexed.
+    int alloc_lines;        // The number of lines allocated.
+    unsigned char ** keys;  // The formatted text of each line.
+    unsigned int * hashes;  // The hash of each key.
+    int * next;             // The next line in the same bucket, or 0.
+    char * valid;           // Whether each line is correct.
+    int first_bad;          // The first incorrect line, 0 if none, -1 if unknown.
+
+    int num_buckets;        // The number of buckets, a power of two.
+    int * buckets;          // The first line in each bucket, or 0.
+};
+
+goal_index * goal_index_init ();
+void goal_index_destroy (goal_index * gi);
+int goal_index_set_line (goal_index * gi, int ln, unsigned char * text);
+int goal_index_insert_line (goal_index * gi, int ln, unsigned char * text,
+                            int valid);
+void goal_index_remove_line (goal_index * gi, int ln);
+void goal_index_set_valid (goal_index * gi, int ln, int valid);
+int goal_index_find (goal_index * gi, unsigned char * text, int * is_valid);
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GOAL_INDEX_H
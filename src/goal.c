@@ -20,6 +20,7 @@
 #include <string.h>
 
 #include "goal.h"
+#include "goal-index.h"
 #include "list.h"
 #include "sentence.h"
 #include "aris-proof.h"
@@ -30,6 +31,7 @@
 #include "callbacks.h"
 #include "process.h"
 #include "conf-file.h"
+#include "eval-worker.h"
 
 /* Initializes a goal structure.
  *  input:
@@ -156,6 +158,68 @@ goal_gui_create_menu (sen_parent * goal)
   gtk_menu_shell_append (GTK_MENU_SHELL (goal->menubar), goal_menu);
 }
 
+/* Displays whether a goal line has been met.
+ *  input:
+ *    goal - the goal containing the sentence.
+ *    sen - the goal sentence.
+ *    ln - the line at which the goal was met, or 0 if it was not met.
+ *    is_valid - whether the lines leading up to the goal are correct.
+ *  output:
+ *    0 on success, -1 on error.
+ */
+int
+goal_apply_line (goal_t * goal, sentence * sen, int ln, int is_valid)
+{
+  if (ln <= 0)
+    {
+      sentence_set_met_at (sen, NULL);
+      sentence_set_value (sen, VALUE_TYPE_FALSE);
+      sen_parent_set_sb ((sen_parent *) goal, "This goal has not been met.");
+      return 0;
+    }
+
+  item_t * ev_itr;
+  sentence * ev_sen;
+
+  ev_itr = ls_nth (SEN_PARENT (goal->parent)->everything, ln - 1);
+  if (!ev_itr)
+    return 0;
+  ev_sen = ev_itr->value;
+
+  sentence_update_line_no (sen, ln);
+  if (sentence_set_met_at (sen, ev_sen) == AEC_MEM)
+    return AEC_MEM;
+
+  if (is_valid)
+    {
+      if (SEN_REALIZED (ev_sen))
+	gtk_widget_override_background_color (ev_sen->eventbox, GTK_STATE_NORMAL,
+				  the_app->bg_colors[BG_COLOR_GOOD]);
+      sentence_set_value (sen, VALUE_TYPE_TRUE);
+    }
+  else
+    {
+      if (SEN_REALIZED (ev_sen))
+	gtk_widget_override_background_color (ev_sen->eventbox, GTK_STATE_NORMAL,
+				  the_app->bg_colors[BG_COLOR_BAD]);
+      sentence_set_value (sen, VALUE_TYPE_REF);
+    }
+
+  char * sb_text = (char *) calloc (30, sizeof (char *));
+  CHECK_ALLOC (sb_text, AEC_MEM);
+  int offset = 0;
+  offset += sprintf (sb_text, "The goal was met at line %i", ln);
+  if (!is_valid)
+    {
+      offset += sprintf (sb_text + offset,
+			 ", however there are errors leading up to it.");
+    }
+  sen_parent_set_sb ((sen_parent *) goal, sb_text);
+  free (sb_text);
+
+  return 0;
+}
+
 /* Checks a line in the goal.
  *  input:
  *    goal - the goal containing the sentence to be checked.
@@ -179,83 +243,20 @@ goal_check_line (goal_t * goal, sentence * sen)
   if (ret_check < 0)
     return AEC_MEM;
 
-  item_t * ev_itr;
-  int is_valid = 1;
-
-  for (ev_itr = SEN_PARENT (goal->parent)->everything->head; ev_itr != NULL;
-       ev_itr = ev_itr->next)
-    {
-      sentence * ev_sen = ev_itr->value;
-      unsigned char * ev_cmp_text = format_string (sentence_get_text (ev_sen));
-      if (!ev_cmp_text)
-	return AEC_MEM;
-
-      if (!strcmp (ev_cmp_text, cmp_text))
-	{
-	  if (SEN_PREM(ev_sen) || SEN_SUB(ev_sen))
-	    {
-	      if (ev_sen->value_type == VALUE_TYPE_ERROR)
-		is_valid = 0;
-	    }
-	  else if (ev_sen->value_type != VALUE_TYPE_TRUE)
-	    is_valid = 0;
-
-	  int ln;
-	  ln = sentence_get_line_no (ev_sen);
-	  sentence_update_line_no (sen, ln);
-
-	  if (is_valid)
-	    {
-	      gtk_widget_override_background_color (ev_sen->eventbox, GTK_STATE_NORMAL,
-				    the_app->bg_colors[BG_COLOR_GOOD]);
-	      sentence_set_value (sen, VALUE_TYPE_TRUE);
-	    }
-	  else
-	    {
-	      gtk_widget_override_background_color (ev_sen->eventbox, GTK_STATE_NORMAL,
-				    the_app->bg_colors[BG_COLOR_BAD]);
-	      sentence_set_value (sen, VALUE_TYPE_REF);
-	    }
-
-	  char * sb_text = (char *) calloc (30, sizeof (char *));
-	  CHECK_ALLOC (sb_text, AEC_MEM);
-	  int offset = 0;
-	  offset += sprintf (sb_text, "The goal was met at line %i", ln);
-	  if (!is_valid)
-	    {
-	      offset += sprintf (sb_text + offset,
-				 ", however there are errors leading up to it.");
-	    }
-	  sen_parent_set_sb ((sen_parent *) goal, sb_text);
-	  free (sb_text);
-	  free (ev_cmp_text);
-	  free (cmp_text);
-	  return 0;
-	}
-      else
-	{
-	  if (SEN_PREM(ev_sen) || SEN_SUB(ev_sen))
-	    {
-	      if (ev_sen->value_type == VALUE_TYPE_ERROR)
-		is_valid = 0;
-	    }
-	  else if (ev_sen->value_type != VALUE_TYPE_TRUE)
-	    {
-	      is_valid = 0;
-	    }
-	}
-
-      free (ev_cmp_text);
-    }
+  int ln, is_valid;
 
+  ln = goal_index_find (goal->parent->lines_index, cmp_text, &is_valid);
   free (cmp_text);
 
-  sentence_set_value (sen, VALUE_TYPE_FALSE);
-  sen_parent_set_sb ((sen_parent *) goal, "This goal has not been met.");
-  return 0;
+  if (ln == AEC_MEM)
+    return AEC_MEM;
+
+  return goal_apply_line (goal, sen, ln, is_valid);
 }
 
 /* Checks all of the sentences in a goal.
+ *  The check runs in the background against the current values of
+ *  the proof's sentences.
  *  input:
  *    goal - the goal for which all of the sentences are being checked.
  *  output:
@@ -264,18 +265,17 @@ goal_check_line (goal_t * goal, sentence * sen)
 int
 goal_check_all (goal_t * goal)
 {
-  item_t * gl_itr;
+  list_t * no_lines;
   int ret_check;
 
-  for (gl_itr = SEN_PARENT (goal)->everything->head;
-       gl_itr != NULL; gl_itr = gl_itr->next)
-    {
-      ret_check = goal_check_line (goal, gl_itr->value);
-      if (ret_check == AEC_MEM)
-	return AEC_MEM;
-    }
+  no_lines = init_list ();
+  if (!no_lines)
+    return AEC_MEM;
 
-  return 0;
+  ret_check = eval_worker_queue (goal->parent, no_lines, 1);
+  destroy_list (no_lines);
+
+  return ret_check;
 }
 
 /* Adds a line to a goal.
@@ -323,17 +323,12 @@ goal_add_line (goal_t * goal, sen_data * sd)
 int
 goal_rem_line (goal_t * goal)
 {
-  int ret, line_num;
+  int ret;
+  sentence * met_at;
 
-  line_num = sentence_get_line_no (SEN_PARENT (goal)->focused->value);
-  if (line_num > 0)
-    {
-      sentence * sen;
-      item_t * itm;
-      itm = ls_nth (SEN_PARENT (goal->parent)->everything, line_num - 1);
-      sen = (sentence *) itm->value;
-      gtk_widget_override_background_color (sen->eventbox, GTK_STATE_NORMAL, NULL);
-    }
+  met_at = SENTENCE (SEN_PARENT (goal)->focused->value)->met_at;
+  if (met_at && SEN_REALIZED (met_at))
+    gtk_widget_override_background_color (met_at->eventbox, GTK_STATE_NORMAL, NULL);
 
   undo_info ui = { 0 };
   ui.type = -1;
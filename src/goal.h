@@ -37,6 +37,7 @@ goal_t * goal_init (aris_proof * ag);
 goal_t * goal_init_from_list (aris_proof * ap, list_t * goals);
 void goal_destroy (goal_t * goal);
 void goal_gui_create_menu (sen_parent * goal);
+int goal_apply_line (goal_t * goal, sentence * sen, int ln, int is_valid);
 int goal_check_line (goal_t * goal, sentence * sen);
 int goal_check_all (goal_t * goal);
 int goal_add_line (goal_t * goal, sen_data * sd);
@@ -2,6 +2,14 @@
 #include <string.h>
 #include <stdio.h>
 #include <math.h>
+#include <ctype.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifndef WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
 //#include <gtk/gtk.h>
 
 #include "../src/vec.h"
@@ -23,14 +31,19 @@ static const char * greek_syms[] = {
     "\\<Psi>", "\\<Omega>", NULL
 };
 
-static char * latin_regexp = "[a-zA-Z]";
-static char * digit_regexp = "[0-9]";
-static char * sym_regexp = "[!#$%&*+-/<=>?@^_|~]";
-static char * string_regexp = "\"[^\"]\"";
-static char * astring_regexp = "\'[^\']\'";
-static char * letter_regexp, * greek_regexp, * nat_regexp,
-    * ql_regexp, * float_regexp, * ident_regexp, * lident_regexp,
-    * symident_regexp, * var_regexp;
+// Character classes of the Isar lexical syntax.
+enum ISAR_CHAR_CLASSES {
+    ICC_LATIN = 1 << 0,
+    ICC_DIGIT = 1 << 1,
+    ICC_SYM = 1 << 2,
+    ICC_SPACE = 1 << 3
+};
+
+static const char * sym_chars = "!#$%&*+-/<=>?@^_|~";
+
+// The character class table, filled in by isar_prep_regexps.
+static unsigned char isar_char_class[256];
+static int isar_classes_ready = 0;
 
 #define ISABELLE_PATH "define-me"
 #define ISABELLE_EXEC "define-me"
@@ -99,67 +112,55 @@ isar_run_cmds (unsigned char ** inputs, unsigned char ** output)
 }
 
 
+/* Prepares the character classes used by the Isar lexer.
+ *  The classes are built once per process;
+ *  subsequent calls return immediately.
+ *  output:
+ *    0 on success.
+ */
 int
 isar_prep_regexps ()
 {
-    /*
-  int l_len, d_len, s_len, lt_len, gr_len, nat_len, ql_len,
-    var_len;
-
-  int tf_len, tv_len;
-  char * tf_regexp, * tv_regexp;
-
-  l_len = 8, d_len = 5, s_len = 20;
-
-  nat_regexp = (char *) calloc (d_len + 2, sizeof (char));
-  CHECK_ALLOC (nat_regexp, -1);
-  nat_len = sprintf (nat_regexp, "%s+", digit_regexp);
-
-  letter_regexp = (char *) calloc (l_len * 4 + gr_len + 32,
-                   sizeof (char));
-  CHECK_ALLOC (letter_regexp, -1);
-  lt_len = sprintf (letter_regexp,
-            "%s|\\\\<%s>|\\\\<%s%s>|%s|\\\\<^isub>|\\\\<^isup>",
-            latin_regexp, latin_regexp, latin_regexp,
-            latin_regexp, greek_regexp);
-
-  sprintf (float_regexp, "%s.%s|-%s.%s",
-       nat_regexp, nat_regexp,
-       nat_regexp, nat_regexp);
-
-  sprintf (ql_regexp, "%s|%s|_|'",
-       letter_regexp, digit_regexp);
-
-  sprintf (ident_regexp, "%s%s*", letter_regexp,
-       ql_regexp);
+    int i;
 
-  sprintf (lident_regexp, "%s(.%s)+", ident_regexp, ident_regexp);
+    if (isar_classes_ready)
+        return 0;
 
-  sprintf (symident_regexp, "%s+ | \\\\<%s>",
-       sym_regexp,
-       ident_regexp);
+    for (i = 0; i < 256; i++)
+    {
+        unsigned char cls = 0;
 
-  var_len = sprintf (var_regexp, "?%s|?%s.%s", ident_regexp,
-             ident_regexp, nat_regexp);
+        if ((i >= 'a' && i <= 'z') || (i >= 'A' && i <= 'Z'))
+            cls |= ICC_LATIN;
+        if (i >= '0' && i <= '9')
+            cls |= ICC_DIGIT;
+        if (i == ' ' || i == '\t' || i == '\n' || i == '\r' || i == '\f')
+            cls |= ICC_SPACE;
 
-  tf_len = sprintf (tf_regexp, "'%s", ident_regexp);
+        isar_char_class[i] = cls;
+    }
 
-  tv_len = sprintf (tv_regexp, "?%s|?%s.%s", tf_regexp, tf_regexp, nat_regexp);
-  */
+    for (i = 0; sym_chars[i]; i++)
+        isar_char_class[(unsigned char) sym_chars[i]] |= ICC_SYM;
 
+    isar_classes_ready = 1;
     return 0;
 }
 
 int
 is_latin (char * input)
 {
-    return isalpha (*input);
+    return (isar_char_class[(unsigned char) *input] & ICC_LATIN);
 }
 
 int
 is_greek (char * input)
 {
     int i;
+
+    if (input[0] != '\\' || input[1] != '<')
+        return 0;
+
     for (i = 0; greek_syms[i]; i++)
     {
         if (!strcmp (input, greek_syms[i]))
@@ -172,13 +173,13 @@ is_greek (char * input)
 int
 is_sym (char * input)
 {
-    return ispunct (*input);
+    return (isar_char_class[(unsigned char) *input] & ICC_SYM);
 }
 
 int
 is_digit (char * input)
 {
-    return isdigit (*input);
+    return (isar_char_class[(unsigned char) *input] & ICC_DIGIT);
 }
 
 int
@@ -676,9 +677,18 @@ get_std_seqs ()
     int chk;
     in_type seq_n, seq_s;
 
-    seqs = init_vec (sizeof (in_type));
-    if (!seqs)
-        return -1;
+    // Sequences added by a previous theory don't carry over.
+    if (seqs)
+    {
+        if (vec_clear (seqs) < 0)
+            return -1;
+    }
+    else
+    {
+        seqs = init_vec (sizeof (in_type));
+        if (!seqs)
+            return -1;
+    }
 
     seq_n.type = "nat";
     seq_n.seq = "n";
@@ -2053,222 +2063,715 @@ isar_to_aris (char * isar)
     return aris;
 }
 
-int
-parse_thy (char * filename, proof_t * proof)
+/* Skips a nested construct, such as a comment or verbatim text.
+ *  input:
+ *    buffer - the theory buffer.
+ *    size - the size of buffer.
+ *    pos - the position of the opening delimiter.
+ *    open - the opening delimiter.
+ *    close - the closing delimiter.
+ *  output:
+ *    the position after the matching closing delimiter, or -1 if unterminated.
+ */
+static int
+isar_skip_nested (const char * buffer, int size, int pos,
+                  const char * open, const char * close)
 {
-    FILE * file;
+    int o_len, c_len, depth;
 
-    file = fopen (filename, "r");
-    CHECK_ALLOC (file, -1);
+    o_len = strlen (open);
+    c_len = strlen (close);
+    depth = 1;
+    pos += o_len;
 
-    int chk;
-    long file_size;
-    chk = fseek (file, 0, SEEK_END);
-    if (chk)
+    while (pos < size)
     {
-        fclose (file);
-        PERROR (NULL);
-        return -1;
+        if (pos + c_len <= size && !strncmp (buffer + pos, close, c_len))
+        {
+            pos += c_len;
+            depth--;
+            if (depth == 0)
+                return pos;
+            continue;
+        }
+
+        if (pos + o_len <= size && !strncmp (buffer + pos, open, o_len))
+        {
+            pos += o_len;
+            depth++;
+            continue;
+        }
+
+        pos++;
     }
 
-    file_size = ftell (file);
+    return -1;
+}
 
-    chk = fseek (file, 0, SEEK_SET);
-    if (chk)
+/* Skips a quoted string, honoring backslash escapes.
+ *  input:
+ *    buffer - the theory buffer.
+ *    size - the size of buffer.
+ *    pos - the position of the opening quote.
+ *  output:
+ *    the position after the closing quote, or -1 if unterminated.
+ */
+static int
+isar_skip_string (const char * buffer, int size, int pos)
+{
+    char quote = buffer[pos];
+
+    for (pos++; pos < size; pos++)
     {
-        fclose (file);
-        PERROR (NULL);
-        return -1;
+        if (buffer[pos] == '\\' && pos + 1 < size)
+        {
+            // Symbols such as \<forall> begin with a backslash,
+            // but only an escaped quote may hide the terminator.
+            if (buffer[pos + 1] == quote || buffer[pos + 1] == '\\')
+                pos++;
+            continue;
+        }
+
+        if (buffer[pos] == quote)
+            return pos + 1;
     }
 
-    char * buffer;
+    return -1;
+}
+
+/* Tokenizes a theory buffer in a single pass.
+ *  Comments and whitespace are dropped; everything else is recorded.
+ *  input:
+ *    buffer - the theory buffer, which need not be nul-terminated.
+ *    size - the size of buffer.
+ *    tokens - the vector of isar_token to fill.
+ *  output:
+ *    0 on success, -1 on memory error, -2 on a lexical error.
+ */
+int
+isar_lex (const char * buffer, int size, vec_t * tokens)
+{
+    int pos, col0;
 
-    buffer = (char *) calloc (file_size, sizeof (char));
-    CHECK_ALLOC (buffer, -1);
+    isar_prep_regexps ();
 
-    fread (buffer, 1, file_size, file);
-    fclose (file);
-    // Read in the file buffer to buffer.
+    pos = 0;
+    col0 = 1;
 
-    // Determine the main start of the file.
-    char * ret_chk_str;
-    ret_chk_str = strstr (buffer, "theory");
-    if (!ret_chk_str)
+    while (pos < size)
     {
-        // Invalid .thy file, return an error.
-        free (buffer);
-        return -2;
+        unsigned char c = (unsigned char) buffer[pos];
+        isar_token tok;
+        int end;
+
+        if (isar_char_class[c] & ICC_SPACE)
+        {
+            col0 = (c == '\n');
+            pos++;
+            continue;
+        }
+
+        if (c == '(' && pos + 1 < size && buffer[pos + 1] == '*')
+        {
+            end = isar_skip_nested (buffer, size, pos, "(*", "*)");
+            if (end == -1)
+                return -2;
+            pos = end;
+            col0 = 0;
+            continue;
+        }
+
+        tok.start = pos;
+        tok.col0 = col0;
+        col0 = 0;
+
+        if (c == '{' && pos + 1 < size && buffer[pos + 1] == '*')
+        {
+            tok.type = ISAR_TOK_VERBATIM;
+            end = isar_skip_nested (buffer, size, pos, "{*", "*}");
+        }
+        else if (c == '\"' || c == '`')
+        {
+            tok.type = ISAR_TOK_STRING;
+            end = isar_skip_string (buffer, size, pos);
+        }
+        else if (pos + 7 <= size && !strncmp (buffer + pos, "\\<open>", 7))
+        {
+            tok.type = ISAR_TOK_CARTOUCHE;
+            end = isar_skip_nested (buffer, size, pos, "\\<open>", "\\<close>");
+        }
+        else if (isar_char_class[c] & ICC_LATIN)
+        {
+            // ident, or longident when joined by dots.
+            tok.type = ISAR_TOK_IDENT;
+            end = pos + 1;
+            while (end < size)
+            {
+                unsigned char n = (unsigned char) buffer[end];
+                if ((isar_char_class[n] & (ICC_LATIN | ICC_DIGIT))
+                    || n == '_' || n == '\'')
+                {
+                    end++;
+                }
+                else if (n == '.' && end + 1 < size
+                         && (isar_char_class[(unsigned char) buffer[end + 1]]
+                             & ICC_LATIN))
+                {
+                    end++;
+                }
+                else if (n == '\\' && end + 2 < size && buffer[end + 1] == '<'
+                         && buffer[end + 2] == '^')
+                {
+                    // Sub- and superscripts, such as \<^sub>.
+                    while (end < size && buffer[end] != '>')
+                        end++;
+                    end++;
+                }
+                else
+                {
+                    break;
+                }
+            }
+        }
+        else if (isar_char_class[c] & ICC_DIGIT)
+        {
+            tok.type = ISAR_TOK_NAT;
+            end = pos + 1;
+            while (end < size && (isar_char_class[(unsigned char) buffer[end]]
+                                  & ICC_DIGIT))
+                end++;
+        }
+        else if (c == '\\' && pos + 1 < size && buffer[pos + 1] == '<')
+        {
+            // A symbol, such as \<forall> or \<alpha>.
+            tok.type = ISAR_TOK_SYM;
+            end = pos + 2;
+            while (end < size && buffer[end] != '>' && buffer[end] != '\n')
+                end++;
+            end++;
+        }
+        else if (isar_char_class[c] & ICC_SYM)
+        {
+            tok.type = ISAR_TOK_SYM;
+            end = pos + 1;
+            while (end < size && (isar_char_class[(unsigned char) buffer[end]]
+                                  & ICC_SYM))
+                end++;
+        }
+        else
+        {
+            tok.type = ISAR_TOK_OTHER;
+            end = pos + 1;
+        }
+
+        if (end == -1 || end > size)
+            return -2;
+
+        tok.len = end - pos;
+        if (vec_add_obj (tokens, &tok) < 0)
+            return -1;
+
+        pos = end;
     }
 
-    item_t * ls_chk;
+    return 0;
+}
+
+// Outer syntax keywords that begin a new command when at the start of a line.
+static const char * isar_commands[] = {
+    "end",
+    "datatype",
+    "section",
+    "chapter",
+    "header",
+    "corollary",
+    "function",
+    "abbreviation",
+    "axiomatization",
+    "consts",
+    "lemmas",
+    "declare",
+    "notation",
+    "termination",
+    NULL
+};
+
+static int
+isar_tok_is (const char * buffer, isar_token * tok, const char * key)
+{
+    int k_len = strlen (key);
+    return (tok->len == k_len && !strncmp (buffer + tok->start, key, k_len));
+}
+
+static int
+isar_tok_is_command (const char * buffer, isar_token * tok)
+{
     int i;
 
+    if (tok->type != ISAR_TOK_IDENT || !tok->col0)
+        return 0;
+
+    for (i = 0; i < KF_NUM_FUNCS; i++)
+    {
+        if (isar_tok_is (buffer, tok, kfs[i].key))
+            return 1;
+    }
+
+    for (i = 0; null_keys[i]; i++)
+    {
+        if (isar_tok_is (buffer, tok, null_keys[i]))
+            return 1;
+    }
+
+    for (i = 0; isar_commands[i]; i++)
+    {
+        if (isar_tok_is (buffer, tok, isar_commands[i]))
+            return 1;
+    }
+
+    return 0;
+}
+
+/* Translates a single command of a theory.
+ *  input:
+ *    cmd - the text of the command, beginning with its keyword.
+ *    key - the keyword of the command.
+ *    refs - the vector of translated definitions.
+ *    lms - the vector of translated lemmas.
+ *  output:
+ *    0 on success, -1 on memory error.
+ */
+static int
+isar_translate_command (char * cmd, char * key, vec_t * refs, vec_t * lms)
+{
+    char * tmp_str = NULL;
+    int i, pos, chk;
+
     //TODO: Check declarations (datatypes, functions, etc.)
     //TODO: Create a seqlog sequence (n for nats, etc.) for each one.
-    //IDEA: Thinking t0, t1, (type 0, etc.) and store each in a map-like structure.
-    //      Makes it easier to determine the input from functions.
-    //NOTE: Datatypes are declared by constructor functions.
-    //NOTE: ALL functions are recursive.
 
-    vec_t * refs, * lms;
+    for (i = 0; i < KF_NUM_FUNCS; i++)
+    {
+        if (!strcmp (key, kfs[i].key))
+        {
+            pos = kfs[i].func (cmd, &tmp_str);
+            if (pos == -1)
+                return -1;
+            break;
+        }
+    }
 
-    char * buf_pos = ret_chk_str;
-    //TODO: Parse the imports.
-    // Will need to keep track of which files have already been parsed.
-    // A chart of predefined files and their imports is shown here:
-    //http://isabelle.in.tum.de/dist/library/HOL/large.html
-    //EDIT: Only check the imports for definitions.
-    //DO NOT REQUIRE THE USER TO CREATE LINES FOR ALL OF THEM,
-    //or at least not for everything in Main.
-    //That would be INSANE.
-    // Isar itself has some nice functionality to check the specific requirements
-    //  of a given lemma.
+    // Might need to parse brackets in the event of 'text', 'section', etc.
 
-    chk = get_std_seqs ();
-    if (chk == -1)
+    for (i = 0; null_keys[i]; i++)
     {
-        free (buffer);
-        return -1;
+        if (!strcmp (key, null_keys[i]))
+        {
+            pos = isar_parse_null (cmd);
+            if (pos == -1)
+                return -1;
+            break;
+        }
     }
 
-    refs = init_vec (sizeof (char *));
-    if (!refs)
+    if (!null_keys[i])
     {
-        free (buffer);
-        return -1;
+        if (!strcmp (key, "datatype"))
+        {
+            pos = isar_parse_datatype (cmd, refs);
+            if (pos == -1)
+                return -1;
+        }
+        else if (tmp_str && (!strcmp (key, "lemma") || !strcmp (key, "theorem")))
+        {
+            char * mod_str, * tmp_mod_str;
+            tmp_mod_str = die_spaces_die (tmp_str);
+            if (!tmp_mod_str)
+                return -1;
+
+            chk = parse_connectives (tmp_mod_str, 0, &mod_str);
+            if (chk == -1)
+                return -1;
+            free (tmp_mod_str);
+
+            printf ("lemma = '%s'\n", mod_str);
+            chk = vec_str_add_obj (lms, mod_str);
+            if (chk < 0)
+                return -1;
+            free (mod_str);
+        }
+        else if (tmp_str)
+        {
+            chk = vec_str_add_obj (refs, tmp_str);
+            if (chk < 0)
+                return -1;
+        }
     }
 
-    lms = init_vec (sizeof (char *));
-    if (!lms)
+    if (tmp_str)
+        free (tmp_str);
+
+    return 0;
+}
+
+/* Reads a theory file into memory, mapping it where possible.
+ *  input:
+ *    filename - the name of the theory file.
+ *    size - receives the size of the file.
+ *  output:
+ *    the contents of the file, or NULL on error.
+ */
+static char *
+isar_map_file (const char * filename, int * size)
+{
+    char * buffer;
+
+#ifndef WIN32
+    int fd;
+    struct stat st;
+
+    fd = open (filename, O_RDONLY);
+    if (fd == -1)
     {
-        free (buffer);
-        destroy_vec (refs);
-        return -1;
+        PERROR (NULL);
+        return NULL;
     }
 
-    // After this, buf_pos will point to the position of 'begin'.
-    buf_pos = strstr (buffer, "begin");
+    if (fstat (fd, &st) == -1 || st.st_size == 0)
+    {
+        close (fd);
+        return NULL;
+    }
 
-    if (strncmp (buf_pos, "begin", 5))
+    buffer = mmap (NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close (fd);
+    if (buffer == MAP_FAILED)
     {
-        // Error stuff.
-        free (buffer);
-        destroy_vec (refs);
-        destroy_vec (lms);
-        return -2;
+        PERROR (NULL);
+        return NULL;
     }
 
-    buf_pos += 5;
+    *size = (int) st.st_size;
+#else
+    FILE * file;
+    long file_size;
+
+    file = fopen (filename, "rb");
+    if (!file)
+    {
+        PERROR (NULL);
+        return NULL;
+    }
 
-    while (isspace (*buf_pos))
-        buf_pos++;
+    fseek (file, 0, SEEK_END);
+    file_size = ftell (file);
+    fseek (file, 0, SEEK_SET);
 
-    while (1)
+    buffer = (char *) calloc (file_size + 1, sizeof (char));
+    if (!buffer)
     {
-        char * tmp_str, * cur_key;
-        // Determine how to handle the current keyword.
+        fclose (file);
+        PERROR (NULL);
+        return NULL;
+    }
 
-        int pos = 0;
-        while (isalnum (buf_pos[pos]) || buf_pos[pos] == '_')
-            pos++;
+    *size = (int) fread (buffer, 1, file_size, file);
+    fclose (file);
+#endif
 
-        cur_key = (char *) calloc (pos + 1, sizeof (char));
-        CHECK_ALLOC (cur_key, -1);
-        strncpy (cur_key, buf_pos, pos);
-        cur_key[pos] = '\0';
+    return buffer;
+}
+
+static void
+isar_unmap_file (char * buffer, int size)
+{
+#ifndef WIN32
+    munmap (buffer, size);
+#else
+    free (buffer);
+#endif
+}
 
-        // Determine the keyword.
+// A theory file that has already been translated.
 
-        if (!strcmp (cur_key, "end"))
+struct isar_theory {
+    char * file_name;   // The name of the theory file.
+    time_t mtime;       // The modification time when it was translated.
+    off_t size;         // The size when it was translated.
+    vec_t * refs;       // The translated definitions.
+    vec_t * lms;        // The translated lemmas.
+};
+
+// Theories translated so far, so repeated lemma references don't re-import.
+static vec_t * thy_cache = NULL;
+
+/* Translates a theory file into definitions and lemmas.
+ *  input:
+ *    filename - the name of the theory file.
+ *    refs - receives the translated definitions.
+ *    lms - receives the translated lemmas.
+ *  output:
+ *    0 on success, -1 on memory error, -2 on an invalid theory.
+ */
+static int
+isar_translate_thy (char * filename, vec_t * refs, vec_t * lms)
+{
+    char * buffer;
+    int size, chk, i, begin;
+    vec_t * tokens;
+
+    buffer = isar_map_file (filename, &size);
+    if (!buffer)
+        return -1;
+
+    tokens = init_vec (sizeof (isar_token));
+    if (!tokens)
+    {
+        isar_unmap_file (buffer, size);
+        return -1;
+    }
+
+    chk = isar_lex (buffer, size, tokens);
+    if (chk < 0)
+    {
+        isar_unmap_file (buffer, size);
+        destroy_vec (tokens);
+        return chk;
+    }
+
+    // The commands begin after 'theory' name 'imports' name+ 'begin'.
+    //TODO: Parse the imports.
+    // Will need to keep track of which files have already been parsed.
+    // A chart of predefined files and their imports is shown here:
+    //http://isabelle.in.tum.de/dist/library/HOL/large.html
+    //EDIT: Only check the imports for definitions.
+    //DO NOT REQUIRE THE USER TO CREATE LINES FOR ALL OF THEM,
+    //or at least not for everything in Main.
+
+    begin = -1;
+    for (i = 0; i < tokens->num_stuff; i++)
+    {
+        isar_token * tok = vec_nth (tokens, i);
+        if (tok->type != ISAR_TOK_IDENT)
+            continue;
+
+        if (begin == -1 && isar_tok_is (buffer, tok, "theory"))
+            begin = -2;
+        else if (begin == -2 && isar_tok_is (buffer, tok, "begin"))
         {
-            free (cur_key);
+            begin = i + 1;
             break;
         }
+    }
+
+    if (begin < 0)
+    {
+        isar_unmap_file (buffer, size);
+        destroy_vec (tokens);
+        return -2;
+    }
+
+    chk = get_std_seqs ();
+    if (chk == -1)
+    {
+        isar_unmap_file (buffer, size);
+        destroy_vec (tokens);
+        return -1;
+    }
 
-        pos = 0;
-        tmp_str = NULL;
+    // Each command runs until the next command keyword.
+    // The first one may share a line with 'begin'.
+
+    if (begin < tokens->num_stuff)
+        ((isar_token *) vec_nth (tokens, begin))->col0 = 1;
+
+    i = begin;
+    while (i < tokens->num_stuff)
+    {
+        isar_token * tok;
+        char * cmd, * key;
+        int cmd_end, j;
 
-        for (i = 0; i < KF_NUM_FUNCS; i++)
+        tok = vec_nth (tokens, i);
+        if (!isar_tok_is_command (buffer, tok))
         {
-            if (!strcmp (cur_key, kfs[i].key))
-            {
-                pos = kfs[i].func (buf_pos, &tmp_str);
-                if (pos == -1)
-                    return -1;
-                break;
-            }
+            i++;
+            continue;
         }
 
-        // Might need to parse brackets in the event of 'text', 'section', etc.
+        if (isar_tok_is (buffer, tok, "end"))
+            break;
 
-        for (i = 0; null_keys[i]; i++)
+        for (j = i + 1; j < tokens->num_stuff; j++)
         {
-            if (!strcmp (cur_key, null_keys[i]))
-            {
-                pos = isar_parse_null (buf_pos);
-                if (pos == -1)
-                    return -1;
+            if (isar_tok_is_command (buffer, vec_nth (tokens, j)))
                 break;
-            }
         }
 
-        if (!null_keys[i])
+        if (j < tokens->num_stuff)
+            cmd_end = ((isar_token *) vec_nth (tokens, j))->start;
+        else
+            cmd_end = size;
+
+        cmd = (char *) calloc (cmd_end - tok->start + 1, sizeof (char));
+        CHECK_ALLOC (cmd, -1);
+        strncpy (cmd, buffer + tok->start, cmd_end - tok->start);
+        cmd[cmd_end - tok->start] = '\0';
+
+        key = (char *) calloc (tok->len + 1, sizeof (char));
+        CHECK_ALLOC (key, -1);
+        strncpy (key, buffer + tok->start, tok->len);
+        key[tok->len] = '\0';
+
+        chk = isar_translate_command (cmd, key, refs, lms);
+        free (cmd);
+        free (key);
+        if (chk == -1)
         {
-            if (!strcmp (cur_key, "datatype"))
-            {
-                pos = isar_parse_datatype (buf_pos, refs);
-                if (pos == -1)
-                    return -1;
-            }
-            else if (!strcmp (cur_key, "lemma") || !strcmp (cur_key, "theorem"))
-            {
-                char * mod_str, * tmp_mod_str;
-                tmp_mod_str = die_spaces_die (tmp_str);
-                if (!tmp_mod_str)
-                    return -1;
+            isar_unmap_file (buffer, size);
+            destroy_vec (tokens);
+            return -1;
+        }
 
-                chk = parse_connectives (tmp_mod_str, 0, &mod_str);
-                if (chk == -1)
-                    return -1;
-                free (tmp_mod_str);
+        i = j;
+    }
 
-                printf ("lemma = '%s'\n", mod_str);
-                chk = vec_str_add_obj (lms, mod_str);
-                if (chk < 0)
-                    return -1;
-                free (mod_str);
-            }
-            else if (tmp_str)
-            {
-                chk = vec_str_add_obj (refs, tmp_str);
-                if (chk < 0)
-                    return -1;
-            }
+    isar_unmap_file (buffer, size);
+    destroy_vec (tokens);
+
+    return 0;
+}
+
+/* Finds the translation of a theory file, translating it if necessary.
+ *  input:
+ *    filename - the name of the theory file.
+ *  output:
+ *    the cached theory, or NULL on error; ret receives the error code.
+ */
+static struct isar_theory *
+isar_get_thy (char * filename, int * ret)
+{
+    struct isar_theory thy, * cur;
+    struct stat st;
+    int i, chk;
+
+    *ret = 0;
+
+    if (stat (filename, &st) == -1)
+    {
+        PERROR (NULL);
+        *ret = -1;
+        return NULL;
+    }
+
+    if (!thy_cache)
+    {
+        thy_cache = init_vec (sizeof (struct isar_theory));
+        if (!thy_cache)
+        {
+            *ret = -1;
+            return NULL;
         }
+    }
 
-        if (pos == 0)
+    for (i = 0; i < thy_cache->num_stuff; i++)
+    {
+        cur = vec_nth (thy_cache, i);
+        if (strcmp (cur->file_name, filename))
+            continue;
+
+        if (cur->mtime == st.st_mtime && cur->size == st.st_size)
+            return cur;
+
+        // The file changed since it was translated.
+        destroy_str_vec (cur->refs);
+        destroy_str_vec (cur->lms);
+        break;
+    }
+
+    thy.refs = init_vec (sizeof (char *));
+    if (!thy.refs)
+    {
+        *ret = -1;
+        return NULL;
+    }
+
+    thy.lms = init_vec (sizeof (char *));
+    if (!thy.lms)
+    {
+        destroy_str_vec (thy.refs);
+        *ret = -1;
+        return NULL;
+    }
+
+    chk = isar_translate_thy (filename, thy.refs, thy.lms);
+    if (chk < 0)
+    {
+        destroy_str_vec (thy.refs);
+        destroy_str_vec (thy.lms);
+        if (i < thy_cache->num_stuff)
         {
-            // Not a recognized keyword.
+            cur = vec_nth (thy_cache, i);
+            free (cur->file_name);
+            memmove (cur, cur + 1, (thy_cache->num_stuff - i - 1) * sizeof (thy));
+            thy_cache->num_stuff--;
         }
+        *ret = chk;
+        return NULL;
+    }
 
-        while (strncmp (buf_pos + pos, "\n\n", 2))
-            buf_pos++;
+    thy.mtime = st.st_mtime;
+    thy.size = st.st_size;
 
-        // Find the next non-whitespace character.
-        while (isspace(buf_pos[pos]))
-            pos++;
+    if (i < thy_cache->num_stuff)
+    {
+        cur = vec_nth (thy_cache, i);
+        cur->mtime = thy.mtime;
+        cur->size = thy.size;
+        cur->refs = thy.refs;
+        cur->lms = thy.lms;
+        return cur;
+    }
 
-        buf_pos += pos;
-        free (tmp_str);
-        free (cur_key);
+    thy.file_name = strdup (filename);
+    CHECK_ALLOC (thy.file_name, NULL);
+
+    chk = vec_add_obj (thy_cache, &thy);
+    if (chk < 0)
+    {
+        *ret = -1;
+        return NULL;
     }
 
+    return vec_nth (thy_cache, thy_cache->num_stuff - 1);
+}
+
+/* Imports a theory file into a proof.
+ *  The definitions become premises, and the lemmas become goals.
+ *  Translations are cached per file, and reused until the file changes.
+ *  input:
+ *    filename - the name of the theory file.
+ *    proof - the proof to fill.
+ *  output:
+ *    0 on success, -1 on memory error, -2 on an invalid theory.
+ */
+int
+parse_thy (char * filename, proof_t * proof)
+{
+    struct isar_theory * thy;
+    item_t * ls_chk;
+    int i, ret;
+
+    thy = isar_get_thy (filename, &ret);
+    if (!thy)
+        return (ret < 0) ? ret : -1;
+
     // Construct the proof.
 
-    for (i = 0; i < refs->num_stuff; i++)
+    for (i = 0; i < thy->refs->num_stuff; i++)
     {
         sen_data * sd;
-        sd = sen_data_init (i, -1, vec_str_nth (refs, i), NULL, 1, NULL, 0, 0, NULL);
+        sd = sen_data_init (i, -1, vec_str_nth (thy->refs, i), NULL, 1, NULL, 0, 0, NULL);
         if (!sd)
             return -1;
 
@@ -2277,12 +2780,14 @@ parse_thy (char * filename, proof_t * proof)
             return -1;
     }
 
-    int ln_offset = refs->num_stuff;
+    int ln_offset = thy->refs->num_stuff;
 
-    for (i = 0; i < lms->num_stuff; i++)
+    for (i = 0; i < thy->lms->num_stuff; i++)
     {
         sen_data * sd;
-        sd = sen_data_init (i + ln_offset, -1, vec_str_nth (lms, i),
+        unsigned char * goal;
+
+        sd = sen_data_init (i + ln_offset, -1, vec_str_nth (thy->lms, i),
                            NULL, 0, NULL, 0, 0, NULL);
         if (!sd)
             return -1;
@@ -2291,15 +2796,13 @@ parse_thy (char * filename, proof_t * proof)
         if (!ls_chk)
             return -1;
 
-        ls_chk = ls_push_obj (proof->goals, vec_str_nth (lms, i));
+        goal = strdup (vec_str_nth (thy->lms, i));
+        CHECK_ALLOC (goal, -1);
+
+        ls_chk = ls_push_obj (proof->goals, goal);
         if (!ls_chk)
             return -1;
     }
 
-    //destroy_str_vec (refs);
-    //destroy_str_vec (lms);
-    free (buffer);
-
-    //destroy_vec (seqs);
     return 0;
 }
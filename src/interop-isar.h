@@ -34,6 +34,25 @@ struct key_function {
     int (* func) (char *, char **);
 };
 
+// A token produced by the Isar lexer.
+
+struct isar_token {
+    int type;   // The type of token, from ISAR_TOKEN_TYPES.
+    int start;  // The offset of the token in the theory buffer.
+    int len;    // The length of the token.
+    int col0;   // Whether the token is at the start of a line.
+};
+
+enum ISAR_TOKEN_TYPES {
+    ISAR_TOK_IDENT = 0,
+    ISAR_TOK_NAT,
+    ISAR_TOK_SYM,
+    ISAR_TOK_STRING,
+    ISAR_TOK_VERBATIM,
+    ISAR_TOK_CARTOUCHE,
+    ISAR_TOK_OTHER
+};
+
 
 enum KEY_FUNCS {
     KF_SYN = 0,
@@ -47,6 +66,8 @@ enum KEY_FUNCS {
 };
 
 int isar_run_cmds (unsigned char ** inputs, unsigned char ** output);
+int isar_prep_regexps ();
+int isar_lex (const char * buffer, int size, vec_t * tokens);
 
 unsigned char * correct_conditionals (unsigned char * in_str);
 unsigned char * isar_to_aris (char * isar);
@@ -20,7 +20,7 @@
 #include "../src/vec.h"
 
 char *
-process (unsigned char * conc, vec_t * prems, const char * rule, vec_t * vars,
+process (unsigned char * conc, vec_t * prems, const char * rule, var_index * vars,
         proof_t * proof)
 {
     unsigned char * conclusion;
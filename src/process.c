@@ -847,6 +847,183 @@ get_generalities (unsigned char * chk_str, unsigned char * conn, vec_t * vec)
     return (int) vec->num_stuff;
 }
 
+/* Matches the parentheses of a string in a single pass.
+ *  input:
+ *    in_str - the string whose parentheses to match.
+ *    len - the length of in_str.
+ *  output:
+ *    an array holding, for each parenthesis of in_str, the position of
+ *    the parenthesis that matches it, and -1 for every other character
+ *    and for unmatched parentheses; or NULL on memory error.
+ */
+int *
+match_parens (const unsigned char * in_str, int len)
+{
+    int * match, * open;
+    int i, num_open = 0;
+
+    match = (int *) calloc (len + 1, sizeof (int));
+    CHECK_ALLOC (match, NULL);
+
+    open = (int *) calloc (len + 1, sizeof (int));
+    CHECK_ALLOC (open, NULL);
+
+    for (i = 0; i < len; i++)
+    {
+        match[i] = -1;
+
+        if (in_str[i] == '(')
+        {
+            open[num_open++] = i;
+        }
+        else if (in_str[i] == ')' && num_open > 0)
+        {
+            num_open--;
+            match[i] = open[num_open];
+            match[open[num_open]] = i;
+        }
+    }
+
+    free (open);
+    return match;
+}
+
+/* Determines whether a span of a string begins with a symbol.
+ *  input:
+ *    str - the string.
+ *    pos - the beginning of the span.
+ *    end - the end of the span.
+ *    sym - the symbol to check for.
+ *    sym_len - the length of sym.
+ *  output:
+ *    1 if the span begins with sym, 0 otherwise.
+ */
+static int
+span_starts (const unsigned char * str, int pos, int end,
+             const char * sym, int sym_len)
+{
+    return (end - pos >= sym_len
+            && !strncmp ((const char *) str + pos, sym, sym_len));
+}
+
+/* Determines whether a connective begins at a position of a string.
+ *  input:
+ *    str - the string.
+ *    pos - the position.
+ *    len - the length of str.
+ *  output:
+ *    the length of the connective, or 0 if none begins at pos.
+ */
+static int
+is_conn (const unsigned char * str, int pos, int len)
+{
+    if (span_starts (str, pos, len, AND, CL) || span_starts (str, pos, len, OR, CL)
+        || span_starts (str, pos, len, CON, CL) || span_starts (str, pos, len, BIC, CL))
+        return CL;
+
+    return 0;
+}
+
+/* Determines whether an infix relation begins at a position of a string.
+ *  input:
+ *    str - the string.
+ *    pos - the position.
+ *    len - the length of str.
+ *  output:
+ *    the length of the relation, or 0 if none begins at pos.
+ */
+static int
+is_infix_rel (const unsigned char * str, int pos, int len)
+{
+    if (str[pos] == '=' || str[pos] == '<')
+        return 1;
+
+    return span_starts (str, pos, len, ELM, CL) ? CL : 0;
+}
+
+/* Finds, for each position of a string, the next symbol at its own
+ * level of parentheses.
+ *  Parentheses are skipped using their matches, so that any span of the
+ *  string can be searched for a symbol at its top level at once.
+ *  input:
+ *    str - the string.
+ *    match - the parenthesis matches of str, from match_parens.
+ *    len - the length of str.
+ *    is_sym - determines whether the symbol begins at a position.
+ *  output:
+ *    an array holding, for each position, the first position from it at
+ *    which the symbol begins at the same level, or len if there is none
+ *    before the level closes; or NULL on memory error.
+ */
+static int *
+next_at_level (const unsigned char * str, const int * match, int len,
+               int (* is_sym) (const unsigned char *, int, int))
+{
+    int * next;
+    int i;
+
+    next = (int *) calloc (len + 1, sizeof (int));
+    CHECK_ALLOC (next, NULL);
+
+    next[len] = len;
+    for (i = len - 1; i >= 0; i--)
+    {
+        if (is_sym (str, i, len))
+            next[i] = i;
+        else if (str[i] == '(' && match[i] >= 0)
+            next[i] = next[match[i] + 1];
+        else if (str[i] == ')')
+            next[i] = len;
+        else
+            next[i] = next[i + 1];
+    }
+
+    return next;
+}
+
+/* Finds the connectives at the top level of a span of a string.
+ *  input:
+ *    str - the string.
+ *    next_conn - the connectives of str, from next_at_level.
+ *    start - the beginning of the span.
+ *    end - the end of the span.
+ *    conns - receives the position of each connective.
+ *    conn - receives the connective, or NULL if none was found.
+ *  output:
+ *    the number of connectives found, or -2 if they are not all the same.
+ */
+static int
+span_connectives (const unsigned char * str, const int * next_conn,
+                  int start, int end, int * conns, const char ** conn)
+{
+    const char * first = NULL;
+    int i, num = 0;
+
+    for (i = next_conn[start]; i < end; i = next_conn[i + CL])
+    {
+        const char * cur;
+
+        if (span_starts (str, i, end, AND, CL))
+            cur = AND;
+        else if (span_starts (str, i, end, OR, CL))
+            cur = OR;
+        else if (span_starts (str, i, end, CON, CL))
+            cur = CON;
+        else
+            cur = BIC;
+
+        if (!first)
+            first = cur;
+        else if (cur != first)
+            return -2;
+
+        conns[num++] = i;
+    }
+
+    *conn = first;
+    return num;
+}
+
 /* Runs text checking on a string to confirm that it follows FOL syntax.
  *  input:
  *    text - the string to check.
@@ -899,9 +1076,51 @@ check_text (unsigned char * text)
     return 0;
 }
 
+/* Checks a single generality of a string, for check_generalities.
+ *  input:
+ *    text - the string being checked.
+ *    start - the beginning of the generality.
+ *    end - the end of the generality.
+ *    infix - 1 to check an infix predicate, 0 to check a predicate symbol.
+ *  output:
+ *    the same as check_generalities.
+ */
+static int
+check_leaf (unsigned char * text, int start, int end, int infix)
+{
+    unsigned char * leaf;
+    int ret_chk;
+
+    leaf = (unsigned char *) calloc (end - start + 1, sizeof (char));
+    CHECK_ALLOC (leaf, AEC_MEM);
+    strncpy (leaf, text + start, end - start);
+
+    if (infix)
+    {
+        ret_chk = check_infix (leaf, 1);
+        free (leaf);
+
+        if (ret_chk == AEC_MEM)
+            return AEC_MEM;
+
+        return (ret_chk == 0) ? 0 : -5;
+    }
+
+    ret_chk = check_symbols (leaf, 1);
+    free (leaf);
+
+    if (ret_chk == AEC_MEM)
+        return AEC_MEM;
+
+    return (ret_chk == -2) ? -5 : 0;
+}
+
 /* Checks the generalities of a string.
+ *  The generalities are checked depth first from an explicit stack of
+ *  spans of text, so that deeply nested sentences neither copy the text
+ *  at each level nor use the native stack.
  *  input:
- *    text - the string to check, and recursively check generalities of.
+ *    text - the string to check, and check the generalities of.
  *  output:
  *    0  - Success
  *    -1 - Memory Error
@@ -917,159 +1136,190 @@ check_generalities (unsigned char * text)
     // 1a. If no opening parentheses is found, confirm that the string is alnum, and return success.
     // 2. Parse the parenthesis, and check their scope.
     // 2a. If the new string is empty, return an error.
-    // 3. Run get_generalities on the new string.
-    // 4. If get_generalities returns an error, return an error.
-    // 5. Check the connective get_generalities returned, and confirm that it fits.
-    // 6. Run check_text() on all generalities, returning an error if one arises.
+    // 3. Get the generalities of the new string.
+    // 4. If the generalities are malformed, return an error.
+    // 5. Check the connective that was found, and confirm that it fits.
+    // 6. Check all of the generalities, returning an error if one arises.
 
-    int pos = 0;
+    int len, i, ret = 0;
+    int * match, * next_conn, * conns, * num_conns, * num_infix;
+    vec_t * spans;
 
-    unsigned char * tmp_str;
-    int tmp_pos, ret_chk;
+    len = strlen (text);
 
-    if (text[0] == '\0')
-        return -5;
+    match = match_parens (text, len);
+    if (!match)
+        return AEC_MEM;
 
-    if (!ISGOOD (text)
-        && !(strstr (text, AND) || strstr (text, OR)
-             || strstr (text, CON) || strstr (text, BIC)))
-    {
-        if (strstr (text, ELM) || strchr (text, '=') || strchr (text, '<'))
-        {
-            ret_chk = check_infix (text, 1);
-            if (ret_chk == AEC_MEM)
-                return AEC_MEM;
+    next_conn = next_at_level (text, match, len, is_conn);
+    if (!next_conn)
+        return AEC_MEM;
 
-            if (ret_chk == 0)
-                return 0;
-        }
+    conns = (int *) calloc (len + 1, sizeof (int));
+    CHECK_ALLOC (conns, AEC_MEM);
+
+    // The number of connectives, and of infix symbols, before each position,
+    //  so that a span can be searched for them at once.
+    num_conns = (int *) calloc (len + 1, sizeof (int));
+    CHECK_ALLOC (num_conns, AEC_MEM);
+
+    num_infix = (int *) calloc (len + 1, sizeof (int));
+    CHECK_ALLOC (num_infix, AEC_MEM);
+
+    for (i = 0; i < len; i++)
+    {
+        num_conns[i + 1] = num_conns[i];
+        if (is_conn (text, i, len))
+            num_conns[i + 1]++;
 
-        return -5;
+        num_infix[i + 1] = num_infix[i];
+        if (is_infix_rel (text, i, len))
+            num_infix[i + 1]++;
     }
 
-    tmp_pos = get_gen (text, 0, &tmp_str);
-    if (tmp_pos == AEC_MEM)
+    spans = init_vec (2 * sizeof (int));
+    if (!spans)
+        return AEC_MEM;
+
+    int span[2] = { 0, len };
+    if (vec_add_obj (spans, span) < 0)
         return AEC_MEM;
 
-    if (!strcmp (tmp_str, text))
+    while (spans->num_stuff > 0 && ret == 0)
     {
-        // This is the entire scope, so strip away the preceding symbol,
-        //  if one exists.
+        int start, end, num;
+        const char * conn;
 
-        if (!strncmp (text, NOT, NL))
-        {
-            if (text[NL] == '\0')
-                return -3;
+        memcpy (span, vec_nth (spans, spans->num_stuff - 1), sizeof (span));
+        vec_pop_obj (spans);
+        start = span[0];
+        end = span[1];
 
-            return check_generalities (text + NL);
-        }
-
-        if (!strncmp (text, UNV, CL) || !strncmp (text, EXL, CL))
+        if (start >= end)
         {
-            pos = CL;
-            while ((islower(text[pos]) || isdigit(text[pos]))
-                   && text[pos] != '\0')
-                pos++;
-            if (text[pos] == '\0')
-                return -4;
-
-            if (strncmp (text + pos, UNV, CL) && strncmp (text + pos, EXL, CL)
-                && strncmp (text + pos, NOT, NL) && text[pos] != '(')
-                return -4;
-
-            return check_generalities (text + pos);
+            ret = -5;
+            break;
         }
 
-        if (text[0] == '(')
+        if (!ISGOOD (text + start) && num_conns[end] == num_conns[start])
         {
-            tmp_str = elim_par (text);
-            if (!tmp_str)
-                return AEC_MEM;
-
-            ret_chk = check_generalities (tmp_str);
-            if (ret_chk == AEC_MEM)
-                return AEC_MEM;
-            free (tmp_str);
-            return ret_chk;
+            if (num_infix[end] > num_infix[start])
+                ret = check_leaf (text, start, end, 1);
+            else
+                ret = -5;
+            continue;
         }
 
-        if (text[0] != '(')
+        num = span_connectives (text, next_conn, start, end, conns, &conn);
+        if (num == 0)
         {
-            ret_chk = check_symbols (text, 1);
-            if (ret_chk == AEC_MEM)
-                return AEC_MEM;
+            // This is the entire scope, so strip away the preceding symbol,
+            //  if one exists.
 
-            if (ret_chk == -2)
-                return -5;
-
-            return 0;
-        }
-    }
+            if (span_starts (text, start, end, NOT, NL))
+            {
+                if (start + NL == end)
+                {
+                    ret = -3;
+                    break;
+                }
 
-    // Get generalities across the parenthesis construct.
+                span[0] = start + NL;
+            }
+            else if (span_starts (text, start, end, UNV, CL)
+                     || span_starts (text, start, end, EXL, CL))
+            {
+                int pos = start + CL;
 
-    int gg;
-    unsigned char conn[CL + 1];
-    vec_t * gens;
+                while (pos < end && (islower (text[pos]) || isdigit (text[pos])))
+                    pos++;
 
-    gens = init_vec (sizeof (char *));
-    if (!gens)
-        return AEC_MEM;
+                if (pos == end)
+                {
+                    ret = -4;
+                    break;
+                }
 
-    conn[0] = '\0';
-    gg = get_generalities (text, conn, gens);
-    if (gg == AEC_MEM)
-        return AEC_MEM;
+                if (!span_starts (text, pos, end, UNV, CL)
+                    && !span_starts (text, pos, end, EXL, CL)
+                    && !span_starts (text, pos, end, NOT, NL) && text[pos] != '(')
+                {
+                    ret = -4;
+                    break;
+                }
 
-    if (gens->num_stuff == 1 || gens->num_stuff == 0)
-    {
-        destroy_str_vec (gens);
+                span[0] = pos;
+            }
+            else if (text[start] == '(')
+            {
+                if (end - start < 2 || text[end - 1] != ')')
+                {
+                    ret = AEC_MEM;
+                    break;
+                }
 
-        int ret_chk = check_symbols (text, 1);
-        if (ret_chk == AEC_MEM)
-            return AEC_MEM;
+                if (match[start] != end - 1)
+                {
+                    // Construction Error.
+                    ret = -5;
+                    break;
+                }
 
-        if (ret_chk == -2)
-            return -5;
+                span[0] = start + 1;
+                span[1] = end - 1;
+            }
+            else
+            {
+                ret = check_leaf (text, start, end, 0);
+                continue;
+            }
 
-        return 0;
-    }
+            if (vec_add_obj (spans, span) < 0)
+                ret = AEC_MEM;
+            continue;
+        }
 
-    if (gg == -2)
-    {
-        // Connective Error.
-        return -3;
-    }
+        // Get generalities across the parenthesis construct.
 
-    if (gens->num_stuff >= 3)
-    {
-        if (!strcmp (conn, CON) || !strcmp (conn, BIC))
+        if (num == -2)
         {
             // Connective Error.
-            destroy_str_vec (gens);
-            return -3;
+            ret = -3;
+            break;
         }
-    }
 
-    int i;
-    unsigned char * cur_gen;
-    for (i = 0; i < gens->num_stuff; i++)
-    {
-        cur_gen = vec_str_nth (gens, i);
-        ret_chk = check_generalities (cur_gen);
-        if (ret_chk == AEC_MEM)
-            return AEC_MEM;
+        if (conns[0] >= end - 1)
+        {
+            ret = check_leaf (text, start, end, 0);
+            continue;
+        }
+
+        if (num >= 2 && (conn == CON || conn == BIC))
+        {
+            // Connective Error.
+            ret = -3;
+            break;
+        }
 
-        if (ret_chk != 0)
+        // Check the generalities from first to last.
+        for (i = num; i >= 0 && ret == 0; i--)
         {
-            destroy_str_vec (gens);
-            return ret_chk;
+            span[0] = (i == 0) ? start : conns[i - 1] + CL;
+            span[1] = (i == num) ? end : conns[i];
+
+            if (vec_add_obj (spans, span) < 0)
+                ret = AEC_MEM;
         }
     }
 
-    destroy_str_vec (gens);
+    destroy_vec (spans);
+    free (num_infix);
+    free (num_conns);
+    free (conns);
+    free (next_conn);
+    free (match);
 
-    return 0;
+    return ret;
 }
 
 /* Checks a predicate / function symbol.
@@ -1182,7 +1432,13 @@ check_symbols (unsigned char * in_str, int pred)
                     return -2;
                 done = 1;
                 if (in_str[cur_pos] == ',')
+                {
                     cur_pos++;
+
+                    // An argument may not be empty, even the last one.
+                    if (in_str[cur_pos] == ')')
+                        return -2;
+                }
                 break;
 
             case '\0':
@@ -1357,279 +1613,423 @@ conn_to_sexpr (unsigned char * conn)
     return ret_conn;
 }
 
-/* Converts a string to a sexpr string.
+// The kinds of steps in converting a sentence to a sexpr.
+enum CONV_STEP {
+  CONV_TEXT = 0,        // Output a piece of text.
+  CONV_SEN,             // Convert a sentence.
+  CONV_FUNC             // Convert a term that may be an infix function.
+};
+
+struct conv_step {
+    int type;             // The kind of step.
+    int start;            // The beginning of the span to convert.
+    int end;              // The end of the span to convert.
+    const char * text;    // The text to output, for CONV_TEXT.
+};
+
+struct conv_buf {
+    unsigned char * str;  // The output so far.
+    int len;              // The length of the output.
+    int alloc;            // The space allocated for the output.
+};
+
+/* Adds text to the output of a conversion.
  *  input:
- *    in_str - the string to convert.
+ *    buf - the output.
+ *    str - the text to add.
+ *    len - the length of the text.
  *  output:
- *    The sexpr form of the input string.
+ *    0 on success, -1 on memory error.
  */
-unsigned char *
-convert_sexpr (unsigned char * in_str)
+static int
+conv_buf_add (struct conv_buf * buf, const unsigned char * str, int len)
 {
-    unsigned char * out_str;
-    int out_pos = 0;
-    int in_len;
-
-    in_len = strlen (in_str);
-
-    unsigned char conn[CL + 1], * sexpr_conn;
-    vec_t * gg_vec;
-    int gg;
-
-    gg_vec = init_vec (sizeof (char *));
-    if (!gg_vec)
-        return NULL;
-
-    conn[0] = '\0';
-
-    gg = get_generalities (in_str, conn, gg_vec);
-    if (gg == AEC_MEM)
-        return NULL;
+    if (buf->len + len + 1 > buf->alloc)
+    {
+        while (buf->len + len + 1 > buf->alloc)
+            buf->alloc *= 2;
 
-    int i;
+        buf->str = (unsigned char *) realloc (buf->str, buf->alloc);
+        CHECK_ALLOC (buf->str, AEC_MEM);
+    }
 
-    if (gg < 0)
-    {
-        destroy_str_vec (gg_vec);
+    memcpy (buf->str + buf->len, str, len);
+    buf->len += len;
+    buf->str[buf->len] = '\0';
 
-        // Only one generality.
-        // Check for a negation.
-        if (!strncmp (in_str, NOT, NL))
-        {
-            unsigned char * neg_in_str, * sexpr_str;
+    return 0;
+}
 
-            neg_in_str = elim_not (in_str);
-            if (!neg_in_str)
-                return NULL;
+/* Adds a step to the stack of a conversion.
+ *  input:
+ *    steps - the stack of steps.
+ *    type - the kind of step.
+ *    start - the beginning of the span, for sentences and terms.
+ *    end - the end of the span, for sentences and terms.
+ *    text - the text to output, for CONV_TEXT.
+ *  output:
+ *    0 on success, -1 on memory error.
+ */
+static int
+conv_push (vec_t * steps, int type, int start, int end, const char * text)
+{
+    struct conv_step step;
 
-            sexpr_str = convert_sexpr (neg_in_str);
-            if (!sexpr_str)
-                return NULL;
-            free (neg_in_str);
-
-            out_str = (unsigned char *) calloc (strlen (sexpr_str) + sexpr_conns.nl + 4,
-                                               sizeof (char));
-            CHECK_ALLOC (out_str, NULL);
-            out_pos += sprintf (out_str + out_pos, "(%s %s)",
-                               sexpr_conns.Not, sexpr_str);
-            free (sexpr_str);
-            return out_str;
-        }
+    step.type = type;
+    step.start = start;
+    step.end = end;
+    step.text = text;
 
-        // Check for an opening parenthesis.
-        if (in_str[0] == '(')
-        {
-            unsigned char * par_in_str, * sexpr_str;
+    return vec_add_obj (steps, &step);
+}
 
-            par_in_str = elim_par (in_str);
-            if (!par_in_str)
-                return NULL;
+/* Determines whether an infix function begins at a position of a string.
+ *  input:
+ *    str - the string.
+ *    pos - the position.
+ *    len - the length of str.
+ *  output:
+ *    1 if one begins at pos, 0 otherwise.
+ */
+static int
+is_infix_func (const unsigned char * str, int pos, int len)
+{
+    return (str[pos] == '+' || str[pos] == '*');
+}
 
-            sexpr_str = convert_sexpr (par_in_str);
-            if (!sexpr_str)
-                return NULL;
-            free (par_in_str);
+/* Determines whether a parenthesis opens at a position of a string.
+ *  input:
+ *    str - the string.
+ *    pos - the position.
+ *    len - the length of str.
+ *  output:
+ *    1 if one opens at pos, 0 otherwise.
+ */
+static int
+is_open_paren (const unsigned char * str, int pos, int len)
+{
+    return (str[pos] == '(');
+}
 
-            out_str = (unsigned char *) calloc (strlen (sexpr_str) + 1, sizeof (char));
-            CHECK_ALLOC (out_str, NULL);
-            strcpy (out_str, sexpr_str);
-            free (sexpr_str);
-            return out_str;
-        }
+/* Determines whether an argument separator is at a position of a string.
+ *  input:
+ *    str - the string.
+ *    pos - the position.
+ *    len - the length of str.
+ *  output:
+ *    1 if one is at pos, 0 otherwise.
+ */
+static int
+is_comma (const unsigned char * str, int pos, int len)
+{
+    return (str[pos] == ',');
+}
 
-        // Check for a quantifier.
-        if (!strncmp (in_str, UNV, CL) || !strncmp (in_str, EXL, CL))
-        {
-            unsigned char * sexpr_quant, * quant_var, quant[CL + 1];
+/* Finds the first infix function of a term, ignoring one that begins it.
+ *  input:
+ *    next_func - the infix functions of the string, from next_at_level.
+ *    start - the beginning of the term.
+ *    end - the end of the term.
+ *  output:
+ *    the position of the function, or end if there is none.
+ */
+static int
+term_infix_func (const int * next_func, int start, int end)
+{
+    int pos;
 
-            strncpy (quant, in_str, CL);
-            quant[CL] = '\0';
+    if (start >= end)
+        return end;
 
-            sexpr_quant = conn_to_sexpr (quant);
+    pos = next_func[start];
+    if (pos == start)
+        pos = next_func[start + 1];
 
-            for (i = CL; in_str[i] != '\0'; i++)
-            {
-                if (!strncmp (in_str + i, EXL, CL) || !strncmp (in_str + i, UNV, CL)
-                    || in_str[i] == '(' || !strncmp (in_str + i, NOT, NL))
-                    break;
-            }
+    return (pos < end) ? pos : end;
+}
 
-            quant_var = (unsigned char *) calloc (i - CL + 1, sizeof (char));
-            CHECK_ALLOC (quant_var, NULL);
+/* Converts a string to a sexpr string.
+ *  The string is converted from an explicit stack of steps, each of which
+ *  either converts a span of the string or outputs a piece of text, so
+ *  that deeply nested sentences are converted in time linear in their
+ *  length, without copying their parts or using the native stack.
+ *  input:
+ *    in_str - the string to convert.
+ *  output:
+ *    The sexpr form of the input string, or NULL on error.
+ */
+unsigned char *
+convert_sexpr (unsigned char * in_str)
+{
+    int in_len, ret = 0;
+    int * match, * next_conn, * next_rel, * next_func, * next_open, * next_comma;
+    int * pos_list;
+    vec_t * steps;
+    struct conv_buf out;
 
-            strncpy (quant_var, in_str + CL, i - CL);
-            quant_var[i - CL] = '\0';
+    in_len = strlen (in_str);
 
-            unsigned char * quant_in_str, * sexpr_str;
+    match = match_parens (in_str, in_len);
+    if (!match)
+        return NULL;
 
-            quant_in_str = (unsigned char *) calloc (in_len - i + 1, sizeof (char));
-            CHECK_ALLOC (quant_in_str, NULL);
+    next_conn = next_at_level (in_str, match, in_len, is_conn);
+    next_rel = next_at_level (in_str, match, in_len, is_infix_rel);
+    next_func = next_at_level (in_str, match, in_len, is_infix_func);
+    next_open = next_at_level (in_str, match, in_len, is_open_paren);
+    next_comma = next_at_level (in_str, match, in_len, is_comma);
+    if (!next_conn || !next_rel || !next_func || !next_open || !next_comma)
+        return NULL;
 
-            strcpy (quant_in_str, in_str + i);
-            sexpr_str = convert_sexpr (quant_in_str);
-            if (!sexpr_str)
-                return NULL;
-            free (quant_in_str);
+    pos_list = (int *) calloc (in_len + 1, sizeof (int));
+    CHECK_ALLOC (pos_list, NULL);
 
-            int alloc_size;
+    out.alloc = 2 * in_len + 16;
+    out.len = 0;
+    out.str = (unsigned char *) calloc (out.alloc, sizeof (char));
+    CHECK_ALLOC (out.str, NULL);
 
-            alloc_size = strlen (quant_var) + sexpr_conns.cl + strlen (sexpr_str) + 7;
-            out_str = (unsigned char *) calloc (alloc_size, sizeof (char));
-            CHECK_ALLOC (out_str, NULL);
-            out_pos += sprintf (out_str + out_pos, "((%s %s) %s)",
-                               sexpr_quant, quant_var, sexpr_str);
-            free (sexpr_str);
-            free (quant_var);
+    steps = init_vec (sizeof (struct conv_step));
+    if (!steps)
+        return NULL;
 
-            return out_str;
-        }
+    if (conv_push (steps, CONV_SEN, 0, in_len, NULL) < 0)
+        return NULL;
 
-        unsigned char * tmp_str;
-        tmp_str = infix_to_prefix (in_str);
-        if (!tmp_str)
-            return NULL;
+    while (steps->num_stuff > 0 && ret == 0)
+    {
+        struct conv_step step;
+        int start, end, pos, num, i;
+        const char * conn;
 
-        int tmp_len;
-        tmp_len = strlen (tmp_str);
+        memcpy (&step, vec_nth (steps, steps->num_stuff - 1), sizeof (step));
+        vec_pop_obj (steps);
+        start = step.start;
+        end = step.end;
 
-        // Nothing was found, so check for a function or predicate.
-        for (i = 0; i < tmp_len; i++)
+        if (step.type == CONV_TEXT)
         {
-            if (tmp_str[i] == '(')
-                break;
+            ret = conv_buf_add (&out, step.text, strlen (step.text));
+            continue;
         }
 
-        if (i == tmp_len)
+        if (step.type == CONV_SEN && start < end)
         {
-            // No parentheses, return in_str.
-            if (!strcmp (tmp_str, TAU) || !strcmp (tmp_str, CTR))
-            {
-                out_str = (unsigned char *) calloc (sexpr_conns.cl + 1, sizeof (char));
-                CHECK_ALLOC (out_str, NULL);
+            // Check for generalities.
+            num = 0;
+            if (next_conn[start] < end - 1)
+                num = span_connectives (in_str, next_conn, start, end,
+                                        pos_list, &conn);
 
-                if (!strcmp (tmp_str, TAU))
-                    strcpy (out_str, sexpr_conns.tau);
-                else
-                    strcpy (out_str, sexpr_conns.ctr);
-            }
-            else if (!strcmp (tmp_str, NIL))
+            if (num > 0)
             {
-                out_str = (unsigned char *) calloc (sexpr_conns.cl + 1, sizeof (char));
-                CHECK_ALLOC (out_str, NULL);
-                strcpy (out_str, sexpr_conns.nil);
+                const char * sexpr_conn = conn_to_sexpr ((unsigned char *) conn);
+
+                ret = conv_buf_add (&out, "(", 1);
+                if (ret == 0)
+                    ret = conv_buf_add (&out, sexpr_conn, strlen (sexpr_conn));
+                if (ret == 0)
+                    ret = conv_push (steps, CONV_TEXT, 0, 0, ")");
+
+                for (i = num; i >= 0 && ret == 0; i--)
+                {
+                    ret = conv_push (steps, CONV_SEN,
+                                     (i == 0) ? start : pos_list[i - 1] + CL,
+                                     (i == num) ? end : pos_list[i], NULL);
+                    if (ret == 0)
+                        ret = conv_push (steps, CONV_TEXT, 0, 0, " ");
+                }
+                continue;
             }
-            else
+
+            // Only one generality.
+            // Check for a negation.
+            if (span_starts (in_str, start, end, NOT, NL))
             {
-                out_str = (unsigned char *) calloc (tmp_len + 1, sizeof (char));
-                CHECK_ALLOC (out_str, NULL);
-                strcpy (out_str, tmp_str);
+                ret = conv_buf_add (&out, "(", 1);
+                if (ret == 0)
+                    ret = conv_buf_add (&out, sexpr_conns.Not, sexpr_conns.nl);
+                if (ret == 0)
+                    ret = conv_buf_add (&out, " ", 1);
+                if (ret == 0)
+                    ret = conv_push (steps, CONV_TEXT, 0, 0, ")");
+                if (ret == 0)
+                    ret = conv_push (steps, CONV_SEN, start + NL, end, NULL);
+                continue;
             }
-        }
-        else
-        {
-            unsigned char * pred_in_str, * sexpr_str;
-
-            vec_t * arg_vec, * sexpr_args;
-            arg_vec = init_vec (sizeof (char *));
-            if (!arg_vec)
-                return NULL;
-
-            int ret_check, alloc_size;
-            ret_check = get_pred_func_args (tmp_str, 0, &pred_in_str, arg_vec);
-            if (ret_check < 0)
-                return NULL;
 
-            sexpr_args = init_vec (sizeof (char *));
-            if (!sexpr_args)
-                return NULL;
-
-            alloc_size = strlen (pred_in_str) + 1;
-            for (i = 0; i < arg_vec->num_stuff; i++)
+            // Check for an opening parenthesis.
+            if (in_str[start] == '(')
             {
-                unsigned char * cur_arg;
-                cur_arg = vec_str_nth (arg_vec, i);
-
-                sexpr_str = convert_sexpr (cur_arg);
-                if (!sexpr_str)
-                    return NULL;
-
-                ret_check = vec_str_add_obj (sexpr_args, sexpr_str);
-                if (ret_check < 0)
-                    return NULL;
+                if (match[start] != end - 1)
+                {
+                    ret = -2;
+                    break;
+                }
 
-                alloc_size += strlen (sexpr_str) + 1;
-                free (sexpr_str);
+                ret = conv_push (steps, CONV_SEN, start + 1, end - 1, NULL);
+                continue;
             }
 
-            destroy_str_vec (arg_vec);
-
-            out_str = (unsigned char *) calloc (alloc_size + 2, sizeof (char));
-            CHECK_ALLOC (out_str, NULL);
-            out_pos += sprintf (out_str + out_pos, "(%s", pred_in_str);
-            free (pred_in_str);
-
-            for (i = 0; i < sexpr_args->num_stuff; i++)
+            // Check for a quantifier.
+            if (span_starts (in_str, start, end, UNV, CL)
+                || span_starts (in_str, start, end, EXL, CL))
             {
-                unsigned char * sexpr_str;
-                sexpr_str = vec_str_nth (sexpr_args, i);
-                out_pos += sprintf (out_str + out_pos, " %s", sexpr_str);
+                const char * sexpr_quant;
+
+                sexpr_quant = span_starts (in_str, start, end, UNV, CL)
+                  ? sexpr_conns.unv : sexpr_conns.exl;
+
+                for (i = start + CL; i < end; i++)
+                {
+                    if (span_starts (in_str, i, end, EXL, CL)
+                        || span_starts (in_str, i, end, UNV, CL)
+                        || in_str[i] == '(' || span_starts (in_str, i, end, NOT, NL))
+                        break;
+                }
+
+                ret = conv_buf_add (&out, "((", 2);
+                if (ret == 0)
+                    ret = conv_buf_add (&out, sexpr_quant, sexpr_conns.cl);
+                if (ret == 0)
+                    ret = conv_buf_add (&out, " ", 1);
+                if (ret == 0)
+                    ret = conv_buf_add (&out, in_str + start + CL, i - start - CL);
+                if (ret == 0)
+                    ret = conv_buf_add (&out, ") ", 2);
+                if (ret == 0)
+                    ret = conv_push (steps, CONV_TEXT, 0, 0, ")");
+                if (ret == 0)
+                    ret = conv_push (steps, CONV_SEN, i, end, NULL);
+                continue;
             }
 
-            destroy_str_vec (sexpr_args);
-            out_pos += sprintf (out_str + out_pos, ")");
+            // Check for an infix relation, such as an identity.
+            pos = next_rel[start];
+            if (pos < end)
+            {
+                int rel_len = is_infix_rel (in_str, pos, in_len);
+
+                ret = conv_buf_add (&out, "(", 1);
+                if (ret == 0)
+                {
+                    if (in_str[pos] == '=' || in_str[pos] == '<')
+                        ret = conv_buf_add (&out, in_str + pos, 1);
+                    else
+                        ret = conv_buf_add (&out, sexpr_conns.elm, sexpr_conns.cl);
+                }
+                if (ret == 0)
+                    ret = conv_push (steps, CONV_TEXT, 0, 0, ")");
+                if (ret == 0)
+                    ret = conv_push (steps, CONV_FUNC, pos + rel_len, end, NULL);
+                if (ret == 0)
+                    ret = conv_push (steps, CONV_TEXT, 0, 0, " ");
+                if (ret == 0)
+                    ret = conv_push (steps, CONV_FUNC, start, pos, NULL);
+                if (ret == 0)
+                    ret = conv_push (steps, CONV_TEXT, 0, 0, " ");
+                continue;
+            }
         }
 
-        free (tmp_str);
-        return out_str;
-    }
-
-    sexpr_conn = conn_to_sexpr (conn);
+        if (start >= end)
+            continue;
 
-    int alloc_size;
-    vec_t * sexpr_gens;
+        // Check for an infix function, such as an addition.
+        pos = term_infix_func (next_func, start, end);
+        if (pos < end)
+        {
+            ret = conv_buf_add (&out, "(", 1);
+            if (ret == 0)
+                ret = conv_buf_add (&out, in_str + pos, 1);
+            if (ret == 0)
+                ret = conv_push (steps, CONV_TEXT, 0, 0, ")");
+            if (ret == 0)
+                ret = conv_push (steps, CONV_FUNC, pos + 1, end, NULL);
+            if (ret == 0)
+                ret = conv_push (steps, CONV_TEXT, 0, 0, " ");
+            if (ret == 0)
+                ret = conv_push (steps, CONV_FUNC, start, pos, NULL);
+            if (ret == 0)
+                ret = conv_push (steps, CONV_TEXT, 0, 0, " ");
+            continue;
+        }
 
-    sexpr_gens = init_vec (sizeof (char *));
-    if (!sexpr_gens)
-        return NULL;
+        if (step.type == CONV_FUNC)
+        {
+            // Anything else is converted as a sentence.
+            ret = conv_push (steps, CONV_SEN, start, end, NULL);
+            continue;
+        }
 
-    alloc_size = sexpr_conns.cl + 1;
+        // Nothing was found, so check for a function or predicate.
+        pos = next_open[start];
+        if (pos >= end)
+        {
+            // No parentheses, so output the symbol.
+            if (end - start == CL && (span_starts (in_str, start, end, TAU, CL)
+                                      || span_starts (in_str, start, end, CTR, CL)
+                                      || span_starts (in_str, start, end, NIL, CL)))
+            {
+                if (span_starts (in_str, start, end, TAU, CL))
+                    conn = sexpr_conns.tau;
+                else if (span_starts (in_str, start, end, CTR, CL))
+                    conn = sexpr_conns.ctr;
+                else
+                    conn = sexpr_conns.nil;
 
-    for (i = 0; i < gg_vec->num_stuff; i++)
-    {
-        int ret_chk;
-        unsigned char * cur_gen, * sexpr_gen;
+                ret = conv_buf_add (&out, conn, sexpr_conns.cl);
+            }
+            else
+            {
+                ret = conv_buf_add (&out, in_str + start, end - start);
+            }
+            continue;
+        }
 
-        cur_gen = vec_str_nth (gg_vec, i);
+        if (match[pos] < 0 || match[pos] >= end)
+        {
+            ret = -2;
+            break;
+        }
 
-        sexpr_gen = convert_sexpr (cur_gen);
-        if (!sexpr_gen)
-            return NULL;
+        ret = conv_buf_add (&out, "(", 1);
+        if (ret == 0)
+            ret = conv_buf_add (&out, in_str + start, pos - start);
+        if (ret == 0)
+            ret = conv_push (steps, CONV_TEXT, 0, 0, ")");
 
-        ret_chk = vec_str_add_obj (sexpr_gens, sexpr_gen);
-        if (ret_chk < 0)
-            return NULL;
+        // Add the arguments from last to first.
+        num = 0;
+        for (i = next_comma[pos + 1]; i < match[pos]; i = next_comma[i + 1])
+            pos_list[num++] = i;
 
-        alloc_size += strlen (sexpr_gen) + 1;
-        free (sexpr_gen);
+        for (i = num; i >= 0 && ret == 0; i--)
+        {
+            ret = conv_push (steps, CONV_SEN,
+                             (i == 0) ? pos + 1 : pos_list[i - 1] + 1,
+                             (i == num) ? match[pos] : pos_list[i], NULL);
+            if (ret == 0)
+                ret = conv_push (steps, CONV_TEXT, 0, 0, " ");
+        }
     }
 
-    destroy_str_vec (gg_vec);
-    out_str = (unsigned char *) calloc (alloc_size + 2, sizeof (char));
-    CHECK_ALLOC (out_str, NULL);
-
-    out_pos += sprintf (out_str, "(%s", sexpr_conn);
+    destroy_vec (steps);
+    free (pos_list);
+    free (next_comma);
+    free (next_open);
+    free (next_func);
+    free (next_rel);
+    free (next_conn);
+    free (match);
 
-    for (i = 0; i < sexpr_gens->num_stuff; i++)
+    if (ret != 0)
     {
-        unsigned char * sexpr_gen;
-        sexpr_gen = vec_str_nth (sexpr_gens, i);
-        out_pos += sprintf (out_str + out_pos, " %s", sexpr_gen);
+        free (out.str);
+        return NULL;
     }
 
-    out_pos += sprintf (out_str + out_pos, ")");
-
-    destroy_str_vec (sexpr_gens);
-    return out_str;
+    return out.str;
 }
 
 /* Converts a string from infix to prefix.
@@ -1750,6 +2150,8 @@ infix_to_prefix (unsigned char * in_str)
 }
 
 /* Converts a function from infix to prefix.
+ *  Functions group to the right, so the string is converted in one pass,
+ *  closing every function at the end.
  *  input:
  *    in_str - the string to convert.
  *  output:
@@ -1760,12 +2162,10 @@ infix_to_prefix_func (unsigned char * in_str)
 {
     unsigned char * out_str;
 
-    int i, pos, in_len;
-    unsigned char * lsen, * rsen, * sym;
+    int i, pos, in_len, out_pos, depth;
+    int * match;
 
     in_len = strlen (in_str);
-    i = 0;
-    pos = 0;
 
     if (!strcmp (in_str, NIL))
     {
@@ -1776,74 +2176,52 @@ infix_to_prefix_func (unsigned char * in_str)
         return out_str;
     }
 
-    while (i < in_len)
-    {
-        while (islower (in_str[i]) || isdigit (in_str[i]))
-            i++;
-
-        if (in_str[i] == '(')
-        {
-            int tmp_pos;
-            unsigned char * tmp_str;
+    match = match_parens (in_str, in_len);
+    if (!match)
+        return NULL;
 
-            tmp_pos = parse_parens (in_str, i, &tmp_str);
-            if (tmp_pos == AEC_MEM)
-                return NULL;
+    // Each function adds a parenthesis, a comma and a closing parenthesis.
+    out_str = (unsigned char *) calloc (3 * in_len + 1, sizeof (char));
+    CHECK_ALLOC (out_str, NULL);
 
-            free (tmp_str);
-            i = tmp_pos + 1;
-            continue;
-        }
+    out_pos = 0;
+    depth = 0;
+    pos = 0;
 
-        if (i != 0 && (in_str[i] == '+' || in_str[i] == '*'))
+    while (1)
+    {
+        for (i = pos; i < in_len; i++)
         {
-            lsen = (unsigned char *) calloc (i + 1, sizeof (char));
-            CHECK_ALLOC (lsen, NULL);
-
-            strncpy (lsen, in_str + pos, i);
-            lsen[i] = '\0';
-
-            pos = i+1;
+            if (in_str[i] == '(' && match[i] >= 0)
+            {
+                i = match[i];
+                continue;
+            }
 
-            break;
+            if (i != pos && (in_str[i] == '+' || in_str[i] == '*'))
+                break;
         }
 
-        i++;
-    }
+        if (i >= in_len)
+            break;
 
-    if (i >= in_len)
-    {
-        out_str = (unsigned char *) calloc (in_len + 1, sizeof (char));
-        CHECK_ALLOC (out_str, NULL);
+        out_pos += sprintf (out_str + out_pos, "%c(", in_str[i]);
+        strncpy (out_str + out_pos, in_str + pos, i - pos);
+        out_pos += i - pos;
+        out_str[out_pos++] = ',';
 
-        strcpy (out_str, in_str);
-        return out_str;
+        depth++;
+        pos = i + 1;
     }
 
-    rsen = (unsigned char *) calloc (in_len - pos + 1, sizeof (char));
-    CHECK_ALLOC (rsen, NULL);
-    strcpy (rsen, in_str + pos);
-
-    unsigned char * c_lsen, * c_rsen;
+    strcpy (out_str + out_pos, in_str + pos);
+    out_pos += in_len - pos;
 
-    c_lsen = infix_to_prefix_func (lsen);
-    if (!c_lsen)
-        return NULL;
+    for (; depth > 0; depth--)
+        out_str[out_pos++] = ')';
+    out_str[out_pos] = '\0';
 
-    c_rsen = infix_to_prefix_func (rsen);
-    if (!c_rsen)
-        return NULL;
-
-    free (lsen);
-    free (rsen);
-
-    out_str = (unsigned char *) calloc (strlen (c_lsen) + strlen (c_rsen) + 5,
-                                       sizeof (char));
-    CHECK_ALLOC (out_str, NULL);
-
-    sprintf (out_str, "%c(%s,%s)", in_str[i], c_lsen, c_rsen);
-    free (c_lsen);
-    free (c_rsen);
+    free (match);
     return out_str;
 }
 
@@ -288,6 +288,8 @@ unsigned char * elim_not (const unsigned char * not_str);
 
 unsigned char * elim_par (const unsigned char * par_str);
 
+int * match_parens (const unsigned char * in_str, int len);
+
 int get_gen (unsigned char * in_str,
          int in_pos,
          unsigned char ** out_str);
@@ -301,7 +303,7 @@ int get_generalities (unsigned char * chk_str,
 char * process (unsigned char * conc,
         vec_t * prems,
         const char * rule,
-        vec_t * vars,
+        var_index * vars,
         proof_t * proof);
 
 
@@ -316,12 +318,12 @@ char * process_equivalence (unsigned char * conc,
 char * process_quantifiers (unsigned char * conc,
                 vec_t * prems,
                 const char * rule,
-                vec_t * vars);
+                var_index * vars);
 
 char * process_misc (unsigned char * conc,
              vec_t * prems,
              const char * rule,
-             vec_t * vars,
+             var_index * vars,
              proof_t * proof);
 
 char * process_bool (unsigned char * conc,
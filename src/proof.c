@@ -4,6 +4,7 @@
 #include "proof.h"
 #include "sen-data.h"
 #include "var.h"
+#include "var-index.h"
 #include "list.h"
 #include "vec.h"
 #include "rules.h"
@@ -89,6 +90,25 @@ proof_eval (proof_t * proof, vec_t * rets, int verbose)
     return rc;
 }
 
+static int eval_proof_lines (list_t * everything, vec_t * rets, int verbose,
+                             proof_eval_func func, void * data);
+
+/* Evaluates a proof object, reporting the result of each line as it goes.
+ *  input:
+ *    proof - The proof that is being evaluated.
+ *    rets - A vector to store the return values, or NULL.
+ *    func - The function to call after each line.
+ *    data - The data to pass to func.
+ *  output:
+ *    0 on success, 1 if func stopped the evaluation, -1 on memory error.
+ */
+int
+proof_eval_each (proof_t * proof, vec_t * rets,
+                 proof_eval_func func, void * data)
+{
+    return eval_proof_lines (proof->everything, rets, 0, func, data);
+}
+
 /* Evaluates a list of sentences.
  *  input:
  *    everything - the list of sentences to evaluate.
@@ -99,17 +119,34 @@ proof_eval (proof_t * proof, vec_t * rets, int verbose)
  */
 int
 eval_proof (list_t * everything, vec_t * rets, int verbose)
+{
+    return eval_proof_lines (everything, rets, verbose, NULL, NULL);
+}
+
+/* Evaluates a list of sentences, calling func after each line.
+ *  input:
+ *    everything - the list of sentences to evaluate.
+ *    rets - a vector in which to store the return values.
+ *    verbose - a flag denoting verbosity (1 if verbose).
+ *    func - the function to call after each line, or NULL.
+ *    data - the data to pass to func.
+ *  output:
+ *    0 on success, 1 if func stopped the evaluation, -1 on memory error.
+ */
+static int
+eval_proof_lines (list_t * everything, vec_t * rets, int verbose,
+                  proof_eval_func func, void * data)
 {
     item_t * sen_itr;
     int got_prems, cur_line;
-    list_t * pf_vars;
+    var_index * pf_vars;
     vec_t * sexpr_text;
     int ret;
 
     got_prems = 0;
     cur_line = 0;
 
-    pf_vars = init_list ();
+    pf_vars = var_index_init ();
     if (!pf_vars)
         return AEC_MEM;
 
@@ -139,6 +176,11 @@ eval_proof (list_t * everything, vec_t * rets, int verbose)
         sen_data * sd;
         sd = sen_itr->value;
 
+        // Drop the variables of the subproofs that have ended.
+        ret = var_index_enter (pf_vars, sd->depth, sd->subproof);
+        if (ret == AEC_MEM)
+            return AEC_MEM;
+
         char * ret_chk;
         int ret_val;
         ret_chk = sen_data_evaluate (sd, &ret_val, pf_vars,
@@ -192,12 +234,20 @@ eval_proof (list_t * everything, vec_t * rets, int verbose)
         int arb = (sd->premise || sd->rule == RULE_EI || sd->subproof) ? 0 : 1;
         if (sd->sexpr)
         {
-            ret = sexpr_collect_vars_to_proof (pf_vars, sd->sexpr, arb);
+            ret = sexpr_collect_vars_to_proof (pf_vars, sd->sexpr, arb,
+                                               cur_line);
             if (ret < 0)
                 return AEC_MEM;
         }
+
+        if (func && func (cur_line, ret_chk, data))
+        {
+            var_index_destroy (pf_vars);
+            return 1;
+        }
     }
 
+    var_index_destroy (pf_vars);
     return 0;
 }
 
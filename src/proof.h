@@ -32,9 +32,15 @@ struct proof {
     int boolean : 1;      // Whether or not this is a boolean mode proof.
 };
 
+// Called after each line of a proof is evaluated, with the line number
+// and its result.  Returning nonzero stops the evaluation.
+typedef int (* proof_eval_func) (int line, const char * ret, void * data);
+
 proof_t * proof_init ();
 void proof_destroy (proof_t * proof);
 int proof_eval (proof_t * proof, vec_t * rets, int verbose);
+int proof_eval_each (proof_t * proof, vec_t * rets,
+                     proof_eval_func func, void * data);
 int eval_proof (list_t * everything, vec_t * rets, int verbose);
 
 int convert_proof_latex (proof_t * proof, const char * filename);
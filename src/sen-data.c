@@ -260,13 +260,13 @@ sd_convert_sexpr (sen_data * sd)
  *  input:
  *   sd - The sentence data to evaluate.
  *   ret_val - The return value.
- *   pf_vars - The variables from the proof.
+ *   pf_vars - The variables in scope at the sentence.
  *   lines - The lines from the proof.
  *  output:
  *   The status message to output.
  */
 char *
-sen_data_evaluate (sen_data * sd, int * ret_val, list_t * pf_vars, list_t * lines)
+sen_data_evaluate (sen_data * sd, int * ret_val, var_index * pf_vars, list_t * lines)
 {
     if (sd->text[0] == '\0')
     {
@@ -408,20 +408,8 @@ sen_data_evaluate (sen_data * sd, int * ret_val, list_t * pf_vars, list_t * line
         }
     }
 
-    // Next, get the variables.
-
-    vec_t * vars = init_vec (sizeof (variable));
-    item_t * var_itr;
     proof_t * proof = NULL;
 
-    for (var_itr = pf_vars->head; var_itr; var_itr = var_itr->next)
-    {
-        variable * var = var_itr->value;
-        ret = vec_add_obj (vars, var);
-        if (ret == AEC_MEM)
-            return NULL;
-    }
-
     char * fin_text;
     ret = sen_convert_sexpr (sd->text, &(sd->sexpr));
     if (ret == AEC_MEM)
@@ -452,12 +440,11 @@ sen_data_evaluate (sen_data * sd, int * ret_val, list_t * pf_vars, list_t * line
             struct connectives_list current_conns;
             current_conns = main_conns;
 
-            proof = aio_open (sd->file);
+            proof = aio_open_lemma (sd->file);
             if (!proof)
             {
                 *ret_val = VALUE_TYPE_ERROR;
                 destroy_str_vec (refs);
-                destroy_vec (vars);
                 return _("Unable to open lemma file.");
             }
 
@@ -465,12 +452,11 @@ sen_data_evaluate (sen_data * sd, int * ret_val, list_t * pf_vars, list_t * line
         }
     }
 
-    char * proc_ret = process (fin_text, refs, rule, vars, proof);
+    char * proc_ret = process (fin_text, refs, rule, pf_vars, proof);
     if (!proc_ret)
         return NULL;
 
     destroy_str_vec (refs);
-    destroy_vec (vars);
     if (proof)
         proof_destroy (proof);
 
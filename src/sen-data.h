@@ -73,7 +73,7 @@ int sen_convert_sexpr (unsigned char * text, unsigned char ** sexpr);
 int sd_convert_sexpr (sen_data * sd);
 
 char * sen_data_evaluate (sen_data * sd, int * ret_val,
-                        list_t * vars, list_t * lines);
+                        var_index * vars, list_t * lines);
 int sen_data_can_select_as_ref (sen_data * sen, sen_data * ref);
 int sen_data_can_sel_as_ref (int sen_line, int * sen_indices,
                             int ref_line, int * ref_indices,
@@ -22,6 +22,7 @@
 #include "sen-data.h"
 #include "app.h"
 #include "list.h"
+#include "callbacks.h"
 
 #define INIT_CONN_PIXBUF(s,i,c,f) {			\
   s->conn_pixbufs[i]					\
@@ -93,6 +94,10 @@ sen_parent_init (sen_parent * sp, const char * title,
   gtk_grid_set_row_spacing (GTK_GRID (sp->container), 4);
   gtk_container_add (GTK_CONTAINER (sp->viewport), sp->container);
   gtk_container_set_focus_vadjustment (GTK_CONTAINER (sp->container), f_adj);
+  g_signal_connect (G_OBJECT (f_adj), "value-changed",
+		    G_CALLBACK (container_scrolled), (gpointer) sp);
+  g_signal_connect (G_OBJECT (f_adj), "changed",
+		    G_CALLBACK (container_scrolled), (gpointer) sp);
 
   // Initialize the status bar.
   sp->statusbar = gtk_statusbar_new ();
@@ -104,6 +109,8 @@ sen_parent_init (sen_parent * sp, const char * title,
 
   sp->type = type;
   sp->undo = 0;
+  sp->lazy = 0;
+  sp->lazy_source = 0;
 }
 
 int
@@ -140,6 +147,10 @@ sen_parent_destroy (sen_parent * sp)
 {
   item_t * ev_itr, * nev_itr;
 
+  if (sp->lazy_source)
+    g_source_remove (sp->lazy_source);
+  sp->lazy_source = 0;
+
   for (ev_itr = sp->everything->head; ev_itr; ev_itr = nev_itr)
     {
       nev_itr = ev_itr->next;
@@ -291,12 +302,23 @@ sen_parent_rem_sentence (sen_parent * sp, sentence * sen)
   row_num = sentence_get_line_no (sen);
   */
 
-  // Only need to start this past the target sentence.
-  for (ev_itr = target->next; ev_itr; ev_itr = ev_itr->next)
+  // Only the sentences that reference this one need to be updated.
+  while (sen->dependents->head)
+    sentence_rem_ref (SENTENCE (sen->dependents->head->value), sen);
+
+  for (ev_itr = sen->references->head; ev_itr; ev_itr = ev_itr->next)
+    ls_rem_obj_value (SENTENCE (ev_itr->value)->dependents, sen);
+
+  // Any goals met at this sentence are no longer met.
+  while (sen->goals->head)
     {
-      sentence * ev_sen = ev_itr->value;
-      sentence_rem_ref (ev_sen, sen);
+      sentence * goal_sen = sen->goals->head->value;
+
+      sentence_update_line_no (goal_sen, -1);
+      sentence_set_value (goal_sen, VALUE_TYPE_BLANK);
+      sentence_set_met_at (goal_sen, NULL);
     }
+  sentence_set_met_at (sen, NULL);
 
   item_t * new_focus;
   if (sp->everything->num_stuff == 1)
@@ -333,6 +355,7 @@ void
 sen_parent_set_focus (sen_parent * sp, item_t * focus)
 {
   sp->focused = focus;
+  sentence_gui_realize (focus->value, 0);
   gtk_widget_grab_focus (((sentence *) focus->value)->entry);
 }
 
@@ -367,3 +390,68 @@ sen_parent_children_set_bg_color (sen_parent * sp)
 
   return 0;
 }
+
+/* Realizes the sentences near the visible part of a sentence parent,
+ * and unrealizes the ones far from it.
+ *  input:
+ *    data - the sentence parent.
+ *  output:
+ *    FALSE, so that the source is removed.
+ */
+static gboolean
+sen_parent_realize_visible (gpointer data)
+{
+  sen_parent * sp = data;
+  GtkAdjustment * adj;
+  item_t * ev_itr;
+  double top, bottom, page;
+
+  sp->lazy_source = 0;
+
+  adj = gtk_scrolled_window_get_vadjustment (GTK_SCROLLED_WINDOW (sp->scrolledwindow));
+  page = gtk_adjustment_get_page_size (adj);
+  if (page <= 0)
+    return FALSE;
+
+  top = gtk_adjustment_get_value (adj) - page * SEN_PARENT_LAZY_MARGIN;
+  bottom = gtk_adjustment_get_value (adj) + page * (1 + SEN_PARENT_LAZY_MARGIN);
+
+  for (ev_itr = sp->everything->head; ev_itr; ev_itr = ev_itr->next)
+    {
+      sentence * sen = ev_itr->value;
+      GtkAllocation alloc;
+
+      // Sentences that haven't been laid out yet are left alone.
+      if (!gtk_widget_get_mapped (sen->panel))
+	continue;
+
+      gtk_widget_get_allocation (sen->panel, &alloc);
+      if (alloc.y + alloc.height >= top && alloc.y <= bottom)
+	{
+	  if (sentence_gui_realize (sen, 0) < 0)
+	    return FALSE;
+	}
+      else if (ev_itr != sp->focused)
+	{
+	  sentence_gui_unrealize (sen);
+	}
+    }
+
+  return FALSE;
+}
+
+/* Queues the visible sentences of a sentence parent to be realized.
+ *  The work is done once the layout has settled.
+ *  input:
+ *    sp - the sentence parent.
+ *  output:
+ *    none.
+ */
+void
+sen_parent_queue_realize (sen_parent * sp)
+{
+  if (!sp->lazy || sp->lazy_source)
+    return;
+
+  sp->lazy_source = g_idle_add (sen_parent_realize_visible, sp);
+}
@@ -50,8 +50,16 @@ struct sen_parent {
   int font;                  // The index of the font in the_app->fonts.
   int type;                  // The type of sentence parent.
   int undo;
+  int lazy;                  // Whether sentence widgets are only created when visible.
+  guint lazy_source;         // The idle source that realizes visible sentences.
 };
 
+// Proofs with more lines than this only create widgets for visible sentences.
+#define SEN_PARENT_LAZY_LINES 200
+
+// The number of pages above and below the view to keep realized.
+#define SEN_PARENT_LAZY_MARGIN 1
+
 void sen_parent_init (sen_parent * sp, const char * title,
 		      int width, int height,
 		      void (* menu_func) (sen_parent *),
@@ -67,6 +75,7 @@ item_t * sen_parent_rem_sentence (sen_parent * sp, sentence * sen);
 void sen_parent_set_focus (sen_parent * sp, item_t * focus);
 
 int sen_parent_children_set_bg_color (sen_parent * sp);
+void sen_parent_queue_realize (sen_parent * sp);
 
 GdkPixbuf * sen_parent_get_conn_by_type (sen_parent * sp, char * type);
 
@@ -42,6 +42,57 @@ static char * sen_values[6] = {"media-playback-stop",
                                "tools-check-spelling",
                                "list-add"};
 
+/* Updates the placeholder label of an unrealized sentence.
+ *  input:
+ *    sen - the sentence to update.
+ *  output:
+ *    none.
+ */
+static void
+sentence_stub_update (sentence * sen)
+{
+  char * label;
+  int ln, alloc_size;
+
+  if (SEN_REALIZED (sen) || !sen->panel)
+    return;
+
+  ln = SD(sen)->line_num;
+  alloc_size = strlen ((char *) SD(sen)->text) + 4 * SEN_DEPTH(sen) + 16;
+  label = (char *) calloc (alloc_size, sizeof (char));
+  if (!label)
+    return;
+
+  if (ln > 0)
+    sprintf (label, "%3i  %*s%s", ln, 4 * SEN_DEPTH(sen), "", SD(sen)->text);
+  else
+    sprintf (label, "     %*s%s", 4 * SEN_DEPTH(sen), "", SD(sen)->text);
+
+  gtk_label_set_text (GTK_LABEL (sen->panel), label);
+  free (label);
+}
+
+/* Creates the placeholder label of an unrealized sentence.
+ *  input:
+ *    sen - the sentence for which to create a placeholder.
+ *  output:
+ *    none.
+ */
+static void
+sentence_gui_stub (sentence * sen)
+{
+  sen->panel = gtk_label_new (NULL);
+  gtk_widget_set_halign (sen->panel, GTK_ALIGN_START);
+  LABEL_SET_FONT (sen->panel, the_app->fonts[sen->parent->font]);
+
+  sen->entry = sen->line_no = sen->value = NULL;
+  sen->eventbox = sen->rule_box = NULL;
+  sen->mark = NULL;
+  sen->sig_id = 0;
+
+  sentence_stub_update (sen);
+}
+
 /* Initializes a sentence
  *  input:
  *    sd  - sentence data to initialize from.
@@ -71,12 +122,11 @@ sentence_init (sen_data * sd, sen_parent * sp, item_t * fcs)
 
   depth = SD(sen)->depth;
 
-  // Initialize the GUI components.
-  sentence_gui_init (sen);
   sen->parent = sp;
   sen->value_type = VALUE_TYPE_BLANK;
   sen->selected = 0;
   sen->font_resizing = 0;
+  sen->bg_color = BG_COLOR_DEFAULT;
 
   // Set the indices.
 
@@ -109,28 +159,8 @@ sentence_init (sen_data * sd, sen_parent * sp, item_t * fcs)
     return NULL;
 
   sentence_set_rule (sen, sd->rule);
-  if (SEN_PREM (sen))
-    {
-      if (sp->type == SEN_PARENT_TYPE_PROOF)
-        gtk_label_set_text (GTK_LABEL (sen->rule_box),
-                            "pr");
-      else
-        gtk_label_set_text (GTK_LABEL (sen->rule_box),
-                            "gl");
-    }
-  else if (SEN_SUB (sen))
-    {
-      gtk_label_set_text (GTK_LABEL (sen->rule_box),
-                          "sf");
-    }
 
-  if (sd->text)
-    {
-      ret = sentence_paste_text (sen);
-      if (ret == -1 || ret == -2)
-        return NULL;
-    }
-  else
+  if (!sd->text)
     {
       SD(sen)->text = strdup ("");
       CHECK_ALLOC (SD(sen)->text, NULL);
@@ -140,16 +170,33 @@ sentence_init (sen_data * sd, sen_parent * sp, item_t * fcs)
   if (!sen->references)
     return NULL;
 
-  ret = sentence_update_refs (sen);
+  sen->dependents = init_list ();
+  if (!sen->dependents)
+    return NULL;
+
+  sen->goals = init_list ();
+  if (!sen->goals)
+    return NULL;
+
+  sen->met_at = NULL;
+
+  ret = sentence_update_refs (sen, fcs);
   if (ret == AEC_MEM)
     return NULL;
 
   sen->reference = 0;
-  sentence_set_font (sen, sen->parent->font);
-  sentence_set_bg_color (sen, BG_COLOR_CONC, GTK_STATE_FLAG_FOCUSED);
-  sentence_set_bg_color (sen, BG_COLOR_DEFAULT, GTK_STATE_FLAG_NORMAL);
 
-  sentence_connect_signals (sen);
+  // Large proofs only create the widgets of the visible sentences.
+  if (sp->lazy)
+    {
+      sentence_gui_stub (sen);
+    }
+  else
+    {
+      ret = sentence_gui_realize (sen, 1);
+      if (ret == -1 || ret == -2)
+        return NULL;
+    }
 
   return sen;
 }
@@ -245,6 +292,116 @@ sentence_gui_init (sentence * sen)
   */
 }
 
+/* Creates the widgets of a sentence, replacing its placeholder.
+ *  input:
+ *    sen - the sentence to realize.
+ *    grab - whether the sentence should take focus once it is mapped.
+ *  output:
+ *    0 on success, -1 on memory error, -2 on a text error.
+ */
+int
+sentence_gui_realize (sentence * sen, int grab)
+{
+  GtkWidget * stub;
+  sen_parent * sp;
+  int ret, top = 0, bg_color;
+
+  if (SEN_REALIZED (sen))
+    return 0;
+
+  sp = sen->parent;
+  stub = sen->panel;
+  if (stub)
+    gtk_container_child_get (GTK_CONTAINER (sp->container), stub,
+                             "top-attach", &top, NULL);
+
+  sentence_gui_init (sen);
+
+  sentence_set_line_no (sen, SD(sen)->line_num);
+  sentence_set_rule (sen, SD(sen)->rule);
+  if (SEN_PREM (sen))
+    {
+      if (sp->type == SEN_PARENT_TYPE_PROOF)
+        gtk_label_set_text (GTK_LABEL (sen->rule_box),
+                            "pr");
+      else
+        gtk_label_set_text (GTK_LABEL (sen->rule_box),
+                            "gl");
+    }
+  else if (SEN_SUB (sen))
+    {
+      gtk_label_set_text (GTK_LABEL (sen->rule_box),
+                          "sf");
+    }
+
+  ret = sentence_paste_text (sen);
+  if (ret == -1 || ret == -2)
+    return ret;
+
+  // Restore the state that was kept while the sentence was unrealized.
+  bg_color = sen->bg_color;
+  sentence_set_font (sen, sp->font);
+  sentence_set_bg_color (sen, BG_COLOR_CONC, GTK_STATE_FLAG_FOCUSED);
+  sentence_set_bg_color (sen, BG_COLOR_DEFAULT, GTK_STATE_FLAG_NORMAL);
+  if (bg_color != BG_COLOR_DEFAULT)
+    sentence_set_bg (sen, bg_color);
+  sentence_set_value (sen, sen->value_type);
+
+  if (sen->goals && sen->goals->head)
+    {
+      sentence * goal_sen = sen->goals->head->value;
+      int good = (goal_sen->value_type == VALUE_TYPE_TRUE);
+
+      gtk_widget_override_background_color (sen->eventbox, GTK_STATE_NORMAL,
+                                            the_app->bg_colors[good ? BG_COLOR_GOOD
+                                                               : BG_COLOR_BAD]);
+    }
+
+  sentence_connect_signals (sen);
+  if (!grab)
+    {
+      g_signal_handler_disconnect (sen->entry, sen->sig_id);
+      sen->sig_id = 0;
+    }
+
+  if (stub)
+    {
+      gtk_widget_destroy (stub);
+      gtk_grid_attach (GTK_GRID (sp->container), sen->panel, 0, top, 1, 1);
+      gtk_widget_show_all (sen->panel);
+    }
+
+  return 0;
+}
+
+/* Destroys the widgets of a sentence, leaving a placeholder in its place.
+ *  input:
+ *    sen - the sentence to unrealize.
+ *  output:
+ *    none.
+ */
+void
+sentence_gui_unrealize (sentence * sen)
+{
+  GtkWidget * panel;
+  sen_parent * sp;
+  int top;
+
+  if (!SEN_REALIZED (sen))
+    return;
+
+  sp = sen->parent;
+  panel = sen->panel;
+  gtk_container_child_get (GTK_CONTAINER (sp->container), panel,
+                           "top-attach", &top, NULL);
+
+  sentence_gui_stub (sen);
+  gtk_widget_destroy (panel);
+
+  gtk_grid_attach (GTK_GRID (sp->container), sen->panel, 0, top, 1, 1);
+  gtk_widget_show (sen->panel);
+}
+
 /* Destroys a sentence.
  *  input:
  *    sen - the sentence to destroy.
@@ -258,6 +415,15 @@ sentence_destroy (sentence * sen)
     destroy_list (sen->references);
   sen->references = NULL;
 
+  if (sen->dependents)
+    destroy_list (sen->dependents);
+  sen->dependents = NULL;
+
+  if (sen->goals)
+    destroy_list (sen->goals);
+  sen->goals = NULL;
+  sen->met_at = NULL;
+
   sen->parent = NULL;
 
   gtk_widget_destroy (sen->panel);
@@ -304,7 +470,10 @@ sentence_set_line_no (sentence * sen, int new_line_no)
         return -2;
 
       SD(sen)->line_num = -1;
-      gtk_label_set_text (GTK_LABEL (sen->line_no), NULL);
+      if (SEN_REALIZED (sen))
+        gtk_label_set_text (GTK_LABEL (sen->line_no), NULL);
+      else
+        sentence_stub_update (sen);
       return 0;
     }
 
@@ -313,6 +482,12 @@ sentence_set_line_no (sentence * sen, int new_line_no)
   int sp_chk = 0;
   SD(sen)->line_num = new_line_no;
 
+  if (!SEN_REALIZED (sen))
+    {
+      sentence_stub_update (sen);
+      return 0;
+    }
+
   //The length of any number in base 10 will be log10(n) + 1
   new_label = (char *) calloc ((int)label_len + 2, sizeof (char));
   CHECK_ALLOC (new_label, AEC_MEM);
@@ -457,6 +632,10 @@ sentence_add_ref (sentence * sen, sentence * ref)
   if (!itm)
     return AEC_MEM;
 
+  itm = ls_push_obj (ref->dependents, sen);
+  if (!itm)
+    return AEC_MEM;
+
   sentence_refresh_refs (sen);
 
   return 0;
@@ -475,6 +654,9 @@ sentence_rem_ref (sentence * sen, sentence * ref)
   if (sen->references)
     ls_rem_obj_value (sen->references, ref);
 
+  if (ref->dependents)
+    ls_rem_obj_value (ref->dependents, sen);
+
   sentence_refresh_refs (sen);
 
   return 0;
@@ -483,11 +665,12 @@ sentence_rem_ref (sentence * sen, sentence * ref)
 /* Update the references of a sentence from data.
  *  input:
  *    sen - the sentence of which to update the references.
+ *    fcs - the item that this sentence comes after.
  *  output:
  *    0 on success, -1 on memory error.
  */
 int
-sentence_update_refs (sentence * sen)
+sentence_update_refs (sentence * sen, item_t * fcs)
 {
   int i, ln;
   ln = sentence_get_line_no (sen);
@@ -500,12 +683,15 @@ sentence_update_refs (sentence * sen)
           item_t * ev_itr;
 
           cur_line = SD(sen)->refs[i];
-          ev_itr = sen->parent->everything->head;
+          ev_itr = fcs;
 
           if (cur_line > ln)
             continue;
 
-          for (; ev_itr != NULL; ev_itr = ev_itr->next)
+          // References are usually close by, and the sentences after
+          // this one haven't been renumbered yet, so search backwards
+          // from the sentence before this one.
+          for (; ev_itr != NULL; ev_itr = ev_itr->prev)
             {
               sentence * ref_sen;
               ref_sen = ev_itr->value;
@@ -517,6 +703,10 @@ sentence_update_refs (sentence * sen)
                   if (!ret)
                     return AEC_MEM;
 
+                  ret = ls_push_obj (ref_sen->dependents, sen);
+                  if (!ret)
+                    return AEC_MEM;
+
                   break;
                 }
             }
@@ -525,6 +715,36 @@ sentence_update_refs (sentence * sen)
   return 0;
 }
 
+/* Sets the sentence at which a goal line is met.
+ *  input:
+ *    sen - the goal line.
+ *    met_at - the proof sentence at which the goal is met, or NULL if
+ *             the goal is not met.
+ *  output:
+ *    0 on success, -1 on memory error.
+ */
+int
+sentence_set_met_at (sentence * sen, sentence * met_at)
+{
+  if (sen->met_at == met_at)
+    return 0;
+
+  if (sen->met_at && sen->met_at->goals)
+    ls_rem_obj_value (sen->met_at->goals, sen);
+
+  sen->met_at = met_at;
+
+  if (met_at)
+    {
+      item_t * itm;
+      itm = ls_push_obj (met_at->goals, sen);
+      if (!itm)
+        return AEC_MEM;
+    }
+
+  return 0;
+}
+
 /* Sets the font of a sentence.
  *  input:
  *    sen - The sentence to set the font of.
@@ -535,6 +755,13 @@ sentence_update_refs (sentence * sen)
 void
 sentence_set_font (sentence * sen, int font)
 {
+  if (!SEN_REALIZED (sen))
+    {
+      if (sen->panel)
+        LABEL_SET_FONT (sen->panel, the_app->fonts[font]);
+      return;
+    }
+
   sen->font_resizing = 1;
 
   sentence_resize_text (sen);
@@ -557,6 +784,9 @@ sentence_resize_text (sentence * sen)
   GtkTextIter iter;
   GtkTextBuffer * buffer;
 
+  if (!SEN_REALIZED (sen))
+    return 0;
+
   buffer = gtk_text_view_get_buffer (GTK_TEXT_VIEW (sen->entry));
   gtk_text_buffer_get_start_iter (buffer, &iter);
 
@@ -592,6 +822,12 @@ sentence_resize_text (sentence * sen)
 void
 sentence_set_bg_color (sentence * sen, int bg_color, int state)
 {
+  if (!SEN_REALIZED (sen))
+    {
+      sen->bg_color = bg_color;
+      return;
+    }
+
   COLOR_TYPE inv;
   INVERT (the_app->bg_colors[bg_color], inv);
   gtk_widget_override_background_color (sen->entry, state,
@@ -630,6 +866,12 @@ sentence_set_bg_color (sentence * sen, int bg_color, int state)
 void
 sentence_set_bg (sentence * sen, int bg_color)
 {
+  if (!SEN_REALIZED (sen))
+    {
+      sen->bg_color = bg_color;
+      return;
+    }
+
   COLOR_TYPE inv;
   INVERT (the_app->bg_colors[bg_color], inv);
   gtk_widget_override_background_color (sen->entry, GTK_STATE_FLAG_NORMAL,
@@ -670,6 +912,12 @@ void
 sentence_set_value (sentence * sen, int value_type)
 {
   sen->value_type = value_type;
+  if (sen->parent->type == SEN_PARENT_TYPE_PROOF)
+    aris_proof_index_line (ARIS_PROOF (sen->parent), sen);
+
+  if (!SEN_REALIZED (sen))
+    return;
+
   gtk_image_set_from_icon_name (GTK_IMAGE (sen->value),
                                 sen_values [value_type],
                                 GTK_ICON_SIZE_MENU);
@@ -800,11 +1048,14 @@ sentence_out (sentence * sen)
   GtkTextBuffer * buffer;
   GtkTextIter start, end;
 
-  buffer = gtk_text_view_get_buffer (GTK_TEXT_VIEW (sen->entry));
+  if (SEN_REALIZED (sen))
+    {
+      buffer = gtk_text_view_get_buffer (GTK_TEXT_VIEW (sen->entry));
 
-  gtk_text_buffer_get_bounds (buffer, &start, &end);
-  gtk_text_buffer_remove_tag_by_name (buffer, "hilight", &start, &end);
-  gtk_text_buffer_remove_tag_by_name (buffer, "negative", &start, &end);
+      gtk_text_buffer_get_bounds (buffer, &start, &end);
+      gtk_text_buffer_remove_tag_by_name (buffer, "hilight", &start, &end);
+      gtk_text_buffer_remove_tag_by_name (buffer, "negative", &start, &end);
+    }
 
   if (!SEN_PREM(sen) && !SEN_SUB(sen))
     {
@@ -1184,7 +1435,7 @@ sentence_key (sentence * sen, int key, int ctrl)
             ? sp->everything->tail : sp->focused->prev;
           if (the_app->verbose)
             printf ("Got Key Up\n");
-          gtk_widget_grab_focus (SENTENCE (dst->value)->entry);
+          sen_parent_set_focus (sp, dst);
           ret = 0;
           break;
         case GDK_KEY_Down:
@@ -1192,7 +1443,7 @@ sentence_key (sentence * sen, int key, int ctrl)
             ? sp->everything->head : sp->focused->next;
           if (the_app->verbose)
             printf ("Got Key Down\n");
-          gtk_widget_grab_focus (SENTENCE (dst->value)->entry);
+          sen_parent_set_focus (sp, dst);
           ret = 0;
           break;
         case GDK_KEY_Left:
@@ -1383,6 +1634,13 @@ sentence_copy_text (sentence * sen)
   GtkTextIter start, end;
   int i;
 
+  if (!SEN_REALIZED (sen))
+    {
+      ret_str = strdup ((char *) sentence_get_text (sen));
+      CHECK_ALLOC (ret_str, NULL);
+      return ret_str;
+    }
+
   buffer = gtk_text_view_get_buffer (GTK_TEXT_VIEW (sen->entry));
   gtk_text_buffer_get_bounds (buffer, &start, &end);
 
@@ -1450,7 +1708,13 @@ sentence_paste_text (sentence * sen)
   GtkTextIter end;
 
   unsigned char * sen_text = sentence_get_text (sen);
-  
+
+  if (!SEN_REALIZED (sen))
+    {
+      sentence_stub_update (sen);
+      return 0;
+    }
+
   buffer = gtk_text_view_get_buffer (GTK_TEXT_VIEW (sen->entry));
   gtk_text_buffer_get_start_iter (buffer, &end);
 
@@ -1538,27 +1802,13 @@ sentence_text_changed (sentence * sen)
   if (sen->font_resizing || sen->parent->undo)
     return 0;
 
-  int ln;
-  ln = sentence_get_line_no (sen);
-
   sen_parent * sp = sen->parent;
   sentence_set_value (sen, VALUE_TYPE_BLANK);
 
-  item_t * e_itr = ls_find (sp->everything, sen);
+  item_t * d_itr;
 
-  for (e_itr = sp->everything->head; e_itr; e_itr = e_itr->next)
-    {
-      list_t * e_refs;
-      e_refs = SENTENCE (e_itr->value)->references;
-      if (e_refs)
-        {
-          item_t * r_itr;
-          r_itr = ls_find (e_refs, sen);
-
-          if (r_itr)
-            sentence_set_value (SENTENCE (e_itr->value), VALUE_TYPE_BLANK);
-        }
-    }
+  for (d_itr = sen->dependents->head; d_itr; d_itr = d_itr->next)
+    sentence_set_value (SENTENCE (d_itr->value), VALUE_TYPE_BLANK);
 
   if (SD(sen)->sexpr)
     {
@@ -1589,7 +1839,7 @@ sentence_text_changed (sentence * sen)
     {
       int ret;
 
-      ui = undo_info_init_one (NULL, sen, UIT_MOD_TEXT);
+      ui = undo_info_init_text (sen, (unsigned char *) text);
       if (ui.type == -1)
         return AEC_MEM;
 
@@ -1599,21 +1849,14 @@ sentence_text_changed (sentence * sen)
 
       gtk_widget_override_background_color (sen->eventbox, GTK_STATE_NORMAL, NULL);
 
-      if (SEN_PARENT (ARIS_PROOF (sp)->goal)->everything->num_stuff > 0)
+      // The goals met at this sentence are no longer known to be met.
+      while (sen->goals->head)
         {
-          item_t * mod_itm;
-          mod_itm = SEN_PARENT (ARIS_PROOF (sp)->goal)->everything->head;
-          for (; mod_itm; mod_itm = mod_itm->next)
-            {
-              int m_ln;
-              m_ln = sentence_get_line_no (mod_itm->value);
-              if (m_ln == ln)
-                {
-                  sentence_update_line_no (SENTENCE (mod_itm->value), -1);
-                  sentence_set_value (SENTENCE (mod_itm->value), VALUE_TYPE_BLANK);
-                  break;
-                }
-            }
+          sentence * goal_sen = sen->goals->head->value;
+
+          sentence_update_line_no (goal_sen, -1);
+          sentence_set_value (goal_sen, VALUE_TYPE_BLANK);
+          sentence_set_met_at (goal_sen, NULL);
         }
     }
   else
@@ -1627,14 +1870,12 @@ sentence_text_changed (sentence * sen)
       if (ret < 0)
         return AEC_MEM;
 
-      item_t * mod_itm;
-      sentence * mod_sen;
-      mod_itm = ls_nth ((SEN_PARENT (GOAL (sp)->parent)->everything), ln);
-      if (mod_itm)
+      if (sen->met_at)
         {
-          mod_sen = mod_itm->value;
-          gtk_widget_override_background_color (mod_sen->eventbox, GTK_STATE_NORMAL, NULL);
+          if (SEN_REALIZED (sen->met_at))
+            gtk_widget_override_background_color (sen->met_at->eventbox, GTK_STATE_NORMAL, NULL);
           sentence_set_line_no (sen, -1);
+          sentence_set_met_at (sen, NULL);
         }
     }
 
@@ -1644,6 +1885,15 @@ sentence_text_changed (sentence * sen)
 
   sentence_set_text (sen, text);
   free (text);
+
+  if (sp->type == SEN_PARENT_TYPE_PROOF)
+    {
+      int ret;
+      ret = aris_proof_schedule_eval (ARIS_PROOF (sp), sen);
+      if (ret < 0)
+        return AEC_MEM;
+    }
+
   return 0;
 }
 
@@ -1725,6 +1975,9 @@ sentence_set_rule (sentence * sen, int rule)
   SD(sen)->rule = rule;
   const char * rule_text = (SD(sen)->rule == -1)
     ? NULL : rules_list[SD(sen)->rule];
+  if (!SEN_REALIZED (sen))
+    return 0;
+
   gtk_label_set_text (GTK_LABEL (sen->rule_box),
                       rule_text);
   return 0;
@@ -1750,6 +2003,9 @@ sentence_set_text (sentence * sen, unsigned char * text)
 
   if (!SD(sen)->text)
     return AEC_MEM;
+
+  if (sen->parent->type == SEN_PARENT_TYPE_PROOF)
+    return aris_proof_index_line (ARIS_PROOF (sen->parent), sen);
   return 0;
 }
 
@@ -30,16 +30,21 @@
 #define SEN_SUB(s) sentence_subproof ((sentence*)(s))
 #define SEN_DEPTH(s) sentence_depth ((sentence*)(s))
 #define SEN_IND(s,i) sentence_get_index ((sentence*)(s),i)
+#define SEN_REALIZED(s) (((sentence*)(s))->entry != NULL)
 
 struct sentence {
   sen_data sd;			// The data components.
 
   int reference : 1;		// Whether or not this sentence is a reference.
   list_t * references;		// A list of sentences that are references.
+  list_t * dependents;		// A list of sentences that reference this one.
+  list_t * goals;		// The goal lines met at this sentence.
+  sentence * met_at;		// For goal lines, the sentence this goal is met at.
 
   proof_t * proof;		// The proof for this sentence, if lemma is used.
 
   // GUI components
+  // Only panel exists until the sentence is realized, as a placeholder label.
   GtkWidget * panel;		// Contains the other items - GtkGrid
   GtkWidget * entry;		// Actual Text Entry - GtkTextView
   GtkWidget * line_no;		// The line number of this sentence - GtkLabel
@@ -62,6 +67,8 @@ struct sentence {
 
 sentence * sentence_init (sen_data * sd, sen_parent * sp, item_t * fcs);
 void sentence_gui_init (sentence * sen);
+int sentence_gui_realize (sentence * sen, int grab);
+void sentence_gui_unrealize (sentence * sen);
 void sentence_destroy (sentence * sen);
 
 sen_data * sentence_copy_to_data (sentence * sen);
@@ -82,7 +89,8 @@ int sentence_get_rule (sentence * sen);
 int sentence_refresh_refs (sentence * sen);
 int sentence_add_ref (sentence * sen, sentence * ref);
 int sentence_rem_ref (sentence * sen, sentence * ref);
-int sentence_update_refs (sentence * sen);
+int sentence_update_refs (sentence * sen, item_t * fcs);
+int sentence_set_met_at (sentence * sen, sentence * met_at);
 
 int select_reference (sentence * sen);
 int select_sentence (sentence * sen);
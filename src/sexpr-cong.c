@@ -0,0 +1,662 @@
+/* Functions for deciding the substitution of equals in sexpr sentences.
+
+   Copyright (C) 2026 The GNU Aris contributors.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sexpr-cong.h"
+#include "sexpr-scope.h"
+#include "sexpr-process.h"
+#include "vec.h"
+
+#define CONG_MIN_BUCKETS 64
+
+/* Initializes a congruence closure with no terms.
+ *  input:
+ *    none.
+ *  output:
+ *    the new congruence closure, or NULL on memory error.
+ */
+sexpr_cong *
+sexpr_cong_init ()
+{
+    sexpr_cong * cong;
+    int i;
+
+    cong = (sexpr_cong *) calloc (1, sizeof (sexpr_cong));
+    CHECK_ALLOC (cong, NULL);
+
+    cong->num_buckets = CONG_MIN_BUCKETS;
+    cong->buckets = (int *) calloc (cong->num_buckets, sizeof (int));
+    CHECK_ALLOC (cong->buckets, NULL);
+
+    for (i = 0; i < cong->num_buckets; i++)
+        cong->buckets[i] = -1;
+
+    return cong;
+}
+
+/* Destroys a congruence closure.
+ *  input:
+ *    cong - the congruence closure to destroy.
+ *  output:
+ *    none.
+ */
+void
+sexpr_cong_destroy (sexpr_cong * cong)
+{
+    int ** arrays[] = {
+        &cong->kinds, &cong->labels, &cong->lens, &cong->arg_starts,
+        &cong->num_args, &cong->classes, &cong->sizes, &cong->use_first,
+        &cong->use_last, &cong->sig_next, &cong->sig_prev, &cong->sig_bucket,
+        &cong->args, &cong->use_terms, &cong->use_next, &cong->buckets,
+        &cong->pending
+    };
+    int i;
+
+    for (i = 0; i < sizeof (arrays) / sizeof (arrays[0]); i++)
+    {
+        if (*arrays[i])
+            free (*arrays[i]);
+    }
+
+    if (cong->text)
+        free (cong->text);
+    free (cong);
+}
+
+/* Finds the class of a term.
+ *  input:
+ *    cong - the congruence closure.
+ *    t - the term.
+ *  output:
+ *    the term that represents the class of t.
+ */
+static int
+cong_find (sexpr_cong * cong, int t)
+{
+    while (cong->classes[t] != t)
+    {
+        cong->classes[t] = cong->classes[cong->classes[t]];
+        t = cong->classes[t];
+    }
+
+    return t;
+}
+
+/* Hashes the signature of a term.
+ *  Arguments are hashed by their classes, so that the signatures of
+ *  congruent terms are the same.
+ *  input:
+ *    cong - the congruence closure.
+ *    t - the term.
+ *  output:
+ *    the FNV-1a hash of the signature of t.
+ */
+static unsigned int
+cong_sig_hash (sexpr_cong * cong, int t)
+{
+    unsigned int hash = 2166136261u;
+    int i;
+
+    hash = (hash ^ (unsigned int) cong->kinds[t]) * 16777619u;
+
+    if (cong->kinds[t] == CONG_FREE)
+    {
+        for (i = 0; i < cong->lens[t]; i++)
+            hash = (hash ^ cong->text[cong->labels[t] + i]) * 16777619u;
+    }
+    else if (cong->kinds[t] == CONG_LIST)
+    {
+        hash = (hash ^ (unsigned int) cong->labels[t]) * 16777619u;
+        for (i = 0; i < cong->num_args[t]; i++)
+        {
+            int a = cong_find (cong, cong->args[cong->arg_starts[t] + i]);
+            hash = (hash ^ (unsigned int) a) * 16777619u;
+        }
+    }
+
+    return hash;
+}
+
+/* Determines whether two terms have the same signature.
+ *  input:
+ *    cong - the congruence closure.
+ *    t_0, t_1 - the terms.
+ *  output:
+ *    1 if they do, 0 otherwise.
+ */
+static int
+cong_sig_equal (sexpr_cong * cong, int t_0, int t_1)
+{
+    int i;
+
+    if (cong->kinds[t_0] != cong->kinds[t_1])
+        return 0;
+
+    if (cong->kinds[t_0] == CONG_FREE)
+        return (cong->lens[t_0] == cong->lens[t_1]
+                && !memcmp (cong->text + cong->labels[t_0],
+                            cong->text + cong->labels[t_1], cong->lens[t_0]));
+
+    if (cong->kinds[t_0] != CONG_LIST)
+        return 1;
+
+    if (cong->labels[t_0] != cong->labels[t_1]
+        || cong->num_args[t_0] != cong->num_args[t_1])
+        return 0;
+
+    for (i = 0; i < cong->num_args[t_0]; i++)
+    {
+        if (cong_find (cong, cong->args[cong->arg_starts[t_0] + i])
+            != cong_find (cong, cong->args[cong->arg_starts[t_1] + i]))
+            return 0;
+    }
+
+    return 1;
+}
+
+/* Links a term into the bucket for its signature.
+ *  input:
+ *    cong - the congruence closure.
+ *    t - the term.
+ *  output:
+ *    none.
+ */
+static void
+cong_link (sexpr_cong * cong, int t)
+{
+    int b = cong_sig_hash (cong, t) & (cong->num_buckets - 1);
+
+    cong->sig_bucket[t] = b;
+    cong->sig_prev[t] = -1;
+    cong->sig_next[t] = cong->buckets[b];
+    if (cong->buckets[b] >= 0)
+        cong->sig_prev[cong->buckets[b]] = t;
+    cong->buckets[b] = t;
+}
+
+/* Unlinks a term from the bucket for its signature.
+ *  input:
+ *    cong - the congruence closure.
+ *    t - the term.
+ *  output:
+ *    none.
+ */
+static void
+cong_unlink (sexpr_cong * cong, int t)
+{
+    if (cong->sig_bucket[t] < 0)
+        return;
+
+    if (cong->sig_prev[t] >= 0)
+        cong->sig_next[cong->sig_prev[t]] = cong->sig_next[t];
+    else
+        cong->buckets[cong->sig_bucket[t]] = cong->sig_next[t];
+
+    if (cong->sig_next[t] >= 0)
+        cong->sig_prev[cong->sig_next[t]] = cong->sig_prev[t];
+
+    cong->sig_bucket[t] = -1;
+}
+
+/* Finds a term with the same signature as another.
+ *  input:
+ *    cong - the congruence closure.
+ *    t - the term.
+ *  output:
+ *    a term other than t with the same signature, or -1 if there is none.
+ */
+static int
+cong_lookup (sexpr_cong * cong, int t)
+{
+    int s;
+
+    s = cong->buckets[cong_sig_hash (cong, t) & (cong->num_buckets - 1)];
+    for (; s >= 0; s = cong->sig_next[s])
+    {
+        if (s != t && cong_sig_equal (cong, s, t))
+            return s;
+    }
+
+    return -1;
+}
+
+/* Makes room for one more term, and its arguments.
+ *  input:
+ *    cong - the congruence closure.
+ *    num_args - the number of arguments of the term.
+ *    text_len - the length of the text of the term.
+ *  output:
+ *    0 on success, -1 on memory error.
+ */
+static int
+cong_grow (sexpr_cong * cong, int num_args, int text_len)
+{
+    int i;
+
+    if (cong->num_terms == cong->alloc_terms)
+    {
+        int ** arrays[] = {
+            &cong->kinds, &cong->labels, &cong->lens, &cong->arg_starts,
+            &cong->num_args, &cong->classes, &cong->sizes, &cong->use_first,
+            &cong->use_last, &cong->sig_next, &cong->sig_prev,
+            &cong->sig_bucket
+        };
+        int new_alloc = (cong->alloc_terms > 0) ? 2 * cong->alloc_terms : 64;
+
+        for (i = 0; i < sizeof (arrays) / sizeof (arrays[0]); i++)
+        {
+            *arrays[i] = (int *) realloc (*arrays[i], new_alloc * sizeof (int));
+            CHECK_ALLOC (*arrays[i], AEC_MEM);
+        }
+
+        cong->alloc_terms = new_alloc;
+    }
+
+    if (cong->num_args_all + num_args > cong->alloc_args)
+    {
+        int new_alloc = (cong->alloc_args > 0) ? cong->alloc_args : 64;
+
+        while (cong->num_args_all + num_args > new_alloc)
+            new_alloc *= 2;
+
+        cong->args = (int *) realloc (cong->args, new_alloc * sizeof (int));
+        CHECK_ALLOC (cong->args, AEC_MEM);
+        cong->alloc_args = new_alloc;
+    }
+
+    if (cong->num_uses + num_args > cong->alloc_uses)
+    {
+        int new_alloc = (cong->alloc_uses > 0) ? cong->alloc_uses : 64;
+
+        while (cong->num_uses + num_args > new_alloc)
+            new_alloc *= 2;
+
+        cong->use_terms = (int *) realloc (cong->use_terms,
+                                           new_alloc * sizeof (int));
+        CHECK_ALLOC (cong->use_terms, AEC_MEM);
+        cong->use_next = (int *) realloc (cong->use_next,
+                                          new_alloc * sizeof (int));
+        CHECK_ALLOC (cong->use_next, AEC_MEM);
+        cong->alloc_uses = new_alloc;
+    }
+
+    if (cong->text_len + text_len > cong->text_alloc)
+    {
+        int new_alloc = (cong->text_alloc > 0) ? cong->text_alloc : 256;
+
+        while (cong->text_len + text_len > new_alloc)
+            new_alloc *= 2;
+
+        cong->text = (unsigned char *) realloc (cong->text, new_alloc);
+        CHECK_ALLOC (cong->text, AEC_MEM);
+        cong->text_alloc = new_alloc;
+    }
+
+    // Keep at least one bucket per term.
+    if (cong->num_terms + 1 > cong->num_buckets)
+    {
+        int new_buckets = 2 * cong->num_buckets;
+
+        free (cong->buckets);
+        cong->buckets = (int *) calloc (new_buckets, sizeof (int));
+        CHECK_ALLOC (cong->buckets, AEC_MEM);
+        cong->num_buckets = new_buckets;
+
+        for (i = 0; i < cong->num_buckets; i++)
+            cong->buckets[i] = -1;
+
+        for (i = 0; i < cong->num_terms; i++)
+        {
+            if (cong->sig_bucket[i] >= 0)
+                cong_link (cong, i);
+        }
+    }
+
+    return 0;
+}
+
+/* Adds a term, unless a term with the same signature exists.
+ *  input:
+ *    cong - the congruence closure.
+ *    kind - the kind of the term.
+ *    label - the head of a list.
+ *    text - the text of a free symbol.
+ *    len - the length of text.
+ *    args - the arguments of a list.
+ *    num_args - the number of arguments.
+ *  output:
+ *    the term, or -1 on memory error.
+ */
+static int
+cong_intern (sexpr_cong * cong, int kind, int label, const unsigned char * text,
+             int len, const int * args, int num_args)
+{
+    int t, s, i;
+
+    if (cong_grow (cong, num_args, len) == AEC_MEM)
+        return AEC_MEM;
+
+    // Build the term in place, and only keep it if it is new.
+    t = cong->num_terms;
+    cong->kinds[t] = kind;
+    cong->labels[t] = (kind == CONG_FREE) ? cong->text_len : label;
+    cong->lens[t] = len;
+    cong->arg_starts[t] = cong->num_args_all;
+    cong->num_args[t] = num_args;
+    memcpy (cong->text + cong->text_len, text, len);
+    memcpy (cong->args + cong->num_args_all, args, num_args * sizeof (int));
+
+    s = cong_lookup (cong, t);
+    if (s >= 0)
+        return s;
+
+    cong->num_terms++;
+    cong->text_len += len;
+    cong->num_args_all += num_args;
+
+    cong->classes[t] = t;
+    cong->sizes[t] = 1;
+    cong->use_first[t] = cong->use_last[t] = -1;
+    cong_link (cong, t);
+
+    for (i = 0; i < num_args; i++)
+    {
+        int a = cong_find (cong, args[i]), u = cong->num_uses++;
+
+        cong->use_terms[u] = t;
+        cong->use_next[u] = cong->use_first[a];
+        cong->use_first[a] = u;
+        if (cong->use_last[a] < 0)
+            cong->use_last[a] = u;
+        cong->sizes[a]++;
+    }
+
+    return t;
+}
+
+/* Adds the terms of a sentence to a congruence closure.
+ *  The sentence is read in one pass, with its lists kept on a stack.
+ *  input:
+ *    cong - the congruence closure.
+ *    sen - the sentence.
+ *  output:
+ *    the term of the sentence, -1 on memory error, or -2 if the sentence
+ *    is malformed.
+ */
+int
+sexpr_cong_add (sexpr_cong * cong, unsigned char * sen)
+{
+    sexpr_scope * sc;
+    int * stack, * frames, * heads;
+    int i, top = 0, num_frames = 0, root = -2;
+
+    sc = sexpr_scope_init (sen);
+    if (!sc)
+        return AEC_MEM;
+
+    stack = (int *) calloc (sc->len + 1, sizeof (int));
+    CHECK_ALLOC (stack, AEC_MEM);
+    frames = (int *) calloc (sc->len + 1, sizeof (int));
+    CHECK_ALLOC (frames, AEC_MEM);
+    heads = (int *) calloc (sc->len + 1, sizeof (int));
+    CHECK_ALLOC (heads, AEC_MEM);
+
+    for (i = 0; i < sc->len; i++)
+    {
+        int t, end, b, is_head;
+
+        if (sen[i] == ' ')
+            continue;
+
+        if (sen[i] == '(')
+        {
+            frames[num_frames] = top;
+            heads[num_frames++] = -1;
+            continue;
+        }
+
+        if (sen[i] == ')')
+        {
+            if (num_frames == 0)
+                break;
+
+            num_frames--;
+            t = cong_intern (cong, CONG_LIST, heads[num_frames], NULL, 0,
+                             stack + frames[num_frames],
+                             top - frames[num_frames]);
+            top = frames[num_frames];
+        }
+        else
+        {
+            end = sexpr_scope_term_end (sc, i);
+            b = sc->binder[i];
+            is_head = (i > 0 && sen[i - 1] == '(');
+
+            if (b == i)
+                t = cong_intern (cong, CONG_BINDING, -1, NULL, 0, NULL, 0);
+            else if (b >= 0)
+                t = cong_intern (cong, sc->index[i], -1, NULL, 0, NULL, 0);
+            else
+                t = cong_intern (cong, CONG_FREE, -1, sen + i, end - i, NULL, 0);
+
+            i = end - 1;
+
+            // The head of a list is kept apart from its arguments, so that
+            // equals are only substituted for arguments.
+            if (t >= 0 && is_head && num_frames > 0)
+            {
+                heads[num_frames - 1] = t;
+                continue;
+            }
+        }
+
+        if (t == AEC_MEM)
+        {
+            root = AEC_MEM;
+            break;
+        }
+
+        if (num_frames == 0)
+        {
+            root = t;
+            break;
+        }
+
+        stack[top++] = t;
+    }
+
+    if (root >= 0 && (i + 1 != sc->len || num_frames > 0))
+        root = -2;
+
+    free (stack);
+    free (frames);
+    free (heads);
+    sexpr_scope_destroy (sc);
+
+    return root;
+}
+
+/* Adds a pair of terms to be merged.
+ *  input:
+ *    cong - the congruence closure.
+ *    t_0, t_1 - the terms.
+ *  output:
+ *    0 on success, -1 on memory error.
+ */
+static int
+cong_push (sexpr_cong * cong, int t_0, int t_1)
+{
+    if (2 * cong->num_pending + 2 > cong->alloc_pending)
+    {
+        int new_alloc = (cong->alloc_pending > 0) ? 2 * cong->alloc_pending : 32;
+
+        cong->pending = (int *) realloc (cong->pending, new_alloc * sizeof (int));
+        CHECK_ALLOC (cong->pending, AEC_MEM);
+        cong->alloc_pending = new_alloc;
+    }
+
+    cong->pending[2 * cong->num_pending] = t_0;
+    cong->pending[2 * cong->num_pending + 1] = t_1;
+    cong->num_pending++;
+
+    return 0;
+}
+
+/* Merges the classes of two terms, and of every pair of terms that
+ * become congruent as a result.
+ *  The class with fewer uses is merged into the other, and only the
+ *  lists using it are looked up again, so that each list is looked up
+ *  a logarithmic number of times.
+ *  input:
+ *    cong - the congruence closure.
+ *    t_0, t_1 - the terms.
+ *  output:
+ *    0 on success, -1 on memory error.
+ */
+int
+sexpr_cong_merge (sexpr_cong * cong, int t_0, int t_1)
+{
+    if (cong_push (cong, t_0, t_1) == AEC_MEM)
+        return AEC_MEM;
+
+    while (cong->num_pending > 0)
+    {
+        int r_0, r_1, u, first;
+
+        cong->num_pending--;
+        r_0 = cong_find (cong, cong->pending[2 * cong->num_pending]);
+        r_1 = cong_find (cong, cong->pending[2 * cong->num_pending + 1]);
+        if (r_0 == r_1)
+            continue;
+
+        if (cong->sizes[r_0] > cong->sizes[r_1])
+        {
+            int tmp = r_0;
+            r_0 = r_1;
+            r_1 = tmp;
+        }
+
+        // The signatures of the lists using r_0 are about to change.
+        for (u = cong->use_first[r_0]; u >= 0; u = cong->use_next[u])
+            cong_unlink (cong, cong->use_terms[u]);
+
+        first = cong->use_first[r_0];
+        cong->classes[r_0] = r_1;
+        cong->sizes[r_1] += cong->sizes[r_0];
+
+        if (first >= 0)
+        {
+            if (cong->use_last[r_1] >= 0)
+                cong->use_next[cong->use_last[r_1]] = first;
+            else
+                cong->use_first[r_1] = first;
+            cong->use_last[r_1] = cong->use_last[r_0];
+        }
+
+        for (u = first; u >= 0; u = cong->use_next[u])
+        {
+            int p = cong->use_terms[u], q;
+
+            if (cong->sig_bucket[p] >= 0)
+                continue;
+
+            q = cong_lookup (cong, p);
+            if (q < 0)
+            {
+                cong_link (cong, p);
+            }
+            else if (cong_find (cong, p) != cong_find (cong, q))
+            {
+                if (cong_push (cong, p, q) == AEC_MEM)
+                    return AEC_MEM;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/* Determines whether two terms are in the same class.
+ *  input:
+ *    cong - the congruence closure.
+ *    t_0, t_1 - the terms.
+ *  output:
+ *    1 if they are, 0 otherwise.
+ */
+int
+sexpr_cong_same (sexpr_cong * cong, int t_0, int t_1)
+{
+    return (cong_find (cong, t_0) == cong_find (cong, t_1));
+}
+
+/* Determines whether one sentence can be reached from another by
+ * substituting equals.
+ *  input:
+ *    eqs - the identities to substitute by, or NULL.
+ *    sen_0, sen_1 - the sentences.
+ *  output:
+ *    1 if it can, 0 if it cannot, -1 on memory error, or -2 if one of
+ *    eqs is not an identity.
+ */
+int
+sexpr_cong_equal (vec_t * eqs, unsigned char * sen_0, unsigned char * sen_1)
+{
+    sexpr_cong * cong;
+    int t_0, t_1, i, ret = 0;
+
+    cong = sexpr_cong_init ();
+    if (!cong)
+        return AEC_MEM;
+
+    t_0 = sexpr_cong_add (cong, sen_0);
+    t_1 = sexpr_cong_add (cong, sen_1);
+    if (t_0 == AEC_MEM || t_1 == AEC_MEM)
+        return AEC_MEM;
+
+    for (i = 0; eqs && i < eqs->num_stuff && ret == 0; i++)
+    {
+        int e, head;
+
+        e = sexpr_cong_add (cong, vec_str_nth (eqs, i));
+        if (e == AEC_MEM)
+            return AEC_MEM;
+
+        head = (e >= 0 && cong->kinds[e] == CONG_LIST) ? cong->labels[e] : -1;
+        if (head < 0 || cong->num_args[e] != 2 || cong->lens[head] != 1
+            || cong->text[cong->labels[head]] != '=')
+        {
+            ret = -2;
+            break;
+        }
+
+        ret = sexpr_cong_merge (cong, cong->args[cong->arg_starts[e]],
+                                cong->args[cong->arg_starts[e] + 1]);
+        if (ret == AEC_MEM)
+            return AEC_MEM;
+    }
+
+    if (ret == 0 && t_0 >= 0 && t_1 >= 0)
+        ret = sexpr_cong_same (cong, t_0, t_1);
+
+    sexpr_cong_destroy (cong);
+
+    return ret;
+}
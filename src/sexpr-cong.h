@@ -0,0 +1,89 @@
+/* Functions for deciding the substitution of equals in sexpr sentences.
+
+   Copyright (C) 2026 The GNU Aris contributors.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SEXPR_CONG_H
+#define SEXPR_CONG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include "typedef.h"
+
+// The kinds of terms that are not bound symbols.
+#define CONG_FREE    -1  // A symbol that no quantifier binds.
+#define CONG_BINDING -2  // The variable of a quantifier.
+#define CONG_LIST    -3  // A list.
+
+// The congruence closure of a set of equations over the terms of some
+// sentences.  Each term is stored once, and its arguments are other
+// terms, so that two terms are equal exactly when their heads are the
+// same and their arguments are in the same classes.  Bound symbols are
+// stored by their distance to their quantifiers, so that equals are
+// never substituted for them.
+
+struct sexpr_cong {
+    int num_terms;          // The number of terms.
+    int alloc_terms;        // The number of terms allocated.
+    int * kinds;            // The kind of each term, or the number of
+                            // quantifiers between a bound symbol and its
+                            // binder.
+    int * labels;           // The text of a free symbol, or the head of a list.
+    int * lens;             // The length of the text of a free symbol.
+    int * arg_starts;       // The first argument of each list.
+    int * num_args;         // The number of arguments of each list.
+    int * classes;          // The parent of each term in its class, or itself.
+    int * sizes;            // The number of uses of each class.
+    int * use_first;        // The first use of each class, or -1.
+    int * use_last;         // The last use of each class, or -1.
+    int * sig_next;         // The next term in the same bucket, or -1.
+    int * sig_prev;         // The previous term in the same bucket, or -1.
+    int * sig_bucket;       // The bucket of each term, or -1 if it has been
+                            // left out for a congruent term.
+
+    int num_args_all;       // The number of arguments of every list.
+    int alloc_args;         // The number of arguments allocated.
+    int * args;             // The arguments of every list.
+
+    int num_uses;           // The number of uses.
+    int alloc_uses;         // The number of uses allocated.
+    int * use_terms;        // The list using a class.
+    int * use_next;         // The next use of the same class, or -1.
+
+    int num_buckets;        // The number of signature buckets, a power of two.
+    int * buckets;          // The first term in each bucket, or -1.
+
+    int text_len;           // The length of text.
+    int text_alloc;         // The space allocated for text.
+    unsigned char * text;   // The text of every free symbol.
+
+    int num_pending;        // The number of pairs waiting to be merged.
+    int alloc_pending;      // The number of pairs allocated.
+    int * pending;          // The pairs of terms waiting to be merged.
+};
+
+sexpr_cong * sexpr_cong_init ();
+void sexpr_cong_destroy (sexpr_cong * cong);
+int sexpr_cong_add (sexpr_cong * cong, unsigned char * sen);
+int sexpr_cong_merge (sexpr_cong * cong, int t_0, int t_1);
+int sexpr_cong_same (sexpr_cong * cong, int t_0, int t_1);
+int sexpr_cong_equal (vec_t * eqs, unsigned char * sen_0, unsigned char * sen_1);
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SEXPR_CONG_H
@@ -0,0 +1,1191 @@
+/* Functions for normalizing the quantifiers of sexpr sentences.
+
+   Copyright (C) 2026 The GNU Aris contributors.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sexpr-prenex.h"
+#include "sexpr-scope.h"
+#include "sexpr-process.h"
+
+int prenex_relaxed = 0;
+
+/* A symbol or a list of a sentence being normalized.  Lists keep their
+ * elements in a linked list, so that a quantifier can be moved between
+ * lists without copying them. */
+struct prenex_node {
+    int pos;        // The position of a symbol, or -1 for a list.
+    int end;        // The end of a symbol, or the beginning of a list.
+    int first;      // The first element of a list, or -1.
+    int last;       // The last element of a list, or -1.
+    int next;       // The next element of the enclosing list, or -1.
+    int lo, hi;     // The first and last symbols in argument position.
+    int var;        // The variable of a quantifier, or -1.
+    int quants;     // Whether a list has a quantifier within it.
+};
+
+/* A sentence being normalized. */
+struct prenex_tree {
+    sexpr_scope * sc;               // The resolved sentence.
+    struct prenex_node * nodes;     // The symbols and lists.
+    int num_nodes;                  // The number of nodes.
+    int alloc_nodes;                // The number of nodes allocated.
+    int * occ_lo, * occ_hi;         // The first and last use of each variable.
+};
+
+/* Adds a node to a tree.
+ *  input:
+ *    tree - the tree.
+ *    pos - the position of the symbol, or -1 for a list.
+ *    end - the end of the symbol.
+ *  output:
+ *    the new node, or -1 on memory error.
+ */
+static int
+prenex_add_node (struct prenex_tree * tree, int pos, int end)
+{
+    struct prenex_node * node;
+
+    if (tree->num_nodes == tree->alloc_nodes)
+    {
+        int new_alloc = (tree->alloc_nodes > 0) ? 2 * tree->alloc_nodes : 64;
+
+        tree->nodes = (struct prenex_node *)
+            realloc (tree->nodes, new_alloc * sizeof (struct prenex_node));
+        CHECK_ALLOC (tree->nodes, AEC_MEM);
+        tree->alloc_nodes = new_alloc;
+    }
+
+    node = tree->nodes + tree->num_nodes;
+    node->pos = pos;
+    node->end = end;
+    node->first = node->last = node->next = -1;
+    node->lo = (pos >= 0) ? pos : tree->sc->len;
+    node->hi = (pos >= 0) ? pos : -1;
+    node->var = -1;
+    node->quants = 0;
+
+    return tree->num_nodes++;
+}
+
+/* Appends a node to a list, widening the span of the list unless the
+ * node is the head of the list.
+ *  input:
+ *    tree - the tree.
+ *    list - the list.
+ *    n - the node to append.
+ *  output:
+ *    none.
+ */
+static void
+prenex_append (struct prenex_tree * tree, int list, int n)
+{
+    struct prenex_node * l = tree->nodes + list, * c = tree->nodes + n;
+
+    c->next = -1;
+    if (c->var >= 0 || c->quants)
+        l->quants = 1;
+
+    if (l->first < 0)
+    {
+        l->first = l->last = n;
+        return;
+    }
+
+    tree->nodes[l->last].next = n;
+    l->last = n;
+
+    if (c->lo < l->lo)
+        l->lo = c->lo;
+    if (c->hi > l->hi)
+        l->hi = c->hi;
+}
+
+/* Determines whether a node is a conjunction or a disjunction.
+ *  input:
+ *    tree - the tree.
+ *    n - the node.
+ *  output:
+ *    1 if it is, 0 otherwise.
+ */
+static int
+prenex_is_junction (struct prenex_tree * tree, int n)
+{
+    struct prenex_node * head;
+
+    if (tree->nodes[n].pos >= 0 || tree->nodes[n].first < 0)
+        return 0;
+
+    head = tree->nodes + tree->nodes[n].first;
+    if (head->pos < 0 || head->end - head->pos != S_CL)
+        return 0;
+
+    return (!strncmp (tree->sc->sen + head->pos, S_AND, S_CL)
+            || !strncmp (tree->sc->sen + head->pos, S_OR, S_CL));
+}
+
+/* Determines whether two junctions have the same connective.
+ *  input:
+ *    tree - the tree.
+ *    j_0, j_1 - the junctions.
+ *  output:
+ *    1 if they do, 0 otherwise.
+ */
+static int
+prenex_same_conn (struct prenex_tree * tree, int j_0, int j_1)
+{
+    int h_0 = tree->nodes[j_0].first, h_1 = tree->nodes[j_1].first;
+
+    return !strncmp (tree->sc->sen + tree->nodes[h_0].pos,
+                     tree->sc->sen + tree->nodes[h_1].pos, S_CL);
+}
+
+/* Splices into a junction the junctions among its generalities that have
+ * its connective.
+ *  Moving a quantifier across a junction may regroup the generalities it
+ *  crosses, and only those, so unless all is set this is only done to a
+ *  junction with a quantifier within it.  The generalities stay in the
+ *  order of the sentence, so the spans that prenex_push relies on are
+ *  kept.
+ *  input:
+ *    tree - the tree.
+ *    list - the junction.
+ *    all - whether to splice in every junction with its connective.
+ *  output:
+ *    none.
+ */
+static void
+prenex_flatten (struct prenex_tree * tree, int list, int all)
+{
+    int prev, n, next;
+
+    if (!all && !tree->nodes[list].quants)
+        return;
+
+    prev = tree->nodes[list].first;
+    for (n = tree->nodes[prev].next; n >= 0; n = next)
+    {
+        int c_first, c_last;
+
+        next = tree->nodes[n].next;
+        if (!prenex_is_junction (tree, n) || !prenex_same_conn (tree, list, n))
+        {
+            prev = n;
+            continue;
+        }
+
+        c_first = tree->nodes[tree->nodes[n].first].next;
+        c_last = tree->nodes[n].last;
+        if (c_first < 0)
+        {
+            prev = n;
+            continue;
+        }
+
+        // The generalities of a spliced junction may be spliced in turn.
+        tree->nodes[prev].next = c_first;
+        tree->nodes[c_last].next = next;
+        if (tree->nodes[list].last == n)
+            tree->nodes[list].last = c_last;
+        next = c_first;
+    }
+}
+
+/* Groups a run of the generalities of a junction.
+ *  input:
+ *    tree - the tree.
+ *    conn - the connective of the junction.
+ *    first - the first generality of the run.
+ *    last - the last generality of the run.
+ *  output:
+ *    the generality if the run has one, a new junction of the run
+ *    otherwise, or -1 on memory error.
+ */
+static int
+prenex_group (struct prenex_tree * tree, int conn, int first, int last)
+{
+    int list, head, n, next;
+
+    if (first == last)
+    {
+        tree->nodes[first].next = -1;
+        return first;
+    }
+
+    list = prenex_add_node (tree, -1, -1);
+    if (list == AEC_MEM)
+        return AEC_MEM;
+
+    head = prenex_add_node (tree, tree->nodes[conn].pos, tree->nodes[conn].end);
+    if (head == AEC_MEM)
+        return AEC_MEM;
+
+    tree->nodes[head].lo = tree->sc->len;
+    tree->nodes[head].hi = -1;
+    prenex_append (tree, list, head);
+
+    for (n = first; ; n = next)
+    {
+        next = tree->nodes[n].next;
+        prenex_append (tree, list, n);
+        if (n == last)
+            break;
+    }
+
+    return list;
+}
+
+/* Moves a quantifier into its scope for as long as the Prenex laws allow.
+ *  A quantifier whose scope is a junction is moved into the run of the
+ *  generalities that use its variable, when some generality does not.
+ *  input:
+ *    tree - the tree.
+ *    q - the quantifier, which is not yet in a list.
+ *    mode - the moves to normalize by.
+ *  output:
+ *    the node that takes the place of q, or -1 on memory error.
+ */
+static int
+prenex_push (struct prenex_tree * tree, int q, int mode)
+{
+    int top = q, parent = -1, prev = -1;
+    int v = tree->nodes[q].var;
+
+    if (tree->occ_lo[v] < 0)
+        return q;
+
+    while (1)
+    {
+        int head, scope, conn, n, f, l, first_gen, last_gen;
+        int pre, mid, post, q_next;
+
+        head = tree->nodes[q].first;
+        scope = tree->nodes[head].next;
+        if (!prenex_is_junction (tree, scope))
+            break;
+
+        if (mode & PRENEX_AS)
+            prenex_flatten (tree, scope, 1);
+
+        conn = tree->nodes[scope].first;
+        first_gen = tree->nodes[conn].next;
+        last_gen = tree->nodes[scope].last;
+        if (first_gen < 0 || first_gen == last_gen)
+            break;
+
+        f = l = -1;
+        for (n = first_gen; n >= 0; n = tree->nodes[n].next)
+        {
+            if (tree->nodes[n].lo <= tree->occ_lo[v]
+                && tree->occ_lo[v] <= tree->nodes[n].hi)
+                f = n;
+            if (tree->nodes[n].lo <= tree->occ_hi[v]
+                && tree->occ_hi[v] <= tree->nodes[n].hi)
+            {
+                l = n;
+                break;
+            }
+        }
+
+        if (f < 0 || l < 0 || (f == first_gen && l == last_gen))
+            break;
+
+        // Find the generality before the run, and the one after it.
+        pre = conn;
+        while (tree->nodes[pre].next != f)
+            pre = tree->nodes[pre].next;
+        post = tree->nodes[l].next;
+
+        mid = prenex_group (tree, conn, f, l);
+        if (mid == AEC_MEM)
+            return AEC_MEM;
+
+        // The quantifier now binds only the run.
+        tree->nodes[head].next = mid;
+        tree->nodes[q].last = mid;
+        tree->nodes[q].lo = tree->nodes[mid].lo;
+        tree->nodes[q].hi = tree->nodes[mid].hi;
+
+        // The junction takes the place of the quantifier.
+        q_next = tree->nodes[q].next;
+        tree->nodes[scope].next = q_next;
+        if (parent < 0)
+        {
+            top = scope;
+        }
+        else
+        {
+            tree->nodes[prev].next = scope;
+            if (tree->nodes[parent].last == q)
+                tree->nodes[parent].last = scope;
+        }
+
+        // The quantifier takes the place of the run.
+        tree->nodes[pre].next = q;
+        tree->nodes[q].next = post;
+        if (post < 0)
+            tree->nodes[scope].last = q;
+        tree->nodes[scope].quants = 1;
+
+        parent = scope;
+        prev = pre;
+    }
+
+    return top;
+}
+
+/* Finishes a list once its last element has been read.
+ *  input:
+ *    tree - the tree.
+ *    list - the list.
+ *    mode - the moves to normalize by.
+ *  output:
+ *    the node that takes the place of the list, or -1 on memory error.
+ */
+static int
+prenex_close (struct prenex_tree * tree, int list, int mode)
+{
+    struct prenex_node * l = tree->nodes + list;
+    int head, scope, v;
+
+    head = l->first;
+    if (head < 0 || l->end < 0)
+        return list;
+
+    if ((mode & PRENEX_AS) && prenex_is_junction (tree, list))
+    {
+        prenex_flatten (tree, list, 0);
+        return list;
+    }
+
+    // Only the arguments of a list are in its span, so a quantifier's
+    // span is that of its scope.
+    scope = tree->nodes[head].next;
+    if (scope < 0 || tree->nodes[scope].next >= 0 || tree->nodes[head].pos >= 0)
+        return list;
+
+    v = sexpr_scope_quant (tree->sc, l->end);
+    if (v < 0)
+        return list;
+
+    l->var = v;
+    l->lo = tree->nodes[scope].lo;
+    l->hi = tree->nodes[scope].hi;
+
+    if ((mode & PRENEX_NQ) && tree->occ_lo[v] < 0)
+    {
+        tree->nodes[scope].next = -1;
+        return scope;
+    }
+
+    // A quantifier may cross any part of its scope.
+    if ((mode & PRENEX_AS) && prenex_is_junction (tree, scope))
+        prenex_flatten (tree, scope, 1);
+
+    if (mode & PRENEX_PR)
+        return prenex_push (tree, list, mode);
+
+    return list;
+}
+
+/* Builds the normalized tree of a sentence in one pass.
+ *  input:
+ *    tree - the tree, whose sentence is resolved.
+ *    mode - the moves to normalize by.
+ *  output:
+ *    the root of the tree, -1 on memory error, or -2 if the sentence is
+ *    malformed.
+ */
+static int
+prenex_build (struct prenex_tree * tree, int mode)
+{
+    unsigned char * sen = tree->sc->sen;
+    int * open;
+    int i, num_open = 0, root = -2, n;
+
+    open = (int *) calloc (tree->sc->len + 1, sizeof (int));
+    CHECK_ALLOC (open, AEC_MEM);
+
+    for (i = 0; i < tree->sc->len && root != AEC_MEM; i++)
+    {
+        if (sen[i] == ' ')
+            continue;
+
+        if (sen[i] == '(')
+        {
+            n = prenex_add_node (tree, -1, i);
+            if (n == AEC_MEM)
+                root = AEC_MEM;
+            open[num_open++] = n;
+            continue;
+        }
+
+        if (sen[i] == ')')
+        {
+            if (num_open == 0)
+                break;
+
+            n = prenex_close (tree, open[--num_open], mode);
+            if (n == AEC_MEM)
+            {
+                root = AEC_MEM;
+                break;
+            }
+        }
+        else
+        {
+            int end = sexpr_scope_term_end (tree->sc, i);
+
+            n = prenex_add_node (tree, i, end);
+            if (n == AEC_MEM)
+            {
+                root = AEC_MEM;
+                break;
+            }
+            i = end - 1;
+        }
+
+        if (num_open > 0)
+        {
+            prenex_append (tree, open[num_open - 1], n);
+        }
+        else
+        {
+            root = n;
+            break;
+        }
+    }
+
+    if (root >= 0 && (i + 1 != tree->sc->len || num_open > 0))
+        root = -2;
+
+    free (open);
+    return root;
+}
+
+/* Appends text to a growing string.
+ *  input:
+ *    out - the string.
+ *    len - the length of the string.
+ *    alloc - the space allocated for the string.
+ *    text - the text to append.
+ *    t_len - the length of text.
+ *  output:
+ *    0 on success, -1 on memory error.
+ */
+static int
+prenex_put (unsigned char ** out, int * len, int * alloc,
+            const unsigned char * text, int t_len)
+{
+    if (*len + t_len + 1 > *alloc)
+    {
+        while (*len + t_len + 1 > *alloc)
+            *alloc *= 2;
+
+        *out = (unsigned char *) realloc (*out, *alloc);
+        CHECK_ALLOC (*out, AEC_MEM);
+    }
+
+    memcpy (*out + *len, text, t_len);
+    *len += t_len;
+    (*out)[*len] = '\0';
+
+    return 0;
+}
+
+/* Writes out a normalized tree.
+ *  The tree is walked with an explicit stack, so that deep sentences do
+ *  not use the native stack.
+ *  input:
+ *    tree - the tree.
+ *    root - the root of the tree.
+ *    mode - the moves to normalize by.
+ *  output:
+ *    the text of the tree, or NULL on memory error.
+ */
+static unsigned char *
+prenex_write (struct prenex_tree * tree, int root, int mode)
+{
+    unsigned char * out, name[32];
+    int * stack, * names;
+    int len = 0, alloc, depth = 0, num_names = 0, n, ret = 0;
+
+    alloc = tree->sc->len + 16;
+    out = (unsigned char *) calloc (alloc, sizeof (char));
+    CHECK_ALLOC (out, NULL);
+
+    stack = (int *) calloc (tree->num_nodes + 1, sizeof (int));
+    CHECK_ALLOC (stack, NULL);
+
+    names = (int *) calloc (tree->sc->len + 1, sizeof (int));
+    CHECK_ALLOC (names, NULL);
+
+    n = root;
+    while (ret == 0)
+    {
+        struct prenex_node * node = tree->nodes + n;
+
+        if (node->pos < 0)
+        {
+            ret = prenex_put (&out, &len, &alloc, "(", 1);
+            if (node->first >= 0)
+            {
+                stack[depth++] = n;
+                n = node->first;
+                continue;
+            }
+
+            ret = (ret == 0) ? prenex_put (&out, &len, &alloc, ")", 1) : ret;
+        }
+        else
+        {
+            int b = tree->sc->binder[node->pos];
+
+            if ((mode & PRENEX_BV) && b >= 0)
+            {
+                // Bound variables are named by their quantifiers, in order.
+                if (b == node->pos)
+                    names[b] = num_names++;
+                sprintf ((char *) name, "#%i", names[b]);
+                ret = prenex_put (&out, &len, &alloc, name,
+                                  strlen ((const char *) name));
+            }
+            else
+            {
+                ret = prenex_put (&out, &len, &alloc, tree->sc->sen + node->pos,
+                                  node->end - node->pos);
+            }
+        }
+
+        // Close every list that this was the last element of.
+        while (ret == 0 && depth > 0 && tree->nodes[n].next < 0)
+        {
+            n = stack[--depth];
+            ret = prenex_put (&out, &len, &alloc, ")", 1);
+        }
+
+        if (ret != 0 || depth == 0)
+            break;
+
+        n = tree->nodes[n].next;
+        ret = prenex_put (&out, &len, &alloc, " ", 1);
+    }
+
+    free (stack);
+    free (names);
+
+    if (ret != 0)
+        return NULL;
+
+    return out;
+}
+
+/* Computes the normal form of a sentence without consulting the cache.
+ *  input:
+ *    sen - the sentence.
+ *    mode - the moves to normalize by.
+ *  output:
+ *    the normal form, or NULL on memory error.
+ */
+static unsigned char *
+prenex_normalize (unsigned char * sen, int mode)
+{
+    struct prenex_tree tree;
+    unsigned char * form;
+    int i, root;
+
+    memset (&tree, 0, sizeof (tree));
+
+    tree.sc = sexpr_scope_init (sen);
+    if (!tree.sc)
+        return NULL;
+
+    tree.occ_lo = (int *) calloc (tree.sc->len + 1, sizeof (int));
+    CHECK_ALLOC (tree.occ_lo, NULL);
+    tree.occ_hi = (int *) calloc (tree.sc->len + 1, sizeof (int));
+    CHECK_ALLOC (tree.occ_hi, NULL);
+
+    for (i = 0; i < tree.sc->len; i++)
+        tree.occ_lo[i] = tree.occ_hi[i] = -1;
+
+    for (i = 0; i < tree.sc->len; i++)
+    {
+        int b = tree.sc->binder[i];
+
+        if (b < 0 || b == i)
+            continue;
+
+        if (tree.occ_lo[b] < 0)
+            tree.occ_lo[b] = i;
+        tree.occ_hi[b] = i;
+    }
+
+    root = prenex_build (&tree, mode);
+    if (root == AEC_MEM)
+        return NULL;
+
+    if (root < 0)
+    {
+        // Leave a malformed sentence as it is.
+        form = (unsigned char *) strdup ((const char *) sen);
+        CHECK_ALLOC (form, NULL);
+    }
+    else
+    {
+        form = prenex_write (&tree, root, mode);
+    }
+
+    free (tree.occ_lo);
+    free (tree.occ_hi);
+    if (tree.nodes)
+        free (tree.nodes);
+    sexpr_scope_destroy (tree.sc);
+
+    return form;
+}
+
+// The normal forms computed most recently, so that a reference used by
+// several lines is only normalized once.
+
+#define PRENEX_CACHE_SIZE 64
+
+struct prenex_memo {
+    int mode;               // The moves the form is taken up to.
+    unsigned int hash;      // The hash of the sentence.
+    unsigned char * sen;    // The sentence, or NULL if the slot is empty.
+    unsigned char * form;   // The normal form of the sentence.
+};
+
+static struct prenex_memo prenex_cache[PRENEX_CACHE_SIZE];
+
+/* Computes the normal form of a sentence up to some quantifier moves.
+ *  Each quantifier is moved as far into its scope as the Prenex laws
+ *  allow, so that two sentences are related by those laws exactly when
+ *  their normal forms are the same.
+ *  input:
+ *    sen - the sentence.
+ *    mode - the moves to normalize by, from PRENEX_PR, PRENEX_NQ,
+ *           PRENEX_BV and PRENEX_AS.
+ *  output:
+ *    a newly allocated normal form, or NULL on memory error.
+ */
+unsigned char *
+sexpr_prenex_form (unsigned char * sen, int mode)
+{
+    struct prenex_memo * memo;
+    unsigned char * form, * ret, * c;
+    unsigned int hash = 2166136261u;
+
+    for (c = sen; *c; c++)
+    {
+        hash ^= *c;
+        hash *= 16777619u;
+    }
+
+    memo = prenex_cache + ((hash ^ mode) & (PRENEX_CACHE_SIZE - 1));
+    if (!memo->sen || memo->mode != mode || memo->hash != hash
+        || strcmp ((const char *) memo->sen, (const char *) sen))
+    {
+        form = prenex_normalize (sen, mode);
+        if (!form)
+            return NULL;
+
+        if (memo->sen)
+        {
+            free (memo->sen);
+            free (memo->form);
+        }
+
+        memo->sen = (unsigned char *) strdup ((const char *) sen);
+        CHECK_ALLOC (memo->sen, NULL);
+        memo->form = form;
+        memo->mode = mode;
+        memo->hash = hash;
+    }
+
+    ret = (unsigned char *) strdup ((const char *) memo->form);
+    CHECK_ALLOC (ret, NULL);
+
+    return ret;
+}
+
+/* Lists the elements of a list of a resolved sentence.
+ *  input:
+ *    sc - the resolved sentence.
+ *    pos - the beginning of the list.
+ *    elems - receives the beginnings of the elements.
+ *  output:
+ *    the number of elements, or -1 if pos is not a list.
+ */
+static int
+prenex_elems (sexpr_scope * sc, int pos, int * elems)
+{
+    int i, end, num = 0;
+
+    if (sc->sen[pos] != '(' || sc->match[pos] < 0)
+        return -1;
+
+    end = sc->match[pos];
+    for (i = pos + 1; i < end; )
+    {
+        if (sc->sen[i] == ' ')
+        {
+            i++;
+            continue;
+        }
+
+        elems[num++] = i;
+        i = sexpr_scope_term_end (sc, i);
+    }
+
+    return num;
+}
+
+/* Determines whether two subterms have the same text.
+ *  input:
+ *    sc_a, a - the first subterm and its resolved sentence.
+ *    sc_b, b - the second subterm and its resolved sentence.
+ *  output:
+ *    1 if they do, 0 otherwise.
+ */
+static int
+prenex_same_text (sexpr_scope * sc_a, int a, sexpr_scope * sc_b, int b)
+{
+    int len_a = sexpr_scope_term_end (sc_a, a) - a;
+    int len_b = sexpr_scope_term_end (sc_b, b) - b;
+
+    return (len_a == len_b && !memcmp (sc_a->sen + a, sc_b->sen + b, len_a));
+}
+
+/* Finds the connective of a conjunction or a disjunction.
+ *  input:
+ *    sc - the resolved sentence.
+ *    pos - the beginning of the subterm.
+ *  output:
+ *    the position of the connective, or -1 if the subterm is neither.
+ */
+static int
+prenex_junction_conn (sexpr_scope * sc, int pos)
+{
+    int c = pos + 1;
+
+    if (sc->sen[pos] != '(' || sc->match[pos] < 0)
+        return -1;
+
+    if (sexpr_scope_term_end (sc, c) - c != S_CL)
+        return -1;
+
+    if (strncmp (sc->sen + c, S_AND, S_CL) && strncmp (sc->sen + c, S_OR, S_CL))
+        return -1;
+
+    return c;
+}
+
+/* Lists the generalities of a junction, with those of the junctions in it
+ * that have the same connective in their place.
+ *  input:
+ *    sc - the resolved sentence.
+ *    pos - the beginning of the junction.
+ *    conn - the connective.
+ *    gens - receives the beginnings of the generalities.
+ *    stack - space for one entry per position of the sentence.
+ *  output:
+ *    the number of generalities, which is one for pos itself if it is not
+ *    a junction of conn.
+ */
+static int
+prenex_flat_gens (sexpr_scope * sc, int pos, const unsigned char * conn,
+                  int * gens, int * stack)
+{
+    int depth = 0, num = 0, n, c, i, num_elems;
+
+    stack[depth++] = pos;
+    while (depth > 0)
+    {
+        n = stack[--depth];
+        c = prenex_junction_conn (sc, n);
+        if (c < 0 || strncmp (sc->sen + c, conn, S_CL))
+        {
+            gens[num++] = n;
+            continue;
+        }
+
+        // Push the generalities in reverse, so that they come off in
+        // order, and leave the connective past the top.
+        num_elems = prenex_elems (sc, n, stack + depth);
+        for (i = 0; i < num_elems / 2; i++)
+        {
+            int tmp = stack[depth + i];
+
+            stack[depth + i] = stack[depth + num_elems - 1 - i];
+            stack[depth + num_elems - 1 - i] = tmp;
+        }
+        depth += num_elems - 1;
+    }
+
+    return num;
+}
+
+/* Determines whether a subterm uses the variable of a quantifier.
+ *  input:
+ *    sc - the resolved sentence.
+ *    pos - the beginning of the subterm.
+ *    var - the position of the variable of the quantifier.
+ *  output:
+ *    1 if it does, 0 otherwise.
+ */
+static int
+prenex_uses (sexpr_scope * sc, int pos, int var)
+{
+    int i, end = sexpr_scope_term_end (sc, pos);
+
+    for (i = pos; i < end; i++)
+    {
+        if (sc->binder[i] == var)
+            return 1;
+    }
+
+    return 0;
+}
+
+/* The pair of sentences of a single Prenex move. */
+struct prenex_step {
+    sexpr_scope * sc_x;     // The sentence with the quantifier outside.
+    sexpr_scope * sc_y;     // The sentence with the quantifier inside.
+    const unsigned char * conn;     // The connective that is crossed.
+    int * x_gens, num_x;    // The generalities of the outer junction of x.
+    int * s_gens, num_s;    // The generalities of the scope of the quantifier.
+    int * y_gens, num_y;    // The generalities of the junction of y.
+    int * r_gens;           // Space for the generalities of a scope of y.
+    int * uses;             // Whether each of s_gens uses the variable.
+    int * stack;            // Space for prenex_flat_gens.
+};
+
+/* Determines whether a quantifier of x moves across some generalities of
+ * its scope to give y, where it keeps the generalities p onwards.
+ *  input:
+ *    st - the pair of sentences.
+ *    k - the index of the quantifier in x_gens.
+ *    p - the index in s_gens of the first generality the quantifier keeps.
+ *    num_r - the number of generalities the quantifier keeps.
+ *  output:
+ *    1 if it does, 0 otherwise.
+ */
+static int
+prenex_pr_keeps (struct prenex_step * st, int k, int p, int num_r)
+{
+    int q = st->x_gens[k], y_q = st->y_gens[k + p];
+    int i, num, y_scope, used = 0;
+
+    for (i = 0; i < st->num_s; i++)
+    {
+        if (i >= p && i < p + num_r)
+            used |= st->uses[i];
+        else if (st->uses[i])
+            return 0;
+    }
+
+    // A null quantifier is moved with Null Quantifier.
+    if (!used)
+        return 0;
+
+    for (i = p + num_r; i < st->num_s; i++)
+    {
+        if (!prenex_same_text (st->sc_x, st->s_gens[i],
+                               st->sc_y, st->y_gens[k + 1 + i - num_r]))
+            return 0;
+    }
+
+    if (sexpr_scope_quant (st->sc_y, y_q) < 0
+        || !prenex_same_text (st->sc_x, q + 1, st->sc_y, y_q + 1))
+        return 0;
+
+    y_scope = st->sc_y->match[y_q + 1] + 2;
+    num = prenex_flat_gens (st->sc_y, y_scope, st->conn, st->r_gens, st->stack);
+    if (num != num_r)
+        return 0;
+
+    for (i = 0; i < num_r; i++)
+    {
+        if (!prenex_same_text (st->sc_x, st->s_gens[p + i],
+                               st->sc_y, st->r_gens[i]))
+            return 0;
+    }
+
+    return 1;
+}
+
+/* Determines whether a quantifier of x moves across some generalities of
+ * its scope, and across nothing else, to give y.
+ *  input:
+ *    st - the pair of sentences, with the generalities of the scope.
+ *    k - the index of the quantifier in x_gens.
+ *  output:
+ *    1 if it does, 0 otherwise.
+ */
+static int
+prenex_pr_move (struct prenex_step * st, int k)
+{
+    int var, num_r, p, i;
+
+    // The quantifier keeps all but the generalities it crosses.
+    num_r = st->num_x + st->num_s - st->num_y;
+    if (num_r < 1 || num_r >= st->num_s)
+        return 0;
+
+    for (i = 0; i < k; i++)
+    {
+        if (!prenex_same_text (st->sc_x, st->x_gens[i], st->sc_y, st->y_gens[i]))
+            return 0;
+    }
+
+    for (i = 1; i < st->num_x - k; i++)
+    {
+        if (!prenex_same_text (st->sc_x, st->x_gens[st->num_x - i],
+                               st->sc_y, st->y_gens[st->num_y - i]))
+            return 0;
+    }
+
+    var = sexpr_scope_quant (st->sc_x, st->x_gens[k]);
+    for (i = 0; i < st->num_s; i++)
+        st->uses[i] = prenex_uses (st->sc_x, st->s_gens[i], var);
+
+    for (p = 0; p + num_r <= st->num_s; p++)
+    {
+        if (p > 0 && !prenex_same_text (st->sc_x, st->s_gens[p - 1],
+                                        st->sc_y, st->y_gens[k + p - 1]))
+            break;
+
+        if (prenex_pr_keeps (st, k, p, num_r))
+            return 1;
+    }
+
+    return 0;
+}
+
+/* Determines whether a single Prenex move takes one subterm to another.
+ *  The quantifier is either the subterm, or one of its generalities.
+ *  input:
+ *    st - the pair of sentences.
+ *    x - the subterm with the quantifier outside.
+ *    y - the subterm with the quantifier inside.
+ *  output:
+ *    1 if it does, 0 otherwise.
+ */
+static int
+prenex_pr_step (struct prenex_step * st, int x, int y)
+{
+    int scope, c, k;
+
+    if (sexpr_scope_quant (st->sc_x, x) >= 0)
+    {
+        scope = st->sc_x->match[x + 1] + 2;
+        c = prenex_junction_conn (st->sc_x, scope);
+        if (c >= 0)
+        {
+            st->conn = st->sc_x->sen + c;
+            st->x_gens[0] = x;
+            st->num_x = 1;
+            st->num_s = prenex_flat_gens (st->sc_x, scope, st->conn,
+                                          st->s_gens, st->stack);
+            st->num_y = prenex_flat_gens (st->sc_y, y, st->conn,
+                                          st->y_gens, st->stack);
+            if (prenex_pr_move (st, 0))
+                return 1;
+        }
+    }
+
+    c = prenex_junction_conn (st->sc_x, x);
+    if (c < 0)
+        return 0;
+
+    st->conn = st->sc_x->sen + c;
+    st->num_x = prenex_flat_gens (st->sc_x, x, st->conn, st->x_gens, st->stack);
+    st->num_y = prenex_flat_gens (st->sc_y, y, st->conn, st->y_gens, st->stack);
+
+    for (k = 0; k < st->num_x; k++)
+    {
+        int q = st->x_gens[k];
+
+        if (sexpr_scope_quant (st->sc_x, q) < 0)
+            continue;
+
+        scope = st->sc_x->match[q + 1] + 2;
+        c = prenex_junction_conn (st->sc_x, scope);
+        if (c < 0 || strncmp (st->sc_x->sen + c, st->conn, S_CL))
+            continue;
+
+        st->num_s = prenex_flat_gens (st->sc_x, scope, st->conn,
+                                      st->s_gens, st->stack);
+        if (prenex_pr_move (st, k))
+            return 1;
+    }
+
+    return 0;
+}
+
+/* Determines whether removing the null quantifiers at the start of one
+ * subterm gives another.
+ *  input:
+ *    sc_x, x - the subterm with the quantifiers, and its resolved sentence.
+ *    sc_y, y - the subterm without them, and its resolved sentence.
+ *  output:
+ *    1 if it does, 0 otherwise.
+ */
+static int
+prenex_nq_step (sexpr_scope * sc_x, int x, sexpr_scope * sc_y, int y)
+{
+    int var, scope;
+
+    for (var = sexpr_scope_quant (sc_x, x); var >= 0;
+         var = sexpr_scope_quant (sc_x, x))
+    {
+        scope = sc_x->match[x + 1] + 2;
+        if (prenex_uses (sc_x, scope, var))
+            return 0;
+
+        x = scope;
+        if (prenex_same_text (sc_x, x, sc_y, y))
+            return 1;
+    }
+
+    return 0;
+}
+
+/* Determines whether two sentences differ by a single quantifier move.
+ *  The pair of subterms that holds every difference is found first, by
+ *  following lists that differ in only one element.  The move may be at
+ *  that pair or at any pair around it.
+ *  input:
+ *    prem - the premise.
+ *    conc - the conclusion, which differs from prem.
+ *    mode - PRENEX_PR to move one quantifier across one conjunction or
+ *           disjunction, or PRENEX_NQ to add or remove the null
+ *           quantifiers in front of one subterm.
+ *  output:
+ *    1 if they do, 0 otherwise, or -1 on memory error.
+ */
+int
+sexpr_prenex_step (unsigned char * prem, unsigned char * conc, int mode)
+{
+    struct prenex_step st, st_rev;
+    sexpr_scope * sc_p, * sc_c;
+    int * path_p, * path_c, * elems_p, * elems_c;
+    int len, depth = 0, p = 0, c = 0, ret = 0;
+
+    sc_p = sexpr_scope_init (prem);
+    if (!sc_p)
+        return AEC_MEM;
+
+    sc_c = sexpr_scope_init (conc);
+    if (!sc_c)
+        return AEC_MEM;
+
+    len = ((sc_p->len > sc_c->len) ? sc_p->len : sc_c->len) + 1;
+
+    path_p = (int *) calloc (len, sizeof (int));
+    CHECK_ALLOC (path_p, AEC_MEM);
+    path_c = (int *) calloc (len, sizeof (int));
+    CHECK_ALLOC (path_c, AEC_MEM);
+    elems_p = (int *) calloc (len, sizeof (int));
+    CHECK_ALLOC (elems_p, AEC_MEM);
+    elems_c = (int *) calloc (len, sizeof (int));
+    CHECK_ALLOC (elems_c, AEC_MEM);
+
+    while (1)
+    {
+        int num_p, num_c, diff, i;
+
+        path_p[depth] = p;
+        path_c[depth++] = c;
+
+        num_p = prenex_elems (sc_p, p, elems_p);
+        num_c = prenex_elems (sc_c, c, elems_c);
+        if (num_p < 0 || num_p != num_c)
+            break;
+
+        diff = -1;
+        for (i = 0; i < num_p; i++)
+        {
+            if (prenex_same_text (sc_p, elems_p[i], sc_c, elems_c[i]))
+                continue;
+
+            diff = (diff == -1) ? i : -2;
+            if (diff == -2)
+                break;
+        }
+
+        if (diff < 0)
+            break;
+
+        p = elems_p[diff];
+        c = elems_c[diff];
+    }
+
+    if (mode == PRENEX_PR)
+    {
+        memset (&st, 0, sizeof (st));
+        st.sc_x = sc_p;
+        st.sc_y = sc_c;
+        st.x_gens = elems_p;
+        st.y_gens = elems_c;
+        st.s_gens = (int *) calloc (len, sizeof (int));
+        CHECK_ALLOC (st.s_gens, AEC_MEM);
+        st.r_gens = (int *) calloc (len, sizeof (int));
+        CHECK_ALLOC (st.r_gens, AEC_MEM);
+        st.uses = (int *) calloc (len, sizeof (int));
+        CHECK_ALLOC (st.uses, AEC_MEM);
+        st.stack = (int *) calloc (len, sizeof (int));
+        CHECK_ALLOC (st.stack, AEC_MEM);
+
+        st_rev = st;
+        st_rev.sc_x = sc_c;
+        st_rev.sc_y = sc_p;
+    }
+
+    while (depth > 0 && !ret)
+    {
+        depth--;
+        p = path_p[depth];
+        c = path_c[depth];
+
+        if (mode == PRENEX_PR)
+            ret = (prenex_pr_step (&st, p, c) || prenex_pr_step (&st_rev, c, p));
+        else
+            ret = (prenex_nq_step (sc_p, p, sc_c, c)
+                   || prenex_nq_step (sc_c, c, sc_p, p));
+    }
+
+    if (mode == PRENEX_PR)
+    {
+        free (st.s_gens);
+        free (st.r_gens);
+        free (st.uses);
+        free (st.stack);
+    }
+
+    free (path_p);
+    free (path_c);
+    free (elems_p);
+    free (elems_c);
+    sexpr_scope_destroy (sc_p);
+    sexpr_scope_destroy (sc_c);
+
+    return ret;
+}
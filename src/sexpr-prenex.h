@@ -0,0 +1,43 @@
+/* Functions for normalizing the quantifiers of sexpr sentences.
+
+   Copyright (C) 2026 The GNU Aris contributors.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SEXPR_PRENEX_H
+#define SEXPR_PRENEX_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include "typedef.h"
+
+// The moves that a normal form is taken up to.
+#define PRENEX_PR   1   // Moving quantifiers across conjunctions and disjunctions.
+#define PRENEX_NQ   2   // Removing null quantifiers.
+#define PRENEX_BV   4   // Renaming bound variables.
+#define PRENEX_AS   8   // Regrouping the generalities next to a quantifier.
+#define PRENEX_RELAXED (PRENEX_PR | PRENEX_NQ | PRENEX_BV | PRENEX_AS)
+
+// Whether pr and nq accept any number of quantifier moves on one line.
+extern int prenex_relaxed;
+
+unsigned char * sexpr_prenex_form (unsigned char * sen, int mode);
+int sexpr_prenex_step (unsigned char * prem, unsigned char * conc, int mode);
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SEXPR_PRENEX_H
@@ -19,7 +19,8 @@
 #include "sexpr-process.h"
 #include "../src/vec.h"
 
-// Boolean rules follow the same structure as equivalence rules.
+// Boolean rules are checked at each site where the sentences differ,
+// as found by sexpr_diff.
 
 char *
 process_bool (unsigned char * conc, vec_t * prems, const char * rule)
@@ -74,84 +75,22 @@ process_bool (unsigned char * conc, vec_t * prems, const char * rule)
   return ret;
 }
 
-char *
-proc_bi (unsigned char * prem, unsigned char * conc)
+/* Checks Boolean Identity where two sentences differ.
+ *  input:
+ *    prem, conc - the differing subterms of the premise and conclusion.
+ *  output:
+ *    CORRECT if the longer one reduces to the other,
+ *    an error message otherwise, or NULL on memory error.
+ */
+static char *
+site_bi (unsigned char * prem, unsigned char * conc)
 {
-  // Standard long-short sentence setup.
-
   unsigned char * ln_sen, * sh_sen;
-  int l_len;
 
   sen_put_len (prem, conc, &sh_sen, &ln_sen);
-  l_len = strlen (ln_sen);
-
-  int i;
-  i = find_difference (ln_sen, sh_sen);
-  if (i == -1)
-    return NO_DIFFERENCE;
-
-  int li, si;
-
-  // Rollback sh_sen to just before the first o-paren.
-  si = li = i;
-  if (sh_sen[si] == '(')
-    {
-      si--;
-      if (si < 0)
-    return _("Boolean Identity constructed incorrectly.");
-    }
-  else if (si > 0
-       && (!strncmp (sh_sen + si - 1, S_AND, S_CL)
-           || !strncmp (sh_sen + si - 1, S_OR, S_CL)
-           || !strncmp (sh_sen + si - 1, S_CON, S_CL)
-           || !strncmp (sh_sen + si - 1, S_BIC, S_CL)
-           || !strncmp (sh_sen + si - 1, S_NOT, S_NL)))
-    {
-      while (sh_sen[si] != '(')
-    si--;
-      si--;
-    }
-
-  si = find_unmatched_o_paren (sh_sen, si);
-  if (si == -1)
-    {
-      // This is the entire sentence.
-      li = 0;
-    }
-  else
-    {
-      if (ln_sen[li] != '(')
-    {
-      li = find_unmatched_o_paren (ln_sen, li);
-      if (li == -1)
-        return _("There must be a connective in the longer sentence.");
-    }
-
-      int ret_chk;
-      ret_chk = sexpr_find_unmatched (ln_sen, sh_sen, &li, &si);
-      if (ret_chk == AEC_MEM)
-    return NULL;
-
-      if (li < 0)
-    return _("Boolean Identity constructed incorrectly.");
-
-      if (si < 0)
-    {
-      // The equivalence uses all of sh_sen.
-      // this means that li needs to be zero.
-      li = 0;
-    }
-    }
 
-  if (ln_sen[li] != '(')
-    return _("Boolean Identity constructed incorrectly.");
-
-  int tmp_pos;
-  unsigned char * tmp_str;
-
-  tmp_pos = parse_parens (ln_sen, li, &tmp_str);
-  if (tmp_pos == AEC_MEM)
-    return NULL;
+  if (ln_sen[0] != '(')
+    return _("There must be a connective in the longer sentence.");
 
   int ftc;
   unsigned char * lsen, * rsen, conn[S_CL + 1];
@@ -159,10 +98,9 @@ proc_bi (unsigned char * prem, unsigned char * conc)
   conn[0] = '\0';
   lsen = rsen = NULL;
 
-  ftc = sexpr_find_top_connective (tmp_str, conn, &lsen, &rsen);
+  ftc = sexpr_find_top_connective (ln_sen, conn, &lsen, &rsen);
   if (ftc == AEC_MEM)
     return NULL;
-  free (tmp_str);
 
   if (ftc < 0)
     {
@@ -210,24 +148,16 @@ with a disjunction.");
     }
   free (good_side);
 
-  unsigned char * oth_sen;
-  int alloc_size;
-
-  alloc_size = l_len - 2 * S_CL - 4;
-  oth_sen = construct_other (ln_sen, li, tmp_pos + 1, alloc_size, "%s", bad_side);
-  if (!oth_sen)
-    return NULL;
-
   char * ret_str;
 
   if (ln_sen == conc)
-    ret_str = proc_bi (sh_sen, oth_sen);
+    ret_str = proc_bi (sh_sen, bad_side);
   else
-    ret_str = proc_bi (oth_sen, sh_sen);
+    ret_str = proc_bi (bad_side, sh_sen);
+  free (bad_side);
 
   if (!ret_str)
     return NULL;
-  free (oth_sen);
 
   if (ret_str == NO_DIFFERENCE || ret_str == CORRECT)
     return CORRECT;
@@ -236,30 +166,28 @@ with a disjunction.");
 }
 
 char *
-proc_bd (unsigned char * prem, unsigned char * conc)
+proc_bi (unsigned char * prem, unsigned char * conc)
+{
+  return sexpr_check_sites (prem, conc, site_bi);
+}
+
+/* Checks Boolean Dominance where two sentences differ.
+ *  input:
+ *    prem, conc - the differing subterms of the premise and conclusion.
+ *  output:
+ *    CORRECT if the longer one is dominated by the other,
+ *    an error message otherwise, or NULL on memory error.
+ */
+static char *
+site_bd (unsigned char * prem, unsigned char * conc)
 {
   unsigned char * ln_sen, * sh_sen;
-  int l_len;
 
   sen_put_len (prem, conc, &sh_sen, &ln_sen);
-  l_len = strlen (ln_sen);
 
-  int i;
-  i = find_difference (ln_sen, sh_sen);
-  if (i == -1)
-    return NO_DIFFERENCE;
-
-  if (ln_sen[i] != '(')
+  if (ln_sen[0] != '(')
     return _("There must be a connective at the difference.");
 
-  int tmp_pos, t_len;
-  unsigned char * tmp_str;
-
-  tmp_pos = parse_parens (ln_sen, i, &tmp_str);
-  if (tmp_pos == AEC_MEM)
-    return NULL;
-  t_len = strlen (tmp_str);
-
   int gg;
   vec_t * gens;
   unsigned char conn[S_CL + 1];
@@ -269,10 +197,9 @@ proc_bd (unsigned char * prem, unsigned char * conc)
   if (!gens)
     return NULL;
 
-  gg = sexpr_get_generalities (tmp_str, conn, gens);
+  gg = sexpr_get_generalities (ln_sen, conn, gens);
   if (gg == AEC_MEM)
     return NULL;
-  free (tmp_str);
 
   if (gg == 1)
     {
@@ -314,24 +241,15 @@ proc_bd (unsigned char * prem, unsigned char * conc)
   if (j == gg)
     return _("There must be a tautology or a contradiction within the difference.");
 
-  unsigned char * oth_sen;
-  int alloc_size;
-  alloc_size = l_len - t_len + S_CL;
-
-  oth_sen = construct_other (ln_sen, i, tmp_pos + 1, alloc_size, "%s", sym);
-  if (!oth_sen)
-    return NULL;
-
   char * ret_str;
 
   if (ln_sen == conc)
-    ret_str = proc_bd (sh_sen, oth_sen);
+    ret_str = proc_bd (sh_sen, sym);
   else
-    ret_str = proc_bd (oth_sen, sh_sen);
+    ret_str = proc_bd (sym, sh_sen);
 
   if (!ret_str)
     return NULL;
-  free (oth_sen);
 
   if (ret_str == NO_DIFFERENCE || ret_str == CORRECT)
     return CORRECT;
@@ -340,39 +258,37 @@ proc_bd (unsigned char * prem, unsigned char * conc)
 }
 
 char *
-proc_bn (unsigned char * prem, unsigned char * conc)
+proc_bd (unsigned char * prem, unsigned char * conc)
+{
+  return sexpr_check_sites (prem, conc, site_bd);
+}
+
+/* Checks Boolean Negation where two sentences differ.
+ *  input:
+ *    prem, conc - the differing subterms of the premise and conclusion.
+ *  output:
+ *    CORRECT if the longer one is a sentence connected with its negation,
+ *    an error message otherwise, or NULL on memory error.
+ */
+static char *
+site_bn (unsigned char * prem, unsigned char * conc)
 {
   unsigned char * ln_sen, * sh_sen;
-  int l_len;
 
   sen_put_len (prem, conc, &sh_sen, &ln_sen);
-  l_len = strlen (ln_sen);
-
-  int i;
-  i = find_difference (ln_sen, sh_sen);
-  if (i == -1)
-    return NO_DIFFERENCE;
 
-  if (ln_sen[i] != '(' ||
-      (strncmp (ln_sen + i + 1, S_AND, S_CL) && strncmp (ln_sen + i + 1, S_OR, S_CL)))
+  if (ln_sen[0] != '(' ||
+      (strncmp (ln_sen + 1, S_AND, S_CL) && strncmp (ln_sen + 1, S_OR, S_CL)))
     return _("There must be a connective at the difference.");
 
-  int tmp_pos;
-  unsigned char * tmp_str;
-
-  tmp_pos = parse_parens (ln_sen, i, &tmp_str);
-  if (tmp_pos == AEC_MEM)
-    return NULL;
-
   int ftc;
   unsigned char * lsen, * rsen;
   unsigned char conn[S_CL + 1];
   conn[0] = '\0';
 
-  ftc = sexpr_find_top_connective (tmp_str, conn, &lsen, &rsen);
+  ftc = sexpr_find_top_connective (ln_sen, conn, &lsen, &rsen);
   if (ftc == AEC_MEM)
     return NULL;
-  free (tmp_str);
 
   if (ftc < 0)
     {
@@ -382,13 +298,20 @@ proc_bn (unsigned char * prem, unsigned char * conc)
       return _("There must be only two connected parts.");
     }
 
-  if (!sexpr_not_check (rsen) || strcmp (sexpr_add_not (lsen), rsen))
-    {
-      free (lsen);
-      free (rsen);
+  unsigned char * not_lsen;
+  int cmp;
 
-      return _("The second part must be the negation of the first.");
-    }
+  not_lsen = sexpr_add_not (lsen);
+  if (!not_lsen)
+    return NULL;
+
+  cmp = sexpr_not_check (rsen) && !strcmp (not_lsen, rsen);
+  free (not_lsen);
+  free (lsen);
+  free (rsen);
+
+  if (!cmp)
+    return _("The second part must be the negation of the first.");
 
   unsigned char sym[S_CL + 1];
   if (!strcmp (conn, S_AND))
@@ -397,29 +320,16 @@ proc_bn (unsigned char * prem, unsigned char * conc)
     strncpy (sym, S_TAU, S_CL);
   sym[S_CL] = '\0';
 
-  free (rsen);
-
-  unsigned char * oth_sen;
-  int alloc_size;
-
-  alloc_size = l_len - 2 * strlen (lsen) - S_NL - 7;
-  free (lsen);
-
-  oth_sen = construct_other (ln_sen, i, tmp_pos + 1, alloc_size, "%s", sym);
-  if (!oth_sen)
-    return NULL;
-
   char * ret_str;
 
   if (ln_sen == conc)
-    ret_str = proc_bn (sh_sen, oth_sen);
+    ret_str = proc_bn (sh_sen, sym);
   else
-    ret_str = proc_bn (oth_sen, sh_sen);
+    ret_str = proc_bn (sym, sh_sen);
 
   if (!ret_str)
     return NULL;
 
-  free (oth_sen);
   if (ret_str == NO_DIFFERENCE || ret_str == CORRECT)
     return CORRECT;
 
@@ -427,33 +337,33 @@ proc_bn (unsigned char * prem, unsigned char * conc)
 }
 
 char *
-proc_sn (unsigned char * prem, unsigned char * conc)
+proc_bn (unsigned char * prem, unsigned char * conc)
+{
+  return sexpr_check_sites (prem, conc, site_bn);
+}
+
+/* Checks Symbol Negation where two sentences differ.
+ *  input:
+ *    prem, conc - the differing subterms of the premise and conclusion.
+ *  output:
+ *    CORRECT if the longer one is the negation of the other's opposite,
+ *    an error message otherwise, or NULL on memory error.
+ */
+static char *
+site_sn (unsigned char * prem, unsigned char * conc)
 {
   unsigned char * ln_sen, * sh_sen;
-  int l_len;
 
   sen_put_len (prem, conc, &sh_sen, &ln_sen);
-  l_len = strlen (ln_sen);
-
-  int i;
-  i = find_difference (ln_sen, sh_sen);
-  if (i == -1)
-    return NO_DIFFERENCE;
 
-  if (ln_sen[i] != '(' || strncmp (ln_sen + i + 1, S_NOT, S_NL))
+  if (ln_sen[0] != '(' || strncmp (ln_sen + 1, S_NOT, S_NL))
     return _("There must be a negation in one sentence.");
 
-  int tmp_pos;
-  unsigned char * tmp_str, * elm_str;
+  unsigned char * elm_str;
 
-  tmp_pos = parse_parens (ln_sen, i, &tmp_str);
-  if (tmp_pos == AEC_MEM)
-    return NULL;
-
-  elm_str = sexpr_elim_not (tmp_str);
+  elm_str = sexpr_elim_not (ln_sen);
   if (!elm_str)
     return NULL;
-  free (tmp_str);
 
   if (strcmp (elm_str, S_CTR) && strcmp (elm_str, S_TAU))
     {
@@ -469,21 +379,12 @@ proc_sn (unsigned char * prem, unsigned char * conc)
   sym[S_CL] = '\0';
   free (elm_str);
 
-  unsigned char * oth_sen;
-  int alloc_size;
-
-  alloc_size = l_len - S_NL - 3;
-  oth_sen = construct_other (ln_sen, i, tmp_pos + 1, alloc_size, "%s", sym);
-  if (!oth_sen)
-    return NULL;
-
   char * ret_str;
 
   if (ln_sen == conc)
-    ret_str = proc_sn (sh_sen, oth_sen);
+    ret_str = proc_sn (sh_sen, sym);
   else
-    ret_str = proc_sn (oth_sen, sh_sen);
-  free (oth_sen);
+    ret_str = proc_sn (sym, sh_sen);
 
   if (!ret_str)
     return NULL;
@@ -493,3 +394,9 @@ proc_sn (unsigned char * prem, unsigned char * conc)
 
   return _("Symbol Negation constructed incorrectly.");
 }
+
+char *
+proc_sn (unsigned char * prem, unsigned char * conc)
+{
+  return sexpr_check_sites (prem, conc, site_sn);
+}
@@ -23,19 +23,18 @@
  *    CORRECT if the evaluation checks out, or an error message otherwise.
  */
 
-/* All equivalence functions (except proc_co and proc_id) have a similar structure:
- *  First, determine some values based on the premise and conclusion (usually strlen).
- *  Use these values to determine which sentence is which.
- *  Find difference (i set to this difference), returning NO_DIFFERENCE if i == -1.
- *  Calculate the desired offset.
- *  Parse parens to get the working scope.
- *  From this, get the necessary parts.
- *  Using these, construct what should be the other sentence.
- *  run recursion, check for NO_DIFFERENCE or CORRECT.
- *  return generic error otherwise.
+/* Implication, DeMorgan, Distribution, Equivalence, Double Negation,
+ * Exportation and Subsumption are checked by rewriting the sentences with
+ * the patterns of their rules, which are listed in sexpr-rewrite.c.
+ */
+
+/* Association is checked at each site where the sentences differ, as found
+ * by sexpr_diff.  At each site, the grouping is taken out of the longer
+ * sentence, and the result is checked against the other one.
  */
 
 #include "sexpr-process.h"
+#include "sexpr-rewrite.h"
 #include "../src/vec.h"
 
 enum {
@@ -43,193 +42,403 @@ enum {
     MODE_ID
 };
 
-/*
- * mode - 0 for commutativity, 1 for idempotence.
- * In Idempotence, sen_0 is the larger sentence, sen_1 the shorter.
+// A sexpr sentence, with what is needed to compare its parts in place.
+struct sen_view {
+    const unsigned char * str;    // The sentence.
+    int len;                      // The length of the sentence.
+    int * match;                  // The parenthesis matches of the sentence.
+    unsigned long long * hash;    // The hash of each prefix of the sentence.
+    unsigned long long * pow;     // The powers of the hash base.
+};
+
+#define SEN_VIEW_BASE 1000003ULL
+
+/* Initializes a view of a sexpr sentence.
+ *  input:
+ *    v - the view to initialize.
+ *    str - the sentence.
+ *  output:
+ *    0 on success, -1 on memory error.
  */
-int
-recurse_mode (unsigned char * sen_0, unsigned char * sen_1, int mode)
+static int
+sen_view_init (struct sen_view * v, const unsigned char * str)
 {
-    if (!strcmp (sen_0, sen_1))
-        return -3;
+    int i;
 
-    int gg_0, gg_1;
-    vec_t * gens_0, * gens_1;
-    int con_0, con_1;
+    v->str = str;
+    v->len = strlen ((const char *) str);
 
-    gens_0 = init_vec (sizeof (char *));
-    if (!gens_0)
+    v->match = match_parens (str, v->len);
+    if (!v->match)
         return AEC_MEM;
 
-    gens_1 = init_vec (sizeof (char *));
-    if (!gens_1)
-        return AEC_MEM;
+    v->hash = (unsigned long long *) calloc (v->len + 1, sizeof (unsigned long long));
+    CHECK_ALLOC (v->hash, AEC_MEM);
 
-    unsigned char conn_0[S_CL + 1], conn_1[S_CL + 1];
+    v->pow = (unsigned long long *) calloc (v->len + 1, sizeof (unsigned long long));
+    CHECK_ALLOC (v->pow, AEC_MEM);
 
-    conn_0[0] = '\0';
-    conn_1[0] = '\0';
+    v->pow[0] = 1;
+    for (i = 0; i < v->len; i++)
+    {
+        v->hash[i + 1] = v->hash[i] * SEN_VIEW_BASE + str[i];
+        v->pow[i + 1] = v->pow[i] * SEN_VIEW_BASE;
+    }
 
-    gg_0 = sexpr_get_generalities (sen_0, conn_0, gens_0);
-    if (gg_0 == AEC_MEM)
-        return AEC_MEM;
+    return 0;
+}
 
-    gg_1 = sexpr_get_generalities (sen_1, conn_1, gens_1);
-    if (gg_1 == AEC_MEM)
-        return AEC_MEM;
+/* Destroys a view of a sexpr sentence.
+ *  input:
+ *    v - the view to destroy.
+ *  output:
+ *    none.
+ */
+static void
+sen_view_destroy (struct sen_view * v)
+{
+    free (v->match);
+    free (v->hash);
+    free (v->pow);
+}
+
+/* Determines whether two spans of sentences are the same.
+ *  The hashes of the spans are compared first, so that different spans
+ *  are told apart without reading them.
+ *  input:
+ *    v0, v1 - the views of the sentences.
+ *    s0, s1 - the spans, as a beginning and an end.
+ *  output:
+ *    1 if the spans are the same, 0 otherwise.
+ */
+static int
+span_equal (struct sen_view * v0, const int * s0, struct sen_view * v1, const int * s1)
+{
+    int len = s0[1] - s0[0];
+    unsigned long long h0, h1;
+
+    if (len != s1[1] - s1[0])
+        return 0;
+
+    h0 = v0->hash[s0[1]] - v0->hash[s0[0]] * v0->pow[len];
+    h1 = v1->hash[s1[1]] - v1->hash[s1[0]] * v1->pow[len];
+    if (h0 != h1)
+        return 0;
+
+    return !memcmp (v0->str + s0[0], v1->str + s1[0], len);
+}
+
+/* Gets a sentence part from a span of a sexpr, as sexpr_get_part does.
+ *  input:
+ *    v - the view of the sentence.
+ *    pos - the position of the part.
+ *    end - the end of the span.
+ *    part - receives the part, or a beginning of -1 if there is none.
+ *  output:
+ *    the end of the part.
+ */
+static int
+span_get_part (struct sen_view * v, int pos, int end, int * part)
+{
+    part[0] = -1;
+    part[1] = -1;
 
-    if (mode == MODE_CO)
+    if (pos >= end)
     {
-        if (gg_0 != gg_1)
-        {
-            destroy_str_vec (gens_0); destroy_str_vec (gens_1);
-            return -2;
-        }
+        part[0] = part[1] = end;
+        return end;
     }
-    else
+
+    if (v->str[pos] == '(')
     {
-        if (gg_0 < gg_1)
-        {
-            destroy_str_vec (gens_0); destroy_str_vec (gens_1);
-            return -2;
-        }
+        part[0] = pos;
+        part[1] = (v->match[pos] >= 0 && v->match[pos] < end) ? v->match[pos] + 1 : end;
+        return part[1];
     }
 
-    // If the larger sentence has no top connective.
-    if (gg_0 == 1)
-    {
-        destroy_str_vec (gens_0); destroy_str_vec (gens_1);
+    if (v->str[pos] == ' ')
+        return pos + 1;
+
+    part[0] = pos;
+    while (pos < end && v->str[pos] != ' ' && v->str[pos] != ')')
+        pos++;
+    part[1] = pos;
+
+    return pos;
+}
 
-        // If only one generality, there is either a negation or quantifier.
+/* Gets the generalities of a span of a sexpr, as sexpr_get_generalities does.
+ *  input:
+ *    v - the view of the sentence.
+ *    span - the span.
+ *    conn - receives the connective, if there is one.
+ *    gens - receives the span of each generality.
+ *  output:
+ *    the number of generalities, or -1 on memory error.
+ */
+static int
+span_get_generalities (struct sen_view * v, const int * span,
+                       unsigned char * conn, vec_t * gens)
+{
+    int car[2], part[2];
+    int pos, car_len;
 
-        if (sen_0[0] != '(' || sen_1[0] != '(')
-            return -2;
+    conn[0] = '\0';
+    vec_clear (gens);
 
-        int pos0, pos1;
-        unsigned char * car_0, * car_1, * cdr_0, * cdr_1;
+    pos = (span[0] < span[1] && v->str[span[0]] == '(') ? span[0] + 1 : span[0];
+    pos = span_get_part (v, pos, span[1], car);
+    pos++;
 
-        pos0 = sexpr_str_car_cdr (sen_0, &car_0, &cdr_0);
-        if (pos0 == AEC_MEM)
+    while (pos < span[1])
+    {
+        pos = span_get_part (v, pos, span[1], part);
+        if (part[0] >= 0 && vec_add_obj (gens, part) < 0)
             return AEC_MEM;
+        pos++;
+    }
 
-        pos1 = sexpr_str_car_cdr (sen_1, &car_1, &cdr_1);
-        if (pos1 == AEC_MEM)
+    if (gens->num_stuff == 0)
+    {
+        if (vec_add_obj (gens, (car[0] < 0) ? span : car) < 0)
             return AEC_MEM;
+        return 1;
+    }
 
-        // Check for a negation.
-        if (!strcmp (car_0, S_NOT) && !strcmp (car_1, S_NOT))
-        {
-            free (car_0); free (car_1);
-            // Eliminate the negation, and continue.
+    car_len = car[1] - car[0];
+    if (car[0] < 0 || v->str[car[0]] == '(' || car_len < S_CL
+        || !IS_SBIN_CONN ((const char *) v->str + car[0]))
+    {
+        vec_clear (gens);
+        if (vec_add_obj (gens, span) < 0)
+            return AEC_MEM;
+        return 1;
+    }
 
-            int ret;
-            ret = recurse_mode (cdr_0, cdr_1, mode);
-            if (ret == AEC_MEM)
-                return AEC_MEM;
+    strncpy (conn, v->str + car[0], S_CL);
+    conn[S_CL] = '\0';
 
-            free (cdr_0); free(cdr_1);
+    return gens->num_stuff;
+}
 
-            return ret;
-        }
+/* Compares the generalities of two spans, as vec_str_cmp and vec_str_sub do.
+ *  input:
+ *    v0, v1 - the views of the sentences.
+ *    gens_0, gens_1 - the generalities.
+ *    mode - MODE_CO to check that they are the same up to order, MODE_ID to
+ *           check that gens_0 has the same generalities as gens_1.
+ *  output:
+ *    0 if they match, -2 if they don't, or -1 on memory error.
+ */
+static int
+span_gens_cmp (struct sen_view * v0, vec_t * gens_0,
+               struct sen_view * v1, vec_t * gens_1, int mode)
+{
+    int i, j, ret = 0;
+    short * check;
 
-        // Check for a quantifier.
-        if (!strcmp (car_0, car_1))
+    check = (short *) calloc (gens_1->num_stuff + 1, sizeof (short));
+    CHECK_ALLOC (check, AEC_MEM);
+
+    for (i = 0; i < gens_0->num_stuff && ret == 0; i++)
+    {
+        for (j = 0; j < gens_1->num_stuff; j++)
         {
-            // Eliminate the quantifier and continue.
-            if (strncmp (car_0 + 1, S_UNV, S_CL)
-                && strncmp (car_0 + 1, S_EXL, S_CL))
+            if (mode == MODE_CO && check[j])
+                continue;
+
+            if (span_equal (v0, vec_nth (gens_0, i), v1, vec_nth (gens_1, j)))
             {
-                free (car_0); free (car_1);
-                free (cdr_0); free(cdr_1);
-                return -2;
+                check[j] = 1;
+                break;
             }
+        }
 
-            free (car_0); free (car_1);
+        if (j == gens_1->num_stuff)
+            ret = -2;
+    }
 
-            int cmp;
-            cmp = recurse_mode (cdr_0, cdr_1, mode);
-            if (cmp == AEC_MEM)
-                return AEC_MEM;
+    for (j = 0; j < gens_1->num_stuff && ret == 0; j++)
+    {
+        if (!check[j])
+            ret = -2;
+    }
 
-            free (cdr_0); free(cdr_1);
+    free (check);
+    return ret;
+}
 
-            return cmp;
-        }
+/* Compares two sentences for commutativity or idempotence.
+ *  The sentences are compared in place from an explicit stack of pairs of
+ *  spans, so that deeply nested sentences neither copy their parts at
+ *  each level nor use the native stack.
+ *  input:
+ *    sen_0 - the first sentence, the larger one for idempotence.
+ *    sen_1 - the second sentence, the shorter one for idempotence.
+ *    mode - MODE_CO for commutativity, MODE_ID for idempotence.
+ *  output:
+ *    0 if the sentences match, -2 if they don't, -3 if they are the same,
+ *    or -1 on memory error.
+ */
+int
+recurse_mode (unsigned char * sen_0, unsigned char * sen_1, int mode)
+{
+    struct sen_view v0, v1;
+    vec_t * pairs, * gens_0, * gens_1;
+    int ret = 0;
 
-        free (car_0); free(car_1);
-        free (cdr_0); free(cdr_1);
+    if (sen_view_init (&v0, sen_0) == AEC_MEM
+        || sen_view_init (&v1, sen_1) == AEC_MEM)
+        return AEC_MEM;
 
-        return -2;
-    }
+    // Each pair holds a span of sen_0, then a span of sen_1.
+    pairs = init_vec (4 * sizeof (int));
+    if (!pairs)
+        return AEC_MEM;
 
-    /* The connectives only need to be the same if mode == 1 */
+    gens_0 = init_vec (2 * sizeof (int));
+    if (!gens_0)
+        return AEC_MEM;
 
-    con_0 = 1;
-    if (strcmp (conn_0, S_AND) && strcmp (conn_0, S_OR))
-        con_0 = 0;
+    gens_1 = init_vec (2 * sizeof (int));
+    if (!gens_1)
+        return AEC_MEM;
 
-    con_1 = 1;
-    if (strcmp (conn_1, S_AND) && strcmp (conn_1, S_OR))
-    {
-        if (!(mode == MODE_ID && conn_1[0] == '\0'))
-            con_1 = 0;
-    }
+    int pair[4] = { 0, v0.len, 0, v1.len };
+    if (vec_add_obj (pairs, pair) < 0)
+        return AEC_MEM;
 
-    if ((con_0 && !con_1) || (!con_0 && con_1))
+    while (pairs->num_stuff > 0 && ret == 0)
     {
-        destroy_str_vec (gens_0); destroy_str_vec (gens_1);
-        return -2;
-    }
+        int gg_0, gg_1, con_0, con_1, i;
+        unsigned char conn_0[S_CL + 1], conn_1[S_CL + 1];
+        int * span_0, * span_1;
 
-    if (con_0 && con_1)
-    {
-        int cmp;
-        if (mode == MODE_CO)
-            cmp = vec_str_cmp (gens_0, gens_1);
-        else
-            cmp = vec_str_sub (gens_1, gens_0);
+        memcpy (pair, vec_nth (pairs, pairs->num_stuff - 1), sizeof (pair));
+        vec_pop_obj (pairs);
+        span_0 = pair;
+        span_1 = pair + 2;
+
+        if (span_equal (&v0, span_0, &v1, span_1))
+        {
+            ret = -3;
+            break;
+        }
+
+        gg_0 = span_get_generalities (&v0, span_0, conn_0, gens_0);
+        if (gg_0 == AEC_MEM)
+            return AEC_MEM;
 
-        if (cmp == AEC_MEM)
+        gg_1 = span_get_generalities (&v1, span_1, conn_1, gens_1);
+        if (gg_1 == AEC_MEM)
             return AEC_MEM;
 
-        if (cmp == 0)
+        if ((mode == MODE_CO && gg_0 != gg_1) || (mode != MODE_CO && gg_0 < gg_1))
         {
-            destroy_str_vec (gens_0); destroy_str_vec (gens_1);
-            return 0;
+            ret = -2;
+            break;
         }
-        else if (mode == MODE_ID && gg_0 != gg_1)
+
+        // If the larger sentence has no top connective.
+        if (gg_0 == 1)
         {
-            destroy_str_vec (gens_0); destroy_str_vec (gens_1);
-            return -2;
-        }
-    }
+            // If only one generality, there is either a negation or quantifier.
+            int car_0[2], car_1[2], cdr_0[2], cdr_1[2];
+            int car_len;
 
-    int ret, i;
+            if (span_0[0] == span_0[1] || v0.str[span_0[0]] != '('
+                || span_1[0] == span_1[1] || v1.str[span_1[0]] != '(')
+            {
+                ret = -2;
+                break;
+            }
 
-    for (i = 0; i < gens_0->num_stuff; i++)
-    {
-        unsigned char * cur_0, * cur_1;
+            span_get_part (&v0, span_get_part (&v0, span_0[0] + 1, span_0[1], car_0) + 1,
+                           span_0[1], cdr_0);
+            span_get_part (&v1, span_get_part (&v1, span_1[0] + 1, span_1[1], car_1) + 1,
+                           span_1[1], cdr_1);
+
+            if (car_0[0] < 0 || car_1[0] < 0 || cdr_0[0] < 0 || cdr_1[0] < 0
+                || !span_equal (&v0, car_0, &v1, car_1))
+            {
+                ret = -2;
+                break;
+            }
 
-        cur_0 = vec_str_nth (gens_0, i);
-        cur_1 = vec_str_nth (gens_1, i);
+            // Check for a negation or a quantifier, and eliminate it.
+            car_len = car_0[1] - car_0[0];
+            if (!(car_len == S_CL && !strncmp (v0.str + car_0[0], S_NOT, S_CL))
+                && !(car_len > S_CL && (!strncmp (v0.str + car_0[0] + 1, S_UNV, S_CL)
+                                        || !strncmp (v0.str + car_0[0] + 1, S_EXL, S_CL))))
+            {
+                ret = -2;
+                break;
+            }
 
-        if (!strcmp (cur_0, cur_1))
+            memcpy (pair, cdr_0, sizeof (cdr_0));
+            memcpy (pair + 2, cdr_1, sizeof (cdr_1));
+            if (vec_add_obj (pairs, pair) < 0)
+                return AEC_MEM;
             continue;
+        }
 
-        ret = recurse_mode (cur_0, cur_1, mode);
-        if (ret == AEC_MEM)
-            return AEC_MEM;
+        /* The connectives only need to be the same if mode == 1 */
+
+        con_0 = (!strcmp (conn_0, S_AND) || !strcmp (conn_0, S_OR));
+        con_1 = (!strcmp (conn_1, S_AND) || !strcmp (conn_1, S_OR)
+                 || (mode == MODE_ID && conn_1[0] == '\0'));
+
+        if (con_0 != con_1)
+        {
+            ret = -2;
+            break;
+        }
+
+        if (con_0 && con_1)
+        {
+            int cmp;
+
+            cmp = span_gens_cmp (&v0, gens_0, &v1, gens_1, mode);
+            if (cmp == AEC_MEM)
+                return AEC_MEM;
+
+            if (cmp == 0)
+                continue;
+
+            if (mode == MODE_ID && gg_0 != gg_1)
+            {
+                ret = -2;
+                break;
+            }
+        }
+
+        if (gens_1->num_stuff < gens_0->num_stuff)
+        {
+            ret = -2;
+            break;
+        }
 
-        if (ret != 0)
+        // Compare the generalities from first to last.
+        for (i = gens_0->num_stuff - 1; i >= 0; i--)
         {
-            destroy_str_vec (gens_0); destroy_str_vec (gens_1);
-            return ret;
+            memcpy (pair, vec_nth (gens_0, i), 2 * sizeof (int));
+            memcpy (pair + 2, vec_nth (gens_1, i), 2 * sizeof (int));
+
+            if (span_equal (&v0, pair, &v1, pair + 2))
+                continue;
+
+            if (vec_add_obj (pairs, pair) < 0)
+                return AEC_MEM;
         }
     }
 
-    destroy_str_vec (gens_0); destroy_str_vec (gens_1);
+    destroy_vec (gens_1);
+    destroy_vec (gens_0);
+    destroy_vec (pairs);
+    sen_view_destroy (&v1);
+    sen_view_destroy (&v0);
 
-    return 0;
+    return ret;
 }
 
 char *
@@ -254,7 +463,7 @@ process_equivalence (unsigned char * conc, vec_t * prems, const char * rule)
         if (prems->num_stuff != 1)
             return _("DeMorgan requires one (1) reference.");
 
-        ret = proc_dm (prem, conc, -1);
+        ret = proc_dm (prem, conc);
         if (!ret)
             return NULL;
     }
@@ -294,7 +503,7 @@ process_equivalence (unsigned char * conc, vec_t * prems, const char * rule)
         if (prems->num_stuff != 1)
             return _("Distribution requires one (1) reference.");
 
-        ret = proc_dt (prem, conc, -1);
+        ret = proc_dt (prem, conc);
         if (!ret)
             return NULL;
     } /* End of distribution. */
@@ -342,1168 +551,245 @@ process_equivalence (unsigned char * conc, vec_t * prems, const char * rule)
     return ret;
 }
 
+/* Checks an equivalence rule by rewriting the differences between two sentences.
+ *  input:
+ *    prem - the premise.
+ *    conc - the conclusion.
+ *    rule - the abbreviation of the rule, as in sexpr-rewrite.c.
+ *    err - the message to return if the sentences are not equivalent.
+ *  output:
+ *    CORRECT if the sentences are equivalent by rule, NO_DIFFERENCE if they
+ *    are the same, err if they are not, or NULL on memory error.
+ */
+static char *
+proc_rewrite (unsigned char * prem, unsigned char * conc, const char * rule,
+              char * err)
+{
+    int ret;
+
+    if (!strcmp (prem, conc))
+        return NO_DIFFERENCE;
+
+    ret = sexpr_rewrite_equiv (prem, conc, rule);
+    if (ret == AEC_MEM)
+        return NULL;
+
+    return ret ? CORRECT : err;
+}
+
 char *
 proc_im (unsigned char * prem, unsigned char * conc)
 {
-    unsigned char * dis_sen, * con_sen;
-    int d_len;
+    return proc_rewrite (prem, conc, "im",
+                         _("Implication constructed incorrectly."));
+}
 
-    sen_put_len (prem, conc, &con_sen, &dis_sen);
-    d_len = strlen (dis_sen);
+char *
+proc_dm (unsigned char * prem, unsigned char * conc)
+{
+    return proc_rewrite (prem, conc, "dm",
+                         _("DeMorgan constructed incorrectly."));
+}
 
-    int i;
+/* Checks Association where two sentences differ.
+ *  input:
+ *    prem, conc - the differing subterms of the premise and conclusion.
+ *  output:
+ *    CORRECT if taking the grouping out of the longer one gives the other,
+ *    an error message otherwise, or NULL on memory error.
+ */
+static char *
+site_as (unsigned char * prem, unsigned char * conc)
+{
+    // Take the grouping out of every part of the longer sentence that has
+    // the same connective as the sentence, and recurse.
 
-    i = find_difference (dis_sen, con_sen);
-    if (i == -1)
-        return NO_DIFFERENCE;
+    unsigned char * ln_sen, * sh_sen;
+    int l_len;
 
-    // i might be zero if this is an incorrect usage of im.
-    // same with i == 1.
-    // Only occurs if there is no top connective on one, or a quantifier.
+    sen_put_len (prem, conc, &sh_sen, &ln_sen);
+    l_len = strlen (ln_sen);
 
-    if (i < 2)
-        return _("Implication constructed incorrectly.");
+    if (ln_sen[0] != '('
+        || (strncmp (ln_sen + 1, S_AND, S_CL)
+            && strncmp (ln_sen + 1, S_OR, S_CL)))
+    {
+        return _("Association must be done on a conjunction or disjunction.");
+    }
 
-    int tmp_pos;
-    unsigned char * tmp_str;
+    int gg;
+    vec_t * gens;
+    unsigned char conn[S_CL + 1];
 
-    tmp_pos = parse_parens (dis_sen, i - 2, &tmp_str);
-    if (tmp_pos == AEC_MEM)
+    conn[0] = '\0';
+    gens = init_vec (sizeof (char *));
+    if (!gens)
         return NULL;
-    if (!tmp_str)
-        return _("Implication constructed incorrectly.");
-
-    int ftc;
-    unsigned char * lsen, * rsen, * n_lsen;
 
-    ftc = sexpr_find_top_connective (tmp_str, S_OR, &lsen, &rsen);
-    if (ftc == AEC_MEM)
+    gg = sexpr_get_generalities (ln_sen, conn, gens);
+    if (gg == AEC_MEM)
         return NULL;
 
-    free (tmp_str);
+    unsigned char * oth_sen;
+    int oth_pos, num_groups, j;
+
+    oth_sen = (unsigned char *) calloc (l_len + 1, sizeof (char));
+    CHECK_ALLOC (oth_sen, NULL);
+    oth_pos = sprintf (oth_sen, "(%s", conn);
 
-    if (ftc < 0)
+    num_groups = 0;
+    for (j = 0; j < gens->num_stuff; j++)
     {
-        if (lsen)  free (lsen);
-        if (rsen)  free (rsen);
+        unsigned char * cur_gen;
+        int g_len;
+
+        cur_gen = vec_str_nth (gens, j);
+        g_len = strlen (cur_gen);
 
-        return _("One sentence must contain a disjunction.");
+        if (cur_gen[0] == '(' && !strncmp (cur_gen + 1, conn, S_CL)
+            && cur_gen[S_CL + 1] == ' ')
+        {
+            oth_pos += sprintf (oth_sen + oth_pos, " %.*s",
+                                g_len - S_CL - 3, cur_gen + S_CL + 2);
+            num_groups++;
+        }
+        else
+        {
+            oth_pos += sprintf (oth_sen + oth_pos, " %s", cur_gen);
+        }
     }
+    strcpy (oth_sen + oth_pos, ")");
+    destroy_str_vec (gens);
 
-    if (!sexpr_not_check (lsen))
+    if (num_groups == 0)
     {
-        free (lsen); free (rsen);
-        return _("The left disjunct must have a negation.");
+        free (oth_sen);
+        return _("Association constructed incorrectly.");
     }
 
-    n_lsen = sexpr_elim_not (lsen);
-    if (!n_lsen)
-        return NULL;
-
-    free (lsen);
-
-    // Construct what should be the other sentence.
-
-    unsigned char * oth_sen;
-    oth_sen = construct_other (dis_sen, i - 1, tmp_pos, d_len - 3 - S_NL,
-                              "%s %s %s", S_CON, n_lsen, rsen);
-    if (!oth_sen)
-        return NULL;
-
-    free (n_lsen);
-    free (rsen);
-
     char * ret_str;
-    if (dis_sen == conc)
-        ret_str = proc_im (con_sen, oth_sen);
+
+    if (ln_sen == conc)
+        ret_str = proc_as (sh_sen, oth_sen);
     else
-        ret_str = proc_im (oth_sen, con_sen);
+        ret_str = proc_as (oth_sen, sh_sen);
+    free (oth_sen);
+
     if (!ret_str)
         return NULL;
 
-    free (oth_sen);
     if (ret_str == NO_DIFFERENCE || ret_str == CORRECT)
         return CORRECT;
 
-    return _("Implication constructed incorrectly.");
+    return _("Association constructed incorrectly.");
 }
 
 char *
-proc_dm (unsigned char * prem, unsigned char * conc, int mode_guess)
+proc_as (unsigned char * prem, unsigned char * conc)
 {
-    int i;
-    i = find_difference (prem, conc);
-    if (i == -1)
-        return NO_DIFFERENCE;
+    return sexpr_check_sites (prem, conc, site_as);
+}
 
-    int p_len, c_len, mode;
+char *
+proc_co (unsigned char * prem, unsigned char * conc)
+{
+    int ret_chk;
+    ret_chk = recurse_mode (prem, conc, MODE_CO);
+    if (ret_chk == AEC_MEM)
+        return NULL;
 
-    if (mode_guess == -1)
-    {
-        p_len = strlen (prem);
-        c_len = strlen (conc);
-        if (p_len != c_len)
-            mode = 0;
-        else
-            mode = 1;
-    }
-    else
+    switch (ret_chk)
     {
-        mode = mode_guess;
+    case 0:
+        return CORRECT;
+    case -3:
+        return NO_DIFFERENCE;
+    default:
+        return _("Commutativity constructed incorrectly.");
     }
+}
 
-    if (mode == 0)
-    {
-        // Determine which sentence has the negation on it.
+char *
+proc_id (unsigned char * prem, unsigned char * conc)
+{
+    unsigned char * ln_sen, * sh_sen;
+    sen_put_len (prem, conc, &sh_sen, &ln_sen);
 
-        unsigned char * not_sen, * oth_sen;
-        int n_len;
+    int ret_chk;
+    ret_chk = recurse_mode (ln_sen, sh_sen, MODE_ID);
+    if (ret_chk == AEC_MEM)
+        return NULL;
 
-        if (i == 0)
-            return _("DeMorgan constructed incorrectly.");
+    switch (ret_chk)
+    {
+    case 0:
+        return CORRECT;
+    case -3:
+        return NO_DIFFERENCE;
+    default:
+        return _("Idempotence constructed incorrectly.");
+    }
+}
 
-        if (!strncmp (prem + i - 1, S_NOT, S_NL))
-        {
-            not_sen = prem;  n_len = p_len;
-            oth_sen = conc;
-        }
-        else if (!strncmp (conc + i - 1, S_NOT, S_NL))
-        {
-            not_sen = conc;  n_len = c_len;
-            oth_sen = prem;
-        }
-        else
-        {
-            return _("There must be a negation at the difference.");
-        }
+char *
+proc_dt (unsigned char * prem, unsigned char * conc)
+{
+    return proc_rewrite (prem, conc, "dt",
+                         _("Distribution constructed incorrectly."));
+}
 
-        // Determine the scope, and remove the negation.
-
-        int tmp_pos;
-        unsigned char * tmp_str;
-
-        tmp_pos = parse_parens (not_sen, i - 2, &tmp_str);
-        if (tmp_pos == AEC_MEM)
-            return NULL;
-        if (!tmp_str)
-            return _("DeMorgan constructed incorrectly.");
-
-        unsigned char * elim_sen;
-
-        elim_sen = sexpr_elim_not (tmp_str);
-        if (!elim_sen)
-            return NULL;
-        free (tmp_str);
-
-        int gg;
-        vec_t * gg_vec;
-        unsigned char conn[S_CL + 1];
-
-        gg_vec = init_vec (sizeof (char *));
-        if (!gg_vec)
-            return NULL;
-
-        conn[0] = '\0';
-        gg = sexpr_get_generalities (elim_sen, conn, gg_vec);
-        if (gg == AEC_MEM)
-            return NULL;
-        free (elim_sen);
-
-        if (gg == 1)
-        {
-            destroy_str_vec (gg_vec);
-            return _("There must be generalities on the negation sentence.");
-        }
-
-        if (strcmp (conn, S_AND) && strcmp (conn, S_OR))
-        {
-            destroy_str_vec (gg_vec);
-            return _("The negation sentence must be negating either a conjunction or a disjunction.");
-        }
-
-        unsigned char oth_conn[S_CL + 1];
-        int j;
-
-        if (!strcmp (conn, S_AND))
-            strcpy (oth_conn, S_OR);
-        else
-            strcpy (oth_conn, S_AND);
-
-        // Construct what should be the other sentence.
-
-        unsigned char * cons_sen;
-        int cons_pos, alloc_size;
-
-        alloc_size = n_len + (gg_vec->num_stuff - 1) * (S_NL + 3);
-        cons_sen = (unsigned char *) calloc (alloc_size + 1, sizeof (char));
-        CHECK_ALLOC (cons_sen, NULL);
-        strncpy (cons_sen, not_sen, i - 1);
-        cons_pos = i - 1;
-
-        cons_pos += sprintf (cons_sen + cons_pos, "%s", oth_conn);
-
-        for (j = 0; j < gg_vec->num_stuff; j++)
-        {
-            cons_pos += sprintf (cons_sen + cons_pos, " (%s %s)",
-                                S_NOT, vec_str_nth (gg_vec, j));
-        }
-
-        strcpy (cons_sen + cons_pos, not_sen + tmp_pos);
-
-        destroy_str_vec (gg_vec);
-
-        char * ret_str;
-        if (not_sen == conc)
-            ret_str = proc_dm (oth_sen, cons_sen, 0);
-        else
-            ret_str = proc_dm (cons_sen, oth_sen, 0);
-        if (!ret_str)
-            return NULL;
-
-        free (cons_sen);
-        if (ret_str == NO_DIFFERENCE || ret_str == CORRECT)
-            return CORRECT;
-
-        return _("DeMorgan constructed incorrectly.");
-    }
-    else
-    {
-        unsigned char * not_sen, * oth_sen;
-        int n_len;
-
-        if (!strncmp (prem + i, S_NOT, S_NL))
-        {
-            not_sen = prem;  n_len = p_len;
-            oth_sen = conc;
-        }
-        else if (!strncmp (conc + i, S_NOT, S_NL))
-        {
-            not_sen = conc;  n_len = c_len;
-            oth_sen = prem;
-        }
-        else
-        {
-            return _("There must be a negation at the difference.");
-        }
-
-        int tmp_pos;
-        unsigned char * tmp_str, * elim_sen;
-
-        tmp_pos = parse_parens (not_sen, i - 1, &tmp_str);
-        if (tmp_pos == AEC_MEM)
-            return NULL;
-        if (!tmp_str)
-            return _("DeMorgan constructed incorrectly.");
-
-        elim_sen = sexpr_elim_not (tmp_str);
-        if (!elim_sen)
-            return NULL;
-        free (tmp_str);
-
-        if (elim_sen[1] != '(')
-            return _("There must be a quantifier after the negation.");
-
-        unsigned char * cmp_str;
-        unsigned char quant[S_CL + 1], oth_quant[S_CL + 1];
-        unsigned char * var;
-
-        cmp_str = sexpr_elim_quant (elim_sen, quant, &var);
-        if (!cmp_str)
-            return NULL;
-
-        if (cmp_str[0] == '\0')
-            return _("DeMorgan constructed incorrectly.");
-
-        if (!strncmp (quant, S_UNV, S_CL))
-            strcpy (oth_quant, S_EXL);
-        else if (!strncmp (quant, S_EXL, S_CL))
-            strcpy (oth_quant, S_UNV);
-        else
-            return _("There must be a quantifier after the negation.");
-
-        // Construct what should be the other sentence.
-
-        unsigned char * cons_sen;
-        int alloc_size;
-
-        alloc_size = n_len;
-        cons_sen = construct_other (not_sen, i - 1, tmp_pos + 1, alloc_size,
-                                   "((%s %s) (%s %s))",
-                                   oth_quant, var, S_NOT, cmp_str);
-        free (cmp_str);
-        free (var);
-
-        char * ret_str;
-
-        if (not_sen == conc)
-            ret_str = proc_dm (oth_sen, cons_sen, 1);
-        else
-            ret_str = proc_dm (cons_sen, oth_sen, 1);
-        if (!ret_str)
-            return NULL;
-
-        free (cons_sen);
-
-        if (ret_str == NO_DIFFERENCE || ret_str == CORRECT)
-            return CORRECT;
-
-        return _("DeMorgan constructed incorrectly.");
-    }
-}
+char *
+proc_eq (unsigned char * prem, unsigned char * conc)
+{
+    return proc_rewrite (prem, conc, "eq",
+                         _("Equivalence constructed incorrectly."));
+}
 
 char *
-proc_as (unsigned char * prem, unsigned char * conc)
-{
-    // At the difference:
-    // rollback sh_sen;
-    // sexpr_find_unmatched
-    // run checks on the larger sentence.
-    // strip the connective and recurse.
-
-    unsigned char * ln_sen, * sh_sen;
-    int l_len;
-
-    sen_put_len (prem, conc, &sh_sen, &ln_sen);
-    l_len = strlen (ln_sen);
-
-    int i;
-    i = find_difference (ln_sen, sh_sen);
-    if (i == -1)
-        return NO_DIFFERENCE;
-
-    int li, si;
-
-    si = li = i;
-    if (sh_sen[si] == '(')
-        si--;
-
-    if (si < 0)
-        return _("There must be a connective in both sentences.");
-
-    si = find_unmatched_o_paren (sh_sen, si);
-    if (si == -1)
-        return _("There must be a connective in both sentences.");
-
-    if (ln_sen[li] != '(')
-    {
-        li = find_unmatched_o_paren (ln_sen, li);
-        if (li == -1)
-            return _("There must be a connective in both sentences.");
-    }
-
-    int ret_chk;
-    ret_chk = sexpr_find_unmatched (ln_sen, sh_sen, &li, &si);
-    if (ret_chk == AEC_MEM)
-        return NULL;
-
-    int tmp_pos;
-    unsigned char * tmp_str;
-    tmp_pos = parse_parens (ln_sen, li, &tmp_str);
-    if (tmp_pos == AEC_MEM)
-        return NULL;
-    if (!tmp_str || tmp_pos < 0)
-    {
-        if (tmp_str) free (tmp_str);
-        return _("Association constructed incorrectly.");
-    }
-    free (tmp_str);
-
-    int ti;
-    ti = li - 1;
-    if (ti < 0)
-        return _("Association constructed incorrectly.");
-
-    ti = find_unmatched_o_paren (ln_sen, ti);
-
-    if (strncmp (ln_sen + ti + 1, S_AND, S_CL)
-        && strncmp (ln_sen + ti + 1, S_OR, S_CL)
-        && strncmp (ln_sen + ti + 1, ln_sen + li + 1, S_CL))
-    {
-        return _("Association must be done on a conjunction or disjunction.");
-    }
-
-    unsigned char * oth_sen;
-    int oth_pos;
-
-    oth_sen = (unsigned char *) calloc (l_len - 2 - S_CL, sizeof (char));
-    CHECK_ALLOC (oth_sen, NULL);
-    strncpy (oth_sen, ln_sen, li);
-    oth_pos = li;
-
-    strncpy (oth_sen + oth_pos, ln_sen + li + S_CL + 2, tmp_pos - li - 2 - S_CL);
-    oth_pos += tmp_pos - li - 2 - S_CL;
-
-    strcpy (oth_sen + oth_pos, ln_sen + tmp_pos + 1);
-
-    char * ret_str;
-
-    if (ln_sen == conc)
-        ret_str = proc_as (sh_sen, oth_sen);
-    else
-        ret_str = proc_as (oth_sen, sh_sen);
-    if (!ret_str)
-        return NULL;
-
-    free (oth_sen);
-    if (ret_str == NO_DIFFERENCE || ret_str == CORRECT)
-        return CORRECT;
-
-    return _("Association constructed incorrectly.");
-}
-
-char *
-proc_co (unsigned char * prem, unsigned char * conc)
+proc_dn (unsigned char * prem, unsigned char * conc)
 {
-    int ret_chk;
-    ret_chk = recurse_mode (prem, conc, MODE_CO);
-    if (ret_chk == AEC_MEM)
-        return NULL;
-
-    switch (ret_chk)
-    {
-    case 0:
-        return CORRECT;
-    case -3:
-        return NO_DIFFERENCE;
-    default:
-        return _("Commutativity constructed incorrectly.");
-    }
+    return proc_rewrite (prem, conc, "dn",
+                         _("Double Negation constructed incorrectly."));
 }
 
 char *
-proc_id (unsigned char * prem, unsigned char * conc)
-{
-    unsigned char * ln_sen, * sh_sen;
-    sen_put_len (prem, conc, &sh_sen, &ln_sen);
-
-    int ret_chk;
-    ret_chk = recurse_mode (ln_sen, sh_sen, MODE_ID);
-    if (ret_chk == AEC_MEM)
-        return NULL;
-
-    switch (ret_chk)
-    {
-    case 0:
-        return CORRECT;
-    case -3:
-        return NO_DIFFERENCE;
-    default:
-        return _("Idempotence constructed incorrectly.");
-    }
-}
-
-char *
-proc_dt (unsigned char * prem, unsigned char * conc, int mode_guess)
-{
-    unsigned char * ln_sen, * sh_sen;
-    int s_len, l_len;
-
-    sen_put_len (prem, conc, &sh_sen, &ln_sen);
-    s_len = strlen (sh_sen);
-    l_len = strlen (ln_sen);
-
-    int mode, i;
-
-    i = find_difference (ln_sen, sh_sen);
-    if (i == -1)
-        return NO_DIFFERENCE;
-
-    if (l_len == s_len)
-        return _("The two sentences must be of different lengths.");
-
-    if (mode_guess == -1)
-        mode = (sh_sen[i] == '(') ? 1 : 0;
-    else
-        mode = mode_guess;
-
-    if (mode == 0)
-    {
-        int tmp_pos;
-        unsigned char * tmp_str;
-
-        if (i < 2
-            || (strncmp (sh_sen + i - 1, S_AND, S_CL)
-                &&  strncmp (sh_sen + i - 1, S_OR, S_CL)))
-        {
-            return _("The top connective must change between sentences.");
-        }
-
-        tmp_pos = parse_parens (sh_sen, i - S_CL + 1, &tmp_str);
-        if (tmp_pos == -2)
-            return NULL;
-        if (!tmp_str)
-            return _("Distribution constructed incorrectly.");
-
-        int ftc;
-        unsigned char * lsen, * rsen, mc[S_CL + 1];
-
-        mc[0] = '\0';
-
-        ftc = sexpr_find_top_connective (tmp_str, mc, &lsen, &rsen);
-        if (ftc == AEC_MEM)
-            return NULL;
-        free (tmp_str);
-
-        if (ftc < 0)
-        {
-            if (lsen)  free (lsen);
-            if (rsen)  free (rsen);
-
-            return _("There must be only two parts for distribution.");
-        }
-
-        if (strcmp (mc, S_AND) && strcmp (mc, S_OR))
-        {
-            free (lsen); free (rsen);
-
-            return _("Distribution must be done around a conjunction or a disjunction.");
-        }
-
-        int r_gg, r_len;
-        unsigned char rc[S_CL + 1];
-        vec_t * rsens;
-
-        r_len = strlen (rsen);
-        rsens = init_vec (sizeof (char *));
-        if (!rsens)
-            return NULL;
-
-        rc[0] = '\0';
-        r_gg = sexpr_get_generalities (rsen, rc, rsens);
-        if (r_gg == AEC_MEM)
-            return NULL;
-        free (rsen);
-
-        if (r_gg == 1)
-        {
-            free (lsen);
-            destroy_str_vec (rsens);
-
-            return _("There must be more than one generality for distribution.");
-        }
-
-        unsigned char * oth_sen;
-        int oth_pos, j, alloc_size;
-
-        // length of lsen + S_CL (mc) + 4 (two spaces, two parens)
-        // r_len - 1 (both of the parentheses, plus one for the null byte).
-        alloc_size = s_len + (strlen (lsen) + S_CL + 4) * rsens->num_stuff + r_len - 1;
-        oth_sen = (unsigned char *) calloc (alloc_size,  sizeof (char));
-        CHECK_ALLOC (oth_sen, NULL);
-        strncpy (oth_sen, sh_sen, i - 1);
-        oth_pos = i - 1;
-
-        oth_pos += sprintf (oth_sen + oth_pos, "%s", rc);
-
-        for (j = 0; j < rsens->num_stuff; j++)
-        {
-            oth_pos += sprintf (oth_sen + oth_pos, " (%s %s %s)",
-                               mc, lsen, vec_str_nth (rsens, j));
-        }
-
-        strcpy (oth_sen + oth_pos, sh_sen + tmp_pos);
-
-        free (lsen);
-        destroy_str_vec (rsens);
-
-        char * ret_str;
-
-        if (sh_sen == conc)
-            ret_str = proc_dt (ln_sen, oth_sen, 0);
-        else
-            ret_str = proc_dt (oth_sen, ln_sen, 0);
-
-        if (!ret_str)
-            return NULL;
-
-        free (oth_sen);
-        if (ret_str == NO_DIFFERENCE || ret_str == CORRECT)
-            return CORRECT;
-
-        return _("Distribution constructed incorrectly.");
-    }
-    else
-    {
-        unsigned char * tmp_str;
-        int tmp_pos;
-
-        if (mode_guess != -1)
-        {
-            if (sh_sen[i] != '(')
-                return _("The difference must be a quantifier.");
-        }
-
-        tmp_pos = parse_parens (sh_sen, i - 1, &tmp_str);
-        if (tmp_pos == AEC_MEM)
-            return NULL;
-        if (!tmp_str)
-            return _("Distribution constructed incorrectly.");
-
-        unsigned char * scope, * var, quant[S_CL + 1];
-        int v_len;
-
-        scope = sexpr_elim_quant (tmp_str, quant, &var);
-        if (!scope)
-            return NULL;
-        if (scope[0] == '\0')
-            return _("Distribution constructed incorrectly.");
-        v_len = strlen (var);
-        free (tmp_str);
-
-        int gg;
-        vec_t * gg_vec;
-        unsigned char conn[S_CL + 1];
-
-        conn[0] = '\0';
-        gg_vec = init_vec (sizeof (char *));
-        if (!gg_vec)
-            return NULL;
-
-        gg = sexpr_get_generalities (scope, conn, gg_vec);
-        if (gg == AEC_MEM)
-            return NULL;
-        free (scope);
-
-        if (gg == 1)
-        {
-            destroy_str_vec (gg_vec);
-            return _("Distribution constructed incorrectly.");
-        }
-
-        if ((strcmp (quant, S_UNV) || strcmp (conn, S_AND))
-            && (strcmp (quant, S_EXL) || strcmp (conn, S_OR)))
-        {
-            destroy_str_vec (gg_vec);
-            return _("A universal is distributed over a conjnction, and an existential is distributed over a disjunction.");
-        }
-
-        unsigned char * oth_sen;
-        int oth_pos, j, alloc_size;
-
-        alloc_size = s_len + (gg_vec->num_stuff * (6 + S_CL + v_len));
-        oth_sen = (unsigned char *) calloc (alloc_size + 1, sizeof (char));
-        CHECK_ALLOC (oth_sen, NULL);
-        strncpy (oth_sen, sh_sen, i - 1);
-        oth_pos = i - 1;
-
-        oth_pos += sprintf (oth_sen + oth_pos, "(%s", conn);
-
-        for (j = 0; j < gg_vec->num_stuff; j++)
-        {
-            unsigned char * cur_gen;
-            cur_gen = vec_str_nth (gg_vec, j);
-            oth_pos += sprintf (oth_sen + oth_pos, " ((%s %s) %s)",
-                               quant, var, cur_gen);
-        }
-
-        oth_pos += sprintf (oth_sen + oth_pos, ")");
-
-        strcpy (oth_sen + oth_pos, sh_sen + tmp_pos + 1);
-
-        free (var);
-        destroy_str_vec (gg_vec);
-
-        char * ret_str;
-        if (sh_sen == conc)
-            ret_str = proc_dt (ln_sen, oth_sen, 1);
-        else
-            ret_str = proc_dt (oth_sen, ln_sen, 1);
-        if (!ret_str)
-            return NULL;
-
-        free (oth_sen);
-        if (ret_str == NO_DIFFERENCE || ret_str == CORRECT)
-            return CORRECT;
-
-        return _("Distribution constructed incorrectly.");
-    }
-}
-
-char *
-proc_eq (unsigned char * prem, unsigned char * conc)
+proc_ep (unsigned char * prem, unsigned char * conc)
 {
-    unsigned char * bic_sen, * oth_sen;
-    int b_len;
-
-    sen_put_len (prem, conc, &bic_sen, &oth_sen);
-    b_len = strlen (bic_sen);
-
-    int i;
-    i = find_difference (bic_sen, oth_sen);
-    if (i == -1)
-        return NO_DIFFERENCE;
-
-    if (i < 2)
-        return _("Equivalence constructed incorrectly.");
-
-    int tmp_pos;
-    unsigned char * tmp_str;
-
-    tmp_pos = parse_parens (bic_sen, i - 2, &tmp_str);
-    if (tmp_pos == AEC_MEM)
-        return NULL;
-    if (!tmp_str)
-        return _("Equivalence constructed incorrectly.");
-
-    int ftc;
-    unsigned char * lsen, * rsen;
-
-    lsen = rsen = NULL;
-    ftc = sexpr_find_top_connective (tmp_str, S_BIC, &lsen, &rsen);
-    if (ftc == AEC_MEM)
-        return NULL;
-    free (tmp_str);
-
-    if (ftc < 0)
-    {
-        if (lsen)  free (lsen);
-        if (rsen)  free (rsen);
-
-        return _("There must be a biconditional in one sentence.");
-    }
-
-    unsigned char * cons_sen;
-    int alloc_size;
-
-    alloc_size = b_len + (tmp_pos - (i - 2) + 1) + S_CL + 4;
-    cons_sen = construct_other (bic_sen, i - 1, tmp_pos, alloc_size,
-                               "%s (%s %s %s) (%s %s %s)",
-                               S_AND, S_CON, lsen, rsen, S_CON, rsen, lsen);
-
-    if (!cons_sen)
-        return NULL;
-
-    free (lsen);
-    free (rsen);
-
-    char * ret_str;
-
-    if (bic_sen == conc)
-        ret_str = proc_eq (oth_sen, cons_sen);
-    else
-        ret_str = proc_eq (cons_sen, oth_sen);
-
-    free (cons_sen);
-
-    if (ret_str == NO_DIFFERENCE || ret_str == CORRECT)
-        return CORRECT;
-
-    return _("Equivalence constructed incorrectly.");
+    return proc_rewrite (prem, conc, "ep",
+                         _("Exportation constructed incorrectly."));
 }
 
-char *
-proc_dn (unsigned char * prem, unsigned char * conc)
+/* Checks Subsumption where two sentences differ.
+ *  input:
+ *    prem, conc - the differing subterms of the premise and conclusion.
+ *  output:
+ *    CORRECT if absorbing each gives the same sentence, an error
+ *    message otherwise, or NULL on memory error.
+ */
+static char *
+site_sb (unsigned char * prem, unsigned char * conc)
 {
-    // Standard long-short setup.
-
     unsigned char * ln_sen, * sh_sen;
-    int l_len;
+    int ret;
 
     sen_put_len (prem, conc, &sh_sen, &ln_sen);
-    l_len = strlen (ln_sen);
-
-    int i;
-    i = find_difference (ln_sen, sh_sen);
-    if (i == -1)
-        return NO_DIFFERENCE;
-
-    if (ln_sen[i] != '(' && strncmp (ln_sen + i, S_NOT, S_NL)
-        && (i > 0 && l_len > S_NL && strncmp (ln_sen + i - 1, S_NOT, S_NL)))
-    {
-        return _("Double Negation must be used to eliminate negations.");
-    }
-
-    if (ln_sen[i] != '(')
-    {
-        if (!strncmp (ln_sen + i, S_NOT, S_NL))
-            i--;
-        else
-            i -= 2;
-    }
-
-    int tmp_pos;
-    unsigned char * tmp_str;
-    tmp_pos = parse_parens (ln_sen, i, &tmp_str);
-    if (tmp_pos == AEC_MEM)
-        return NULL;
-    if (!tmp_str)
-        return _("Double Negation constructed incorrectly.");
-
-    int pos;
-    int oth_pos;
-
-    pos = i;
-    if (!sexpr_not_check (tmp_str) || strncmp (tmp_str + S_NL + 3, S_NOT, S_NL))
-    {
-        free (tmp_str);
-        return _("Double Negation removes negations in pairs.");
-    }
-
-    free (tmp_str);
-    pos = i + 4 + 2 * S_NL;
-    // Begin removing pairs of negations, until there are no more pairs.
-
-    unsigned char * oth_sen;
-    int alloc_size;
-
-    alloc_size = l_len - S_NL * 2 - 6;
-    oth_sen = (unsigned char *) calloc (alloc_size + 1, sizeof (char));
-    CHECK_ALLOC (oth_sen, NULL);
-    strncpy (oth_sen, ln_sen, i);
-    oth_pos = i;
-
-    strncpy (oth_sen + oth_pos, ln_sen + pos, tmp_pos - pos - 1);
-    oth_pos += tmp_pos - pos - 1;
-
-    strcpy (oth_sen + oth_pos, ln_sen + tmp_pos + 1);
-
-    char * ret_str;
-
-    if (ln_sen == conc)
-        ret_str = proc_dn (sh_sen, oth_sen);
-    else
-        ret_str = proc_dn (oth_sen, sh_sen);
-
-    if (!ret_str)
-        return NULL;
-
-    free (oth_sen);
-    if (ret_str == NO_DIFFERENCE || ret_str == CORRECT)
-        return CORRECT;
-
-    return _("Double Negation constructed incorrectly.");
-}
-
-char *
-proc_ep (unsigned char * prem, unsigned char * conc)
-{
-    /* First, determine which sentence is which. */
-
-    unsigned char * and_sen, * con_sen;
-    int p_len, c_len, a_len;
-
-    p_len = strlen (prem);
-    c_len = strlen (conc);
-
-    // Count number of conditionals in each sentence.
-
-    int i, c_cons = 0, p_cons = 0;
-
-    for (i = 0; i < p_len; i++)
-    {
-        if (!strncmp (prem + i, S_CON, S_CL))
-            p_cons++;
-
-        if (!strncmp (conc + i, S_CON, S_CL))
-            c_cons++;
-    }
-
-    if (c_cons > p_cons)
-    {
-        and_sen = prem;  a_len = p_len;
-        con_sen = conc;
-    }
-    else
-    {
-        and_sen = conc;  a_len = c_len;
-        con_sen = prem;
-    }
-
-    /* Then, find the difference. */
-
-    i = find_difference (and_sen, con_sen);
-    if (i == -1)
-        return NO_DIFFERENCE;
-
-    /* Roll back to the start of the difference. */
-
-    int ai, ci;
-
-    ai = ci = i;
-
-    if (con_sen[ci] == '(')
-    {
-        ci--;
-        if (ci == -1)
-            return _("Exportation constructed incorrectly.");
-    }
-
-    ci = find_unmatched_o_paren (con_sen, ci);
-    if (ci == -1)
-        return _("There must be connectives on both sentences.");
-
-    if (and_sen[ai] != '(')
-    {
-        ai = find_unmatched_o_paren (and_sen, ai);
-        if (ai == -1)
-            return _("There must be connectives on both sentences.");
-    }
-
-    int ret_chk;
-    ret_chk = sexpr_find_unmatched (and_sen, con_sen, &ai, &ci);
-    if (ret_chk == AEC_MEM)
-        return NULL;
-
-    ai--;
-    if (ai < 0)
-        return _("Exportation constructed incorrectly.");
-
-    ai = find_unmatched_o_paren (and_sen, ai);
-    if (ai == -1)
-        return _("Exportation constructed incorrectly.");
 
-    /* Get the sentence parts. */
-
-    int tmp_pos;
-    unsigned char * tmp_str;
-
-    tmp_pos = parse_parens (and_sen, ai, &tmp_str);
-    if (tmp_pos == AEC_MEM)
-        return NULL;
-
-    int ftc;
-    unsigned char * lsen, * rsen;
-
-    lsen = rsen = NULL;
-    ftc = sexpr_find_top_connective (tmp_str, S_CON, &lsen, &rsen);
-    if (ftc == AEC_MEM)
-        return NULL;
-    free (tmp_str);
-
-    if (ftc < 0)
+    if (ln_sen[0] != '('
+        || (strncmp (ln_sen + 1, S_AND, S_CL)
+            && strncmp (ln_sen + 1, S_OR, S_CL)))
     {
-        if (lsen)  free (lsen);
-        if (rsen)  free (rsen);
-
-        return _("There must be a conditional in both sentences.");
-    }
-
-    vec_t * a_sens;
-
-    a_sens = init_vec (sizeof (char *));
-    if (!a_sens)
-        return NULL;
-
-    ftc = sexpr_get_generalities (lsen, S_AND, a_sens);
-    if (ftc == AEC_MEM)
-        return NULL;
-    free (lsen);
-
-    if (ftc == 1)
-    {
-        destroy_str_vec (a_sens);
-        free (rsen);
-        return _("Exportation constructed incorrectly.");
-    }
-
-    /* Construct what should be the other sentence. */
-
-    unsigned char * oth_sen;
-    int oth_pos, alloc_size;
-
-    alloc_size = a_len + (3 + S_CL) * a_sens->num_stuff;
-    oth_sen = (unsigned char *) calloc (alloc_size + 1, sizeof (char));
-    CHECK_ALLOC (oth_sen, NULL);
-    strncpy (oth_sen, and_sen, ai);
-    oth_pos = ai;
-
-    for (i = 0; i < a_sens->num_stuff; i++)
-    {
-        oth_pos += sprintf (oth_sen + oth_pos, "(%s %s ",
-                           S_CON, vec_str_nth (a_sens, i));
+        return _("Subsumption must be done around a disjunction or a conjunction.");
     }
 
-    oth_pos += sprintf (oth_sen + oth_pos, "%s", rsen);
-    for (i = 0; i < a_sens->num_stuff; i++)
-        oth_pos += sprintf (oth_sen + oth_pos, ")");
-
-    destroy_str_vec (a_sens);
-    free (rsen);
-
-    strcpy (oth_sen + oth_pos, and_sen + tmp_pos + 1);
-
-    char * ret_str;
-    if (and_sen == conc)
-        ret_str = proc_ep (con_sen, oth_sen);
-    else
-        ret_str = proc_ep (oth_sen, con_sen);
-    if (!ret_str)
+    ret = sexpr_rewrite_equiv (prem, conc, "sb");
+    if (ret == AEC_MEM)
         return NULL;
-    free (oth_sen);
-
-    if (ret_str == NO_DIFFERENCE || ret_str == CORRECT)
-        return CORRECT;
 
-    return _("Exportation constructed incorrectly.");
+    return ret ? CORRECT : _("Subsumption constructed incorrectly.");
 }
 
 char *
 proc_sb (unsigned char * prem, unsigned char * conc)
 {
-    // Standard long-short setup.
-
-    unsigned char * ln_sen, * sh_sen;
-    int l_len;
-
-    sen_put_len (prem, conc, &sh_sen, &ln_sen);
-    l_len = strlen (ln_sen);
-
-    int i;
-    i = find_difference (ln_sen, sh_sen);
-    if (i == -1)
-        return NO_DIFFERENCE;
-
-    // Standard find_unmatched setup.
-
-    int li, si;
-
-    si = li = i;
-    if (sh_sen[si] == '(')
-    {
-        si--;
-        if (si < 0)
-            return _("Subsumption constructed incorrectly.");
-    }
-    else if (si > 0
-             && (!strncmp (sh_sen + si - 1, S_AND, S_CL)
-                 || !strncmp (sh_sen + si - 1, S_OR, S_CL)
-                 || !strncmp (sh_sen + si - 1, S_CON, S_CL)
-                 || !strncmp (sh_sen + si - 1, S_BIC, S_CL)))
-    {
-        while (sh_sen[si] != '(')
-            si--;
-        si--;
-    }
-
-    si = find_unmatched_o_paren (sh_sen, si);
-    if (si == -1)
-    {
-        // This is the entire sentence.
-        li = 0;
-    }
-    else
-    {
-        if (ln_sen[li] != '(')
-            li = find_unmatched_o_paren (ln_sen, li);
-        if (li < 0)
-            return _("Subsumption constructed incorrectly.");
-
-        int ret_chk;
-        ret_chk = sexpr_find_unmatched (ln_sen, sh_sen, &li, &si);
-        if (ret_chk == AEC_MEM)
-            return NULL;
-
-        if (li < 0)
-            return _("Subsumption constructed incorrectly.");
-    }
-
-    if (ln_sen[li] != '(')
-        return _("There must be a connective in one sentence.");
-
-    int tmp_pos;
-    unsigned char * tmp_str;
-
-    tmp_pos = parse_parens (ln_sen, li, &tmp_str);
-    if (tmp_pos == AEC_MEM)
-        return NULL;
-    if (!tmp_str)
-        return _("Subsumption constructed incorrectly.");
-
-    int ftc;
-    unsigned char * t_lsen, * t_rsen, tconn[S_CL + 1];
-
-    tconn[0] = '\0';
-    t_lsen = t_rsen = NULL;
-    ftc = sexpr_find_top_connective (tmp_str, tconn, &t_lsen, &t_rsen);
-    if (ftc == AEC_MEM)
-        return NULL;
-
-    free (tmp_str);
-
-    if (ftc < 0)
-    {
-        if (t_lsen)  free (t_lsen);
-        if (t_rsen)  free (t_rsen);
-
-        return _("Subsumption must be done around a connective.");
-    }
-
-    if (strcmp (tconn, S_AND) && strcmp (tconn, S_OR))
-    {
-        free (t_lsen); free (t_rsen);
-
-        return _("Subsumption must be done around a disjunction or a conjunction.");
-    }
-
-    int r_len;
-    unsigned char * lsen, * rsen, conn[S_CL + 1];
-
-    r_len = strlen (t_rsen);
-    conn[0] = '\0';
-    lsen = rsen = NULL;
-    ftc = sexpr_find_top_connective (t_rsen, conn, &lsen, &rsen);
-    if (ftc == AEC_MEM)
-        return NULL;
-    free (t_rsen);
-    if (rsen)  free (rsen);
-
-    if (ftc < 0)
-    {
-        free (t_lsen);
-        if (lsen)  free (lsen);
-
-        return _("Subsumption must be done around two connectives.");
-    }
-
-    if ((strcmp (tconn, S_AND) || strcmp (conn, S_OR))
-        && (strcmp (tconn, S_OR) || strcmp (conn, S_AND)))
-    {
-        free (t_lsen);
-        free (lsen);
-
-        return _("The two connectives must be complementary to one another.");
-    }
-
-    if (strcmp (t_lsen, lsen))
-    {
-        free (t_lsen);
-        free (lsen);
-
-        return _("Both of the left sentences must be the same.");
-    }
-    free (lsen);
-
-    /* Construct what should be the other sentence. */
-
-    unsigned char * oth_sen;
-    int oth_pos, alloc_size;
-
-    alloc_size = l_len - r_len - S_CL - 4;
-
-    oth_sen = (unsigned char *) calloc (alloc_size + 1, sizeof (char));
-    CHECK_ALLOC (oth_sen, NULL);
-    strncpy (oth_sen, ln_sen, li);
-    oth_pos = li;
-
-    strcpy (oth_sen + oth_pos, t_lsen);
-    oth_pos += strlen (t_lsen);
-    free (t_lsen);
-
-    strcpy (oth_sen + oth_pos, ln_sen + tmp_pos + 1);
-
-    char * ret_str;
-
-    if (ln_sen == conc)
-        ret_str = proc_sb (sh_sen, oth_sen);
-    else
-        ret_str = proc_sb (oth_sen, sh_sen);
-
-    if (!ret_str)
-        return NULL;
-
-    free (oth_sen);
-    if (ret_str == NO_DIFFERENCE || ret_str == CORRECT)
-        return CORRECT;
-
-    return _("Subsumption constructed incorrectly.");
+    return sexpr_check_sites (prem, conc, site_sb);
 }
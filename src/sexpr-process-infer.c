@@ -231,6 +231,294 @@ proc_sm (unsigned char * prem, unsigned char * conc)
     return _("One of the conjuncts in the reference must match the conclusion.");
 }
 
+/* The distinct parts of some sentences, so that each part is compared
+ * by its id rather than against every other part. */
+
+struct infer_terms {
+    int num_terms;          // The number of distinct terms.
+    unsigned char ** text;  // The text of each term.
+    unsigned int * hashes;  // The hash of each term.
+    int * next;             // The next term in the same bucket, or -1.
+    int * count;            // The number of unmatched copies of each term.
+
+    int num_buckets;        // The number of buckets, a power of two.
+    int * buckets;          // The first term in each bucket, or -1.
+};
+
+/* Hashes a term.
+ *  input:
+ *    str - the term to hash.
+ *  output:
+ *    the FNV-1a hash of str.
+ */
+static unsigned int
+infer_terms_hash (unsigned char * str)
+{
+    unsigned int hash = 2166136261u;
+
+    for (; *str; str++)
+    {
+        hash ^= *str;
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+/* Initializes a table of terms.
+ *  input:
+ *    terms - the table to initialize.
+ *    max_terms - the most terms that will be added.
+ *  output:
+ *    0 on success, -1 on memory error.
+ */
+static int
+infer_terms_init (struct infer_terms * terms, int max_terms)
+{
+    int i;
+
+    terms->num_terms = 0;
+
+    terms->text = (unsigned char **) calloc (max_terms + 1, sizeof (char *));
+    CHECK_ALLOC (terms->text, AEC_MEM);
+    terms->hashes = (unsigned int *) calloc (max_terms + 1, sizeof (int));
+    CHECK_ALLOC (terms->hashes, AEC_MEM);
+    terms->next = (int *) calloc (max_terms + 1, sizeof (int));
+    CHECK_ALLOC (terms->next, AEC_MEM);
+    terms->count = (int *) calloc (max_terms + 1, sizeof (int));
+    CHECK_ALLOC (terms->count, AEC_MEM);
+
+    // Keep the chains short by keeping at least two buckets per term.
+    for (terms->num_buckets = 16; terms->num_buckets < 2 * max_terms;
+         terms->num_buckets *= 2)
+        ;
+
+    terms->buckets = (int *) calloc (terms->num_buckets, sizeof (int));
+    CHECK_ALLOC (terms->buckets, AEC_MEM);
+    for (i = 0; i < terms->num_buckets; i++)
+        terms->buckets[i] = -1;
+
+    return 0;
+}
+
+/* Destroys a table of terms.  The terms themselves are not freed.
+ *  input:
+ *    terms - the table to destroy.
+ *  output:
+ *    none.
+ */
+static void
+infer_terms_destroy (struct infer_terms * terms)
+{
+    free (terms->text);
+    free (terms->hashes);
+    free (terms->next);
+    free (terms->count);
+    free (terms->buckets);
+}
+
+/* Finds the id of a term.
+ *  input:
+ *    terms - the table of terms.
+ *    text - the term to find.
+ *    add - whether to add the term if it is not in the table.
+ *  output:
+ *    the id of the term, or -1 if it is not in the table.
+ */
+static int
+infer_terms_id (struct infer_terms * terms, unsigned char * text, int add)
+{
+    unsigned int hash;
+    int b, t;
+
+    hash = infer_terms_hash (text);
+    b = hash & (terms->num_buckets - 1);
+
+    for (t = terms->buckets[b]; t >= 0; t = terms->next[t])
+    {
+        if (terms->hashes[t] == hash && !strcmp (terms->text[t], text))
+            return t;
+    }
+
+    if (!add)
+        return -1;
+
+    t = terms->num_terms++;
+    terms->text[t] = text;
+    terms->hashes[t] = hash;
+    terms->count[t] = 0;
+    terms->next[t] = terms->buckets[b];
+    terms->buckets[b] = t;
+
+    return t;
+}
+
+/* Compares two string vectors, ignoring positioning, as vec_str_cmp does.
+ *  Each string is found by its hash, so this is linear in the number of
+ *  strings.
+ *  input:
+ *    vec_0, vec_1 - the string vectors.
+ *  output:
+ *    0 - they are the same.
+ *    -1 - memory error.
+ *    -2 - An element from vec_0 doesn't match one from vec_1
+ *    -3 - An element from vec_1 doesn't match one from vec_0
+ */
+static int
+infer_terms_cmp (vec_t * vec_0, vec_t * vec_1)
+{
+    struct infer_terms terms;
+    int i, t, ret = 0;
+
+    if (infer_terms_init (&terms, vec_1->num_stuff) == AEC_MEM)
+        return AEC_MEM;
+
+    for (i = 0; i < vec_1->num_stuff; i++)
+    {
+        t = infer_terms_id (&terms, vec_str_nth (vec_1, i), 1);
+        terms.count[t]++;
+    }
+
+    for (i = 0; i < vec_0->num_stuff && ret == 0; i++)
+    {
+        t = infer_terms_id (&terms, vec_str_nth (vec_0, i), 0);
+        if (t < 0 || terms.count[t] == 0)
+            ret = -2;
+        else
+            terms.count[t]--;
+    }
+
+    for (t = 0; t < terms.num_terms && ret == 0; t++)
+    {
+        if (terms.count[t] > 0)
+            ret = -3;
+    }
+
+    infer_terms_destroy (&terms);
+    return ret;
+}
+
+/* Checks that conditionals chain from one sentence to another.
+ *  The antecedent and consequence of each conditional are given ids, so
+ *  that the conditionals form a graph whose edges are the conditionals.
+ *  They chain together if a path from the first sentence to the last
+ *  uses every edge once, which is when the last sentence is reachable,
+ *  every edge is reachable, and every other sentence is entered as many
+ *  times as it is left.
+ *  input:
+ *    first - the sentence that begins the chain.
+ *    last - the sentence that ends the chain.
+ *    ants - the antecedent of each conditional.
+ *    cons - the consequence of each conditional.
+ *  output:
+ *    0 if the conditionals chain from first to last, -2 if last cannot be
+ *    reached, -3 if not every conditional is in the chain, or -1 on
+ *    memory error.
+ */
+static int
+infer_check_chain (unsigned char * first, unsigned char * last,
+                   vec_t * ants, vec_t * cons)
+{
+    struct infer_terms terms;
+    int * src, * dst, * start, * adj, * queue;
+    char * seen;
+    int a, z, i, t, num_edges, head, tail, ret = 0;
+
+    num_edges = ants->num_stuff;
+    if (infer_terms_init (&terms, 2 * num_edges + 2) == AEC_MEM)
+        return AEC_MEM;
+
+    src = (int *) calloc (num_edges + 1, sizeof (int));
+    CHECK_ALLOC (src, AEC_MEM);
+    dst = (int *) calloc (num_edges + 1, sizeof (int));
+    CHECK_ALLOC (dst, AEC_MEM);
+
+    a = infer_terms_id (&terms, first, 1);
+    z = infer_terms_id (&terms, last, 1);
+
+    // The count of each sentence holds the edges leaving it, less those
+    // entering it.
+    for (i = 0; i < num_edges; i++)
+    {
+        src[i] = infer_terms_id (&terms, vec_str_nth (ants, i), 1);
+        dst[i] = infer_terms_id (&terms, vec_str_nth (cons, i), 1);
+        terms.count[src[i]]++;
+        terms.count[dst[i]]--;
+    }
+
+    // Group the edges by the sentence they leave.
+    start = (int *) calloc (terms.num_terms + 1, sizeof (int));
+    CHECK_ALLOC (start, AEC_MEM);
+    adj = (int *) calloc (num_edges + 1, sizeof (int));
+    CHECK_ALLOC (adj, AEC_MEM);
+
+    for (i = 0; i < num_edges; i++)
+        start[src[i] + 1]++;
+    for (t = 0; t < terms.num_terms; t++)
+        start[t + 1] += start[t];
+    for (i = 0; i < num_edges; i++)
+        adj[start[src[i]]++] = dst[i];
+    for (t = terms.num_terms; t > 0; t--)
+        start[t] = start[t - 1];
+    start[0] = 0;
+
+    // Find every sentence reachable from the first one.
+    seen = (char *) calloc (terms.num_terms, sizeof (char));
+    CHECK_ALLOC (seen, AEC_MEM);
+    queue = (int *) calloc (terms.num_terms, sizeof (int));
+    CHECK_ALLOC (queue, AEC_MEM);
+
+    head = tail = 0;
+    seen[a] = 1;
+    queue[tail++] = a;
+    while (head < tail)
+    {
+        t = queue[head++];
+        for (i = start[t]; i < start[t + 1]; i++)
+        {
+            if (!seen[adj[i]])
+            {
+                seen[adj[i]] = 1;
+                queue[tail++] = adj[i];
+            }
+        }
+    }
+
+    if (a == z)
+    {
+        ret = -3;
+    }
+    else if (!seen[z])
+    {
+        ret = -2;
+    }
+    else
+    {
+        for (i = 0; i < num_edges && ret == 0; i++)
+        {
+            if (!seen[src[i]])
+                ret = -3;
+        }
+
+        for (t = 0; t < terms.num_terms && ret == 0; t++)
+        {
+            int bal = (t == a) ? 1 : ((t == z) ? -1 : 0);
+            if (terms.count[t] != bal)
+                ret = -3;
+        }
+    }
+
+    free (src);
+    free (dst);
+    free (start);
+    free (adj);
+    free (seen);
+    free (queue);
+    infer_terms_destroy (&terms);
+
+    return ret;
+}
+
 char *
 proc_cn (vec_t * prems, unsigned char * conc)
 {
@@ -252,7 +540,7 @@ proc_cn (vec_t * prems, unsigned char * conc)
     }
 
     int cmp_chk;
-    cmp_chk = vec_str_cmp (prems, gg_vec);
+    cmp_chk = infer_terms_cmp (prems, gg_vec);
     if (cmp_chk == AEC_MEM)
         return NULL;
 
@@ -330,46 +618,14 @@ proc_hs (vec_t * prems, unsigned char * conc)
             return NULL;
     }
 
-    // Iterate through each antecedent, matching it with a consequence.
+    // Check that the references chain from the antecedent of the
+    // conclusion to its consequence.
 
-    unsigned char * cur_con;
-    short * check;
+    int chain_chk;
 
-    cur_con = c_lsen;
-    check = (short *) calloc (prems->num_stuff, sizeof (short));
-    CHECK_ALLOC (check, NULL);
-
-    while (strcmp (cur_con, c_rsen))
-    {
-        for (i = 0; i < ants->num_stuff; i++)
-        {
-            if (check[i])
-                continue;
-
-            unsigned char * cur_ant;
-            cur_ant = vec_str_nth (ants, i);
-
-            if (!strcmp (cur_con, cur_ant))
-            {
-                check[i] = 1;
-                cur_con = vec_str_nth (cons, i);
-                break;
-            }
-        }
-
-        if (i == ants->num_stuff)
-        {
-            free (check);
-
-            destroy_str_vec (ants);
-            destroy_str_vec (cons);
-
-            free (c_lsen);
-            free (c_rsen);
-
-            return _("One of the consequences of a reference does not match an antecedent.");
-        }
-    }
+    chain_chk = infer_check_chain (c_lsen, c_rsen, ants, cons);
+    if (chain_chk == AEC_MEM)
+        return NULL;
 
     free (c_lsen);
     free (c_rsen);
@@ -377,18 +633,14 @@ proc_hs (vec_t * prems, unsigned char * conc)
     destroy_str_vec (ants);
     destroy_str_vec (cons);
 
-    // Confirm that each reference was used.
-
-    for (i = 0; i < prems->num_stuff; i++)
+    switch (chain_chk)
     {
-        if (!check[i])
-        {
-            free (check);
-            return _("All of the references must be used.");
-        }
+    case 0:
+        return CORRECT;
+    case -2:
+        return _("One of the consequences of a reference does not match an antecedent.");
     }
-
-    return CORRECT;
+    return _("All of the references must be used.");
 }
 
 char *
@@ -469,7 +721,7 @@ proc_ds (vec_t * prems, unsigned char * conc)
     if (ret_chk < 0)
         return NULL;
 
-    ret_chk = vec_str_cmp (gg_vec, not_refs);
+    ret_chk = infer_terms_cmp (gg_vec, not_refs);
     if (ret_chk == AEC_MEM)
         return NULL;
 
@@ -626,11 +878,11 @@ proc_cd (vec_t * prems, unsigned char * conc)
 
     int ants_ret_chk, cons_ret_chk;
 
-    ants_ret_chk = vec_str_cmp (ref_gg_vec, ants);
+    ants_ret_chk = infer_terms_cmp (ref_gg_vec, ants);
     if (ants_ret_chk == AEC_MEM)
         return NULL;
 
-    cons_ret_chk = vec_str_cmp (conc_gg_vec, cons);
+    cons_ret_chk = infer_terms_cmp (conc_gg_vec, cons);
     if (cons_ret_chk == AEC_MEM)
         return NULL;
 
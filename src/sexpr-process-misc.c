@@ -26,6 +26,7 @@
 #include "../src/list.h"
 #include "../src/sen-data.h"
 #include "../src/var.h"
+#include "../src/var-index.h"
 
 int
 sexpr_id_chk (unsigned char * cur_ref, int * pf_id, vec_t * cur_sen_ids)
@@ -257,7 +258,7 @@ equiv_lemma (unsigned char * prem,
 }
 
 char *
-process_misc (unsigned char * conc, vec_t * prems, const char * rule, vec_t * vars,
+process_misc (unsigned char * conc, vec_t * prems, const char * rule, var_index * vars,
              proof_t * proof)
 {
     char * ret = NOT_MINE;
@@ -506,7 +507,7 @@ proc_sp (unsigned char * prem_0, unsigned char * prem_1, unsigned char * conc)
 }
 
 char *
-proc_sq (unsigned char * conc, vec_t * vars)
+proc_sq (unsigned char * conc, var_index * vars)
 {
     unsigned char * scope, * var, quant[S_CL + 1];
 
@@ -580,15 +581,10 @@ proc_sq (unsigned char * conc, vec_t * vars)
     }
 
     int i;
-    for (i = 0; i < vars->num_stuff; i++)
-    {
-        variable * cur_var;
-        cur_var = vec_nth (vars, i);
-        if (!strcmp (cur_var->text, vec_str_nth (args_0, 0)))
-            break;
-    }
+    unsigned char * seq_var;
+    seq_var = vec_str_nth (args_0, 0);
 
-    if (i != vars->num_stuff)
+    if (var_index_find (vars, seq_var, strlen ((const char *) seq_var)))
     {
         destroy_str_vec (args);
         destroy_str_vec (args_0);
@@ -669,7 +665,7 @@ proc_sq (unsigned char * conc, vec_t * vars)
 }
 
 char *
-proc_in (unsigned char * prem_0, unsigned char * prem_1, unsigned char * conc, vec_t * vars)
+proc_in (unsigned char * prem_0, unsigned char * prem_1, unsigned char * conc, var_index * vars)
 {
     unsigned char * c_scope, * c_var, c_quant[S_CL + 1];
 
@@ -18,6 +18,8 @@
 
 #include "process.h"
 #include "sexpr-process.h"
+#include "sexpr-scope.h"
+#include "var-index.h"
 #include "../src/vec.h"
 #include "../src/var.h"
 #include "../src/list.h"
@@ -250,9 +252,9 @@ sexpr_add_not (unsigned char * in_str)
 {
     unsigned char * not_in_str;
 
-    not_in_str = (unsigned char *) calloc (strlen (in_str) + S_NL + 3, sizeof (char));
+    not_in_str = (unsigned char *) calloc (strlen (in_str) + S_NL + 4, sizeof (char));
     CHECK_ALLOC (not_in_str, NULL);
-    sprintf (not_in_str, "(%s %s)\0", S_NOT, in_str);
+    sprintf (not_in_str, "(%s %s)", S_NOT, in_str);
 
     return not_in_str;
 }
@@ -465,6 +467,418 @@ sexpr_find_unmatched (unsigned char * sen_a, unsigned char * sen_b,
     return 0;
 }
 
+// The base of the hashes that sexpr_diff compares subterms with.
+#define DIFF_HASH_BASE 1000003UL
+
+/* A sentence being compared by sexpr_diff. */
+struct diff_text {
+    const unsigned char * str;  // The sentence.
+    int len;                    // The length of str.
+    int * match;                // The parenthesis matches of str.
+    unsigned long * hash;       // The hash of each prefix of str.
+    int * kids;                 // Holds the elements of a list of str.
+};
+
+/* A pair of subterms waiting to be compared by sexpr_diff. */
+struct diff_pair {
+    int a_pos, b_pos;
+    int parent;
+};
+
+/* Sets up a sentence to be compared by sexpr_diff.
+ *  input:
+ *    txt - the text to set up.
+ *    str - the sentence.
+ *  output:
+ *    0 on success, -1 on memory error.
+ */
+static int
+diff_text_init (struct diff_text * txt, const unsigned char * str)
+{
+    int i;
+
+    txt->str = str;
+    txt->len = strlen ((const char *) str);
+
+    txt->match = match_parens (str, txt->len);
+    if (!txt->match)
+        return AEC_MEM;
+
+    txt->hash = (unsigned long *) calloc (txt->len + 1, sizeof (unsigned long));
+    CHECK_ALLOC (txt->hash, AEC_MEM);
+
+    txt->kids = (int *) calloc (txt->len + 1, sizeof (int));
+    CHECK_ALLOC (txt->kids, AEC_MEM);
+
+    txt->hash[0] = 0;
+    for (i = 0; i < txt->len; i++)
+        txt->hash[i + 1] = txt->hash[i] * DIFF_HASH_BASE + str[i];
+
+    return 0;
+}
+
+/* Frees the data of a sentence compared by sexpr_diff.
+ *  input:
+ *    txt - the text to free.
+ *  output:
+ *    none.
+ */
+static void
+diff_text_destroy (struct diff_text * txt)
+{
+    if (txt->match)  free (txt->match);
+    if (txt->hash)   free (txt->hash);
+    if (txt->kids)   free (txt->kids);
+}
+
+/* Finds the end of a subterm.
+ *  input:
+ *    txt - the sentence holding the subterm.
+ *    pos - the beginning of the subterm.
+ *  output:
+ *    the position just past the subterm, or -2 if it is malformed.
+ */
+static int
+diff_term_end (struct diff_text * txt, int pos)
+{
+    int end;
+
+    if (txt->str[pos] == '(')
+        return (txt->match[pos] < 0) ? -2 : txt->match[pos] + 1;
+
+    for (end = pos; end < txt->len; end++)
+    {
+        if (txt->str[end] == ' ' || txt->str[end] == '('
+            || txt->str[end] == ')')
+            break;
+    }
+
+    return (end == pos) ? -2 : end;
+}
+
+/* Finds the elements of a list.
+ *  The positions of the elements are placed in txt->kids.
+ *  input:
+ *    txt - the sentence holding the list.
+ *    pos - the opening parenthesis of the list.
+ *  output:
+ *    the number of elements, or -2 if the list is malformed.
+ */
+static int
+diff_list_kids (struct diff_text * txt, int pos)
+{
+    int end, num = 0;
+
+    end = txt->match[pos];
+    pos++;
+
+    while (pos < end)
+    {
+        int kid_end;
+
+        kid_end = diff_term_end (txt, pos);
+        if (kid_end < 0 || kid_end > end)
+            return -2;
+
+        txt->kids[num++] = pos;
+        pos = kid_end;
+        if (txt->str[pos] == ' ')
+            pos++;
+    }
+
+    return num;
+}
+
+/* Determines whether two subterms are the same.
+ *  The hashes are compared first, so that only subterms that are likely
+ *  to be the same are compared character by character.
+ *  input:
+ *    a, b - the sentences holding the subterms.
+ *    a_pos, a_end - the span of the subterm of a.
+ *    b_pos, b_end - the span of the subterm of b.
+ *    pows - the powers of the hash base.
+ *  output:
+ *    1 if the subterms are the same, 0 otherwise.
+ */
+static int
+diff_same (struct diff_text * a, int a_pos, int a_end,
+           struct diff_text * b, int b_pos, int b_end,
+           const unsigned long * pows)
+{
+    int len = a_end - a_pos;
+    unsigned long a_hash, b_hash;
+
+    if (len != b_end - b_pos)
+        return 0;
+
+    a_hash = a->hash[a_end] - a->hash[a_pos] * pows[len];
+    b_hash = b->hash[b_end] - b->hash[b_pos] * pows[len];
+    if (a_hash != b_hash)
+        return 0;
+
+    return !memcmp (a->str + a_pos, b->str + b_pos, len);
+}
+
+/* Finds the differing subterms of two sexpr sentences.
+ *  Both sentences are walked together, once.  Where two differing lists
+ *  have the same head and the same number of elements, the walk goes into
+ *  their elements; any other pair of differing subterms is a minimal pair.
+ *  input:
+ *    sen_a, sen_b - the sentences to compare.
+ *    sites - a vector of sexpr_site that receives, in preorder, every pair
+ *      of differing subterms that the walk visits.
+ *  output:
+ *    the number of minimal pairs, -1 on memory error,
+ *    or -2 if either sentence is malformed.
+ */
+int
+sexpr_diff (unsigned char * sen_a, unsigned char * sen_b, vec_t * sites)
+{
+    struct diff_text a, b;
+    struct diff_pair pair;
+    unsigned long * pows;
+    vec_t * stack;
+    int i, max_len, ret = 0;
+
+    memset (&a, 0, sizeof (struct diff_text));
+    memset (&b, 0, sizeof (struct diff_text));
+
+    if (diff_text_init (&a, sen_a) == AEC_MEM
+        || diff_text_init (&b, sen_b) == AEC_MEM)
+        return AEC_MEM;
+
+    max_len = (a.len > b.len) ? a.len : b.len;
+    pows = (unsigned long *) calloc (max_len + 1, sizeof (unsigned long));
+    CHECK_ALLOC (pows, AEC_MEM);
+
+    pows[0] = 1;
+    for (i = 0; i < max_len; i++)
+        pows[i + 1] = pows[i] * DIFF_HASH_BASE;
+
+    stack = init_vec (sizeof (struct diff_pair));
+    if (!stack)
+        return AEC_MEM;
+
+    if (a.len > 0 && b.len > 0)
+    {
+        pair.a_pos = pair.b_pos = 0;
+        pair.parent = -1;
+        if (vec_add_obj (stack, &pair) < 0)
+            return AEC_MEM;
+    }
+    else if (a.len != b.len)
+    {
+        ret = -2;
+    }
+
+    while (stack->num_stuff > 0 && ret >= 0)
+    {
+        sexpr_site site;
+        int num_a, num_b;
+
+        pair = *((struct diff_pair *) vec_nth (stack, stack->num_stuff - 1));
+        vec_pop_obj (stack);
+
+        site.a_pos = pair.a_pos;
+        site.b_pos = pair.b_pos;
+        site.a_end = diff_term_end (&a, pair.a_pos);
+        site.b_end = diff_term_end (&b, pair.b_pos);
+        if (site.a_end < 0 || site.b_end < 0)
+        {
+            ret = -2;
+            break;
+        }
+
+        if (diff_same (&a, site.a_pos, site.a_end,
+                       &b, site.b_pos, site.b_end, pows))
+            continue;
+
+        site.parent = pair.parent;
+        site.last = sites->num_stuff;
+        site.leaf = 1;
+
+        num_a = num_b = 0;
+        if (sen_a[site.a_pos] == '(' && sen_b[site.b_pos] == '(')
+        {
+            num_a = diff_list_kids (&a, site.a_pos);
+            num_b = diff_list_kids (&b, site.b_pos);
+            if (num_a == -2 || num_b == -2)
+            {
+                ret = -2;
+                break;
+            }
+        }
+
+        // A list whose head changed, or whose length changed, is the
+        // smallest subterm that holds the difference.
+        if (num_a > 0 && num_a == num_b
+            && diff_same (&a, a.kids[0], diff_term_end (&a, a.kids[0]),
+                          &b, b.kids[0], diff_term_end (&b, b.kids[0]),
+                          pows))
+        {
+            site.leaf = 0;
+
+            // Push the elements backwards, so that they are visited in order.
+            for (i = num_a - 1; i > 0; i--)
+            {
+                pair.a_pos = a.kids[i];
+                pair.b_pos = b.kids[i];
+                pair.parent = sites->num_stuff;
+                if (vec_add_obj (stack, &pair) < 0)
+                    return AEC_MEM;
+            }
+        }
+        else
+        {
+            ret++;
+        }
+
+        if (vec_add_obj (sites, &site) < 0)
+            return AEC_MEM;
+    }
+
+    // Every pair comes after the pair that holds it.
+    for (i = sites->num_stuff - 1; i >= 0; i--)
+    {
+        sexpr_site * cur_site, * par_site;
+
+        cur_site = vec_nth (sites, i);
+        if (cur_site->parent < 0)
+            continue;
+
+        par_site = vec_nth (sites, cur_site->parent);
+        if (par_site->last < cur_site->last)
+            par_site->last = cur_site->last;
+    }
+
+    destroy_vec (stack);
+    free (pows);
+    diff_text_destroy (&a);
+    diff_text_destroy (&b);
+
+    return ret;
+}
+
+/* Copies a span of a string.
+ *  input:
+ *    in_str - the string to copy from.
+ *    pos - the beginning of the span.
+ *    end - the position just past the span.
+ *  output:
+ *    the copy, or NULL on memory error.
+ */
+static unsigned char *
+copy_span (const unsigned char * in_str, int pos, int end)
+{
+    unsigned char * out_str;
+
+    out_str = (unsigned char *) calloc (end - pos + 1, sizeof (char));
+    CHECK_ALLOC (out_str, NULL);
+    strncpy (out_str, in_str + pos, end - pos);
+    out_str[end - pos] = '\0';
+
+    return out_str;
+}
+
+/* Checks a rule at each site where two sentences differ.
+ *  Each minimal pair from sexpr_diff is checked on its own.  If the rule
+ *  does not apply to a pair, the pairs that hold it are tried in turn,
+ *  since a rule that changes the shape of a subterm can line up the
+ *  wrong parts of the two sentences.
+ *  input:
+ *    prem - the premise.
+ *    conc - the conclusion.
+ *    check - checks one application of the rule at the top of two subterms.
+ *  output:
+ *    NO_DIFFERENCE if the sentences are the same, CORRECT if the rule
+ *    applies at every site, the error from check if it does not,
+ *    or NULL on memory error.
+ */
+char *
+sexpr_check_sites (unsigned char * prem, unsigned char * conc,
+                   sexpr_site_func check)
+{
+    vec_t * sites;
+    int num_leaves, i;
+    char * ret = CORRECT;
+
+    sites = init_vec (sizeof (sexpr_site));
+    if (!sites)
+        return NULL;
+
+    num_leaves = sexpr_diff (prem, conc, sites);
+    if (num_leaves == AEC_MEM)
+        return NULL;
+
+    if (num_leaves == 0)
+    {
+        destroy_vec (sites);
+        return NO_DIFFERENCE;
+    }
+
+    if (num_leaves == -2)
+    {
+        destroy_vec (sites);
+        return check (prem, conc);
+    }
+
+    i = 0;
+    while (i < sites->num_stuff)
+    {
+        sexpr_site * site;
+        char * first_err = NULL;
+        int cur;
+
+        site = vec_nth (sites, i);
+        if (!site->leaf)
+        {
+            i++;
+            continue;
+        }
+
+        for (cur = i; cur >= 0; cur = site->parent)
+        {
+            unsigned char * p_str, * c_str;
+
+            site = vec_nth (sites, cur);
+
+            p_str = copy_span (prem, site->a_pos, site->a_end);
+            if (!p_str)
+                return NULL;
+
+            c_str = copy_span (conc, site->b_pos, site->b_end);
+            if (!c_str)
+                return NULL;
+
+            ret = check (p_str, c_str);
+            free (p_str);
+            free (c_str);
+
+            if (!ret)
+                return NULL;
+
+            if (ret == CORRECT || ret == NO_DIFFERENCE)
+                break;
+
+            if (!first_err)
+                first_err = ret;
+        }
+
+        if (cur < 0)
+        {
+            ret = first_err;
+            break;
+        }
+
+        // Everything within the pair that was checked is accounted for.
+        ret = CORRECT;
+        i = site->last + 1;
+    }
+
+    destroy_vec (sites);
+    return ret;
+}
+
 /* Get the predicate arguments from a sexpr string.
  *  input:
  *    in_str - the sexpr text from which to get the predicate arguments.
@@ -542,6 +956,8 @@ sexpr_elim_quant (unsigned char * in_str, unsigned char * quant,
 }
 
 /* Get the offsets from the start of a quantifier's scope of its variable.
+ *  Only the occurrences that the quantifier binds are found, so a nested
+ *  quantifier of the same variable hides its own scope.
  *  input:
  *    in_str - the sexpr string from which to obtain the offsets.
  *    var - a vector of integers that receives the offsets.
@@ -551,35 +967,37 @@ sexpr_elim_quant (unsigned char * in_str, unsigned char * quant,
 int
 sexpr_get_quant_vars (unsigned char * in_str, vec_t * vars)
 {
-    unsigned char * scope, quant[S_CL + 1], * var;
+    sexpr_scope * sc;
+    int var, scope_pos, i, ret_chk;
 
-    scope = sexpr_elim_quant (in_str, quant, &var);
-    if (!scope)
+    sc = sexpr_scope_init (in_str);
+    if (!sc)
         return AEC_MEM;
 
-    if (scope[0] == '\0')
+    var = sexpr_scope_quant (sc, 0);
+    if (var < 0)
+    {
+        sexpr_scope_destroy (sc);
         return -2;
+    }
 
-    int i, v_len, ret_chk;
-
-    v_len = strlen (var);
+    // The scope begins after the quantifier and its variable.
+    scope_pos = sc->match[1] + 2;
 
-    for (i = 0; scope[i] != '\0'; i++)
+    for (i = scope_pos; i < sc->len; i++)
     {
-        if (strncmp (scope + i, var, v_len))
-            continue;
+        int off;
 
-        if (scope[i - 1] == '(')
+        if (sc->binder[i] != var)
             continue;
 
-        if (scope[i + 1] != ')' && scope[i + 1] != ' ')
-            continue;
-
-        ret_chk = vec_add_obj (vars, &i);
+        off = i - scope_pos;
+        ret_chk = vec_add_obj (vars, &off);
         if (ret_chk < 0)
             return AEC_MEM;
     }
 
+    sexpr_scope_destroy (sc);
     return vars->num_stuff;
 }
 
@@ -626,189 +1044,284 @@ sexpr_replace_var (unsigned char * in_str, unsigned char * new_var,
     return 0;
 }
 
-/* Processes the standard quantifier inference rules.
+/* A quantified variable being instantiated by sexpr_quant_infer. */
+struct quant_hole {
+    int var;        // The position of the variable in the quantified sentence.
+    int pos, end;   // The span of its instance in the other sentence, or -1.
+    int uses;       // The number of places the instance was matched.
+};
+
+/* Counts the quantifiers of one kind at the start of a sentence.
  *  input:
- *    quant_sen - the quantifier sentence.
- *    elim_sen - the other sentence.
+ *    sc - the resolved sentence.
  *    quant - the quantifier.
- *    cons - the constraints - 0 normally, 1 for ug, 2 for ei.
- *    cur_vars - the current variables, or NULL if they're not neccessary.
+ *    holes - receives the quantifiers' variables, or NULL.
  *  output:
- *    0 - success
- *    1 - the strings are the same
- *    -1 - memory error
- *    -2 - general error
- *    -3 - variable error
+ *    the number of quantifiers.
  */
-int
-sexpr_quant_infer (unsigned char * quant_sen, unsigned char * elim_sen,
-                  unsigned char * quant, int cons, vec_t * cur_vars)
+static int
+quant_chain (sexpr_scope * sc, unsigned char * quant, struct quant_hole * holes)
 {
-    if (!strcmp (quant_sen, elim_sen))
-        return 1;
-
-    if (quant_sen[0] != '(' || quant_sen[1] != '(')
-        return -2;
+    int pos = 0, num = 0, var;
 
-    unsigned char * var, * elm_sen, qs_quant[S_CL + 1];
+    while ((var = sexpr_scope_quant (sc, pos)) >= 0
+           && !strncmp (sc->sen + pos + 2, quant, S_CL))
+    {
+        if (holes)
+        {
+            holes[num].var = var;
+            holes[num].pos = holes[num].end = -1;
+            holes[num].uses = 0;
+        }
 
-    elm_sen = sexpr_elim_quant (quant_sen, qs_quant, &var);
-    if (!elm_sen)
-        return AEC_MEM;
+        num++;
+        pos = sc->match[pos + 1] + 2;
+    }
 
-    if (elm_sen[0] == '\0' || strcmp (qs_quant, quant))
-        return -2;
+    return num;
+}
 
-    int q_pos, e_pos, cmp, tmp_0;
+/* Matches a quantifier's scope against an instance of it.
+ *  The scope and the instance are walked together once.  Each place
+ *  bound by one of the quantifiers is a hole; the first instance found
+ *  for a hole is kept, and every later one must be the same.
+ *  input:
+ *    q_sc - the resolved quantified sentence.
+ *    pos - the beginning of the scope in q_sc.
+ *    e_sc - the resolved instance.
+ *    holes - the holes, with their instances unset.
+ *    hole_of - for each position of q_sc, the hole of the variable there,
+ *      or -1.
+ *  output:
+ *    1 if the instance matches, 0 otherwise.
+ */
+static int
+quant_match (sexpr_scope * q_sc, int pos, sexpr_scope * e_sc,
+             struct quant_hole * holes, int * hole_of)
+{
+    unsigned char * q_sen = q_sc->sen, * e_sen = e_sc->sen;
+    int end, i, j;
 
-    cmp = 0;
-    tmp_0 = -2;
+    end = sexpr_scope_term_end (q_sc, pos);
 
-    while (!cmp)
+    for (i = pos, j = 0; i < end; )
     {
-        int tmp_1;
-        unsigned char * str_0, * str_1;
-
-        q_pos = tmp_0 + 2;
-
-        if (elm_sen[q_pos + 1] != '(')
-            break;
+        int h, q_end, e_end, k;
 
-        tmp_0 = parse_parens (elm_sen, q_pos + 1, &str_0);
-        if (tmp_0 == AEC_MEM)
-            return AEC_MEM;
+        if (j >= e_sc->len)
+            return 0;
 
-        if (elim_sen[1] != '(')
+        if (q_sc->binder[i] == SCOPE_NONE)
         {
-            free (str_0);
-            q_pos = tmp_0 + 2;
-            continue;
+            // A parenthesis, a space or the head of a list.
+            if (q_sen[i] == '(' || q_sen[i] == ')' || q_sen[i] == ' ')
+            {
+                if (q_sen[i] != e_sen[j])
+                    return 0;
+
+                i++;
+                j++;
+                continue;
+            }
         }
 
-        tmp_1 = parse_parens (elim_sen, 1, &str_1);
-        if (tmp_1 == AEC_MEM)
-            return AEC_MEM;
+        q_end = sexpr_scope_term_end (q_sc, i);
+        e_end = sexpr_scope_term_end (e_sc, j);
 
-        cmp = !strcmp (str_0, str_1);
-        free (str_0);
-        free (str_1);
-    }
+        h = (q_sc->binder[i] >= 0) ? hole_of[q_sc->binder[i]] : -1;
+        if (h < 0)
+        {
+            if (e_sen[j] == '(' || q_end - i != e_end - j
+                || memcmp (q_sen + i, e_sen + j, q_end - i))
+                return 0;
 
-    // Determine the offset, and get the quantifier's variable positions.
+            i = q_end;
+            j = e_end;
+            continue;
+        }
 
-    int offset, ret_chk;
-    vec_t * var_offs;
+        if (holes[h].pos < 0)
+        {
+            holes[h].pos = j;
+            holes[h].end = e_end;
+        }
+        else if (holes[h].end - holes[h].pos != e_end - j
+                 || memcmp (e_sen + holes[h].pos, e_sen + j, e_end - j))
+        {
+            return 0;
+        }
+        holes[h].uses++;
 
-    offset = q_pos;
-    var_offs = init_vec (sizeof (int));
-    if (!var_offs)
-        return AEC_MEM;
+        // The instance must not be caught by a quantifier around the hole.
+        for (k = j; k < e_end; k++)
+        {
+            if (e_sc->binder[k] >= 0)
+                return 0;
+        }
 
-    ret_chk = sexpr_get_quant_vars (quant_sen, var_offs);
-    if (ret_chk == AEC_MEM)
-        return AEC_MEM;
+        i = q_end;
+        j = e_end;
+    }
 
-    // Use the offset to determine the position of the first variable in elim_sen.
-    // Get the variable from elim_sen.
+    return (j == e_sc->len);
+}
 
-    int * off_0;
-    unsigned char * oth_sen, * new_var = NULL;
+/* Counts the free occurrences of a symbol in a sentence.
+ *  input:
+ *    sc - the resolved sentence.
+ *    pos - the beginning of the symbol in sc.
+ *    end - the end of the symbol in sc.
+ *  output:
+ *    the number of free occurrences.
+ */
+static int
+quant_count_free (sexpr_scope * sc, int pos, int end)
+{
+    int i, num = 0;
 
-    off_0 = vec_nth (var_offs, 0);
-    if (!off_0)
+    for (i = 0; i < sc->len; i++)
     {
-        destroy_vec (var_offs);
-        free (elm_sen);
-        return -2;
-    }
-    q_pos = e_pos = *off_0 - offset;
+        if (sc->binder[i] != SCOPE_FREE)
+            continue;
 
-    if (elim_sen[e_pos] == '(')
-    {
-        q_pos = parse_parens (elim_sen, e_pos, &new_var);
-        if (q_pos == AEC_MEM)
-            return AEC_MEM;
+        if (sexpr_scope_term_end (sc, i) - i == end - pos
+            && !memcmp (sc->sen + i, sc->sen + pos, end - pos))
+            num++;
     }
-    else
-    {
-        while (elim_sen[q_pos] != ' ' && elim_sen[q_pos] != ')')
-            q_pos++;
-
-        new_var = (unsigned char *) calloc (q_pos - e_pos + 1, sizeof (char));
-        CHECK_ALLOC (new_var, AEC_MEM);
 
-        strncpy (new_var, elim_sen + e_pos, q_pos - e_pos);
-        new_var[q_pos - e_pos] = '\0';
-    }
+    return num;
+}
 
-    // If there are constraints, then check them.
+/* Checks the instances of quantified variables against the constraints
+ * of a rule.
+ *  input:
+ *    e_sc - the resolved instance.
+ *    holes - the quantified variables and their instances.
+ *    cons - the constraints - 1 for ug, 2 for ei.
+ *    cur_vars - the current variables.
+ *  output:
+ *    0 if the constraints are met, -2 if the instance of ug is not
+ *    general, or -3 if a variable may not be used.
+ */
+static int
+quant_check_cons (sexpr_scope * e_sc, struct quant_hole * holes,
+                  int num_holes, int cons, var_index * cur_vars)
+{
+    variable * cur_var;
+    int h, i;
 
-    if (cons)
+    for (h = 0; h < num_holes; h++)
     {
-        int i;
+        struct quant_hole * hole = holes + h;
+        int len = hole->end - hole->pos;
 
-        for (i = 0; new_var[i] != '\0'; i++)
-            if (new_var[i] == ' ')
-                break;
+        if (hole->pos < 0)
+            continue;
 
-        if (new_var[i] != '\0')
-        {
-            free (new_var);
-            destroy_vec (var_offs);
-            free (elm_sen);
+        for (i = hole->pos; i < hole->end; i++)
+            if (e_sc->sen[i] == ' ' || e_sc->sen[i] == '(')
+                return -3;
+
+        cur_var = var_index_find (cur_vars, e_sc->sen + hole->pos, len);
+        if (cur_var && (cons == 2 || (cons == 1 && !cur_var->arbitrary)))
             return -3;
-        }
 
-        for (i = 0; i < cur_vars->num_stuff; i++)
-        {
-            variable * cur_var;
-            cur_var = vec_nth (cur_vars, i);
-            if (!strcmp (cur_var->text, new_var))
-                break;
-        }
+        if (cons != 1)
+            continue;
 
-        if (i != cur_vars->num_stuff)
+        // Every occurrence of a generalized variable must be generalized,
+        // each by its own quantifier.
+        for (i = 0; i < h; i++)
         {
-            variable * cur_var;
-            cur_var = vec_nth (cur_vars, i);
-
-            if (cons == 2 || (cons == 1 && !cur_var->arbitrary))
-            {
-                free (new_var);
-                destroy_vec (var_offs);
-                free (elm_sen);
-                return -3;
-            }
+            if (holes[i].pos >= 0 && holes[i].end - holes[i].pos == len
+                && !memcmp (e_sc->sen + holes[i].pos, e_sc->sen + hole->pos, len))
+                return -2;
         }
+
+        if (quant_count_free (e_sc, hole->pos, hole->end) != hole->uses)
+            return -2;
     }
 
-    ret_chk = sexpr_replace_var (elm_sen, new_var, var, var_offs, &oth_sen);
-    if (ret_chk == AEC_MEM)
+    return 0;
+}
+
+/* Processes the standard quantifier inference rules.
+ *  The quantifiers of quant_sen that elim_sen leaves out are instantiated
+ *  by matching their scope against elim_sen.  Except for ei, several
+ *  quantifiers of the same kind may be instantiated at once.
+ *  input:
+ *    quant_sen - the quantifier sentence.
+ *    elim_sen - the other sentence.
+ *    quant - the quantifier.
+ *    cons - the constraints - 0 normally, 1 for ug, 2 for ei.
+ *    cur_vars - the current variables, or NULL if they're not neccessary.
+ *  output:
+ *    0 - success
+ *    1 - the strings are the same
+ *    -1 - memory error
+ *    -2 - general error
+ *    -3 - variable error
+ */
+int
+sexpr_quant_infer (unsigned char * quant_sen, unsigned char * elim_sen,
+                  unsigned char * quant, int cons, var_index * cur_vars)
+{
+    if (!strcmp (quant_sen, elim_sen))
+        return 1;
+
+    sexpr_scope * q_sc, * e_sc;
+
+    q_sc = sexpr_scope_init (quant_sen);
+    if (!q_sc)
         return AEC_MEM;
 
-    free (var);
-    free (elm_sen);
-    destroy_vec (var_offs);
-    free (new_var);
+    e_sc = sexpr_scope_init (elim_sen);
+    if (!e_sc)
+        return AEC_MEM;
 
-    if (cons != 2)
-    {
-        ret_chk = sexpr_quant_infer (oth_sen, elim_sen, quant, cons, cur_vars);
-        if (ret_chk == AEC_MEM)
-            return AEC_MEM;
+    struct quant_hole * holes;
+    int * hole_of;
+    int num_q, num_holes, pos, h, ret;
 
-        ret_chk = (ret_chk == 1) ? 0 : ret_chk;
+    holes = (struct quant_hole *) calloc (q_sc->num_binders + 1,
+                                          sizeof (struct quant_hole));
+    CHECK_ALLOC (holes, AEC_MEM);
+
+    // The instance still has the quantifiers that were not instantiated.
+    num_q = quant_chain (q_sc, quant, holes);
+    num_holes = num_q - quant_chain (e_sc, quant, NULL);
+
+    if (num_holes < 1 || (cons == 2 && num_holes != 1))
+    {
+        free (holes);
+        sexpr_scope_destroy (q_sc);
+        sexpr_scope_destroy (e_sc);
+        return -2;
     }
-    else
+
+    hole_of = (int *) calloc (q_sc->len + 1, sizeof (int));
+    CHECK_ALLOC (hole_of, AEC_MEM);
+
+    for (pos = 0; pos < q_sc->len; pos++)
+        hole_of[pos] = -1;
+
+    pos = 0;
+    for (h = 0; h < num_holes; h++)
     {
-        ret_chk = strcmp (oth_sen, elim_sen);
+        hole_of[holes[h].var] = h;
+        pos = q_sc->match[pos + 1] + 2;
     }
 
-    free (oth_sen);
-    if (ret_chk)
-        return -2;
+    ret = -2;
+    if (quant_match (q_sc, pos, e_sc, holes, hole_of))
+        ret = cons ? quant_check_cons (e_sc, holes, num_holes, cons, cur_vars) : 0;
 
-    return 0;
+    free (hole_of);
+    free (holes);
+    sexpr_scope_destroy (q_sc);
+    sexpr_scope_destroy (e_sc);
+
+    return ret;
 }
 
 /* Determines the positions in a string of a variable.
@@ -910,69 +1423,51 @@ sexpr_parse_vars (unsigned char * in_str, vec_t * vars, int quant)
     return vars->num_stuff;
 }
 
-/* Collect variables from a sentence to a list.
+/* Collect variables from a sentence to the variables of a proof.
+ *  Each variable is looked up in the index, so only the variables that
+ *  the sentence introduces are added.
  *  input:
- *    vars - the list of variables from a proof.
+ *    vars - the variables from a proof.
  *    text - the text of the sentence.
  *    arb - whether or not the variables are arbitrary.
+ *    line - the line of the sentence.
  *  output:
  *    0 on success, -1 on memory error.
  */
 int
-sexpr_collect_vars_to_proof (list_t * vars, unsigned char * text, int arb)
+sexpr_collect_vars_to_proof (var_index * vars, unsigned char * text, int arb,
+                             int line)
 {
-    int ret, i, is_arbitrary;
-    vec_t * sen_vars;
-
-    sen_vars = init_vec (sizeof (char *));
-    if (!sen_vars)
-        return AEC_MEM;
-
-    ret = sexpr_parse_vars (text, sen_vars, 0);
-    if (ret == AEC_MEM)
-        return AEC_MEM;
+    int i, ret;
 
-    is_arbitrary = arb;
-
-    if (sen_vars->num_stuff == 0)
-    {
-        destroy_str_vec (sen_vars);
+    // There are no variables in this string.
+    if (text[0] != '(')
         return 0;
-    }
 
-    for (i = 0; i < sen_vars->num_stuff; i++)
+    for (i = 1; text[i] != '\0'; i++)
     {
-        unsigned char * cur_var;
-        item_t * ap_var_itr;
-
-        cur_var = vec_str_nth (sen_vars, i);
-        ap_var_itr = vars->head;
+        int pos;
 
-        for (; ap_var_itr; ap_var_itr = ap_var_itr->next)
-        {
-            variable * var;
+        if (!islower (text[i]) || text[i - 1] != ' ')
+            continue;
 
-            var = ap_var_itr->value;
-            if (!strcmp (var->text, cur_var))
-                break;
-        }
+        pos = i;
+        while (text[pos] != ' ' && text[pos] != ')' && text[pos] != '\0')
+            pos++;
 
-        if (!ap_var_itr)
+        // Skip the variables of quantifiers.
+        if (i <= (S_CL + 1) ||
+            (strncmp (text + i - (1 + S_CL), S_UNV, S_CL)
+             && strncmp (text + i - (1 + S_CL), S_EXL, S_CL)))
         {
-            variable * var;
-            item_t * itm;
-
-            var = variable_init (cur_var, is_arbitrary);
-            if (!var)
-                return AEC_MEM;
-
-            itm = ls_push_obj (vars, var);
-            if (!itm)
+            ret = var_index_add (vars, text + i, pos - i, arb, line);
+            if (ret == AEC_MEM)
                 return AEC_MEM;
         }
+
+        i = pos - 1;
     }
 
-    destroy_str_vec (sen_vars);
     return 0;
 }
 
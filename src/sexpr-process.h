@@ -81,6 +81,20 @@ int find_unmatched_o_paren (unsigned char * in_str, int in_pos);
 
 int sexpr_find_unmatched (unsigned char * sen_a, unsigned char * sen_b, int * ai, int * bi);
 
+/* A pair of differing subterms, as found by sexpr_diff. */
+struct sexpr_site {
+    int a_pos, a_end;   // The span of the subterm in the first sentence.
+    int b_pos, b_end;   // The span of the subterm in the second sentence.
+    int parent;         // The index of the pair that holds this one, or -1.
+    int last;           // The index of the last pair within this one.
+    int leaf;           // Whether this is a minimal differing pair.
+};
+
+int sexpr_diff (unsigned char * sen_a, unsigned char * sen_b, vec_t * sites);
+
+char * sexpr_check_sites (unsigned char * prem, unsigned char * conc,
+                          sexpr_site_func check);
+
 int sexpr_get_pred_args (unsigned char * in_str, unsigned char ** pred, vec_t * args);
 
 unsigned char * sexpr_elim_quant (unsigned char * in_str, unsigned char * quant,
@@ -93,13 +107,14 @@ int sexpr_replace_var (unsigned char * in_str, unsigned char * new_var,
                       unsigned char ** out_str);
 
 int sexpr_quant_infer (unsigned char * quant_sen, unsigned char * elim_sen,
-                      unsigned char * quant, int cons, vec_t * cur_vars);
+                      unsigned char * quant, int cons, var_index * cur_vars);
 
 int sexpr_find_vars (unsigned char * in_str, unsigned char * var, vec_t * offsets);
 
 int sexpr_parse_vars (unsigned char * in_str, vec_t * vars, int quant);
 
-int sexpr_collect_vars_to_proof (list_t * vars, unsigned char * text, int arb);
+int sexpr_collect_vars_to_proof (var_index * vars, unsigned char * text, int arb,
+                                 int line);
 
 int sexpr_get_ids (unsigned char * sen, int ** ids, vec_t * sen_ids);
 
@@ -125,7 +140,7 @@ char * proc_cd (vec_t * prems, unsigned char * conc);
 
 char * proc_im (unsigned char * prem, unsigned char * conc);
 
-char * proc_dm (unsigned char * prem, unsigned char * conc, int mode_guess);
+char * proc_dm (unsigned char * prem, unsigned char * conc);
 
 char * proc_as (unsigned char * prem, unsigned char * conc);
 
@@ -133,7 +148,7 @@ char * proc_co (unsigned char * prem, unsigned char * conc);
 
 char * proc_id (unsigned char * prem, unsigned char * conc);
 
-char * proc_dt (unsigned char * prem, unsigned char * conc, int mode_guess);
+char * proc_dt (unsigned char * prem, unsigned char * conc);
 
 char * proc_eq (unsigned char * prem, unsigned char * conc);
 
@@ -145,13 +160,13 @@ char * proc_sb (unsigned char * prem, unsigned char * conc);
 
 /* Predicate rule functions. */
 
-char * proc_ug (unsigned char * prem, unsigned char * conc, vec_t * vars);
+char * proc_ug (unsigned char * prem, unsigned char * conc, var_index * vars);
 
 char * proc_ui (unsigned char * prem, unsigned char * conc);
 
 char * proc_eg (unsigned char * prem, unsigned char * conc);
 
-char * proc_ei (unsigned char * prem, unsigned char * conc, vec_t * vars);
+char * proc_ei (unsigned char * prem, unsigned char * conc, var_index * vars);
 
 char * proc_bv (unsigned char * prem, unsigned char * conc);
 
@@ -161,7 +176,7 @@ char * proc_pr (unsigned char * prem, unsigned char * conc);
 
 char * proc_ii (unsigned char * conc);
 
-char * proc_fv (unsigned char * prem_0,  unsigned char * prem_1, unsigned char * conc);
+char * proc_fv (vec_t * prems, unsigned char * conc);
 
 /* Boolean rule functions. */
 
@@ -179,9 +194,9 @@ char * proc_lm (vec_t * prems, unsigned char * conc, proof_t * proof);
 
 char * proc_sp (unsigned char * prem_0, unsigned char * prem_1, unsigned char * conc);
 
-char * proc_sq (unsigned char * conc, vec_t * vars);
+char * proc_sq (unsigned char * conc, var_index * vars);
 
-char * proc_in (unsigned char * prem_0, unsigned char * prem_1, unsigned char * conc, vec_t * vars);
+char * proc_in (unsigned char * prem_0, unsigned char * prem_1, unsigned char * conc, var_index * vars);
 #ifdef __cplusplus
 }
 #endif
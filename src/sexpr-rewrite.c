@@ -0,0 +1,1070 @@
+/* Functions for checking equivalence rules by rewriting.
+
+   Copyright (C) 2026 The GNU Aris contributors.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sexpr-rewrite.h"
+#include "vec.h"
+
+// The most variables that a single rewrite may use.
+#define RW_MAX_VARS 8
+
+// The size of each block of memory of a pool.
+#define RW_BLOCK_SIZE 16384
+
+/* Each equivalence rule is a set of rewrites from one pattern to another,
+ * written in the sexpr form that convert_sexpr produces.  An atom that
+ * begins with '?' is a variable, and "..." repeats the element before it
+ * one or more times.  A variable that only appears in repeated elements
+ * matches a sequence of terms; every other variable must match the same
+ * term wherever it appears.
+ *
+ * The rewrites of each rule only go one way, so that rewriting a sentence
+ * always comes to an end, and two sentences are equivalent by a rule if
+ * rewriting them as far as possible leaves the same sentence.  The
+ * rewrites of Subsumption overlap, so absorbing in different orders can
+ * leave different sentences; if rewriting the outermost terms first
+ * leaves different sentences, the innermost terms are rewritten first
+ * instead.  Adding a rule only takes adding its rewrites to this table.
+ */
+
+struct rw_rule {
+    const char * rule;  // The abbreviation of the rule.
+    const char * from;  // The pattern that is rewritten.
+    const char * to;    // The pattern that it is rewritten to.
+};
+
+static const struct rw_rule rw_rules[] = {
+    // Implication
+    { "im", "(<o> (<n> ?a) ?b)", "(<i> ?a ?b)" },
+
+    // DeMorgan
+    { "dm", "(<o> (<n> ?a) ...)", "(<n> (<a> ?a ...))" },
+    { "dm", "(<a> (<n> ?a) ...)", "(<n> (<o> ?a ...))" },
+    { "dm", "((<e> ?x) (<n> ?a))", "(<n> ((<u> ?x) ?a))" },
+    { "dm", "((<u> ?x) (<n> ?a))", "(<n> ((<e> ?x) ?a))" },
+
+    // Distribution
+    { "dt", "(<o> (<a> ?a ?b) ...)", "(<a> ?a (<o> ?b ...))" },
+    { "dt", "(<a> (<o> ?a ?b) ...)", "(<o> ?a (<a> ?b ...))" },
+    { "dt", "(<a> ((<u> ?x) ?a) ...)", "((<u> ?x) (<a> ?a ...))" },
+    { "dt", "(<o> ((<e> ?x) ?a) ...)", "((<e> ?x) (<o> ?a ...))" },
+
+    // Equivalence
+    { "eq", "(<a> (<i> ?a ?b) (<i> ?b ?a))", "(<b> ?a ?b)" },
+
+    // Double Negation
+    { "dn", "(<n> (<n> ?a))", "?a" },
+
+    // Exportation
+    { "ep", "(<i> (<a> ?a ?b) ?c)", "(<i> ?a (<i> ?b ?c))" },
+    { "ep", "(<i> (<a> ?a ?b ?c ...) ?d)", "(<i> ?a (<i> (<a> ?b ?c ...) ?d))" },
+
+    // Subsumption
+    { "sb", "(<a> ?a (<o> ?a ?b ...))", "?a" },
+    { "sb", "(<o> ?a (<a> ?a ?b ...))", "?a" }
+};
+
+#define RW_NUM_RULES ((int) (sizeof (rw_rules) / sizeof (rw_rules[0])))
+
+// A sentence or a pattern, parsed into a tree.
+
+struct rw_term {
+    const unsigned char * sym;  // The symbol of an atom, or NULL for a list.
+    int sym_len;              // The length of the symbol.
+    int num_args;             // The number of elements of a list.
+    struct rw_term ** args;   // The elements of a list.
+    unsigned int hash;        // The hash of the whole term.
+
+    int var;                  // The variable of a pattern atom, or -1.
+    int rep;                  // The element of a pattern repeated by "...", or -1.
+    int rep_var;              // A sequence variable of the repeated element.
+    int normal;               // Whether the list can not be rewritten further.
+};
+
+// The terms of a check, which are allocated from large blocks and freed
+// together.  The symbols of atoms point into the parsed strings.
+
+struct rw_block {
+    struct rw_block * next;
+    size_t used;
+    size_t size;
+};
+
+struct rw_pool {
+    struct rw_block * blocks;
+};
+
+// A rewrite, compiled into a pair of patterns.
+
+struct rw_compiled {
+    const char * rule;        // The abbreviation of the rule.
+    struct rw_term * from;    // The pattern that is rewritten.
+    struct rw_term * to;      // The pattern that it is rewritten to.
+    int num_vars;             // The number of variables.
+    char seq[RW_MAX_VARS];    // Whether each variable matches a sequence.
+};
+
+// The terms matched by a variable.
+
+struct rw_binding {
+    int num;
+    int alloc;
+    struct rw_term ** terms;
+    struct rw_term * first[4];  // The terms, until there are more than four.
+};
+
+// The rewrites are compiled the first time that they are needed, and kept
+// for the rest of the session.
+static struct rw_pool rw_rule_pool;
+static struct rw_compiled rw_compiled_rules[RW_NUM_RULES];
+static int rw_rules_ready = 0;
+
+/* Allocates memory from a pool.
+ *  input:
+ *    pool - the pool that owns the memory.
+ *    size - the number of bytes to allocate.
+ *  output:
+ *    the new memory, or NULL on memory error.
+ */
+static void *
+rw_alloc (struct rw_pool * pool, size_t size)
+{
+    struct rw_block * block = pool->blocks;
+    void * mem;
+
+    size = (size + sizeof (void *) - 1) & ~(sizeof (void *) - 1);
+
+    if (!block || block->used + size > block->size)
+    {
+        size_t block_size = RW_BLOCK_SIZE;
+
+        if (size > block_size)
+            block_size = size;
+
+        block = (struct rw_block *) malloc (sizeof (struct rw_block) + block_size);
+        CHECK_ALLOC (block, NULL);
+
+        block->next = pool->blocks;
+        block->used = 0;
+        block->size = block_size;
+        pool->blocks = block;
+    }
+
+    mem = (char *) (block + 1) + block->used;
+    block->used += size;
+
+    return mem;
+}
+
+/* Allocates a new term.
+ *  input:
+ *    pool - the pool that owns the term.
+ *    sym - the symbol of an atom, or NULL for a list.
+ *    sym_len - the length of sym.
+ *    num_args - the number of elements of a list.
+ *  output:
+ *    the new term, or NULL on memory error.
+ */
+static struct rw_term *
+rw_new (struct rw_pool * pool, const unsigned char * sym, int sym_len,
+        int num_args)
+{
+    struct rw_term * t;
+
+    // Keep the elements right after the term.
+    t = (struct rw_term *) rw_alloc (pool, sizeof (struct rw_term)
+                                     + num_args * sizeof (struct rw_term *));
+    if (!t)
+        return NULL;
+
+    t->sym = sym;
+    t->sym_len = sym_len;
+    t->num_args = num_args;
+    t->args = (struct rw_term **) (t + 1);
+    t->hash = 0;
+    t->var = t->rep = t->rep_var = -1;
+    t->normal = 0;
+
+    return t;
+}
+
+/* Frees every term of a pool.
+ *  input:
+ *    pool - the pool to free.
+ *  output:
+ *    none.
+ */
+static void
+rw_pool_destroy (struct rw_pool * pool)
+{
+    struct rw_block * block, * next;
+
+    for (block = pool->blocks; block; block = next)
+    {
+        next = block->next;
+        free (block);
+    }
+
+    pool->blocks = NULL;
+}
+
+/* Determines whether two atoms have the same symbol.
+ *  input:
+ *    t0, t1 - the atoms to compare.
+ *  output:
+ *    1 if the symbols are the same, 0 otherwise.
+ */
+static int
+rw_same_sym (struct rw_term * t0, struct rw_term * t1)
+{
+    return (t0->sym_len == t1->sym_len
+            && !memcmp (t0->sym, t1->sym, t0->sym_len));
+}
+
+/* Sets the hash of a term from its symbol or its elements.
+ *  input:
+ *    t - the term, whose elements are already hashed.
+ *  output:
+ *    none.
+ */
+static void
+rw_hash (struct rw_term * t)
+{
+    unsigned int hash = 2166136261u;
+    int i;
+
+    if (t->sym)
+    {
+        for (i = 0; i < t->sym_len; i++)
+        {
+            hash ^= t->sym[i];
+            hash *= 16777619u;
+        }
+    }
+    else
+    {
+        hash ^= '(';
+        for (i = 0; i < t->num_args; i++)
+        {
+            hash ^= t->args[i]->hash;
+            hash *= 16777619u;
+        }
+        hash ^= ')';
+        hash *= 16777619u;
+    }
+
+    t->hash = hash;
+}
+
+/* Determines whether two terms are the same.
+ *  input:
+ *    t0, t1 - the terms to compare.
+ *  output:
+ *    1 if the terms are the same, 0 if not, -1 on memory error.
+ */
+static int
+rw_equal (struct rw_term * t0, struct rw_term * t1)
+{
+    struct rw_term * pair[2];
+    vec_t * stack;
+    int i, ret = 1;
+
+    if (t0 == t1)
+        return 1;
+
+    if (t0->hash != t1->hash)
+        return 0;
+
+    // Compare the trees with a stack, since sentences may be deeply nested.
+    stack = init_vec (sizeof (pair));
+    if (!stack)
+        return AEC_MEM;
+
+    pair[0] = t0;
+    pair[1] = t1;
+    if (vec_add_obj (stack, pair) < 0)
+        return AEC_MEM;
+
+    while (stack->num_stuff > 0)
+    {
+        memcpy (pair, vec_nth (stack, stack->num_stuff - 1), sizeof (pair));
+        vec_pop_obj (stack);
+        t0 = pair[0];
+        t1 = pair[1];
+
+        if (t0 == t1)
+            continue;
+
+        if (t0->hash != t1->hash || t0->num_args != t1->num_args
+            || !t0->sym != !t1->sym)
+        {
+            ret = 0;
+            break;
+        }
+
+        if (t0->sym)
+        {
+            if (!rw_same_sym (t0, t1))
+            {
+                ret = 0;
+                break;
+            }
+            continue;
+        }
+
+        for (i = 0; i < t0->num_args; i++)
+        {
+            pair[0] = t0->args[i];
+            pair[1] = t1->args[i];
+            if (vec_add_obj (stack, pair) < 0)
+                return AEC_MEM;
+        }
+    }
+
+    destroy_vec (stack);
+    return ret;
+}
+
+/* Makes a list term from the last elements of a stack.
+ *  input:
+ *    pool - the pool that owns the term.
+ *    items - the elements of the list.
+ *    num_items - the number of elements.
+ *    pattern - whether the list is part of a pattern.
+ *  output:
+ *    the new list, or NULL on memory error or a misplaced "...".
+ */
+static struct rw_term *
+rw_make_list (struct rw_pool * pool, struct rw_term ** items, int num_items,
+              int pattern)
+{
+    struct rw_term * t;
+    int i;
+
+    t = rw_new (pool, NULL, 0, num_items);
+    if (!t)
+        return NULL;
+
+    t->num_args = 0;
+    for (i = 0; i < num_items; i++)
+    {
+        if (pattern && items[i]->sym && items[i]->sym_len == 3
+            && !memcmp (items[i]->sym, "...", 3))
+        {
+            if (t->num_args == 0 || t->rep >= 0)
+                return NULL;
+
+            t->rep = t->num_args - 1;
+            continue;
+        }
+
+        t->args[t->num_args++] = items[i];
+    }
+
+    rw_hash (t);
+    return t;
+}
+
+/* Parses a sexpr into a term.
+ *  The symbols of the atoms point into str, which must outlive the term.
+ *  input:
+ *    pool - the pool that owns the new terms.
+ *    str - the sexpr to parse.
+ *    pattern - whether str is a pattern, which may use "...".
+ *    out - receives the term.
+ *  output:
+ *    0 on success, -1 on memory error, -2 if str is not a single sexpr.
+ */
+static int
+rw_parse (struct rw_pool * pool, const unsigned char * str, int pattern,
+          struct rw_term ** out)
+{
+    struct rw_term ** items, * t;
+    int * opens;
+    int i, end, len, num_items = 0, num_opens = 0;
+
+    // There is at most one term and one parenthesis for each character.
+    len = strlen ((const char *) str);
+
+    items = (struct rw_term **) rw_alloc (pool, (len + 1) * sizeof (struct rw_term *));
+    if (!items)
+        return AEC_MEM;
+
+    opens = (int *) rw_alloc (pool, (len + 1) * sizeof (int));
+    if (!opens)
+        return AEC_MEM;
+
+    for (i = 0; i < len; i++)
+    {
+        if (str[i] == ' ')
+            continue;
+
+        if (str[i] == '(')
+        {
+            opens[num_opens++] = num_items;
+            continue;
+        }
+
+        if (str[i] == ')')
+        {
+            if (num_opens == 0)
+                return -2;
+
+            num_opens--;
+            t = rw_make_list (pool, items + opens[num_opens],
+                              num_items - opens[num_opens], pattern);
+            if (!t)
+                return -2;
+
+            num_items = opens[num_opens];
+        }
+        else
+        {
+            for (end = i; end < len; end++)
+            {
+                if (str[end] == ' ' || str[end] == '(' || str[end] == ')')
+                    break;
+            }
+
+            t = rw_new (pool, str + i, end - i, 0);
+            if (!t)
+                return AEC_MEM;
+
+            rw_hash (t);
+            i = end - 1;
+        }
+
+        items[num_items++] = t;
+    }
+
+    if (num_opens != 0 || num_items != 1)
+        return -2;
+
+    *out = items[0];
+    return 0;
+}
+
+/* Numbers the variables of a pattern.
+ *  input:
+ *    t - the pattern.
+ *    names - the first atom of each variable found so far.
+ *    num_vars - the number of variables found so far.
+ *    outside - whether each variable appears outside of a repeated element.
+ *    repeated - whether t is inside of a repeated element.
+ *  output:
+ *    0 on success, -2 if there are too many variables.
+ */
+static int
+rw_number_vars (struct rw_term * t, struct rw_term ** names, int * num_vars,
+                char * outside, int repeated)
+{
+    int i, ret;
+
+    if (t->sym)
+    {
+        if (t->sym[0] != '?')
+            return 0;
+
+        for (i = 0; i < *num_vars; i++)
+        {
+            if (rw_same_sym (names[i], t))
+                break;
+        }
+
+        if (i == *num_vars)
+        {
+            if (*num_vars == RW_MAX_VARS)
+                return -2;
+
+            names[(*num_vars)++] = t;
+        }
+
+        t->var = i;
+        if (!repeated)
+            outside[i] = 1;
+
+        return 0;
+    }
+
+    for (i = 0; i < t->num_args; i++)
+    {
+        ret = rw_number_vars (t->args[i], names, num_vars, outside,
+                              repeated || i == t->rep);
+        if (ret < 0)
+            return ret;
+    }
+
+    return 0;
+}
+
+/* Finds a sequence variable in a pattern.
+ *  input:
+ *    rc - the compiled rewrite of the pattern.
+ *    t - the pattern.
+ *  output:
+ *    the first sequence variable of t, or -1 if there is none.
+ */
+static int
+rw_find_seq (struct rw_compiled * rc, struct rw_term * t)
+{
+    int i, var;
+
+    if (t->var >= 0)
+        return rc->seq[t->var] ? t->var : -1;
+
+    for (i = 0; i < t->num_args; i++)
+    {
+        var = rw_find_seq (rc, t->args[i]);
+        if (var >= 0)
+            return var;
+    }
+
+    return -1;
+}
+
+/* Marks the variable that sets how many times each repeated element
+ * of a pattern is built.
+ *  input:
+ *    rc - the compiled rewrite of the pattern.
+ *    t - the pattern.
+ *  output:
+ *    0 on success, -2 if a repeated element has no sequence variable.
+ */
+static int
+rw_set_rep_vars (struct rw_compiled * rc, struct rw_term * t)
+{
+    int i;
+
+    if (t->rep >= 0)
+    {
+        t->rep_var = rw_find_seq (rc, t->args[t->rep]);
+        if (t->rep_var < 0)
+            return -2;
+    }
+
+    for (i = 0; i < t->num_args; i++)
+    {
+        if (rw_set_rep_vars (rc, t->args[i]) < 0)
+            return -2;
+    }
+
+    return 0;
+}
+
+/* Compiles every rewrite of the rule table.
+ *  input:
+ *    none.
+ *  output:
+ *    0 on success, -1 on memory error, -2 if the table is malformed.
+ */
+static int
+rw_compile_rules ()
+{
+    int i, ret;
+
+    if (rw_rules_ready)
+        return 0;
+
+    for (i = 0; i < RW_NUM_RULES; i++)
+    {
+        struct rw_compiled * rc = rw_compiled_rules + i;
+        struct rw_term * names[RW_MAX_VARS];
+        char outside[RW_MAX_VARS];
+        int v, num_vars = 0;
+
+        memset (outside, 0, RW_MAX_VARS);
+        rc->rule = rw_rules[i].rule;
+
+        ret = rw_parse (&rw_rule_pool, (const unsigned char *) rw_rules[i].from,
+                        1, &rc->from);
+        if (ret < 0)
+            return ret;
+
+        ret = rw_parse (&rw_rule_pool, (const unsigned char *) rw_rules[i].to,
+                        1, &rc->to);
+        if (ret < 0)
+            return ret;
+
+        ret = rw_number_vars (rc->from, names, &num_vars, outside, 0);
+        if (ret < 0)
+            return ret;
+
+        ret = rw_number_vars (rc->to, names, &num_vars, outside, 0);
+        if (ret < 0)
+            return ret;
+
+        rc->num_vars = num_vars;
+        for (v = 0; v < num_vars; v++)
+            rc->seq[v] = !outside[v];
+
+        // Only lists are rewritten.
+        if (rc->from->sym)
+            return -2;
+
+        if (rw_set_rep_vars (rc, rc->from) < 0
+            || rw_set_rep_vars (rc, rc->to) < 0)
+            return -2;
+    }
+
+    rw_rules_ready = 1;
+    return 0;
+}
+
+/* Finds the pattern element that matches an element of a list.
+ *  input:
+ *    pat - the list pattern.
+ *    i - the position of the element in the list.
+ *    k - the number of times the repeated element of pat is used.
+ *  output:
+ *    the position of the matching element in pat.
+ */
+static int
+rw_pat_arg (struct rw_term * pat, int i, int k)
+{
+    if (pat->rep < 0 || i < pat->rep)
+        return i;
+
+    if (i < pat->rep + k)
+        return pat->rep;
+
+    return i - k + 1;
+}
+
+/* Matches a term against a pattern.
+ *  input:
+ *    rc - the compiled rewrite of the pattern.
+ *    pat - the pattern.
+ *    t - the term to match.
+ *    b - the bindings of the variables of rc.
+ *  output:
+ *    1 if t matches pat, 0 if not, -1 on memory error.
+ */
+static int
+rw_match (struct rw_compiled * rc, struct rw_term * pat, struct rw_term * t,
+          struct rw_binding * b)
+{
+    int i, k, ret;
+
+    if (pat->var >= 0)
+    {
+        struct rw_binding * vb = b + pat->var;
+
+        if (!rc->seq[pat->var] && vb->num > 0)
+            return rw_equal (vb->terms[0], t);
+
+        if (vb->num == vb->alloc)
+        {
+            struct rw_term ** terms;
+
+            terms = (struct rw_term **) malloc (2 * vb->alloc * sizeof (struct rw_term *));
+            CHECK_ALLOC (terms, AEC_MEM);
+
+            memcpy (terms, vb->terms, vb->num * sizeof (struct rw_term *));
+            if (vb->terms != vb->first)
+                free (vb->terms);
+
+            vb->terms = terms;
+            vb->alloc *= 2;
+        }
+
+        vb->terms[vb->num++] = t;
+        return 1;
+    }
+
+    if (pat->sym)
+        return (t->sym && rw_same_sym (pat, t));
+
+    if (t->sym)
+        return 0;
+
+    if (pat->rep < 0)
+    {
+        if (t->num_args != pat->num_args)
+            return 0;
+        k = 1;
+    }
+    else
+    {
+        k = t->num_args - pat->num_args + 1;
+        if (k < 1)
+            return 0;
+    }
+
+    for (i = 0; i < t->num_args; i++)
+    {
+        ret = rw_match (rc, pat->args[rw_pat_arg (pat, i, k)], t->args[i], b);
+        if (ret != 1)
+            return ret;
+    }
+
+    return 1;
+}
+
+/* Builds a term from a pattern.
+ *  input:
+ *    pool - the pool that owns the new terms.
+ *    rc - the compiled rewrite of the pattern.
+ *    pat - the pattern.
+ *    b - the bindings of the variables of rc.
+ *    idx - the repetition being built, for sequence variables.
+ *  output:
+ *    the new term, or NULL on memory error.
+ */
+static struct rw_term *
+rw_build (struct rw_pool * pool, struct rw_compiled * rc, struct rw_term * pat,
+          struct rw_binding * b, int idx)
+{
+    struct rw_term * t;
+    int i, j, k, num_args;
+
+    // Terms are never changed once built, so they may be shared.
+    if (pat->var >= 0)
+        return b[pat->var].terms[rc->seq[pat->var] ? idx : 0];
+
+    if (pat->sym)
+        return pat;
+
+    k = (pat->rep < 0) ? 1 : b[pat->rep_var].num;
+    num_args = pat->num_args - 1 + k;
+
+    t = rw_new (pool, NULL, 0, num_args);
+    if (!t)
+        return NULL;
+
+    for (i = 0; i < num_args; i++)
+    {
+        j = rw_pat_arg (pat, i, k);
+
+        t->args[i] = rw_build (pool, rc, pat->args[j], b,
+                               (j == pat->rep) ? i - pat->rep : idx);
+        if (!t->args[i])
+            return NULL;
+    }
+
+    rw_hash (t);
+    return t;
+}
+
+/* Determines quickly whether a term can not match a pattern.
+ *  Only the lengths of the lists and the first elements are compared.
+ *  input:
+ *    pat - the pattern.
+ *    t - the term.
+ *  output:
+ *    1 if t can not match pat, 0 if it might.
+ */
+static int
+rw_quick_reject (struct rw_term * pat, struct rw_term * t)
+{
+    while (pat->var < 0)
+    {
+        if (pat->sym)
+            return !(t->sym && rw_same_sym (pat, t));
+
+        if (t->sym)
+            return 1;
+
+        if (pat->rep < 0 ? t->num_args != pat->num_args
+            : t->num_args < pat->num_args)
+            return 1;
+
+        if (pat->num_args == 0)
+            return 0;
+
+        pat = pat->args[0];
+        t = t->args[0];
+    }
+
+    return 0;
+}
+
+/* Rewrites a term at its top level.
+ *  input:
+ *    pool - the pool that owns the new terms.
+ *    rc - the rewrite to use.
+ *    t - the term to rewrite.
+ *    out - receives the rewritten term.
+ *  output:
+ *    1 if t was rewritten, 0 if it does not match, -1 on memory error.
+ */
+static int
+rw_apply (struct rw_pool * pool, struct rw_compiled * rc, struct rw_term * t,
+          struct rw_term ** out)
+{
+    struct rw_binding b[RW_MAX_VARS];
+    int i, ret;
+
+    if (rw_quick_reject (rc->from, t))
+        return 0;
+
+    for (i = 0; i < rc->num_vars; i++)
+    {
+        b[i].num = 0;
+        b[i].alloc = 4;
+        b[i].terms = b[i].first;
+    }
+
+    ret = rw_match (rc, rc->from, t, b);
+    if (ret == 1)
+    {
+        *out = rw_build (pool, rc, rc->to, b, 0);
+        if (!*out)
+            ret = AEC_MEM;
+    }
+
+    for (i = 0; i < rc->num_vars; i++)
+    {
+        if (b[i].terms != b[i].first)
+            free (b[i].terms);
+    }
+
+    return ret;
+}
+
+/* Rewrites a term at its top level by the first rewrite that matches.
+ *  input:
+ *    pool - the pool that owns the new terms.
+ *    rules - the rewrites to use.
+ *    num_rules - the number of rewrites.
+ *    t - the term to rewrite.
+ *    out - receives the rewritten term.
+ *  output:
+ *    1 if t was rewritten, 0 if no rewrite matches, -1 on memory error.
+ */
+static int
+rw_apply_rules (struct rw_pool * pool, struct rw_compiled ** rules,
+                int num_rules, struct rw_term * t, struct rw_term ** out)
+{
+    int i, ret;
+
+    for (i = 0; i < num_rules; i++)
+    {
+        ret = rw_apply (pool, rules[i], t, out);
+        if (ret != 0)
+            return ret;
+    }
+
+    return 0;
+}
+
+// A term being rewritten by rw_normalize.
+
+struct rw_frame {
+    struct rw_term * t;     // The term.
+    struct rw_term * out;   // A copy of t with rewritten elements, or NULL.
+    int i;                  // The next element to rewrite, or -1 before the top.
+};
+
+/* Rewrites a term as far as possible.
+ *  Either the top level is rewritten before the elements, and again once
+ *  the elements have been rewritten, or the elements are rewritten first.
+ *  input:
+ *    pool - the pool that owns the new terms.
+ *    rules - the rewrites to use.
+ *    num_rules - the number of rewrites.
+ *    t - the term to rewrite.
+ *    inner - 1 to rewrite the innermost terms first, 0 for the outermost.
+ *  output:
+ *    the rewritten term, or NULL on memory error.
+ */
+static struct rw_term *
+rw_normalize (struct rw_pool * pool, struct rw_compiled ** rules, int num_rules,
+              struct rw_term * t, int inner)
+{
+    struct rw_frame frame, * f;
+    struct rw_term * done, * out, * ret_t = NULL;
+    vec_t * stack;
+    int ret;
+
+    // Walk the tree with a stack, since sentences may be deeply nested.
+    stack = init_vec (sizeof (struct rw_frame));
+    if (!stack)
+        return NULL;
+
+    frame.t = t;
+    frame.out = NULL;
+    frame.i = -1;
+    if (vec_add_obj (stack, &frame) < 0)
+        return NULL;
+
+    while (stack->num_stuff > 0)
+    {
+        f = vec_nth (stack, stack->num_stuff - 1);
+        done = NULL;
+
+        if (f->i < 0)
+        {
+            // Only lists are rewritten.  Atoms may be shared with the
+            // patterns, so they are never marked.
+            if (f->t->sym || f->t->normal)
+            {
+                done = f->t;
+            }
+            else
+            {
+                if (!inner)
+                {
+                    ret = rw_apply_rules (pool, rules, num_rules, f->t, &out);
+                    if (ret == AEC_MEM)
+                        break;
+
+                    if (ret == 1)
+                    {
+                        f->t = out;
+                        continue;
+                    }
+                }
+
+                f->i = 0;
+                f->out = NULL;
+            }
+        }
+
+        if (!done && f->i < f->t->num_args)
+        {
+            frame.t = f->t->args[f->i];
+            frame.out = NULL;
+            frame.i = -1;
+            if (vec_add_obj (stack, &frame) < 0)
+                break;
+            continue;
+        }
+
+        if (!done)
+        {
+            if (f->out)
+            {
+                rw_hash (f->out);
+                f->t = f->out;
+                f->out = NULL;
+
+                // Rewrite the top level again.
+                if (!inner)
+                {
+                    f->i = -1;
+                    continue;
+                }
+            }
+
+            if (inner)
+            {
+                ret = rw_apply_rules (pool, rules, num_rules, f->t, &out);
+                if (ret == AEC_MEM)
+                    break;
+
+                if (ret == 1)
+                {
+                    f->t = out;
+                    f->i = -1;
+                    continue;
+                }
+            }
+
+            f->t->normal = 1;
+            done = f->t;
+        }
+
+        // Hand the rewritten term to the list that holds it.
+        vec_pop_obj (stack);
+        if (stack->num_stuff == 0)
+        {
+            ret_t = done;
+            break;
+        }
+
+        f = vec_nth (stack, stack->num_stuff - 1);
+        if (done != f->t->args[f->i])
+        {
+            if (!f->out)
+            {
+                f->out = rw_new (pool, NULL, 0, f->t->num_args);
+                if (!f->out)
+                    break;
+
+                memcpy (f->out->args, f->t->args,
+                        f->t->num_args * sizeof (struct rw_term *));
+            }
+
+            f->out->args[f->i] = done;
+        }
+        f->i++;
+    }
+
+    destroy_vec (stack);
+    return ret_t;
+}
+
+/* Determines whether two sentences are equivalent by an equivalence rule.
+ *  input:
+ *    sen_0, sen_1 - the sentences, in sexpr form.
+ *    rule - the abbreviation of the rule.
+ *  output:
+ *    1 if the sentences are equivalent by rule, 0 if not,
+ *    -1 on memory error.
+ */
+int
+sexpr_rewrite_equiv (unsigned char * sen_0, unsigned char * sen_1,
+                     const char * rule)
+{
+    struct rw_compiled * rules[RW_NUM_RULES];
+    struct rw_pool pool;
+    struct rw_term * t0, * t1;
+    int i, ret, num_rules = 0;
+
+    ret = rw_compile_rules ();
+    if (ret < 0)
+        return AEC_MEM;
+
+    for (i = 0; i < RW_NUM_RULES; i++)
+    {
+        if (!strcmp (rw_compiled_rules[i].rule, rule))
+            rules[num_rules++] = rw_compiled_rules + i;
+    }
+
+    pool.blocks = NULL;
+
+    ret = rw_parse (&pool, sen_0, 0, &t0);
+    if (ret == 0)
+        ret = rw_parse (&pool, sen_1, 0, &t1);
+
+    if (ret == 0)
+    {
+        struct rw_term * n0, * n1;
+        int inner;
+
+        for (inner = 0; inner < 2; inner++)
+        {
+            n0 = rw_normalize (&pool, rules, num_rules, t0, inner);
+            n1 = rw_normalize (&pool, rules, num_rules, t1, inner);
+
+            ret = (n0 && n1) ? rw_equal (n0, n1) : AEC_MEM;
+            if (ret != 0)
+                break;
+        }
+    }
+    else if (ret == -2)
+    {
+        ret = 0;
+    }
+
+    rw_pool_destroy (&pool);
+    return ret;
+}
@@ -0,0 +1,33 @@
+/* Functions for checking equivalence rules by rewriting.
+
+   Copyright (C) 2026 The GNU Aris contributors.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SEXPR_REWRITE_H
+#define SEXPR_REWRITE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include "typedef.h"
+
+int sexpr_rewrite_equiv (unsigned char * sen_0, unsigned char * sen_1,
+                         const char * rule);
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SEXPR_REWRITE_H
@@ -0,0 +1,348 @@
+/* Functions for resolving the bound variables of sexpr sentences.
+
+   Copyright (C) 2026 The GNU Aris contributors.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sexpr-scope.h"
+#include "sexpr-process.h"
+
+/* A variable name while its sentence is resolved. */
+struct scope_name {
+    int pos;        // The position of the name, or -1 if the slot is empty.
+    int len;        // The length of the name.
+    int binder;     // The innermost quantifier binding the name, or -1.
+    int depth;      // The number of quantifiers enclosing that quantifier.
+};
+
+/* A quantifier whose scope is being resolved. */
+struct scope_quant {
+    int end;        // The end of the scope of the quantifier.
+    int slot;       // The slot holding the name of its variable.
+    int prev;       // The quantifier that held the slot before it.
+    int prev_depth; // The depth of that quantifier.
+};
+
+/* Determines whether a position is a delimiter of a sexpr sentence.  */
+#define SCOPE_DELIM(c) ((c) == '(' || (c) == ')' || (c) == ' ' || (c) == '\0')
+
+/* Finds the end of a subterm of a sentence.
+ *  input:
+ *    sc - the resolved sentence.
+ *    pos - the beginning of the subterm.
+ *  output:
+ *    the position just past the subterm.
+ */
+int
+sexpr_scope_term_end (sexpr_scope * sc, int pos)
+{
+    if (sc->sen[pos] == '(')
+        return (sc->match[pos] < 0) ? sc->len : sc->match[pos] + 1;
+
+    while (!SCOPE_DELIM (sc->sen[pos]))
+        pos++;
+
+    return pos;
+}
+
+/* Determines whether a list is a quantifier.
+ *  input:
+ *    sc - the resolved sentence.
+ *    pos - the beginning of the list.
+ *  output:
+ *    the position of the variable of the quantifier, or -1 if the list
+ *    is not a quantifier.
+ */
+int
+sexpr_scope_quant (sexpr_scope * sc, int pos)
+{
+    unsigned char * sen = sc->sen;
+
+    if (sen[pos] != '(' || sen[pos + 1] != '(' || sc->match[pos] < 0
+        || sc->match[pos + 1] < 0)
+        return -1;
+
+    if (strncmp (sen + pos + 2, S_UNV, S_CL)
+        && strncmp (sen + pos + 2, S_EXL, S_CL))
+        return -1;
+
+    if (sen[pos + 2 + S_CL] != ' ' || SCOPE_DELIM (sen[pos + 3 + S_CL]))
+        return -1;
+
+    return pos + 3 + S_CL;
+}
+
+/* Hashes a variable name.
+ *  input:
+ *    str - the name.
+ *    len - the length of the name.
+ *  output:
+ *    the FNV-1a hash of the name.
+ */
+static unsigned int
+scope_hash (const unsigned char * str, int len)
+{
+    unsigned int hash = 2166136261u;
+    int i;
+
+    for (i = 0; i < len; i++)
+    {
+        hash ^= str[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+/* Finds the slot for a variable name.
+ *  input:
+ *    sc - the sentence being resolved.
+ *    names - the names seen so far.
+ *    mask - the number of slots in names, less one.
+ *    pos - the position of the name.
+ *    len - the length of the name.
+ *  output:
+ *    the slot holding the name, or the empty slot where it belongs.
+ */
+static int
+scope_find_slot (sexpr_scope * sc, struct scope_name * names, int mask,
+                 int pos, int len)
+{
+    int slot;
+
+    slot = scope_hash (sc->sen + pos, len) & mask;
+    while (names[slot].pos >= 0)
+    {
+        if (names[slot].len == len
+            && !memcmp (sc->sen + names[slot].pos, sc->sen + pos, len))
+            break;
+
+        slot = (slot + 1) & mask;
+    }
+
+    return slot;
+}
+
+/* Resolves the bound variables of a sentence.
+ *  Each quantifier is entered when its variable is reached, and left at
+ *  the end of its scope, so that the innermost quantifier of each name
+ *  is always known.
+ *  input:
+ *    sen - the sentence, which must outlive the result.
+ *  output:
+ *    the resolved sentence, or NULL on memory error.
+ */
+sexpr_scope *
+sexpr_scope_init (unsigned char * sen)
+{
+    sexpr_scope * sc;
+    struct scope_name * names;
+    struct scope_quant * quants;
+    int i, mask, num_active;
+
+    sc = (sexpr_scope *) calloc (1, sizeof (sexpr_scope));
+    CHECK_ALLOC (sc, NULL);
+
+    sc->sen = sen;
+    sc->len = strlen ((const char *) sen);
+
+    sc->match = match_parens (sen, sc->len);
+    if (!sc->match)
+        return NULL;
+
+    sc->binder = (int *) calloc (sc->len + 1, sizeof (int));
+    CHECK_ALLOC (sc->binder, NULL);
+
+    sc->index = (int *) calloc (sc->len + 1, sizeof (int));
+    CHECK_ALLOC (sc->index, NULL);
+
+    for (i = 0; i <= sc->len; i++)
+    {
+        sc->binder[i] = SCOPE_NONE;
+        if (i < sc->len && sexpr_scope_quant (sc, i) >= 0)
+            sc->num_binders++;
+    }
+
+    // Keep the table of names at most half full.
+    for (mask = 1; mask < 2 * sc->num_binders + 1; mask <<= 1)
+        ;
+
+    names = (struct scope_name *) calloc (mask, sizeof (struct scope_name));
+    CHECK_ALLOC (names, NULL);
+    for (i = 0; i < mask; i++)
+        names[i].pos = -1;
+    mask--;
+
+    quants = (struct scope_quant *) calloc (sc->num_binders + 1,
+                                            sizeof (struct scope_quant));
+    CHECK_ALLOC (quants, NULL);
+
+    num_active = 0;
+    for (i = 0; i <= sc->len; i++)
+    {
+        int var, end, slot;
+
+        // Leave the quantifiers whose scopes have ended.
+        while (num_active > 0 && quants[num_active - 1].end <= i)
+        {
+            struct scope_quant * q;
+
+            q = quants + --num_active;
+            names[q->slot].binder = q->prev;
+            names[q->slot].depth = q->prev_depth;
+        }
+
+        if (i == sc->len || SCOPE_DELIM (sc->sen[i]))
+            continue;
+
+        if (i > 0 && sc->sen[i - 1] != ' ')
+            continue;
+
+        end = sexpr_scope_term_end (sc, i);
+
+        var = (i >= 3 + S_CL) ? sexpr_scope_quant (sc, i - 3 - S_CL) : -1;
+        if (var == i)
+        {
+            // Enter the quantifier whose variable this is.
+            struct scope_quant * q;
+
+            slot = scope_find_slot (sc, names, mask, i, end - i);
+            if (names[slot].pos < 0)
+            {
+                names[slot].pos = i;
+                names[slot].len = end - i;
+                names[slot].binder = -1;
+            }
+
+            q = quants + num_active;
+            q->end = sc->match[i - 3 - S_CL];
+            q->slot = slot;
+            q->prev = names[slot].binder;
+            q->prev_depth = names[slot].depth;
+
+            names[slot].binder = i;
+            names[slot].depth = num_active++;
+
+            sc->binder[i] = i;
+        }
+        else
+        {
+            slot = scope_find_slot (sc, names, mask, i, end - i);
+            if (names[slot].pos < 0 || names[slot].binder < 0)
+            {
+                sc->binder[i] = SCOPE_FREE;
+            }
+            else
+            {
+                sc->binder[i] = names[slot].binder;
+                sc->index[i] = num_active - 1 - names[slot].depth;
+            }
+        }
+
+        i = end - 1;
+    }
+
+    free (names);
+    free (quants);
+
+    return sc;
+}
+
+/* Destroys a resolved sentence.
+ *  input:
+ *    sc - the resolved sentence to destroy.
+ *  output:
+ *    none.
+ */
+void
+sexpr_scope_destroy (sexpr_scope * sc)
+{
+    if (sc->match)
+        free (sc->match);
+    if (sc->binder)
+        free (sc->binder);
+    if (sc->index)
+        free (sc->index);
+    free (sc);
+}
+
+/* Determines whether two subterms are the same up to the names of the
+ * variables that are bound within them.
+ *  Symbols bound within the subterms are compared by their distance to
+ *  their quantifiers, and every other symbol by its name.
+ *  input:
+ *    sc_a, sc_b - the resolved sentences.
+ *    a_pos - the beginning of the subterm of sc_a.
+ *    b_pos - the beginning of the subterm of sc_b.
+ *  output:
+ *    1 if the subterms are alpha-equivalent, 0 otherwise.
+ */
+int
+sexpr_scope_alpha_equiv (sexpr_scope * sc_a, int a_pos,
+                         sexpr_scope * sc_b, int b_pos)
+{
+    int a_end, b_end, i, j;
+
+    a_end = sexpr_scope_term_end (sc_a, a_pos);
+    b_end = sexpr_scope_term_end (sc_b, b_pos);
+
+    i = a_pos;
+    j = b_pos;
+    while (i < a_end && j < b_end)
+    {
+        unsigned char * a = sc_a->sen, * b = sc_b->sen;
+        int ai, bj, a_bound, b_bound;
+
+        if (SCOPE_DELIM (a[i]) || SCOPE_DELIM (b[j]))
+        {
+            if (a[i] != b[j])
+                return 0;
+
+            i++;
+            j++;
+            continue;
+        }
+
+        ai = sexpr_scope_term_end (sc_a, i);
+        bj = sexpr_scope_term_end (sc_b, j);
+
+        a_bound = (sc_a->binder[i] >= a_pos);
+        b_bound = (sc_b->binder[j] >= b_pos);
+
+        if (a_bound != b_bound)
+            return 0;
+
+        if (a_bound)
+        {
+            // A quantifier's own variable is only matched with another.
+            if ((sc_a->binder[i] == i) != (sc_b->binder[j] == j)
+                || sc_a->index[i] != sc_b->index[j])
+                return 0;
+        }
+        else if (ai - i != bj - j || memcmp (a + i, b + j, ai - i))
+        {
+            return 0;
+        }
+
+        i = ai;
+        j = bj;
+    }
+
+    return (i == a_end && j == b_end);
+}
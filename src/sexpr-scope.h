@@ -0,0 +1,58 @@
+/* Functions for resolving the bound variables of sexpr sentences.
+
+   Copyright (C) 2026 The GNU Aris contributors.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SEXPR_SCOPE_H
+#define SEXPR_SCOPE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include "typedef.h"
+
+// The values of binder for positions that are not bound symbols.
+#define SCOPE_FREE  -1  // A symbol that no quantifier binds.
+#define SCOPE_NONE  -2  // Not the start of a symbol in argument position.
+
+// The binding structure of a sexpr sentence, computed in one pass.
+// Every symbol in argument position, that is, every symbol that is not
+// the head of a list, is resolved to the quantifier that binds it.
+
+struct sexpr_scope {
+    unsigned char * sen;    // The sentence.
+    int len;                // The length of sen.
+    int * match;            // The parenthesis matches of sen.
+    int * binder;           // For each position, the position of the variable
+                            // of the quantifier binding the symbol there,
+                            // SCOPE_FREE, or SCOPE_NONE.  The variable of a
+                            // quantifier is bound by that quantifier.
+    int * index;            // For each bound symbol, the number of quantifiers
+                            // between it and its binder.
+    int num_binders;        // The number of quantifiers in sen.
+};
+
+sexpr_scope * sexpr_scope_init (unsigned char * sen);
+void sexpr_scope_destroy (sexpr_scope * sc);
+int sexpr_scope_term_end (sexpr_scope * sc, int pos);
+int sexpr_scope_quant (sexpr_scope * sc, int pos);
+int sexpr_scope_alpha_equiv (sexpr_scope * sc_a, int a_pos,
+                             sexpr_scope * sc_b, int b_pos);
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SEXPR_SCOPE_H
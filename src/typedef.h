@@ -34,6 +34,7 @@ typedef struct aris_proof aris_proof;
 typedef struct variable variable;
 typedef struct input_type in_type;
 typedef struct key_function key_func;
+typedef struct isar_token isar_token;
 typedef struct aris_app aris_app;
 typedef struct rules_table rules_table;
 typedef struct sen_id sen_id;
@@ -41,8 +42,18 @@ typedef struct rules_group rules_group;
 typedef struct conf_object conf_obj;
 typedef struct menu_item_data mid_t;
 typedef struct undo_info undo_info;
+typedef struct undo_delta undo_delta;
+typedef struct eval_job eval_job;
+typedef struct archive archive_t;
+typedef struct archive_entry archive_entry;
+typedef struct goal_index goal_index;
+typedef struct sexpr_site sexpr_site;
+typedef struct sexpr_scope sexpr_scope;
+typedef struct var_index var_index;
+typedef struct sexpr_cong sexpr_cong;
 
 typedef void * (* conf_obj_value_func) (conf_obj * obj, int get);
+typedef char * (* sexpr_site_func) (unsigned char * prem, unsigned char * conc);
 
 #ifndef WIN32
 #include <libintl.h>
@@ -70,7 +81,8 @@ perror ("CHECK_ALLOC FAILED: " __FILE__ ", line " _S(__LINE__) );   \
 
 enum ARIS_ERROR_CODES {
     AEC_MEM = -1, /* Memory Error */
-    AEC_IO = -2   /* I/O Error */
+    AEC_IO = -2,  /* I/O Error */
+    AEC_FORMAT = -3 /* Malformed Input */
 };
 #ifdef __cplusplus
 }
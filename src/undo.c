@@ -26,6 +26,48 @@
 #include "vec.h"
 #include "sen-data.h"
 #include "sentence.h"
+#include "process.h"
+
+/* Determines the memory held by a sentence data object.
+ *  input:
+ *    sd - the sentence data.
+ *  output:
+ *    the number of bytes held by sd.
+ */
+static size_t
+undo_sd_size (sen_data * sd)
+{
+  size_t size = sizeof (sen_data) + sizeof (item_t);
+  int i;
+
+  if (sd->text)
+    size += strlen ((char *) sd->text) + 1;
+  if (sd->sexpr)
+    size += strlen ((char *) sd->sexpr) + 1;
+  if (sd->file)
+    size += strlen ((char *) sd->file) + 1;
+  if (sd->indices)
+    size += (sd->depth + 1) * sizeof (int);
+  if (sd->refs)
+    {
+      for (i = 0; sd->refs[i] != REF_END; i++);
+      size += (i + 1) * sizeof (short);
+    }
+
+  return size;
+}
+
+/* Determines the memory held by a text change.
+ *  input:
+ *    delta - the text change.
+ *  output:
+ *    the number of bytes held by delta.
+ */
+static size_t
+undo_delta_size (undo_delta * delta)
+{
+  return strlen ((char *) delta->removed) + strlen ((char *) delta->inserted) + 2;
+}
 
 /* Initialize and undo information object.
  *  input:
@@ -41,20 +83,14 @@ undo_info_init (aris_proof * ap, list_t * sens, int type)
   undo_info ret;
   ret.type = -1;
 
-  item_t * it, * nit;
-  ret.ls = init_list ();
-  if (!ret.ls)
-    return ret;
+  item_t * it;
 
-  for (it = sens->head; it;)
-    {
-      nit = it->next;
-      sen_data * sd = it->value;
-      ls_push_obj (ret.ls, sd);
-      free (it);
-      it = nit;
-    }
-  free (sens);
+  memset (&ret.delta, 0, sizeof (undo_delta));
+  ret.ls = sens;
+  ret.size = sizeof (undo_info) + sizeof (list_t);
+
+  for (it = sens->head; it; it = it->next)
+    ret.size += undo_sd_size (it->value);
 
   ret.type = type;
   ret.stamp = time (NULL);
@@ -108,6 +144,61 @@ undo_info_init_one (aris_proof * ap, sentence * sen, int type)
   return ret;
 }
 
+/* Initialize an undo information object from a change to a sentence's text.
+ *  Only the span of text that changed is kept.
+ *  input:
+ *    sen - the sentence, still holding its old text.
+ *    new_text - the new text of the sentence.
+ *  output:
+ *    A newly initialized undo information object.
+ */
+undo_info
+undo_info_init_text (sentence * sen, unsigned char * new_text)
+{
+  undo_info ret;
+  unsigned char * old_text;
+  int old_len, new_len, pre, suf;
+
+  memset (&ret, 0, sizeof (undo_info));
+  ret.type = -1;
+
+  old_text = sentence_get_text (sen);
+  old_len = strlen ((char *) old_text);
+  new_len = strlen ((char *) new_text);
+
+  pre = find_difference (old_text, new_text);
+  if (pre == -1)
+    pre = (old_len < new_len) ? old_len : new_len;
+
+  for (suf = 0; suf < old_len - pre && suf < new_len - pre; suf++)
+    {
+      if (old_text[old_len - suf - 1] != new_text[new_len - suf - 1])
+        break;
+    }
+
+  ret.delta.line_num = sentence_get_line_no (sen);
+  ret.delta.offset = pre;
+
+  ret.delta.removed = (unsigned char *) strndup ((char *) old_text + pre,
+                                                 old_len - pre - suf);
+  CHECK_ALLOC (ret.delta.removed, ret);
+
+  ret.delta.inserted = (unsigned char *) strndup ((char *) new_text + pre,
+                                                  new_len - pre - suf);
+  if (!ret.delta.inserted)
+    {
+      free (ret.delta.removed);
+      ret.delta.removed = NULL;
+      return ret;
+    }
+
+  ret.type = UIT_MOD_TEXT;
+  ret.stamp = time (NULL);
+  ret.size = sizeof (undo_info) + undo_delta_size (&ret.delta);
+
+  return ret;
+}
+
 /* Destroy an undo information object.
  *  input:
  *    ui - the undo information object to destroy.
@@ -133,6 +224,86 @@ undo_info_destroy (undo_info ui)
       free (ui.ls);
     }
   ui.ls = NULL;
+
+  if (ui.delta.removed)
+    free (ui.delta.removed);
+  if (ui.delta.inserted)
+    free (ui.delta.inserted);
+}
+
+/* Merges a text change into the text change that preceded it.
+ *  The changes can only be merged if they are on the same line, and the
+ *  span replaced by the second touches the span inserted by the first,
+ *  since only then is all of the text between them known.
+ *  input:
+ *    last - the earlier text change, which receives the merged change.
+ *    ui - the later text change.
+ *  output:
+ *    0 if merged, 1 if the changes can't be merged, -1 on memory error.
+ */
+int
+undo_info_merge (undo_info * last, undo_info * ui)
+{
+  undo_delta * a, * b;
+  int a_start, a_end, b_start, b_end, start, end;
+  int a_rem, b_ins;
+  unsigned char * mid, * removed, * inserted;
+
+  if (last->type != UIT_MOD_TEXT || ui->type != UIT_MOD_TEXT)
+    return 1;
+
+  a = &last->delta;
+  b = &ui->delta;
+
+  if (a->line_num != b->line_num)
+    return 1;
+
+  // The spans of the text between the two changes.
+  a_start = a->offset;
+  a_end = a_start + strlen ((char *) a->inserted);
+  b_start = b->offset;
+  b_end = b_start + strlen ((char *) b->removed);
+
+  if (b_start > a_end || b_end < a_start)
+    return 1;
+
+  start = (a_start < b_start) ? a_start : b_start;
+  end = (a_end > b_end) ? a_end : b_end;
+
+  // Rebuild the text between the changes from the two spans.
+  mid = (unsigned char *) calloc (end - start + 1, sizeof (char));
+  CHECK_ALLOC (mid, AEC_MEM);
+
+  memcpy (mid + a_start - start, a->inserted, a_end - a_start);
+  memcpy (mid + b_start - start, b->removed, b_end - b_start);
+
+  a_rem = strlen ((char *) a->removed);
+  b_ins = strlen ((char *) b->inserted);
+
+  removed = (unsigned char *) calloc ((a_start - start) + a_rem + (end - a_end) + 1,
+                                      sizeof (char));
+  CHECK_ALLOC (removed, AEC_MEM);
+
+  inserted = (unsigned char *) calloc ((b_start - start) + b_ins + (end - b_end) + 1,
+                                       sizeof (char));
+  CHECK_ALLOC (inserted, AEC_MEM);
+
+  sprintf ((char *) removed, "%.*s%s%s", a_start - start, mid,
+           a->removed, mid + a_end - start);
+  sprintf ((char *) inserted, "%.*s%s%s", b_start - start, mid,
+           b->inserted, mid + b_end - start);
+  free (mid);
+
+  free (a->removed);
+  free (a->inserted);
+  a->removed = removed;
+  a->inserted = inserted;
+  a->offset = start;
+
+  last->stamp = ui->stamp;
+  last->size = sizeof (undo_info) + undo_delta_size (a);
+
+  return 0;
 }
 
 /* Determines the required operation based on the initial operation and undo/redo.
@@ -180,30 +351,35 @@ undo_op_remove (aris_proof * ap, undo_info * ui)
   if (!ls)
     return AEC_MEM;
 
-  item_t * itm, * ui_itr;
-  int ln;
+  item_t * itm, * ui_itr, ** lines;
+  int ln, num_lines;
+
+  // Look the lines up by number in a single pass.
+  num_lines = SEN_PARENT (ap)->everything->num_stuff;
+  lines = (item_t **) calloc (num_lines, sizeof (item_t *));
+  CHECK_ALLOC (lines, AEC_MEM);
+
+  ln = 0;
+  for (itm = SEN_PARENT (ap)->everything->head; itm; itm = itm->next)
+    lines[ln++] = itm;
 
   for (ui_itr = ui->ls->head; ui_itr; ui_itr = ui_itr->next)
     {
       sen_data * sd = ui_itr->value;
-      for (itm = SEN_PARENT (ap)->everything->head; itm; itm = itm->next)
-        {
-          sentence * sen = (sentence*) itm->value;
-          ln = sentence_get_line_no (sen);
-          if (ln == sd->line_num)
-            {
-              ls_push_obj (ls, sen);
-              continue;
-            }
-        }
-    }
+      if (sd->line_num < 1 || sd->line_num > num_lines)
+        continue;
 
-  for (itm = ls->head; itm; itm = itm->next)
-    {
-      sentence * sen = itm->value;
-      aris_proof_remove_sentence (ap, sen);
+      if (!ls_push_obj (ls, lines[sd->line_num - 1]->value))
+        return AEC_MEM;
     }
 
+  free (lines);
+
+  if (aris_proof_remove_sentences (ap, ls) == AEC_MEM)
+    return AEC_MEM;
+
+  destroy_list (ls);
+
   return 0;
 }
 
@@ -256,43 +432,58 @@ undo_op_add (aris_proof * ap, undo_info * ui)
 int
 undo_op_mod (aris_proof * ap, undo_info * ui)
 {
-  item_t * ui_itr, * itm;
-
-  for (ui_itr = ui->ls->head; ui_itr; ui_itr = ui_itr->next)
+  item_t * itm;
+  undo_delta * delta = &ui->delta;
+  GtkTextBuffer * buffer;
+  int ln, cur_len, ins_len;
+  sentence * sen = 0;
+  unsigned char * cur_text, * new_text, * tmp;
+
+  for (itm = SEN_PARENT (ap)->everything->head; itm; itm = itm->next)
     {
-      sen_data * sd;
-      GtkTextBuffer * buffer;
-      int ln;
-      sentence * sen = 0;
+      sen = (sentence *) itm->value;
+      ln = sentence_get_line_no (sen);
+      if (ln >= delta->line_num)
+        break;
+    }
 
-      sd = (sen_data *) ui_itr->value;
+  if (!itm)
+    return 1;
 
-      for (itm = SEN_PARENT (ap)->everything->head; itm; itm = itm->next)
-        {
-          sen = (sentence *) itm->value;
-          ln = sentence_get_line_no (sen);
-          if (ln >= sd->line_num)
-            break;
-        }
+  cur_text = sentence_get_text (sen);
+  cur_len = strlen ((char *) cur_text);
+  ins_len = strlen ((char *) delta->inserted);
 
+  if (delta->offset + ins_len > cur_len)
+    return 1;
 
-      unsigned char * old_text = strdup (sentence_get_text (sen));
-      CHECK_ALLOC (old_text, AEC_MEM);
-      SEN_PARENT(ap)->undo = 1;
-      int ret = sentence_set_text (sen, sd->text);
-      if (ret == -1)
-        return -1;
+  // Replace the inserted text with the removed text.
+  new_text = (unsigned char *) calloc (cur_len - ins_len
+                                       + strlen ((char *) delta->removed) + 1,
+                                       sizeof (char));
+  CHECK_ALLOC (new_text, AEC_MEM);
 
-      free (sd->text);
-      sd->text = strdup (old_text);
-      CHECK_ALLOC (sd->text, AEC_MEM);
-      free (old_text);
+  sprintf ((char *) new_text, "%.*s%s%s", delta->offset, cur_text,
+           delta->removed, cur_text + delta->offset + ins_len);
 
+  SEN_PARENT(ap)->undo = 1;
+  int ret = sentence_set_text (sen, new_text);
+  free (new_text);
+  if (ret == -1)
+    return -1;
+
+  // The reverse change is the same change with the spans swapped.
+  tmp = delta->removed;
+  delta->removed = delta->inserted;
+  delta->inserted = tmp;
+
+  if (SEN_REALIZED (sen))
+    {
       buffer = gtk_text_view_get_buffer (GTK_TEXT_VIEW (sen->entry));
       gtk_text_buffer_set_text (buffer, "", -1);
-      sentence_paste_text (sen);
-      SEN_PARENT(ap)->undo = 0;
     }
+  sentence_paste_text (sen);
+  SEN_PARENT(ap)->undo = 0;
 
   return 0;
 }
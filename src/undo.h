@@ -30,17 +30,33 @@ enum UNDO_INFO_TYPE {
 
 #define UNDO_INT 1
 
+// The default limit on the memory held by each undo stack, in kilobytes.
+#define UNDO_LIMIT_DEFAULT 4096
+
+// A change to the text of a line, stored as the span that changed.
+
+struct undo_delta {
+  int line_num;			// The line that was changed.
+  int offset;			// The offset at which the text changed.
+  unsigned char * removed;	// The text that was replaced.
+  unsigned char * inserted;	// The text that replaced it.
+};
+
 struct undo_info {
   int type;
   time_t stamp;
-  list_t * ls;
+  size_t size;			// The memory held by this object.
+  list_t * ls;			// The sentences added or removed.
+  undo_delta delta;		// The change of a text modification.
 };
 
 typedef int (*undo_op) (aris_proof *, undo_info *);
 
 undo_info undo_info_init (aris_proof * ap, list_t * sens, int type);
 undo_info undo_info_init_one (aris_proof * ap, sentence * sen, int type);
+undo_info undo_info_init_text (sentence * sen, unsigned char * new_text);
 void undo_info_destroy (undo_info ui);
+int undo_info_merge (undo_info * last, undo_info * ui);
 
 undo_op undo_determine_op (int undo, int type);
 int undo_op_remove (aris_proof * ap, undo_info * ui);
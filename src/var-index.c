@@ -0,0 +1,298 @@
+/* Functions for indexing the variables of a proof.
+
+   Copyright (C) 2026 The GNU Aris contributors.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "var-index.h"
+#include "process.h"
+
+#define VAR_INDEX_MIN_BUCKETS 16
+
+/* Hashes the name of a variable.
+ *  input:
+ *    text - the name.
+ *    len - the length of the name.
+ *  output:
+ *    the FNV-1a hash of the name.
+ */
+static unsigned int
+var_index_hash (const unsigned char * text, int len)
+{
+    unsigned int hash = 2166136261u;
+    int i;
+
+    for (i = 0; i < len; i++)
+    {
+        hash ^= text[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+/* Initializes a variable index.
+ *  input:
+ *    none.
+ *  output:
+ *    the new variable index, or NULL on memory error.
+ */
+var_index *
+var_index_init ()
+{
+    var_index * vi;
+    int i;
+
+    vi = (var_index *) calloc (1, sizeof (var_index));
+    CHECK_ALLOC (vi, NULL);
+
+    vi->num_buckets = VAR_INDEX_MIN_BUCKETS;
+    vi->buckets = (int *) calloc (vi->num_buckets, sizeof (int));
+    CHECK_ALLOC (vi->buckets, NULL);
+
+    for (i = 0; i < vi->num_buckets; i++)
+        vi->buckets[i] = -1;
+
+    return vi;
+}
+
+/* Destroys a variable index.
+ *  input:
+ *    vi - the variable index to destroy.
+ *  output:
+ *    none.
+ */
+void
+var_index_destroy (var_index * vi)
+{
+    var_index_truncate (vi, 0);
+
+    if (vi->vars)
+        free (vi->vars);
+    if (vi->lines)
+        free (vi->lines);
+    if (vi->hashes)
+        free (vi->hashes);
+    if (vi->next)
+        free (vi->next);
+    if (vi->scope_depths)
+        free (vi->scope_depths);
+    if (vi->scope_vars)
+        free (vi->scope_vars);
+    free (vi->buckets);
+    free (vi);
+}
+
+/* Links a variable into the bucket for its hash.
+ *  input:
+ *    vi - the variable index.
+ *    v - the variable to link.
+ *  output:
+ *    none.
+ */
+static void
+var_index_link (var_index * vi, int v)
+{
+    int b = vi->hashes[v] & (vi->num_buckets - 1);
+
+    vi->next[v] = vi->buckets[b];
+    vi->buckets[b] = v;
+}
+
+/* Makes room for one more variable in a variable index.
+ *  input:
+ *    vi - the variable index.
+ *  output:
+ *    0 on success, -1 on memory error.
+ */
+static int
+var_index_grow (var_index * vi)
+{
+    int i;
+
+    if (vi->num_vars == vi->alloc_vars)
+    {
+        int new_alloc = (vi->alloc_vars > 0) ? 2 * vi->alloc_vars : 16;
+
+        vi->vars = (variable *) realloc (vi->vars, new_alloc * sizeof (variable));
+        CHECK_ALLOC (vi->vars, AEC_MEM);
+        vi->lines = (int *) realloc (vi->lines, new_alloc * sizeof (int));
+        CHECK_ALLOC (vi->lines, AEC_MEM);
+        vi->hashes = (unsigned int *) realloc (vi->hashes, new_alloc * sizeof (int));
+        CHECK_ALLOC (vi->hashes, AEC_MEM);
+        vi->next = (int *) realloc (vi->next, new_alloc * sizeof (int));
+        CHECK_ALLOC (vi->next, AEC_MEM);
+
+        vi->alloc_vars = new_alloc;
+    }
+
+    // Keep the chains short by keeping at least one bucket per variable.
+    if (vi->num_vars + 1 > vi->num_buckets)
+    {
+        int new_buckets = 2 * vi->num_buckets;
+
+        free (vi->buckets);
+        vi->buckets = (int *) calloc (new_buckets, sizeof (int));
+        CHECK_ALLOC (vi->buckets, AEC_MEM);
+        vi->num_buckets = new_buckets;
+
+        for (i = 0; i < vi->num_buckets; i++)
+            vi->buckets[i] = -1;
+
+        // Relinking in order keeps the newest variable first in each bucket.
+        for (i = 0; i < vi->num_vars; i++)
+            var_index_link (vi, i);
+    }
+
+    return 0;
+}
+
+/* Finds a variable in a variable index.
+ *  input:
+ *    vi - the variable index.
+ *    text - the name of the variable.
+ *    len - the length of the name.
+ *  output:
+ *    the variable, or NULL if it has not been introduced.  The variable
+ *    is only valid until the next variable is added.
+ */
+variable *
+var_index_find (var_index * vi, const unsigned char * text, int len)
+{
+    int v;
+
+    v = vi->buckets[var_index_hash (text, len) & (vi->num_buckets - 1)];
+    for (; v >= 0; v = vi->next[v])
+    {
+        variable * var = vi->vars + v;
+
+        if (!strncmp ((const char *) var->text, (const char *) text, len)
+            && var->text[len] == '\0')
+            return var;
+    }
+
+    return NULL;
+}
+
+/* Adds a variable to a variable index, unless it is already there.
+ *  input:
+ *    vi - the variable index.
+ *    text - the name of the variable.
+ *    len - the length of the name.
+ *    arbitrary - whether or not the variable is arbitrary.
+ *    line - the line that introduces the variable.
+ *  output:
+ *    0 on success, -1 on memory error.
+ */
+int
+var_index_add (var_index * vi, const unsigned char * text, int len,
+               int arbitrary, int line)
+{
+    variable * var;
+    int ret, v;
+
+    if (var_index_find (vi, text, len))
+        return 0;
+
+    ret = var_index_grow (vi);
+    if (ret == AEC_MEM)
+        return AEC_MEM;
+
+    v = vi->num_vars;
+    var = vi->vars + v;
+
+    var->text = (unsigned char *) calloc (len + 1, sizeof (char));
+    CHECK_ALLOC (var->text, AEC_MEM);
+    memcpy (var->text, text, len);
+    var->arbitrary = arbitrary;
+
+    vi->lines[v] = line;
+    vi->hashes[v] = var_index_hash (text, len);
+    var_index_link (vi, v);
+    vi->num_vars++;
+
+    return 0;
+}
+
+/* Removes the newest variables from a variable index.
+ *  input:
+ *    vi - the variable index.
+ *    keep - the number of variables to keep.
+ *  output:
+ *    none.
+ */
+void
+var_index_truncate (var_index * vi, int keep)
+{
+    while (vi->num_vars > keep)
+    {
+        int v = --vi->num_vars;
+
+        // Every newer variable is gone, so this one begins its bucket.
+        vi->buckets[vi->hashes[v] & (vi->num_buckets - 1)] = vi->next[v];
+        free (vi->vars[v].text);
+    }
+}
+
+/* Moves a variable index to the next line of a proof.
+ *  The variables of each subproof that the line is not in are removed.
+ *  input:
+ *    vi - the variable index.
+ *    depth - the depth of the line.
+ *    subproof - whether the line begins a subproof.
+ *  output:
+ *    0 on success, -1 on memory error.
+ */
+int
+var_index_enter (var_index * vi, int depth, int subproof)
+{
+    while (vi->num_scopes > 0)
+    {
+        int top = vi->scope_depths[vi->num_scopes - 1];
+
+        if (top < depth || (top == depth && !subproof))
+            break;
+
+        vi->num_scopes--;
+        var_index_truncate (vi, vi->scope_vars[vi->num_scopes]);
+    }
+
+    if (!subproof)
+        return 0;
+
+    if (vi->num_scopes == vi->alloc_scopes)
+    {
+        int new_alloc = (vi->alloc_scopes > 0) ? 2 * vi->alloc_scopes : 8;
+
+        vi->scope_depths = (int *) realloc (vi->scope_depths,
+                                            new_alloc * sizeof (int));
+        CHECK_ALLOC (vi->scope_depths, AEC_MEM);
+        vi->scope_vars = (int *) realloc (vi->scope_vars,
+                                          new_alloc * sizeof (int));
+        CHECK_ALLOC (vi->scope_vars, AEC_MEM);
+
+        vi->alloc_scopes = new_alloc;
+    }
+
+    vi->scope_depths[vi->num_scopes] = depth;
+    vi->scope_vars[vi->num_scopes] = vi->num_vars;
+    vi->num_scopes++;
+
+    return 0;
+}
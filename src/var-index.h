@@ -0,0 +1,61 @@
+/* Functions for indexing the variables of a proof.
+
+   Copyright (C) 2026 The GNU Aris contributors.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef VAR_INDEX_H
+#define VAR_INDEX_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include "typedef.h"
+#include "var.h"
+
+// A hash table from the name of each variable of a proof to the line
+// that introduced it, kept up to date as the proof is evaluated from
+// the top.  Variables are kept in the order they were introduced, so
+// that those of a subproof are dropped together when it ends.
+
+struct var_index {
+    int num_vars;           // The number of variables indexed.
+    int alloc_vars;         // The number of variables allocated.
+    variable * vars;        // The variables, in the order introduced.
+    int * lines;            // The line that introduced each variable.
+    unsigned int * hashes;  // The hash of each variable.
+    int * next;             // The next variable in the same bucket, or -1.
+
+    int num_buckets;        // The number of buckets, a power of two.
+    int * buckets;          // The first variable in each bucket, or -1.
+
+    int num_scopes;         // The number of subproofs open.
+    int alloc_scopes;       // The number of subproofs allocated.
+    int * scope_depths;     // The depth of each open subproof.
+    int * scope_vars;       // The number of variables before each subproof.
+};
+
+var_index * var_index_init ();
+void var_index_destroy (var_index * vi);
+variable * var_index_find (var_index * vi, const unsigned char * text, int len);
+int var_index_add (var_index * vi, const unsigned char * text, int len,
+                   int arbitrary, int line);
+void var_index_truncate (var_index * vi, int keep);
+int var_index_enter (var_index * vi, int depth, int subproof);
+#ifdef __cplusplus
+}
+#endif
+
+#endif // VAR_INDEX_H
@@ -43,3 +43,17 @@ variable_init (unsigned char * text, int arbitrary)
 
     return var;
 }
+
+/* Destroys a variable object.
+ *  input:
+ *    var - the variable to destroy.
+ *  output:
+ *    none.
+ */
+void
+variable_destroy (variable * var)
+{
+    if (var->text)
+        free (var->text);
+    free (var);
+}
@@ -34,6 +34,7 @@ struct variable {
 
 variable * variable_init (unsigned char * text,
                         int arbitrary);
+void variable_destroy (variable * var);
 
 #ifdef __cplusplus
 }